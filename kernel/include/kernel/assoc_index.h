@@ -0,0 +1,212 @@
+/**
+ * QuantumOS Associative Memory Index
+ *
+ * Approximate nearest-neighbour index over fixed-length byte vectors,
+ * the store behind msi_assoc_put/get/query/forget (msi/include/msi.h).
+ * It is an HNSW graph (hierarchical navigable small world): every entry
+ * is linked to up to 2*M close neighbours on layer 0, and a geometrically
+ * shrinking subset is linked on the layers above, so a query descends
+ * greedily from the top layer and then runs a best-first search of
+ * width ef on layer 0. Exact lookups go through a hash table keyed by
+ * the CRC32C of the vector bytes.
+ *
+ * Small stores skip the graph: below `flat_threshold` entries a query
+ * is an exact scan of the vector matrix, which is faster there and
+ * costs nothing to maintain. The insert that reaches the threshold
+ * builds the graph over everything stored so far (a one-off pause of
+ * roughly threshold link operations) and later inserts link as they go.
+ *
+ * A store can also keep a quantised copy of every vector: 4 bits per
+ * dimension, or 1 bit (the top bit of each byte) compared by Hamming
+ * distance. A flat query then streams that matrix instead, which is a
+ * half or an eighth of the bytes, keeps the `rerank` * k nearest codes
+ * and re-ranks those against the full vectors. The result is
+ * approximate, so quantised stores suit a larger flat threshold rather
+ * than the default; the graph and exact searches always use full vectors.
+ *
+ * Everything lives in one caller-supplied arena, referenced by 32-bit
+ * offsets from its base, so an index can be mapped at any address:
+ *
+ *   header | nodes | vectors (64-byte stride) | codes | layer-0 links |
+ *   hash table | visited tags | search scratch | upper links | payloads
+ *
+ * Upper-layer link lists and payload copies are bump-allocated from
+ * their own regions and never freed; nodes refer to both by offset. Forgetting an entry only marks it deleted: it keeps
+ * routing searches but is never returned, and putting the same vector
+ * again revives it in place.
+ *
+ * Distances are integers. L2 is the squared Euclidean distance, DOT is
+ * 255 * 255 * dimensions minus the dot product (so smaller is closer),
+ * HAMMING counts differing bits. The kernels use SSE2/AVX2 where the
+ * build allows vector registers and POPCNT when the CPU has it; the
+ * kernel itself is built without SSE and gets unrolled scalar code.
+ *
+ * An index is not internally locked and a query writes the shared
+ * search scratch, so callers serialise all operations.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef ASSOC_INDEX_H
+#define ASSOC_INDEX_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define ASSOC_MAX_DIMENSIONS    4096    /* Bytes per vector */
+#define ASSOC_MAX_CAPACITY      (16U * 1024 * 1024)
+#define ASSOC_MAX_LEVEL         16
+#define ASSOC_MAX_M             64
+#define ASSOC_MAX_EF            1024
+#define ASSOC_VECTOR_ALIGN      64      /* Vector stride and arena alignment */
+
+#define ASSOC_DEFAULT_M                 16
+#define ASSOC_DEFAULT_EF_CONSTRUCTION   128
+#define ASSOC_DEFAULT_EF_SEARCH         64
+#define ASSOC_DEFAULT_FLAT_THRESHOLD    2048    /* Measured crossover, make bench-assoc-sizes */
+#define ASSOC_DEFAULT_RERANK            8       /* 4-bit; make bench-assoc-quant */
+#define ASSOC_DEFAULT_RERANK_BINARY     32
+
+#define ASSOC_INVALID_ID        0xFFFFFFFFU
+
+typedef enum {
+    ASSOC_METRIC_L2 = 0,
+    ASSOC_METRIC_DOT,
+    ASSOC_METRIC_HAMMING,
+    ASSOC_METRIC_COUNT
+} assoc_metric_t;
+
+typedef enum {
+    ASSOC_QUANT_NONE = 0,
+    ASSOC_QUANT_4BIT,                   /* Top nibble of each byte */
+    ASSOC_QUANT_BINARY,                 /* Top bit of each byte, Hamming distance */
+    ASSOC_QUANT_COUNT
+} assoc_quant_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t dimensions;                /* Bytes per vector */
+    uint32_t capacity;                  /* Entries, forgotten ones included */
+    uint32_t m;                         /* Links per node above layer 0; 0 = default */
+    uint32_t ef_construction;           /* Search width when inserting; 0 = default */
+    uint32_t ef_search;                 /* Search width when querying; 0 = default */
+    uint32_t payload_bytes;             /* Arena reserved for payload copies */
+    uint32_t flat_threshold;            /* Entries before the graph is built; 0 = default */
+    uint32_t rerank;                    /* Quantised candidates per result; 0 = default */
+    assoc_metric_t metric;
+    assoc_quant_t quantization;         /* Not with ASSOC_METRIC_HAMMING */
+    uint64_t seed;                      /* Level generator; 0 = fixed default */
+} assoc_config_t;
+
+typedef struct {
+    uint32_t id;
+    uint32_t distance;
+} assoc_match_t;
+
+typedef struct {
+    uint32_t count;                     /* Live entries */
+    uint32_t deleted;                   /* Forgotten entries still stored */
+    uint32_t linked;                    /* Entries in the graph, 0 while flat */
+    uint32_t max_level;
+    uint64_t arena_size;
+    uint64_t arena_used;
+    uint64_t payload_used;              /* Of arena_used, payload copies */
+    uint32_t vector_bytes;              /* Matrix stride per entry */
+    uint32_t code_bytes;                /* Quantised matrix stride, 0 if none */
+    uint64_t distance_evals;            /* Since creation, quantised ones included */
+} assoc_stats_t;
+
+typedef struct assoc_index assoc_index_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Bytes of arena an index with this configuration needs, or 0 if the
+ * configuration is invalid
+ */
+size_t assoc_index_arena_size(const assoc_config_t *config);
+
+/**
+ * Build an empty index in `arena`, which must be ASSOC_VECTOR_ALIGN
+ * aligned and at least assoc_index_arena_size() bytes
+ */
+status_t assoc_index_create(void *arena, size_t size, const assoc_config_t *config,
+                            assoc_index_t **index);
+
+/**
+ * Add a vector with a copy of its payload
+ *
+ * @return STATUS_BUSY if a live entry already holds the same vector,
+ *         STATUS_NO_MEMORY if the index or its arena is full
+ */
+status_t assoc_index_insert(assoc_index_t *index, const uint8_t *vector,
+                            const void *payload, uint32_t payload_size, uint32_t *id);
+
+/**
+ * Id of the live entry whose vector equals `vector`
+ */
+status_t assoc_index_lookup(const assoc_index_t *index, const uint8_t *vector, uint32_t *id);
+
+/**
+ * Mark an entry deleted; it stays in the graph for routing
+ */
+status_t assoc_index_remove(assoc_index_t *index, uint32_t id);
+
+/**
+ * Up to `k` live entries closest to `vector`, nearest first
+ *
+ * @param ef Search width, 0 for the configured default; raised to k
+ * @return Number of matches written
+ */
+uint32_t assoc_index_search(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                            uint32_t ef, assoc_match_t *matches);
+
+/**
+ * Exact k nearest neighbours by a linear scan of the vector matrix;
+ * what assoc_index_search() does below the flat threshold when the
+ * store is not quantised
+ */
+uint32_t assoc_index_search_exact(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                                  assoc_match_t *matches);
+
+/* Bytes per vector */
+uint32_t assoc_index_dimensions(const assoc_index_t *index);
+
+/* Stored data of an entry; pointers stay valid for the life of the arena */
+const uint8_t *assoc_index_vector(const assoc_index_t *index, uint32_t id);
+const void *assoc_index_payload(const assoc_index_t *index, uint32_t id, uint32_t *size);
+
+void assoc_index_get_stats(const assoc_index_t *index, assoc_stats_t *stats);
+
+/**
+ * Distance between two vectors with the dispatched kernels
+ */
+uint32_t assoc_distance(assoc_metric_t metric, const uint8_t *a, const uint8_t *b,
+                        uint32_t dimensions);
+
+/* ============================================================================
+ * MSI Binding (kernel/src/msi/assoc.c)
+ * ============================================================================ */
+
+/**
+ * Set up the store behind msi_assoc_*(). Without this the first
+ * msi_assoc_put() creates a default L2 store sized for its vectors.
+ *
+ * @return STATUS_BUSY if the store already exists
+ */
+status_t msi_assoc_configure(const assoc_config_t *config);
+
+/**
+ * The store behind msi_assoc_*(), or NULL before the first put
+ */
+assoc_index_t *msi_assoc_index(void);
+
+#endif /* ASSOC_INDEX_H */
@@ -66,6 +66,7 @@ void boot_log(const char *message);
 bool boot_validate_multiboot(uint32_t magic, uint32_t info_addr);
 
 // Early boot utilities
+void boot_run_constructors(void);
 void early_console_init(void);
 void early_console_write(const char *str);
 void early_console_write_hex(uint64_t value);
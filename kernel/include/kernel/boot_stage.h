@@ -0,0 +1,73 @@
+/**
+ * QuantumOS Boot Stages
+ *
+ * Kernel initialisation expressed as a dependency graph. Each stage
+ * names the stages it needs; the runner orders them into waves, where
+ * every stage in a wave depends only on earlier waves, and timestamps
+ * each stage with the TSC for a boot-time breakdown.
+ *
+ * Stages in the same wave are independent of each other, which makes
+ * them the unit of parallelism once application processors are brought
+ * up. Until then waves run one stage after another on the BSP.
+ *
+ * Stages flagged BOOT_STAGE_DEFERRED (self-tests, benchmarks, warm-up
+ * work) are kept off the critical path and run only after the system
+ * has reported ready.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef BOOT_STAGE_H
+#define BOOT_STAGE_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define BOOT_STAGE_MAX          32      /* Stages per graph (dependency mask width) */
+
+/* boot_stage_t.flags */
+#define BOOT_STAGE_DEFERRED     BIT(0)  /* Run after "ready" */
+#define BOOT_STAGE_OPTIONAL     BIT(1)  /* Failure is logged, not fatal */
+
+#define BOOT_STAGE_DEP(id)      BIT(id)
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef status_t (*boot_stage_fn_t)(void);
+
+typedef struct {
+    const char *name;
+    boot_stage_fn_t fn;
+    uint32_t deps;                      /* BOOT_STAGE_DEP() mask of prerequisites */
+    uint32_t flags;
+
+    /* Filled in by the runner */
+    uint32_t wave;                      /* Dependency depth */
+    status_t result;
+    uint64_t cycles;                    /* TSC cycles spent in fn */
+    bool done;
+} boot_stage_t;
+
+typedef struct {
+    uint64_t start_tsc;                 /* Kernel entry */
+    uint64_t ready_tsc;                 /* End of the critical path */
+    uint64_t deferred_tsc;              /* End of deferred work */
+    uint32_t waves;                     /* Critical-path waves */
+} boot_profile_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+void boot_profile_start(boot_profile_t *profile);
+status_t boot_stages_run(boot_stage_t *stages, uint32_t count, bool deferred,
+                         boot_profile_t *profile);
+void boot_stages_report(const boot_stage_t *stages, uint32_t count,
+                        const boot_profile_t *profile);
+
+#endif /* BOOT_STAGE_H */
@@ -0,0 +1,197 @@
+/**
+ * QuantumOS Capability Spaces
+ *
+ * A CSpace maps capability pointers (cptrs) to capabilities: a typed
+ * kernel object reference with the operations it allows. Slots live in
+ * a fixed-depth radix tree of CSPACE_RADIX-entry nodes, so resolving a
+ * cptr is CSPACE_LEVELS dependent loads however many capabilities the
+ * space holds. Nodes are allocated on first use and only freed when
+ * the space is destroyed, so a reader never follows a pointer into a
+ * freed node.
+ *
+ * CAP_TYPE_RIGHT capabilities grant a system right (cap_right_t) rather
+ * than an object. Every space caches the union of its rights as a
+ * bitmap, kept in step with a per-right grant count, so "may the caller
+ * do X" is one bit test and never walks the slots.
+ *
+ * One writer per space: callers serialise insert, delete and seal.
+ * Readers of an open space take a copy of a slot under a sequence
+ * counter and retry if a write raced them. Sealing a space makes it
+ * immutable for the rest of its life; sealed reads skip the counter
+ * and are plain loads.
+ *
+ * Spaces made with cspace_init_table() are not registered: they are
+ * reached only through their owner, like the per-process endpoint
+ * tables in kernel/ipc.h.
+ *
+ * A process is placed in a space by cspace_attach(), which stores the
+ * space id in process_t.capability_root. A process outside any space
+ * gets a fixed default: every right for PROCESS_TYPE_KERNEL processes,
+ * which run kernel code, and none for any other type, so user and
+ * service processes must be attached before they can call in. A
+ * process whose space was destroyed holds no rights at all.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CAPABILITY_H
+#define CAPABILITY_H
+
+#include <kernel/types.h>
+#include <kernel/process.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define CSPACE_RADIX_BITS       6
+#define CSPACE_RADIX            (1U << CSPACE_RADIX_BITS)
+#define CSPACE_LEVELS           3
+#define CSPACE_SLOTS            (1U << (CSPACE_RADIX_BITS * CSPACE_LEVELS))
+
+#define CAP_NULL                0       /* Never a valid cptr */
+#define CAP_RIGHT_MAX           256
+#define CAP_RIGHT_WORDS         (CAP_RIGHT_MAX / 64)
+
+#define CSPACE_MAX_SPACES       256
+
+/**
+ * System rights. Numbers from CAP_RIGHT_SERVICE up are free for
+ * services to assign to their own operations.
+ */
+typedef enum {
+    CAP_RIGHT_IPC_SEND = 0,             /* ipc_send, ipc_call, ipc_reply, ipc_endpoint_send/grant */
+    CAP_RIGHT_IPC_RECEIVE,              /* ipc_receive, ipc_queue_depth, ipc_endpoint_create, wait sets */
+    CAP_RIGHT_IPC_PORT,                 /* Port create, destroy, lookup and traffic */
+    CAP_RIGHT_PROCESS_KILL,
+    CAP_RIGHT_MSI_EVENT,                /* msi_event_*, once events exist */
+    CAP_RIGHT_MSI_STATE,                /* msi_state_map, read, write and commit */
+    CAP_RIGHT_MSI_ASSOC,                /* msi_assoc_put, get, query and forget */
+    CAP_RIGHT_MSI_LANE,                 /* msi_lane_spawn */
+    CAP_RIGHT_SERVICE = 64
+} cap_right_t;
+
+typedef enum {
+    CAP_TYPE_NULL = 0,                  /* Free slot */
+    CAP_TYPE_RIGHT,                     /* `rights` holds one cap_right_t */
+    CAP_TYPE_OBJECT,                    /* `object` with an operation mask in `rights` */
+    CAP_TYPE_ENDPOINT                   /* IPC queue, IPC_ENDPOINT_* in `rights` */
+} cap_type_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct {
+    void *object;
+    uint32_t type;                      /* cap_type_t */
+    uint32_t rights;
+    uint64_t badge;                     /* Chosen by the granter; free slots: next free cptr */
+    uint64_t generation;                /* Incarnation of `object` it was made for */
+} cap_t;
+
+typedef struct cspace_node cspace_node_t;
+
+typedef struct {
+    /* Read on every check */
+    uint64_t rights[CAP_RIGHT_WORDS];   /* Bit set while any slot grants the right */
+    bool sealed;
+    uint32_t seq;                       /* Odd while a write is in progress */
+    uint32_t id;                        /* Registry id, 0 once destroyed */
+
+    cspace_node_t *root;
+    uint32_t next_cptr;                 /* Slots at and above never used */
+    uint32_t free_head;                 /* Deleted slots, CAP_NULL-terminated */
+    uint32_t count;                     /* Slots in use */
+    uint32_t grants[CAP_RIGHT_MAX];     /* CAP_TYPE_RIGHT slots per right; holds CSPACE_SLOTS */
+} cspace_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Initialise an empty space and give it a registry id
+ *
+ * @return STATUS_NO_MEMORY with CSPACE_MAX_SPACES spaces live
+ */
+status_t cspace_init(cspace_t *cs);
+
+/**
+ * Initialise an empty space without a registry id
+ */
+status_t cspace_init_table(cspace_t *cs);
+
+/**
+ * Free every node and retire the id; attached processes lose all rights
+ */
+void cspace_destroy(cspace_t *cs);
+
+/**
+ * Place a capability in a free slot
+ *
+ * @param cptr Receives the slot, may be NULL
+ * @return STATUS_PERMISSION_DENIED once sealed, STATUS_NO_MEMORY when
+ *         the space or the heap is full
+ */
+status_t cspace_insert(cspace_t *cs, const cap_t *cap, uint32_t *cptr);
+
+/**
+ * Grant a system right; a right granted twice takes two deletes to lose
+ */
+status_t cspace_grant(cspace_t *cs, uint32_t right, uint32_t *cptr);
+
+/**
+ * Empty a slot
+ *
+ * @return STATUS_NOT_FOUND for a free slot, STATUS_PERMISSION_DENIED once sealed
+ */
+status_t cspace_delete(cspace_t *cs, uint32_t cptr);
+
+/**
+ * Copy out the capability at `cptr`. Lock-free: sealed spaces read the
+ * slot directly, open ones retry across concurrent writes.
+ *
+ * @return STATUS_NOT_FOUND for a free or out-of-range slot
+ */
+status_t cspace_lookup(const cspace_t *cs, uint32_t cptr, cap_t *cap);
+
+/**
+ * Make the space immutable. Idempotent.
+ */
+void cspace_seal(cspace_t *cs);
+
+/**
+ * Space with registry id `id`, NULL if none is live
+ */
+cspace_t *cspace_get(uint32_t id);
+
+/**
+ * Restrict process `pid` to the rights of `cs`
+ */
+status_t cspace_attach(cspace_t *cs, uint32_t pid);
+
+/**
+ * Whether the space grants `right`. One aligned word, so it needs no
+ * retry loop whether or not the space is sealed.
+ */
+static inline bool cspace_has_right(const cspace_t *cs, uint32_t right) {
+    if (right >= CAP_RIGHT_MAX) {
+        return false;
+    }
+    return (__atomic_load_n(&cs->rights[right / 64], __ATOMIC_RELAXED) >> (right % 64)) & 1;
+}
+
+/**
+ * Whether `process` may use `right`: the per-call check on IPC and MSI
+ * entry points. NULL is the kernel before the first process exists and
+ * holds every right; unattached processes get the default above.
+ */
+bool cap_process_has(const process_t *process, uint32_t right);
+
+/**
+ * cap_process_has() for the running process
+ */
+bool cap_current_has(uint32_t right);
+
+#endif /* CAPABILITY_H */
@@ -0,0 +1,132 @@
+/**
+ * QuantumOS CPU Primitives
+ *
+ * Small inline helpers for CPU-local facilities that hot paths need
+ * without a function call: the time-stamp counter, MSR access and the
+ * identity of the executing CPU.
+ *
+ * In the native test build (QUANTUM_HOST, see tests/host) the
+ * privileged instructions would fault in user mode: MSRs read as zero
+ * and the interrupt flag is left alone.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CPU_H
+#define CPU_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * CPU Identity
+ * ============================================================================ */
+
+#define MAX_CPUS        8       /* Upper bound for per-CPU arrays */
+
+/**
+ * Index of the executing CPU
+ *
+ * Per-CPU data is kept in arrays indexed by this value. Only the BSP is
+ * brought up today, so this is always 0.
+ *
+ * @return CPU index in [0, MAX_CPUS)
+ */
+static inline uint32_t cpu_current_id(void) {
+    return 0;
+}
+
+/* ============================================================================
+ * Time-Stamp Counter
+ * ============================================================================ */
+
+/**
+ * Read the time-stamp counter
+ *
+ * Not serialising: the read may be reordered with surrounding
+ * instructions, which is fine for accounting at context-switch and
+ * interrupt granularity.
+ *
+ * @return Current TSC value in cycles
+ */
+static inline uint64_t cpu_rdtsc(void) {
+    uint32_t lo, hi;
+    __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/* ============================================================================
+ * Model-Specific Registers
+ * ============================================================================ */
+
+#ifdef QUANTUM_HOST
+
+static inline uint64_t cpu_rdmsr(uint32_t msr) {
+    (void)msr;
+    return 0;
+}
+
+static inline void cpu_wrmsr(uint32_t msr, uint64_t value) {
+    (void)msr;
+    (void)value;
+}
+
+#else
+
+static inline uint64_t cpu_rdmsr(uint32_t msr) {
+    uint32_t lo, hi;
+    __asm__ volatile("rdmsr" : "=a"(lo), "=d"(hi) : "c"(msr));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static inline void cpu_wrmsr(uint32_t msr, uint64_t value) {
+    __asm__ volatile("wrmsr" : : "c"(msr), "a"((uint32_t)value), "d"((uint32_t)(value >> 32)));
+}
+
+#endif /* QUANTUM_HOST */
+
+/* ============================================================================
+ * Local Interrupt State
+ * ============================================================================ */
+
+/**
+ * Disable interrupts on this CPU, returning the previous RFLAGS
+ */
+static inline uint64_t cpu_irq_save(void) {
+    uint64_t flags;
+#ifdef QUANTUM_HOST
+    __asm__ volatile("pushfq; popq %0" : "=r"(flags) : : "memory");
+    flags &= ~(uint64_t)BIT(9);
+#else
+    __asm__ volatile("pushfq; popq %0; cli" : "=r"(flags) : : "memory");
+#endif
+    return flags;
+}
+
+/**
+ * Set the interrupt flag
+ */
+static inline void cpu_irq_enable(void) {
+#ifndef QUANTUM_HOST
+    __asm__ volatile("sti" : : : "memory");
+#endif
+}
+
+/**
+ * Clear the interrupt flag
+ */
+static inline void cpu_irq_disable(void) {
+#ifndef QUANTUM_HOST
+    __asm__ volatile("cli" : : : "memory");
+#endif
+}
+
+/**
+ * Restore the interrupt flag saved by cpu_irq_save()
+ */
+static inline void cpu_irq_restore(uint64_t flags) {
+    if (flags & BIT(9)) {
+        __asm__ volatile("sti" : : : "memory");
+    }
+}
+
+#endif /* CPU_H */
@@ -0,0 +1,90 @@
+/**
+ * QuantumOS Per-Process Cycle Budgets
+ *
+ * Hard CPU budgets for processes that must not starve the rest of the
+ * system, primarily consciousness-class workloads. Each budgeted process
+ * may consume at most `budget` TSC cycles per replenishment `period`.
+ *
+ * Cycles are charged at context-switch time from RDTSC deltas. Once a
+ * process exhausts its budget it is throttled: the scheduler skips it
+ * until its current period ends and the budget is replenished. Any
+ * consumption beyond the budget is recorded as an overrun.
+ *
+ * Replenishment is lazy - it happens on the next charge or throttle
+ * check after the period boundary - so no timer is required.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef CYCLE_BUDGET_H
+#define CYCLE_BUDGET_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define CYCLE_BUDGET_UNLIMITED          0       /* No budget enforced */
+#define CYCLE_BUDGET_DEFAULT_PERIOD     100000000ULL /* ~50ms at 2GHz TSC */
+#define CYCLE_BUDGET_MIN_PERIOD         10000ULL     /* Reject tiny periods */
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+/**
+ * Per-process budget state
+ */
+typedef struct {
+    uint64_t budget;            /* Cycles allowed per period (0 = unlimited) */
+    uint64_t period;            /* Replenishment period in TSC cycles */
+    uint64_t period_start;      /* TSC at start of current period */
+    uint64_t used;              /* Cycles consumed in current period */
+
+    /* Statistics */
+    uint64_t total_used;        /* Cycles consumed over lifetime */
+    uint64_t overrun_cycles;    /* Cycles consumed beyond budget */
+    uint32_t overrun_count;     /* Periods in which budget was exceeded */
+    uint32_t throttle_count;    /* Times the process was throttled */
+    uint32_t replenish_count;   /* Periods completed */
+
+    uint32_t pid;               /* Process the budget belongs to */
+    bool throttled;             /* Budget exhausted for current period */
+    bool active;                /* Budget is being enforced */
+} cycle_budget_t;
+
+/**
+ * Global budget statistics
+ */
+typedef struct {
+    uint32_t budgeted_processes;/* Processes with an active budget */
+    uint32_t throttled_processes;/* Currently throttled */
+    uint64_t total_overruns;    /* Overrun events across all processes */
+    uint64_t total_overrun_cycles; /* Cycles beyond budget, all processes */
+} cycle_budget_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/* Initialization */
+status_t cycle_budget_init(void);
+
+/* Budget configuration */
+status_t cycle_budget_set(uint32_t pid, uint64_t budget, uint64_t period);
+status_t cycle_budget_clear(uint32_t pid);
+
+/* Accounting (called from the context-switch path) */
+status_t cycle_budget_charge(uint32_t pid, uint64_t cycles, uint64_t now);
+bool cycle_budget_is_throttled(uint32_t pid, uint64_t now);
+uint64_t cycle_budget_remaining(uint32_t pid, uint64_t now);
+
+/* Information */
+status_t cycle_budget_get(uint32_t pid, cycle_budget_t *out);
+status_t cycle_budget_get_stats(cycle_budget_stats_t *stats);
+
+/* Debug and diagnostics */
+void cycle_budget_dump(uint32_t pid);
+
+#endif /* CYCLE_BUDGET_H */
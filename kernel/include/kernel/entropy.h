@@ -0,0 +1,179 @@
+/**
+ * QuantumOS Entropy Pool
+ *
+ * Kernel random numbers: an input pool fed by the CPU (RDSEED, RDRAND),
+ * TSC jitter and interrupt timing, and a ChaCha20 generator that expands
+ * it into output.
+ *
+ * Inputs are absorbed into a sponge over the ChaCha permutation. Each
+ * source is credited a conservative number of bits; once the pool
+ * holds ENTROPY_RESEED_BITS the next draw reseeds the base generator
+ * from it. Interrupts are first folded into a small per-CPU pool on the
+ * interrupt path and reach the input pool every ENTROPY_IRQ_BATCH
+ * interrupts.
+ *
+ * Output comes from per-CPU generators keyed from the base generator.
+ * Each refills a small buffer with fast key erasure: a batch of ChaCha20
+ * blocks whose first 32 bytes replace the key, so earlier output cannot
+ * be recomputed from a later state. Small draws copy out of the buffer
+ * with interrupts disabled on the local CPU; draws above
+ * ENTROPY_DIRECT_MIN take a private key from the buffer and run ChaCha20
+ * straight into the caller's memory with interrupts enabled.
+ *
+ * The ENTROPY_GET / ENTROPY_REFRESH service of the Memory & Entropy
+ * Manager (docs/SERVICES_ARCHITECTURE.md) is served over an IPC port by
+ * entropy_service_poll(), writing bulk results into a shared region the
+ * client grants to the server.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef ENTROPY_H
+#define ENTROPY_H
+
+#include <kernel/types.h>
+#include <kernel/ipc.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define ENTROPY_RESEED_BITS     256     /* Pool credit that triggers a reseed */
+#define ENTROPY_RESEED_BYTES    (1ULL << 20)  /* Per-CPU output between rekeys from the base */
+#define ENTROPY_BUFFER_BLOCKS   8       /* ChaCha20 blocks per per-CPU refill */
+#define ENTROPY_DIRECT_MIN      256     /* Draws from here up bypass the buffer */
+#define ENTROPY_IRQ_BATCH       64      /* Interrupts per fold into the input pool */
+
+#define ENTROPY_SERVICE_NAME    "entropy"
+#define ENTROPY_INLINE_MAX      256     /* Bytes a reply may carry without a region */
+
+/*
+ * Service requests. Numbered as in the Memory & Entropy Manager's
+ * memory_msg_t (docs/SERVICES_ARCHITECTURE.md).
+ */
+#define ENTROPY_GET             5
+#define ENTROPY_REFRESH         6
+
+/* Input sources */
+typedef enum {
+    ENTROPY_SOURCE_RDSEED = 0,
+    ENTROPY_SOURCE_RDRAND,
+    ENTROPY_SOURCE_JITTER,              /* TSC deltas across a memory walk */
+    ENTROPY_SOURCE_INTERRUPT,
+    ENTROPY_SOURCE_EXTERNAL,            /* entropy_add() */
+    ENTROPY_SOURCE_COUNT
+} entropy_source_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+/**
+ * ENTROPY_GET / ENTROPY_REFRESH request, the payload of an IPC message
+ *
+ * region_id 0 asks for up to ENTROPY_INLINE_MAX bytes inline in the
+ * reply; otherwise `length` bytes are written at `offset` in the region,
+ * which the client must have granted to the server with IPC_SHARE_WRITE.
+ */
+typedef struct {
+    uint32_t type;                      /* ENTROPY_GET or ENTROPY_REFRESH */
+    uint32_t region_id;
+    uint64_t offset;
+    uint64_t length;
+} entropy_request_t;
+
+/**
+ * Reply payload; inline bytes follow it
+ */
+typedef struct {
+    uint32_t type;
+    int32_t status;                     /* ipc_result_t */
+    uint64_t length;                    /* Bytes written */
+    uint64_t entropy_available;         /* Bits credited to the pool since the last reseed */
+    uint32_t entropy_quality;           /* Bits the generator was last seeded with */
+    uint32_t reserved;
+} entropy_response_t;
+
+typedef struct {
+    uint64_t samples[ENTROPY_SOURCE_COUNT];
+    uint64_t credited[ENTROPY_SOURCE_COUNT];    /* Bits */
+    uint64_t reseeds;
+    uint64_t bytes_out;
+    uint32_t pool_bits;
+    uint32_t seed_bits;
+    bool has_rdseed;
+    bool has_rdrand;
+} entropy_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Detect the CPU sources and seed the generator from them and TSC jitter
+ */
+status_t entropy_init(void);
+
+/**
+ * Record an interrupt. Called on the interrupt path with interrupts
+ * disabled; costs a few ALU operations, plus a pool absorb every
+ * ENTROPY_IRQ_BATCH calls.
+ */
+void entropy_add_interrupt(uint32_t vector, uint64_t tsc);
+
+/**
+ * Mix caller-supplied input into the pool
+ *
+ * @param bits Entropy to credit, at most 8 per byte
+ */
+void entropy_add(const void *data, size_t len, uint32_t bits);
+
+/**
+ * Gather fresh CPU and jitter input and reseed every generator from the
+ * pool now, whatever its credit (ENTROPY_REFRESH)
+ */
+void entropy_reseed(void);
+
+/**
+ * Fill `buf` with random bytes. Never blocks; before entropy_init()
+ * output rests on whatever input has reached the pool.
+ */
+void entropy_get(void *buf, size_t len);
+
+uint64_t entropy_get_u64(void);
+
+void entropy_get_stats(entropy_stats_t *stats);
+
+/**
+ * The generator's ChaCha20 block function (64-bit counter and nonce),
+ * exposed for known-answer tests
+ */
+void entropy_chacha20_block(const uint32_t key[8], uint64_t counter, uint64_t nonce,
+                            uint32_t out[16]);
+
+/* ============================================================================
+ * Service
+ * ============================================================================ */
+
+/**
+ * Create the ENTROPY_SERVICE_NAME port, owned by the caller
+ */
+ipc_result_t entropy_service_start(uint32_t *port_id);
+
+/**
+ * Answer one request as the server process
+ *
+ * @param request Message received on the service port
+ * @param reply Filled with an entropy_response_t and any inline bytes
+ * @return Status also placed in the response
+ */
+ipc_result_t entropy_service_handle(const ipc_message_t *request, ipc_message_t *reply);
+
+/**
+ * Receive and answer up to `max` requests waiting on `port_id`
+ *
+ * @return Requests answered
+ */
+uint32_t entropy_service_poll(uint32_t port_id, uint32_t max);
+
+#endif /* ENTROPY_H */
@@ -0,0 +1,33 @@
+/**
+ * QuantumOS Text Formatting
+ *
+ * Appenders for the line-oriented dumps written over serial (trace,
+ * profile, gcov and kbench output). Each writes at buf[len] and returns
+ * the new length; the caller sizes the buffer, and nothing is
+ * terminated. Hex is lower case without a 0x prefix.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <kernel/types.h>
+
+/* Longest fmt_dec() output: UINT64_MAX */
+#define FMT_DEC_MAX             20
+
+uint32_t fmt_str(char *buf, uint32_t len, const char *str);
+uint32_t fmt_dec(char *buf, uint32_t len, uint64_t value);
+
+/**
+ * Hex without leading zeros; "0" for zero
+ */
+uint32_t fmt_hex(char *buf, uint32_t len, uint64_t value);
+
+/**
+ * Two hex digits
+ */
+uint32_t fmt_hex_byte(char *buf, uint32_t len, uint8_t byte);
+
+#endif /* FORMAT_H */
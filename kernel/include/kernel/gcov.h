@@ -0,0 +1,113 @@
+/**
+ * QuantumOS Profile Counter Export (gcov)
+ *
+ * Minimal runtime for kernels compiled with -fprofile-arcs, the first
+ * half of the profile-guided build (`make pgo`). The compiler gives
+ * every translation unit a constructor that calls __gcov_init() with a
+ * description of the unit's arc counters; boot_run_constructors() runs
+ * them before anything else. gcov_dump() then serialises each unit in
+ * the .gcda format that -fprofile-use reads and writes it to the serial
+ * console as hex:
+ *
+ *   #GCOV-BEGIN <version> <units>
+ *   #GCDA <path of the .gcda file>
+ *   #D <up to GCOV_DUMP_LINE_BYTES bytes of it, hex>
+ *   #GCOV-END <units> <bytes>
+ *
+ * tools/gcovdump.c turns a capture back into .gcda files. Only arc
+ * counters are collected (no value profiles), which is what branch
+ * probabilities, block placement and inlining decisions are built from.
+ *
+ * The counter layout follows the compiler; GCC 10 to 14 are supported.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef GCOV_H
+#define GCOV_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define GCOV_DUMP_VERSION       1
+#define GCOV_DUMP_LINE_BYTES    32
+
+#define GCOV_DATA_MAGIC         0x67636461U     /* "gcda" */
+#define GCOV_TAG_FUNCTION       0x01000000U
+#define GCOV_TAG_OBJECT_SUMMARY 0xa1000000U
+#define GCOV_COUNTER_ARCS       0               /* Counter kind of edge counts */
+#define GCOV_TAG_COUNTER_BASE   0x01a10000U
+#define GCOV_TAG_FOR_COUNTER(n) (GCOV_TAG_COUNTER_BASE + ((uint32_t)(n) << 17))
+
+#if defined(__GNUC__) && __GNUC__ >= 14
+#define GCOV_COUNTERS           9
+#else
+#define GCOV_COUNTERS           8
+#endif
+
+/* Record lengths are in bytes from GCC 12, in 32-bit words before */
+#if defined(__GNUC__) && __GNUC__ >= 12
+#define GCOV_UNIT_SIZE          4
+#else
+#define GCOV_UNIT_SIZE          1
+#endif
+
+/* ============================================================================
+ * Data Structures (emitted by the compiler)
+ * ============================================================================ */
+
+typedef int64_t gcov_type;
+
+struct gcov_info;
+
+typedef struct {
+    uint32_t num;                       /* Counters */
+    gcov_type *values;
+} gcov_ctr_info_t;
+
+typedef struct {
+    const struct gcov_info *key;
+    uint32_t ident;
+    uint32_t lineno_checksum;
+    uint32_t cfg_checksum;
+    gcov_ctr_info_t ctrs[];             /* One per active counter kind */
+} gcov_fn_info_t;
+
+typedef struct gcov_info {
+    uint32_t version;
+    struct gcov_info *next;
+    uint32_t stamp;
+#if defined(__GNUC__) && __GNUC__ >= 12
+    uint32_t checksum;
+#endif
+    const char *filename;
+    void (*merge[GCOV_COUNTERS])(gcov_type *, uint32_t);  /* NULL: kind unused */
+    uint32_t n_functions;
+    const gcov_fn_info_t *const *functions;
+} gcov_info_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Number of units registered by __gcov_init()
+ */
+uint32_t gcov_unit_count(void);
+
+/**
+ * Write every unit's counters to the serial console
+ *
+ * @return STATUS_NOT_FOUND if the kernel is not instrumented
+ */
+status_t gcov_dump(void);
+
+/* Compiler interface */
+void __gcov_init(gcov_info_t *info);
+void __gcov_exit(void);
+void __gcov_merge_add(gcov_type *counters, uint32_t count);
+
+#endif /* GCOV_H */
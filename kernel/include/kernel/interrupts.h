@@ -59,6 +59,11 @@ typedef enum {
 #define IRQ_PRIMARY_ATA          14
 #define IRQ_SECONDARY_ATA        15
 
+// Dynamically allocated vectors (MSI/MSI-X), allocated per CPU
+#define IRQ_VECTOR_DYNAMIC_BASE  48
+#define IRQ_VECTOR_DYNAMIC_MAX   254
+#define APIC_SPURIOUS_VECTOR     255
+
 // Interrupt gate descriptor
 typedef struct {
     uint16_t offset_low;
@@ -76,6 +81,20 @@ typedef struct {
     uint64_t base;
 } __attribute__((packed)) idt_ptr_t;
 
+// GDT pointer (same layout as the IDT's)
+typedef idt_ptr_t gdt_ptr_t;
+
+// 64-bit task-state segment: only the stack pointers are used
+typedef struct {
+    uint32_t reserved0;
+    uint64_t rsp[3];  // Stack loaded on entry from ring 3 (rsp[0])
+    uint64_t reserved1;
+    uint64_t ist[7];  // Interrupt stack table: IST index n is ist[n - 1]
+    uint64_t reserved2;
+    uint16_t reserved3;
+    uint16_t iomap_base;
+} __attribute__((packed)) tss_t;
+
 // CPU state saved on interrupt
 typedef struct {
     uint64_t r15, r14, r13, r12, r11, r10, r9, r8;
@@ -87,6 +106,9 @@ typedef struct {
 // Interrupt handler function type
 typedef void (*interrupt_handler_t)(cpu_state_t *state);
 
+// Handler for a dynamically allocated vector
+typedef void (*irq_vector_handler_t)(uint8_t vector, void *context);
+
 // Interrupt handler registration
 typedef struct {
     interrupt_handler_t handler;
@@ -94,6 +116,27 @@ typedef struct {
     uint32_t flags;
 } interrupt_handler_info_t;
 
+// Handler latency histogram: bucket b counts handlers that took
+// [2^(b+SHIFT), 2^(b+SHIFT+1)) TSC cycles; first and last buckets are open-ended
+#define IRQ_LATENCY_BUCKETS       16
+#define IRQ_LATENCY_BUCKET_SHIFT  6
+
+// Per-CPU interrupt statistics (written only by the owning CPU)
+typedef struct {
+    uint64_t count[IRQ_MAX + 1];
+    uint64_t latency_total[IRQ_MAX + 1];
+    uint64_t latency_max[IRQ_MAX + 1];
+    uint32_t latency_hist[IRQ_MAX + 1][IRQ_LATENCY_BUCKETS];
+} __attribute__((aligned(64))) irq_cpu_stats_t;
+
+// Per-vector statistics aggregated across CPUs
+typedef struct {
+    uint64_t count;
+    uint64_t latency_total;
+    uint64_t latency_max;
+    uint64_t latency_hist[IRQ_LATENCY_BUCKETS];
+} irq_vector_stats_t;
+
 // Interrupt management functions
 irq_result_t interrupts_init(void);
 irq_result_t interrupt_register(uint8_t vector, interrupt_handler_t handler, void *context);
@@ -103,9 +146,15 @@ irq_result_t interrupt_disable(uint8_t vector);
 irq_result_t interrupt_enable_all(void);
 irq_result_t interrupt_disable_all(void);
 
+// Per-CPU vector allocation for message-signalled interrupts
+irq_result_t irq_vector_alloc(uint32_t cpu, irq_vector_handler_t handler, void *context, uint8_t *vector);
+irq_result_t irq_vector_free(uint32_t cpu, uint8_t vector);
+uint32_t irq_vector_free_count(uint32_t cpu);
+
 // Exception handling
 void exception_handler(cpu_state_t *state);
 void divide_error_handler(cpu_state_t *state);
+void nmi_handler(cpu_state_t *state);
 void page_fault_handler(cpu_state_t *state);
 void general_protection_fault_handler(cpu_state_t *state);
 void double_fault_handler(cpu_state_t *state);
@@ -114,12 +163,17 @@ void double_fault_handler(cpu_state_t *state);
 void irq_handler(cpu_state_t *state);
 void timer_irq_handler(cpu_state_t *state);
 void keyboard_irq_handler(cpu_state_t *state);
+void timer_softirq_handler(void);
+void keyboard_softirq_handler(void);
 
 // Low-level interrupt handling
 void idt_set_gate(uint8_t vector, uint64_t handler_addr, uint16_t selector, uint8_t type_attr);
 void idt_install(void);
 void load_idt(idt_ptr_t *idtp);
 
+// Entry stubs for vectors IRQ_VECTOR_DYNAMIC_BASE..255 (interrupts.S)
+extern void (*const vector_stub_table[])(void);
+
 // Interrupt controller (PIC)
 void pic_init(void);
 void pic_send_eoi(uint8_t irq);
@@ -131,15 +185,25 @@ void apic_init(void);
 void apic_timer_init(uint32_t frequency);
 void apic_send_eoi(void);
 void apic_timer_handler(cpu_state_t *state);
+bool apic_is_enabled(void);
+uint32_t apic_get_id(uint32_t cpu);
+irq_result_t apic_send_self_ipi(uint8_t vector);
+irq_result_t apic_set_perf_nmi(bool enable);
 
 // Stack switching for interrupts
 void interrupt_stack_init(void);
 void set_ist_entry(uint8_t vector, uint8_t ist_index);
+void load_gdt(gdt_ptr_t *gdtp);  // Also reloads CS, DS, ES and SS
+void load_tss(uint16_t selector);
+uint64_t irq_stack_top(uint64_t rsp);  // Called by irq_common
 
 // Debugging
 void dump_cpu_state(cpu_state_t *state);
 void dump_idt(void);
 void interrupt_stats(void);
+irq_result_t interrupt_get_vector_stats(uint8_t vector, irq_vector_stats_t *out);
+uint64_t interrupt_total_count(void);
+uint64_t interrupt_measure_overhead(uint32_t iterations);
 
 // Error codes for exceptions
 #define PF_PRESENT     0x01
@@ -157,11 +221,34 @@ void interrupt_stats(void);
 #define DPL_KERNEL    0x00
 #define DPL_USER      0x03
 
-// IST indices
+// IST indices. Vectors that can arrive with any stack pointer (an NMI
+// or #MC between SYSCALL and the stack switch, a #DF from an overflow)
+// run on their own per-CPU stack.
 #define IST_NONE      0
 #define IST_DOUBLE_FAULT 1
 #define IST_NMI       2
+#define IST_MACHINE_CHECK 3
 #define IST_MAX       7
+#define IST_STACKS    3       // IST indices 1..IST_STACKS are backed
+#define IST_STACK_SIZE 8192
+
+// Per-CPU interrupt stack. irq_common moves IRQ handlers, and the
+// softirqs run on their way out, off whatever stack was interrupted (a
+// lane's can be 1 KiB); entries from ring 3 arrive on it through the
+// TSS. A canary at its base is checked on every switch onto it.
+#define IRQ_STACK_SIZE    16384
+#define IRQ_STACK_CANARY  0x5155414E54495251ULL
+
+// GDT layout. SYSRET takes user SS and CS from SYSCALL_USER_BASE + 8 and
+// + 16 (kernel/syscall.h); each CPU's TSS descriptor is 16 bytes.
+#define GDT_KERNEL_CODE   0x08
+#define GDT_KERNEL_DATA   0x10
+#define GDT_USER_CODE32   0x18
+#define GDT_USER_DATA     0x20
+#define GDT_USER_CODE     0x28
+#define GDT_TSS_BASE      0x30
+#define GDT_TSS(cpu)      (GDT_TSS_BASE + 16 * (cpu))
+#define GDT_ENTRIES       (GDT_TSS_BASE / 8 + 2 * MAX_CPUS)
 
 // Constants
 #define IDT_ENTRIES 256
@@ -0,0 +1,60 @@
+/**
+ * QuantumOS Port I/O
+ *
+ * Inline x86 port I/O accessors.
+ *
+ * The native test build (QUANTUM_HOST) has no ports: writes are
+ * dropped and reads return all ones, as from an empty bus.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef IO_H
+#define IO_H
+
+#include <kernel/types.h>
+
+#ifdef QUANTUM_HOST
+
+static inline void outb(uint16_t port, uint8_t value) { (void)port; (void)value; }
+static inline uint8_t inb(uint16_t port) { (void)port; return 0xFF; }
+static inline void outw(uint16_t port, uint16_t value) { (void)port; (void)value; }
+static inline uint16_t inw(uint16_t port) { (void)port; return 0xFFFF; }
+static inline void outl(uint16_t port, uint32_t value) { (void)port; (void)value; }
+static inline uint32_t inl(uint16_t port) { (void)port; return 0xFFFFFFFF; }
+
+#else
+
+static inline void outb(uint16_t port, uint8_t value) {
+    __asm__ volatile("outb %0, %1" : : "a"(value), "Nd"(port));
+}
+
+static inline uint8_t inb(uint16_t port) {
+    uint8_t ret;
+    __asm__ volatile("inb %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
+}
+
+static inline void outw(uint16_t port, uint16_t value) {
+    __asm__ volatile("outw %0, %1" : : "a"(value), "Nd"(port));
+}
+
+static inline uint16_t inw(uint16_t port) {
+    uint16_t ret;
+    __asm__ volatile("inw %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
+}
+
+static inline void outl(uint16_t port, uint32_t value) {
+    __asm__ volatile("outl %0, %1" : : "a"(value), "Nd"(port));
+}
+
+static inline uint32_t inl(uint16_t port) {
+    uint32_t ret;
+    __asm__ volatile("inl %1, %0" : "=a"(ret) : "Nd"(port));
+    return ret;
+}
+
+#endif /* QUANTUM_HOST */
+
+#endif /* IO_H */
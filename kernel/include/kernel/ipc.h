@@ -17,6 +17,7 @@
 #define IPC_H
 
 #include <kernel/types.h>
+#include <kernel/waitset.h>
 
 /* ============================================================================
  * Constants
@@ -46,6 +47,20 @@
 #define IPC_PORT_OPEN           1
 #define IPC_PORT_LISTENING      2
 
+/* Endpoint capability rights */
+#define IPC_ENDPOINT_SEND       0x01    /* ipc_endpoint_send() through it */
+#define IPC_ENDPOINT_GRANT      0x02    /* Copy it, and transfer capabilities through it */
+#define IPC_ENDPOINT_ALL        (IPC_ENDPOINT_SEND | IPC_ENDPOINT_GRANT)
+
+#define IPC_ENDPOINT_SELF       0       /* ipc_endpoint_create(): the caller's own queue */
+
+/* Wait set sources */
+#define IPC_WAIT_QUEUE          0       /* The caller's own queue; id ignored */
+#define IPC_WAIT_PORT           1       /* A port the caller owns */
+#define IPC_WAIT_CHANNEL        2       /* The caller's receiving side of a channel */
+
+#define IPC_MAX_WAITSETS        64
+
 /* Special process IDs */
 #define IPC_PID_KERNEL          0
 #define IPC_PID_ANY             0xFFFFFFFF
@@ -92,6 +107,7 @@ typedef struct {
     uint32_t length;            /* Payload length in bytes */
     uint64_t timestamp;         /* Send timestamp (ns since boot) */
     uint64_t deadline;          /* Delivery deadline (0 = no deadline) */
+    uint32_t capability;        /* Transferred endpoint: cptr in the receiver's table (0 if none) */
     uint8_t  data[IPC_MAX_MESSAGE_SIZE];  /* Message payload */
 } PACKED ipc_message_t;
 
@@ -109,15 +125,21 @@ typedef struct ipc_queue_entry {
 /**
  * Process Message Queue
  *
- * Per-process queue for incoming messages.
+ * Per-process queue for incoming messages. Entries come from the kernel
+ * heap on demand and stay with the queue (on its free list) until it is
+ * closed, so a queue never holds more than max_size of them.
  */
 typedef struct {
     ipc_queue_entry_t *head;    /* First message in queue */
     ipc_queue_entry_t *tail;    /* Last message in queue */
+    ipc_queue_entry_t *free;    /* Owned entries not holding a message */
     uint32_t count;             /* Number of messages in queue */
+    uint32_t reserved;          /* Entries owned (queued + free) */
     uint32_t max_size;          /* Maximum queue size */
     uint32_t dropped;           /* Count of dropped messages */
+    uint32_t generation;        /* Bumped on close; stales endpoint capabilities */
     uint8_t state;              /* Queue state */
+    waitset_source_t ready;     /* Wait sets watching this queue */
 } ipc_queue_t;
 
 /**
@@ -314,6 +336,69 @@ ipc_result_t ipc_port_send(uint32_t port_id, const ipc_message_t *msg);
  */
 ipc_result_t ipc_port_receive(uint32_t port_id, ipc_message_t *msg, uint64_t timeout_ns);
 
+/* ============================================================================
+ * Endpoint Capabilities
+ * ============================================================================ */
+
+/*
+ * An endpoint capability names a message queue - a process's own or a
+ * port's - in the holder's per-process capability table (a CSpace,
+ * kernel/capability.h). A send resolves the slot straight to the queue
+ * pointer; there is no PID to validate, and whoever holds the slot may
+ * send, whatever its PID. The holder of IPC_ENDPOINT_GRANT may copy the
+ * capability to another process, with the same or fewer rights, or
+ * hand one over inside a message. Closing the queue (process exit,
+ * port destroy) stales every capability to it.
+ */
+
+/**
+ * Make an endpoint capability in the caller's table
+ *
+ * @param port_id IPC_ENDPOINT_SELF for the caller's queue, or a port it owns
+ * @param rights IPC_ENDPOINT_* mask
+ * @param cptr Receives the slot
+ * @return IPC_SUCCESS on success, error code otherwise
+ */
+ipc_result_t ipc_endpoint_create(uint32_t port_id, uint32_t rights, uint32_t *cptr);
+
+/**
+ * Copy an endpoint capability into another process's table
+ *
+ * Needs IPC_ENDPOINT_GRANT on `cptr`; the copy gets `rights` masked by
+ * the original's.
+ *
+ * @param cptr Capability in the caller's table
+ * @param grantee_id Process receiving the copy
+ * @param rights IPC_ENDPOINT_* mask for the copy
+ * @param grantee_cptr Receives the slot in the grantee's table, may be NULL
+ * @return IPC_SUCCESS on success, error code otherwise
+ */
+ipc_result_t ipc_endpoint_grant(uint32_t cptr, uint32_t grantee_id, uint32_t rights,
+                                uint32_t *grantee_cptr);
+
+/**
+ * Delete an endpoint capability from the caller's table
+ *
+ * @param cptr Slot to empty
+ * @return IPC_SUCCESS on success, error code otherwise
+ */
+ipc_result_t ipc_endpoint_delete(uint32_t cptr);
+
+/**
+ * Send through an endpoint capability
+ *
+ * With `transfer` other than 0 the capability in that slot is copied
+ * into the receiver's table and its new slot delivered in
+ * msg->capability; this needs IPC_ENDPOINT_GRANT on both capabilities.
+ *
+ * @param cptr Endpoint to send through
+ * @param msg Message to send
+ * @param transfer Capability to hand over, 0 for none
+ * @return IPC_SUCCESS on success, IPC_ERROR_PORT_CLOSED for a stale
+ *         capability, error code otherwise
+ */
+ipc_result_t ipc_endpoint_send(uint32_t cptr, const ipc_message_t *msg, uint32_t transfer);
+
 /* ============================================================================
  * Zero-Copy Shared Memory Operations
  * ============================================================================ */
@@ -375,6 +460,28 @@ ipc_result_t ipc_share_revoke(uint32_t region_id, uint32_t grantee_id);
  */
 ipc_result_t ipc_share_map(uint32_t region_id, void **addr);
 
+/**
+ * Size of a shared region and the caller's access to it
+ *
+ * @param region_id Region to query
+ * @param size Receives the region size, may be NULL
+ * @param permissions Receives IPC_SHARE_* for the caller, may be NULL
+ * @return IPC_SUCCESS, IPC_ERROR_PERMISSION_DENIED if neither owner nor grantee
+ */
+ipc_result_t ipc_share_query(uint32_t region_id, size_t *size, uint32_t *permissions);
+
+/**
+ * Size of a shared region and the access process `pid` has to it
+ *
+ * For servers acting on a region a client names: the client's own access
+ * must be checked, not only the server's.
+ *
+ * @return IPC_SUCCESS, IPC_ERROR_PERMISSION_DENIED if `pid` is neither
+ *         owner nor grantee
+ */
+ipc_result_t ipc_share_access(uint32_t region_id, uint32_t pid, size_t *size,
+                              uint32_t *permissions);
+
 /**
  * Unmap a shared region
  *
@@ -428,6 +535,70 @@ ipc_result_t ipc_channel_send(uint32_t channel_id, const ipc_message_t *msg);
 ipc_result_t ipc_channel_receive(uint32_t channel_id, ipc_message_t *msg,
                                  uint64_t timeout_ns);
 
+/* ============================================================================
+ * Wait Sets
+ * ============================================================================ */
+
+/*
+ * A wait set watches many queues - the caller's own, ports it owns and
+ * its side of channels - and returns the ready ones in a batch. Sends
+ * put a watched queue on the set's ready list as they enqueue, so a
+ * collect costs O(ready), not O(watched). Sources are level-triggered
+ * unless registered with WAITSET_EDGE (kernel/waitset.h). Destroying a
+ * watched port or channel reports WAITSET_HANGUP for it. Collecting
+ * never blocks: callers poll, as with ipc_receive(IPC_NO_WAIT).
+ */
+
+/**
+ * Create a wait set owned by the caller
+ *
+ * @param waitset_id Receives the set's id
+ * @return IPC_SUCCESS on success, error code otherwise
+ */
+ipc_result_t ipc_waitset_create(uint32_t *waitset_id);
+
+/**
+ * Destroy a wait set and all of its registrations
+ *
+ * @param waitset_id Set to destroy
+ * @return IPC_SUCCESS on success, error code otherwise
+ */
+ipc_result_t ipc_waitset_destroy(uint32_t waitset_id);
+
+/**
+ * Watch a queue from a wait set
+ *
+ * @param waitset_id Set to add to
+ * @param source IPC_WAIT_QUEUE, IPC_WAIT_PORT or IPC_WAIT_CHANNEL
+ * @param id Port or channel id
+ * @param flags WAITSET_LEVEL or WAITSET_EDGE
+ * @param cookie Returned in the source's events
+ * @return IPC_SUCCESS on success, IPC_ERROR_ALREADY_EXISTS if already
+ *         watched, error code otherwise
+ */
+ipc_result_t ipc_waitset_add(uint32_t waitset_id, uint32_t source, uint32_t id,
+                             uint32_t flags, uint64_t cookie);
+
+/**
+ * Stop watching a queue
+ *
+ * @return IPC_SUCCESS on success, IPC_ERROR_NOT_FOUND if not watched
+ */
+ipc_result_t ipc_waitset_remove(uint32_t waitset_id, uint32_t source, uint32_t id);
+
+/**
+ * Collect ready sources without blocking
+ *
+ * @param waitset_id Set to collect from
+ * @param events Buffer for up to `max` events
+ * @param max Capacity of `events`
+ * @param count Receives the number of events written
+ * @return IPC_SUCCESS with at least one event, IPC_ERROR_NO_MESSAGE
+ *         when nothing is ready, error code otherwise
+ */
+ipc_result_t ipc_waitset_collect(uint32_t waitset_id, waitset_event_t *events, uint32_t max,
+                                 uint32_t *count);
+
 /* ============================================================================
  * Quantum IPC Extensions
  * ============================================================================ */
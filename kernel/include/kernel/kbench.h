@@ -0,0 +1,90 @@
+/**
+ * QuantumOS In-kernel Benchmark Suite
+ *
+ * Times kernel paths that only exist on the real kernel (page tables,
+ * the physical frame allocator, interrupt entry) alongside the process
+ * and IPC paths that tests/bench also covers on the host, so the two
+ * can be compared. Each case takes KBENCH_SAMPLES individually timed
+ * operations with the TSC after KBENCH_WARMUP untimed ones:
+ *
+ *   process_create      process_create(), 32 live at a time
+ *   process_destroy     process_destroy() of those processes
+ *   process_create_log_polled
+ *                       process_create() with the console at LOG_DEBUG
+ *                       and output polled out of the UART
+ *   process_create_log_ring
+ *                       the same with output queued on the log ring
+ *   ipc_round_trip      64-byte ipc_send() to self + ipc_receive()
+ *   pmm_alloc_frame     allocation only; the frame is freed untimed
+ *   memory_map_page     map one page at KBENCH_MAP_VADDR; unmapped untimed
+ *   irq_entry_exit      `int KBENCH_IRQ_VECTOR` to an empty handler and back
+ *   irq_stats_overhead  per-CPU count and latency histogram update of one
+ *                       interrupt (interrupt_measure_overhead())
+ *   msi_vector          self-IPI on a dynamic vector to its handler
+ *                       (pci_msi_selftest())
+ *   syscall_null        SYS_NULL through the SYSCALL entry, from ring 0
+ *                       (syscall_benchmark())
+ *   int80_null          SYS_NULL through `int SYSCALL_VECTOR`
+ *   syscall_queue_depth SYS_IPC_QUEUE_DEPTH through the SYSCALL entry
+ *   vdso_time_read      vdso_time_us() on the clock page
+ *   vdso_queue_depth    vdso_ipc_queue_depth() on the kernel's status page,
+ *                       the polling alternative to syscall_queue_depth
+ *   resonant_sync       reported as skipped: the resonant scheduler is
+ *                       floating point and is not built into the kernel
+ *
+ * Results go to the serial console as one JSON object per line,
+ *
+ *   {"suite":"kernel","event":"begin","samples":N,"tsc_khz":K,"rdtsc_overhead":C}
+ *   {"suite":"kernel","bench":"<name>","unit":"cycles","samples":N,
+ *    "mean":..,"min":..,"p50":..,"p90":..,"p99":..,"max":..}
+ *   {"suite":"kernel","event":"end","cases":N,"failed":F}
+ *
+ * Percentiles are nearest-rank, as in tests/bench. Cycle counts include
+ * the cost of one cpu_rdtsc() pair, reported once as rdtsc_overhead.
+ *
+ * The suite only runs in a kernel built with KERNEL_BENCH defined
+ * (`make bench-qemu`), which then leaves QEMU through the isa-debug-exit
+ * device at KBENCH_EXIT_PORT. QEMU exits with (code << 1) | 1, so a
+ * clean run exits with status 1.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef KBENCH_H
+#define KBENCH_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define KBENCH_SAMPLES          256
+#define KBENCH_WARMUP           16
+
+#define KBENCH_IRQ_VECTOR       0xF0
+#define KBENCH_MAP_VADDR        0xFFFFC00000000000ULL   /* Unused by the kernel */
+
+#define KBENCH_EXIT_PORT        0xF4    /* -device isa-debug-exit,iobase=0xf4 */
+#define KBENCH_EXIT_SUCCESS     0
+#define KBENCH_EXIT_FAILURE     1
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Run every case and print the results
+ *
+ * @return STATUS_SUCCESS, or STATUS_ERROR if any case failed to run
+ */
+status_t kbench_run(void);
+
+/**
+ * Leave QEMU through isa-debug-exit with `code`
+ *
+ * Halts if the device is absent.
+ */
+NORETURN void kbench_exit(uint32_t code);
+
+#endif /* KBENCH_H */
@@ -0,0 +1,197 @@
+/**
+ * QuantumOS Lanes
+ *
+ * Lanes are the green threads behind msi_lane_* (msi/include/msi.h):
+ * execution contexts that are switched by saving the callee-saved
+ * registers on their own stack and loading another stack pointer. A
+ * yield is a function call into lane_switch(); it never enters the
+ * kernel scheduler, takes no lock and touches only the lane's CPU-local
+ * run queue.
+ *
+ * Scheduling is M:N. Every domain keeps a run queue, a sleep wheel and
+ * a scheduler context per CPU, and the domain's carrier on that CPU (the
+ * process that called lane_run()) multiplexes the domain's lanes onto
+ * itself. The carrier only goes back to the kernel when every lane it
+ * owns is blocked or asleep: lane_run() then blocks the carrier process
+ * and returns, and the wake that makes a lane runnable again unblocks it.
+ *
+ * Stacks are small power-of-two blocks between LANE_STACK_MIN and
+ * LANE_STACK_MAX with the lane control block at the top. Finished lanes
+ * return their block to a per-size free list, so the pool grows with the
+ * peak number of lanes and is reused after that. A canary at the stack
+ * limit is checked on every switch away from a lane; a lane that ran
+ * past it is killed and counted in lane_stats_t.overflows. Interrupts
+ * do not run on lane stacks: irq_common moves the handler and any
+ * softirqs to the per-CPU interrupt stack (kernel/interrupts.h), leaving
+ * only the interrupted registers (under 256 bytes) on the lane, and the
+ * NMI, #DF and #MC have IST stacks.
+ *
+ * Sleep uses the vDSO clock page (kernel/vdso.h), so a sleeping lane's
+ * timer is set and polled without a kernel entry, at microsecond
+ * resolution.
+ *
+ * Lanes are placed on the spawning CPU and do not migrate. Only the BSP
+ * runs today, so the per-CPU state is unlocked; every call that takes a
+ * lane must come from that lane's CPU.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LANE_H
+#define LANE_H
+
+#include <kernel/types.h>
+#include <kernel/timer.h>
+#include <kernel/cpu.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define LANE_STACK_MIN          1024
+#define LANE_STACK_MAX          (64 * 1024)
+#define LANE_STACK_DEFAULT      4096
+#define LANE_STACK_CLASSES      7       /* 1 KiB .. 64 KiB */
+
+#define LANE_NO_WAKE            UINT64_MAX
+
+typedef enum {
+    LANE_STATE_READY = 0,
+    LANE_STATE_RUNNING,
+    LANE_STATE_BLOCKED,                 /* Until lane_wake() */
+    LANE_STATE_SLEEPING,                /* Until its timer or lane_wake() */
+    LANE_STATE_DEAD
+} lane_state_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef void (*lane_entry_t)(msi_lane_t *lane, void *arg);
+
+/**
+ * Lane control block, at the top of the lane's stack block
+ */
+struct msi_lane {
+    uint64_t sp;                        /* Saved stack pointer while switched out */
+    struct msi_lane *next;              /* Run queue or free list */
+    msi_domain_t *domain;
+    lane_entry_t entry;
+    void *arg;
+    uint8_t *stack;                     /* Lowest address, holds the canary */
+    uint32_t stack_size;
+    uint32_t id;
+    uint16_t cpu;
+    uint8_t state;                      /* lane_state_t */
+    uint8_t stack_class;
+    struct msi_lane *all_next;          /* Every live lane of the CPU */
+    struct msi_lane **all_pprev;
+    ktimer_t timer;                     /* Wakes a sleeping lane */
+};
+
+typedef struct {
+    msi_lane_t *head;
+    msi_lane_t *tail;
+    uint32_t count;
+} lane_queue_t;
+
+/**
+ * One CPU's share of a domain
+ */
+typedef struct {
+    lane_queue_t ready;
+    msi_lane_t *current;                /* NULL while in the scheduler */
+    msi_lane_t *all;                    /* Live lanes, any state */
+    msi_lane_t *zombies;                /* Exited, stack not yet released */
+    uint64_t sched_sp;                  /* Carrier context inside lane_run() */
+    uint32_t carrier_pid;
+    uint32_t lanes;                     /* Live lanes on this CPU */
+    bool in_run;                        /* Carrier is inside lane_run() */
+    bool parked;                        /* Carrier blocked with all lanes idle */
+    timer_wheel_t sleepers;
+} lane_cpu_t;
+
+/**
+ * Lane state embedded in every domain
+ */
+typedef struct {
+    lane_cpu_t cpus[MAX_CPUS];
+    lane_entry_t entry;                 /* Started by msi_lane_spawn() */
+    void *arg;
+    uint32_t stack_size;                /* For msi_lane_spawn(), 0 = default */
+    uint32_t live;
+    uint32_t next_id;
+} lane_domain_t;
+
+typedef struct {
+    uint64_t spawned;
+    uint64_t exited;
+    uint64_t switches;                  /* Lane to lane or to and from a carrier */
+    uint64_t parks;                     /* Carrier blocked in the kernel */
+    uint64_t overflows;                 /* Lanes killed for running past their stack */
+    uint64_t stack_bytes;               /* Stack blocks allocated, free ones included */
+} lane_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Set up the lane state of a new domain (msi_domain_create())
+ */
+void lane_domain_init(msi_domain_t *domain);
+
+/**
+ * Set what msi_lane_spawn() starts in this domain
+ */
+void lane_domain_set_entry(msi_domain_t *domain, lane_entry_t entry, void *arg,
+                           uint32_t stack_size);
+
+/**
+ * Create a lane on the calling CPU, ready to run `entry(lane, arg)`
+ *
+ * @param stack_size Rounded up to a power of two, 0 for LANE_STACK_DEFAULT
+ */
+status_t lane_spawn(msi_domain_t *domain, lane_entry_t entry, void *arg,
+                    uint32_t stack_size, msi_lane_t **lane);
+
+/**
+ * Carrier loop: run the domain's lanes on this CPU until none is
+ * runnable. If lanes remain, the calling process is blocked until one
+ * is woken.
+ *
+ * @return When to run again for a sleeping lane, in microseconds on
+ *         the vDSO clock (no later than its wake time),
+ *         LANE_NO_WAKE if the remaining lanes wait for lane_wake(),
+ *         0 if the domain has no lanes left on this CPU
+ */
+uint64_t lane_run(msi_domain_t *domain);
+
+/* The running lane, NULL outside a lane */
+msi_lane_t *lane_current(void);
+
+/* Called from inside a lane */
+void lane_yield(void);
+void lane_sleep_us(uint64_t micros);
+void lane_block(void);
+void NORETURN lane_exit(void);
+
+/**
+ * Make a blocked or sleeping lane runnable; no effect on other states
+ */
+status_t lane_wake(msi_lane_t *lane);
+
+/**
+ * End a lane. A lane killing itself does not return.
+ */
+status_t lane_kill(msi_lane_t *lane);
+
+/**
+ * End every lane of a domain that is not running
+ */
+void lane_domain_teardown(msi_domain_t *domain);
+
+void lane_get_stats(lane_stats_t *stats);
+
+#endif /* LANE_H */
@@ -0,0 +1,89 @@
+/**
+ * QuantumOS Kernel Log
+ *
+ * Leveled kernel messages recorded in a lock-free ring and drained to
+ * the serial console by the UART transmit interrupt, so logging from hot
+ * paths costs a copy into memory instead of ~87 us per byte of polled
+ * output at 115200 baud.
+ *
+ * The ring is a bounded multi-producer queue of fixed-size records. A
+ * producer claims a slot with one compare-and-swap, formats the message
+ * into it and publishes it by updating the slot's sequence number, so
+ * any context, including interrupt handlers and other CPUs, may log
+ * without locks. If the ring is full the message is dropped and counted
+ * rather than waiting for the UART.
+ *
+ * Messages above the console level are discarded before touching the
+ * ring. Before the UART interrupt is enabled, and from the moment of a
+ * panic, output is written synchronously.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define LOG_RING_SLOTS          256     /* Records in the ring (power of two) */
+#define LOG_SLOT_SIZE           128     /* Bytes per record, header included */
+#define LOG_TEXT_MAX            (LOG_SLOT_SIZE - 8)
+
+typedef enum {
+    LOG_EMERG = 0,                      /* System is unusable */
+    LOG_ERR,                            /* Operation failed */
+    LOG_WARN,                           /* Unexpected but recoverable */
+    LOG_INFO,                           /* Boot progress and state changes */
+    LOG_DEBUG                           /* Hot-path tracing, off by default */
+} log_level_t;
+
+#define LOG_DEFAULT_LEVEL       LOG_INFO
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+/**
+ * Ring record
+ *
+ * seq == position + 1 once the record at `position` is published, and
+ * position + LOG_RING_SLOTS once it has been consumed and may be reused.
+ */
+typedef struct {
+    uint32_t seq;
+    uint8_t level;
+    uint8_t len;
+    uint16_t reserved;
+    char text[LOG_TEXT_MAX];
+} log_slot_t;
+
+typedef struct {
+    uint64_t written;                   /* Records published */
+    uint64_t dropped;                   /* Records lost to a full ring */
+    uint64_t filtered;                  /* Records above the console level */
+} log_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+void log_init(void);
+void klog(log_level_t level, const char *message);
+void klog_hex(log_level_t level, const char *message, uint64_t value);
+void log_set_level(log_level_t level);
+log_level_t log_get_level(void);
+bool log_enabled(log_level_t level);
+void log_set_sync(bool sync);
+void log_flush(void);
+void log_panic(const char *message);
+void log_get_stats(log_stats_t *stats);
+
+/* Consumer side, used by the console driver */
+bool log_ring_pop(char *c);
+bool log_ring_empty(void);
+
+#endif /* LOG_H */
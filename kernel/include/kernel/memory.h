@@ -124,8 +124,16 @@ void memory_dump_physical_map(void);
 #define PAGE_MASK (~(PAGE_SIZE - 1))
 
 #define KERNEL_BASE_ADDR 0xFFFF800000000000
+#ifdef QUANTUM_HOST
+// Native test build: the heap is an array in tests/host/host_shim.c
+#define HOST_KERNEL_HEAP_SIZE 0x40000000  // 1GB
+extern uint8_t host_kernel_heap[HOST_KERNEL_HEAP_SIZE];
+#define KERNEL_HEAP_START ((uintptr_t)host_kernel_heap)
+#define KERNEL_HEAP_SIZE HOST_KERNEL_HEAP_SIZE
+#else
 #define KERNEL_HEAP_START 0xFFFF800000000000
 #define KERNEL_HEAP_SIZE 0x100000000  // 4GB
+#endif
 
 #define USER_BASE_ADDR 0x0000000000400000
 #define USER_HEAP_START 0x0000000000800000
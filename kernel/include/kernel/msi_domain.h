@@ -0,0 +1,49 @@
+/**
+ * QuantumOS MSI Domains
+ *
+ * The kernel side of msi_domain_t (msi/include/msi.h). A domain owns
+ * the lanes spawned into it (kernel/lane.h); destroying the domain ends
+ * them. It is also a capability space (kernel/capability.h):
+ * msi_domain_grant() adds a right, msi_domain_seal() freezes the set,
+ * and processes attached to the domain are held to it.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef MSI_DOMAIN_H
+#define MSI_DOMAIN_H
+
+#include <kernel/types.h>
+#include <kernel/lane.h>
+#include <kernel/capability.h>
+#include <msi.h>
+
+#define MSI_DOMAIN_MAGIC        0x4E4D4F44U     /* "DOMN" */
+
+struct msi_domain {
+    uint32_t magic;
+    uint32_t id;
+    lane_domain_t lanes;
+    cspace_t caps;
+    struct msi_domain *cache_next;      /* Recycle list link while destroyed */
+};
+
+/* A live domain, as opposed to NULL, garbage or a destroyed one */
+static inline bool msi_domain_valid(const msi_domain_t *domain) {
+    return domain && domain->magic == MSI_DOMAIN_MAGIC;
+}
+
+/**
+ * Whether the domain holds `right` (a cap_right_t): the O(1) check
+ * services make on each call
+ */
+static inline bool msi_domain_has(const msi_domain_t *domain, uint32_t right) {
+    return msi_domain_valid(domain) && cspace_has_right(&domain->caps, right);
+}
+
+/**
+ * Hold process `pid` to the domain's rights
+ */
+msi_result_t msi_domain_attach(msi_domain_t *domain, uint32_t pid);
+
+#endif /* MSI_DOMAIN_H */
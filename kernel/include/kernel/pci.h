@@ -0,0 +1,175 @@
+/**
+ * QuantumOS PCI Bus Support
+ *
+ * Configuration-space access through the legacy 0xCF8/0xCFC mechanism,
+ * bus enumeration, and message-signalled interrupts (MSI and MSI-X).
+ *
+ * Each MSI-X table entry is bound to a vector allocated on a specific
+ * CPU, so a device queue's interrupt can be steered to the CPU that
+ * consumes the queue (pci_msix_set_affinity()).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef PCI_H
+#define PCI_H
+
+#include <kernel/types.h>
+#include <kernel/interrupts.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define PCI_CONFIG_ADDRESS      0xCF8
+#define PCI_CONFIG_DATA         0xCFC
+
+#define PCI_MAX_BUSES           256
+#define PCI_MAX_SLOTS           32
+#define PCI_MAX_FUNCTIONS       8
+#define PCI_MAX_DEVICES         64      /* Devices tracked after enumeration */
+#define PCI_MSIX_MAX_VECTORS    32      /* MSI-X entries tracked per device */
+
+#define PCI_ANY_ID              0xFFFF
+
+/* Configuration space offsets */
+#define PCI_VENDOR_ID           0x00
+#define PCI_DEVICE_ID           0x02
+#define PCI_COMMAND             0x04
+#define PCI_STATUS              0x06
+#define PCI_CLASS_REVISION      0x08
+#define PCI_HEADER_TYPE         0x0E
+#define PCI_BAR0                0x10
+#define PCI_CAPABILITY_LIST     0x34
+#define PCI_INTERRUPT_LINE      0x3C
+
+/* Command register bits */
+#define PCI_COMMAND_MEMORY      BIT(1)
+#define PCI_COMMAND_MASTER      BIT(2)
+#define PCI_COMMAND_INTX_DISABLE BIT(10)
+
+#define PCI_STATUS_CAP_LIST     BIT(4)
+
+/* Capability IDs */
+#define PCI_CAP_ID_MSI          0x05
+#define PCI_CAP_ID_VENDOR       0x09
+#define PCI_CAP_ID_MSIX         0x11
+
+/* MSI capability */
+#define PCI_MSI_FLAGS           0x02
+#define PCI_MSI_FLAGS_ENABLE    BIT(0)
+#define PCI_MSI_FLAGS_64BIT     BIT(7)
+#define PCI_MSI_ADDRESS_LO      0x04
+#define PCI_MSI_ADDRESS_HI      0x08
+#define PCI_MSI_DATA_32         0x08
+#define PCI_MSI_DATA_64         0x0C
+
+/* MSI-X capability */
+#define PCI_MSIX_FLAGS          0x02
+#define PCI_MSIX_FLAGS_QSIZE    0x07FF
+#define PCI_MSIX_FLAGS_MASKALL  BIT(14)
+#define PCI_MSIX_FLAGS_ENABLE   BIT(15)
+#define PCI_MSIX_TABLE          0x04
+#define PCI_MSIX_TABLE_BIR      0x07
+
+/* MSI-X table entry layout (16 bytes each) */
+#define PCI_MSIX_ENTRY_SIZE     16
+#define PCI_MSIX_ENTRY_ADDR_LO  0x0
+#define PCI_MSIX_ENTRY_ADDR_HI  0x4
+#define PCI_MSIX_ENTRY_DATA     0x8
+#define PCI_MSIX_ENTRY_CTRL     0xC
+#define PCI_MSIX_ENTRY_MASKED   BIT(0)
+
+/* x86 MSI message address: fixed delivery, physical destination */
+#define PCI_MSI_ADDRESS_BASE    0xFEE00000U
+#define PCI_MSI_DEST_SHIFT      12
+
+#define PCI_VENDOR_VIRTIO       0x1AF4
+
+#define MSI_SELFTEST_TIMEOUT_US 1000    /* pci_msi_selftest(): per interrupt */
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+/**
+ * Binding of one MSI/MSI-X message to a CPU vector
+ */
+typedef struct {
+    uint32_t cpu;                   /* Target CPU */
+    uint8_t vector;                 /* Vector on that CPU */
+    bool active;
+    irq_vector_handler_t handler;
+    void *context;
+} pci_msi_vector_t;
+
+/**
+ * PCI function
+ */
+typedef struct {
+    uint8_t bus;
+    uint8_t slot;
+    uint8_t func;
+    uint8_t header_type;
+
+    uint16_t vendor_id;
+    uint16_t device_id;
+    uint8_t class_code;
+    uint8_t subclass;
+    uint8_t prog_if;
+    uint8_t irq_line;               /* Legacy INTx routing */
+
+    uint8_t msi_cap;                /* Capability offsets, 0 if absent */
+    uint8_t msix_cap;
+
+    /* MSI-X state */
+    volatile uint32_t *msix_table;
+    uint16_t msix_table_size;
+    bool msix_enabled;
+    pci_msi_vector_t msix_vectors[PCI_MSIX_MAX_VECTORS];
+
+    /* MSI state (single message) */
+    pci_msi_vector_t msi_vector;
+} pci_device_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/* Initialization and enumeration */
+status_t pci_init(void);
+uint32_t pci_device_count(void);
+pci_device_t *pci_get_device(uint32_t index);
+pci_device_t *pci_find_device(uint16_t vendor_id, uint16_t device_id, uint32_t nth);
+
+/* Configuration space access */
+uint32_t pci_config_read32(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset);
+uint16_t pci_config_read16(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset);
+uint8_t pci_config_read8(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset);
+void pci_config_write32(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset, uint32_t value);
+void pci_config_write16(uint8_t bus, uint8_t slot, uint8_t func, uint8_t offset, uint16_t value);
+
+/* Device helpers */
+uint8_t pci_find_capability(pci_device_t *dev, uint8_t cap_id);
+uint64_t pci_get_bar(pci_device_t *dev, uint8_t bar);
+void pci_enable_bus_master(pci_device_t *dev);
+
+/* MSI */
+status_t pci_msi_enable(pci_device_t *dev, uint32_t cpu, irq_vector_handler_t handler, void *context);
+status_t pci_msi_disable(pci_device_t *dev);
+
+/* MSI-X */
+status_t pci_msix_enable(pci_device_t *dev);
+status_t pci_msix_disable(pci_device_t *dev);
+status_t pci_msix_request(pci_device_t *dev, uint16_t entry, uint32_t cpu,
+                          irq_vector_handler_t handler, void *context);
+status_t pci_msix_free(pci_device_t *dev, uint16_t entry);
+status_t pci_msix_set_affinity(pci_device_t *dev, uint16_t entry, uint32_t cpu);
+void pci_msix_mask(pci_device_t *dev, uint16_t entry);
+void pci_msix_unmask(pci_device_t *dev, uint16_t entry);
+
+/* Diagnostics */
+status_t pci_msi_selftest(uint64_t *samples, uint32_t count);
+void pci_dump_devices(void);
+
+#endif /* PCI_H */
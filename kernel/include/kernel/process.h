@@ -24,12 +24,34 @@
  * Constants
  * ============================================================================ */
 
-#define MAX_PROCESSES              256     /* Maximum concurrent processes */
+#define MAX_PROCESSES              65536   /* Maximum concurrent processes (PCB slots) */
 #define MAX_THREADS_PER_PROCESS    16      /* Maximum threads per process */
 #define PROCESS_NAME_MAX_LEN       64      /* Maximum process name length */
+#define PROCESS_STACK_SIZE         8192    /* Default kernel stack size */
 #define KERNEL_PROCESS_ID          0       /* Reserved for kernel process */
 #define INIT_PROCESS_ID            1       /* First user process */
 
+/*
+ * A PID is a PCB slot index tagged with the slot's generation, which is
+ * bumped each time the slot is reused, so a stale PID does not name the
+ * next process in its slot. Generation 0 keeps the first PIDs equal to
+ * their slots (kernel 0, idle 1). PIDs stay below 2^31.
+ */
+#define PROCESS_PID_INDEX_BITS     16
+#define PROCESS_PID_GENERATION_BITS 15
+#define PROCESS_PID_MAX            ((1U << (PROCESS_PID_INDEX_BITS + PROCESS_PID_GENERATION_BITS)) - 1)
+#define PROCESS_PID_INDEX(pid)     ((pid) & ((1U << PROCESS_PID_INDEX_BITS) - 1))
+#define PROCESS_PID_GENERATION(pid) ((pid) >> PROCESS_PID_INDEX_BITS)
+
+_Static_assert(MAX_PROCESSES == 1U << PROCESS_PID_INDEX_BITS, "PID index field covers the table");
+
+/* Tables indexed by PCB slot (PCBs, cycle budgets, vDSO status pages) are
+ * backed PROCESS_CHUNK_SIZE slots at a time as slots are first used,
+ * through a directory of PROCESS_CHUNKS pointers */
+#define PROCESS_CHUNK_SHIFT        6
+#define PROCESS_CHUNK_SIZE         (1U << PROCESS_CHUNK_SHIFT)
+#define PROCESS_CHUNKS             (MAX_PROCESSES / PROCESS_CHUNK_SIZE)
+
 /* Process priorities */
 #define PRIORITY_IDLE              0       /* Lowest priority */
 #define PRIORITY_LOW               1       /* Low priority */
@@ -90,19 +112,22 @@ typedef struct process {
     
     /* Process timing */
     uint64_t creation_time;        /* When process was created */
-    uint64_t runtime_total;        /* Total runtime in nanoseconds */
-    uint64_t runtime_last;         /* Runtime of last quantum */
-    uint64_t last_scheduled;       /* Last time process was scheduled */
+    uint64_t runtime_total;        /* Total runtime in TSC cycles */
+    uint64_t runtime_last;         /* Runtime of last quantum (TSC cycles) */
+    uint64_t last_scheduled;       /* TSC when process was last switched in */
     
     /* IPC integration - queues managed internally by PID via ipc_process_init() */
     uint32_t port_count;           /* Number of owned IPC ports */
     
     /* Capability security */
-    uint32_t capability_root;      /* Root capability for this process */
+    uint32_t capability_root;      /* CSpace id (kernel/capability.h), 0 for none */
     uint32_t capability_count;     /* Number of held capabilities */
     
-    /* Process relationships */
-    uint32_t children[MAX_PROCESSES]; /* Child process PIDs */
+    /* Process relationships: children form an intrusive sibling list */
+    struct process *parent;        /* Process whose child list holds this one */
+    struct process *first_child;   /* Most recently added child */
+    struct process *next_sibling;  /* Next child of the same parent */
+    struct process *prev_sibling;  /* Previous child of the same parent */
     uint32_t child_count;          /* Number of children */
     
     /* Exit information */
@@ -145,6 +170,7 @@ typedef struct {
     uint32_t zombie_processes;     /* Zombie processes */
     uint64_t total_runtime;        /* Total runtime of all processes */
     uint64_t context_switches;     /* Number of context switches */
+    uint32_t pcb_capacity;         /* PCB slots backed by memory */
 } process_stats_t;
 
 /* ============================================================================
@@ -0,0 +1,105 @@
+/**
+ * QuantumOS Sampling Profiler
+ *
+ * Statistical profile of where the kernel spends CPU time. Performance
+ * counter 0 is programmed to overflow every `period` events (unhalted
+ * core cycles or instructions retired) and the local APIC delivers the
+ * overflow as an NMI, so samples land even inside interrupts-off code.
+ * Where no architectural PMU is exposed (QEMU without KVM, or no local
+ * APIC) the timer tick samples instead, at TIMER_HZ.
+ *
+ * Each sample holds the interrupted RIP and a frame-pointer walk of the
+ * kernel stack (the kernel is built with -fno-omit-frame-pointer). The
+ * walk only follows frames inside the kernel image and heap and return
+ * addresses inside .text, so a corrupt chain ends the walk instead of
+ * faulting. User-mode samples record the RIP only.
+ *
+ * Samples go to per-CPU buffers that stop filling when full. They are
+ * dumped over the serial console as
+ *
+ *   #PROFILE-BEGIN <version> <source> <event> <period>
+ *   #S <cpu> <pid> <flags> <rip> [<return address>...]   (hex)
+ *   #PROFILE-END <samples> <dropped>
+ *
+ * and tools/profsym.c symbolises a capture against kernel.elf into a
+ * flat profile or folded stacks. Console commands (bytes on COM1):
+ *
+ *   P  start (cycles)     Q  stop     F  dump and reset
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <kernel/types.h>
+#include <kernel/interrupts.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define PROFILE_VERSION         1
+#define PROFILE_SAMPLES         1024        /* Per CPU */
+#define PROFILE_MAX_DEPTH       14          /* Return addresses per sample */
+#define PROFILE_DEFAULT_PERIOD  1000000     /* Events between samples */
+#define PROFILE_MAX_PERIOD      0x7FFFFFFFULL
+
+#define PROFILE_CMD_START       'P'
+#define PROFILE_CMD_STOP        'Q'
+#define PROFILE_CMD_DUMP        'F'
+
+/* profile_sample_t.flags */
+#define PROFILE_SAMPLE_USER     BIT(0)      /* Interrupted in user mode */
+
+typedef enum {
+    PROFILE_SOURCE_NONE = 0,
+    PROFILE_SOURCE_PMU,                     /* Counter overflow NMI */
+    PROFILE_SOURCE_TIMER                    /* Timer tick fallback */
+} profile_source_t;
+
+typedef enum {
+    PROFILE_EVENT_CYCLES = 0,               /* Unhalted core cycles */
+    PROFILE_EVENT_INSTRUCTIONS              /* Instructions retired */
+} profile_event_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t rip;
+    uint32_t pid;
+    uint8_t cpu;
+    uint8_t depth;                          /* Valid entries in frames[] */
+    uint16_t flags;
+    uint64_t frames[PROFILE_MAX_DEPTH];     /* Return addresses, innermost first */
+} profile_sample_t;
+
+_Static_assert(sizeof(profile_sample_t) == 128, "sample layout");
+
+typedef struct {
+    uint64_t samples;                       /* Samples held */
+    uint64_t dropped;                       /* Samples lost to full buffers */
+    uint64_t spurious;                      /* NMIs claimed with nothing to record */
+    profile_source_t source;                /* Active source, NONE when stopped */
+    bool pmu_available;
+} profile_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+status_t profile_init(void);
+status_t profile_start(profile_event_t event, uint64_t period);
+void profile_stop(void);
+void profile_reset(void);
+void profile_dump(void);
+void profile_command(char c);
+void profile_get_stats(profile_stats_t *stats);
+
+/* Sample sources, called from the interrupt paths */
+bool profile_nmi(cpu_state_t *state);
+void profile_timer_tick(cpu_state_t *state);
+
+#endif /* PROFILE_H */
@@ -20,8 +20,7 @@
 #ifndef RESONANCE_TYPES_H
 #define RESONANCE_TYPES_H
 
-#include <stdint.h>
-#include <stdbool.h>
+#include <kernel/types.h>
 
 /* ============================================================================
  * Mathematical Constants (from ghostOS)
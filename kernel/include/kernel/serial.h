@@ -0,0 +1,68 @@
+/**
+ * QuantumOS Serial Console (16550 UART)
+ *
+ * COM1 at 115200 8N1 with the FIFO enabled. Output is taken from the log
+ * ring (kernel/log.h): once interrupts are up, the transmitter-empty
+ * interrupt (IRQ4) refills the FIFO, so writers only copy into memory.
+ * Before that, and after a panic, bytes are written synchronously by
+ * polling the line status register.
+ *
+ * Received bytes are handed to every registered handler from the
+ * interrupt; handlers ignore bytes they do not recognise, which is
+ * enough for one-key console commands.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef SERIAL_H
+#define SERIAL_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define SERIAL_COM1_BASE        0x3F8
+#define SERIAL_BAUD             115200
+#define SERIAL_FIFO_SIZE        16      /* Transmit FIFO depth */
+#define SERIAL_RX_HANDLERS      4       /* Registered receive handlers */
+
+/* Register offsets */
+#define SERIAL_THR              0       /* Transmit holding (DLAB=0) */
+#define SERIAL_RBR              0       /* Receive buffer (DLAB=0, read) */
+#define SERIAL_DLL              0       /* Divisor low (DLAB=1) */
+#define SERIAL_IER              1       /* Interrupt enable (DLAB=0) */
+#define SERIAL_DLM              1       /* Divisor high (DLAB=1) */
+#define SERIAL_IIR              2       /* Interrupt identification (read) */
+#define SERIAL_FCR              2       /* FIFO control (write) */
+#define SERIAL_LCR              3       /* Line control */
+#define SERIAL_MCR              4       /* Modem control */
+#define SERIAL_LSR              5       /* Line status */
+
+#define SERIAL_IER_RDA          BIT(0)  /* Received data available */
+#define SERIAL_IER_THRE         BIT(1)  /* Transmit holding register empty */
+#define SERIAL_LCR_8N1          0x03
+#define SERIAL_LCR_DLAB         BIT(7)
+#define SERIAL_FCR_ENABLE       0x07    /* Enable and clear both FIFOs */
+#define SERIAL_MCR_OUT2         0x0B    /* DTR, RTS, OUT2 (IRQ gate) */
+#define SERIAL_LSR_DR           BIT(0)  /* Data ready */
+#define SERIAL_LSR_THRE         BIT(5)
+
+typedef void (*serial_rx_handler_t)(char c);
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+void serial_init(void);
+void serial_enable_irq(void);
+void serial_disable_irq(void);
+bool serial_irq_enabled(void);
+void serial_putc_sync(char c);
+void serial_write_sync(const char *buf, uint32_t len);
+status_t serial_register_rx_handler(serial_rx_handler_t handler);
+void serial_tx_kick(void);
+void serial_irq_handler(void);
+
+#endif /* SERIAL_H */
@@ -0,0 +1,95 @@
+/**
+ * QuantumOS Deferred Interrupt Work
+ *
+ * Bottom halves for interrupt handlers. Hard-IRQ handlers do the minimum
+ * needed to quiesce the device and defer the rest:
+ *
+ *   - Softirqs: a small fixed set of per-CPU pending bits, raised from
+ *     hard-IRQ context and run with interrupts enabled on the outermost
+ *     IRQ exit.
+ *   - Tasklets: dynamically scheduled callbacks queued per CPU and run
+ *     from the SOFTIRQ_HI / SOFTIRQ_TASKLET softirqs. A tasklet is never
+ *     queued twice and never runs concurrently with itself.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef SOFTIRQ_H
+#define SOFTIRQ_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+/* Softirq numbers, lower runs first */
+#define SOFTIRQ_HI              0       /* High-priority tasklets */
+#define SOFTIRQ_TIMER           1       /* Timer tick bottom half */
+#define SOFTIRQ_INPUT           2       /* Keyboard and other input */
+#define SOFTIRQ_TASKLET         3       /* Normal tasklets */
+#define SOFTIRQ_COUNT           8       /* Maximum softirq numbers */
+
+/* Softirq passes per IRQ exit before remaining work is left for later */
+#define SOFTIRQ_MAX_RESTART     4
+
+/* Tasklet state bits */
+#define TASKLET_STATE_SCHED     BIT(0)  /* Queued for execution */
+#define TASKLET_STATE_RUN       BIT(1)  /* Currently running */
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef void (*softirq_handler_t)(void);
+
+/**
+ * Tasklet
+ */
+typedef struct tasklet {
+    struct tasklet *next;           /* Per-CPU queue link */
+    void (*func)(uint64_t data);    /* Callback */
+    uint64_t data;                  /* Callback argument */
+    volatile uint32_t state;        /* TASKLET_STATE_* */
+} tasklet_t;
+
+#define TASKLET_INIT(fn, arg) { .next = NULL, .func = (fn), .data = (arg), .state = 0 }
+
+/**
+ * Deferred work statistics
+ */
+typedef struct {
+    uint64_t softirq_runs[SOFTIRQ_COUNT];   /* Handler invocations */
+    uint64_t tasklet_runs;                  /* Tasklets executed */
+    uint64_t restart_limit_hits;            /* Exits that left work pending */
+    uint64_t irqoff_max_cycles;             /* Longest hard-IRQ window */
+} softirq_stats_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/* Initialization */
+status_t softirq_init(void);
+
+/* Softirqs */
+status_t softirq_register(uint32_t nr, softirq_handler_t handler);
+void softirq_raise(uint32_t nr);
+bool softirq_pending(void);
+void softirq_run_pending(void);
+
+/* Tasklets */
+void tasklet_init(tasklet_t *t, void (*func)(uint64_t data), uint64_t data);
+void tasklet_schedule(tasklet_t *t);
+void tasklet_hi_schedule(tasklet_t *t);
+
+/* IRQ context tracking (called by the interrupt dispatcher) */
+void irq_enter(void);
+void irq_exit(void);
+bool in_interrupt(void);
+
+/* Statistics */
+status_t softirq_get_stats(softirq_stats_t *stats);
+void softirq_dump_stats(void);
+
+#endif /* SOFTIRQ_H */
@@ -0,0 +1,180 @@
+/**
+ * QuantumOS Transactional State
+ *
+ * The store behind msi_state_map/read/write/commit (msi/include/msi.h).
+ * A region is a sparse byte range of up to STATE_MAX_SIZE whose contents
+ * are published as numbered versions. Writes build the next version
+ * privately; a commit publishes it atomically; readers always see one
+ * whole committed version, never a mix.
+ *
+ * Each version is a two-level tree of x86-format page tables (pte_t): a
+ * root of STATE_PTES_PER_TABLE entries, each pointing at a table of
+ * STATE_PTES_PER_TABLE page entries. The first write to a page after a
+ * commit is a copy-on-write fault handled in software: the page, its
+ * table and the root are copied once and the private copies are marked
+ * with the pte_t dirty bit, so later writes in the same transaction go
+ * straight to the copy. Everything not written stays shared with the
+ * previous version. A commit is a single pointer swap to the new root,
+ * so it never copies data, and a version's dirty bits record exactly
+ * the pages its commit changed. The copies are paid by the writes; the
+ * frames they superseded are freed later, in time proportional to
+ * their number.
+ *
+ * Readers pin the current version with an atomic counter and walk its
+ * tree without locks. Pages a commit superseded are freed once their
+ * version and every older one are unpinned; this happens on the writer's
+ * side, during later commits. There is one writer per region: callers
+ * serialise write, commit and abort.
+ *
+ * The kernel's own page tables are not used because the VMM does not
+ * yet load them or handle faults; the walk here is what the MMU would do
+ * on a mapped region, and the layout is the one it would need.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef STATE_H
+#define STATE_H
+
+#include <kernel/types.h>
+#include <kernel/memory.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define STATE_PTES_PER_TABLE    512
+#define STATE_MAX_PAGES         (STATE_PTES_PER_TABLE * STATE_PTES_PER_TABLE)
+#define STATE_MAX_SIZE          ((uint64_t)STATE_MAX_PAGES * PAGE_SIZE)     /* 1 GiB */
+#define STATE_MAX_REGIONS       64
+
+/* msi_state_map() addresses: one STATE_MAX_SIZE slot per region */
+#define STATE_WINDOW_BASE       0x0000600000000000ULL
+
+#define STATE_READ              0x01
+#define STATE_WRITE             0x02
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct state_garbage state_garbage_t;
+typedef struct state_chunk state_chunk_t;
+
+/**
+ * One committed version of a region
+ */
+typedef struct state_version {
+    pte_t *root;
+    uint64_t seq;                       /* 0 for the empty initial version */
+    uint32_t readers;                   /* Pins, updated atomically */
+    uint32_t changed;                   /* Pages this version's commit wrote */
+    state_garbage_t *garbage;           /* Frames the next commit superseded */
+    struct state_version *next;         /* Retired list or free list */
+} state_version_t;
+
+typedef struct {
+    uint64_t commits;
+    uint64_t aborts;
+    uint64_t cow_pages;                 /* Pages copied or zero-filled on first write */
+    uint64_t cow_tables;                /* Tables and roots copied */
+    uint64_t reclaimed;                 /* Frames freed after their readers left */
+    uint64_t frames;                    /* Frames allocated, free ones included */
+    uint32_t pending;                   /* Pages written since the last commit */
+    uint32_t retired;                   /* Versions waiting to be reclaimed */
+} state_stats_t;
+
+typedef struct {
+    uint64_t size;
+    uint32_t pages;
+    uint32_t flags;                     /* STATE_READ | STATE_WRITE */
+
+    state_version_t *current;           /* Published, swapped atomically */
+    state_version_t *oldest;            /* Retired versions, oldest first */
+    state_version_t *newest;
+    state_version_t *free_versions;
+
+    pte_t *work_root;                   /* Next version, NULL with nothing pending */
+    state_garbage_t *txn_garbage;       /* Frames the next commit will supersede */
+    state_garbage_t *free_blocks;       /* Free frames, listed like garbage */
+    uint32_t free_count;
+    state_chunk_t *chunks;              /* Frame allocations, for destroy */
+
+    state_stats_t stats;
+} state_region_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/**
+ * Create a region of `size` bytes (rounded up to pages), all zero
+ */
+status_t state_region_create(uint64_t size, uint32_t flags, state_region_t **region);
+
+/**
+ * Free a region and every frame it owns
+ *
+ * @return STATUS_BUSY while a snapshot is pinned
+ */
+status_t state_region_destroy(state_region_t *region);
+
+/**
+ * Write into the pending version
+ *
+ * @return STATUS_PERMISSION_DENIED without STATE_WRITE,
+ *         STATUS_NO_MEMORY with part of the write possibly applied
+ *         (state_abort() drops it)
+ */
+status_t state_write(state_region_t *region, uint64_t offset, const void *data, uint64_t len);
+
+/**
+ * Publish the pending version; a no-op with nothing pending
+ *
+ * @param seq Receives the current version number, may be NULL
+ */
+status_t state_commit(state_region_t *region, uint64_t *seq);
+
+/**
+ * Drop every write since the last commit
+ */
+void state_abort(state_region_t *region);
+
+/**
+ * Pin the current version. The snapshot stays readable and unchanged
+ * until released, whatever is committed meanwhile. Lock-free.
+ */
+const state_version_t *state_snapshot_acquire(state_region_t *region);
+void state_snapshot_release(const state_version_t *snapshot);
+
+/**
+ * Copy bytes out of a pinned snapshot; unwritten bytes read as zero
+ */
+status_t state_snapshot_read(const state_region_t *region, const state_version_t *snapshot,
+                             uint64_t offset, void *buf, uint64_t len);
+
+/**
+ * Whether the commit that created `snapshot` wrote the page at `offset`
+ */
+bool state_snapshot_changed(const state_version_t *snapshot, uint64_t offset);
+
+/**
+ * Read from the current version (acquire, read, release)
+ */
+status_t state_read(state_region_t *region, uint64_t offset, void *buf, uint64_t len);
+
+void state_get_stats(const state_region_t *region, state_stats_t *stats);
+
+/* ============================================================================
+ * MSI Binding
+ * ============================================================================ */
+
+/**
+ * Region behind an address returned by msi_state_map(), with the
+ * offset of `addr` inside it. msi_state_read() reads the current
+ * version; msi_state_commit() publishes every pending write of the
+ * region its range lies in.
+ */
+state_region_t *msi_state_region(const void *addr, uint64_t *offset);
+
+#endif /* STATE_H */
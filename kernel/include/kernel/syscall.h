@@ -0,0 +1,130 @@
+/**
+ * QuantumOS System Call Interface
+ *
+ * System calls enter through SYSCALL/SYSRET. The entry stub swaps to the
+ * per-CPU kernel GS base, switches to the per-CPU syscall stack and calls
+ * the handler from a flat table indexed by RAX; no cpu_state_t is built.
+ *
+ * Register convention (System V style, as used by the user stubs):
+ *   RAX          System call number in, result out
+ *   RDI RSI RDX  Arguments 0-2
+ *   R10 R8  R9   Arguments 3-5 (R10 replaces RCX, which SYSCALL clobbers)
+ *
+ * RCX, R11 and the argument registers are clobbered; RBX, RBP, RSP and
+ * R12-R15 are preserved. Interrupts stay masked (IA32_FMASK) for the
+ * whole call, so handlers must not block.
+ *
+ * A legacy `int $SYSCALL_VECTOR` gate with the same register convention
+ * goes through the generic interrupt path, for comparison and for
+ * callers without SYSCALL.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef SYSCALL_H
+#define SYSCALL_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define SYSCALL_VECTOR          0x80    /* Software-interrupt entry */
+#define SYSCALL_STACK_SIZE      8192    /* Per-CPU syscall stack */
+
+/* Segment selectors programmed into IA32_STAR. SYSRET derives user CS
+ * and SS from the user base (CS = base + 16, SS = base + 8), so the GDT
+ * must lay out kernel code, kernel data, user data, user code in order. */
+#define SYSCALL_KERNEL_CS       0x08
+#define SYSCALL_USER_BASE       0x18
+
+/* System call numbers */
+typedef enum {
+    SYS_NULL = 0,               /* No-op, for latency measurement */
+
+    /* Processes */
+    SYS_PROCESS_GETPID,
+    SYS_PROCESS_EXIT,
+    SYS_PROCESS_KILL,
+    SYS_PROCESS_YIELD,
+    SYS_PROCESS_GET_STATE,
+    SYS_PROCESS_GET_PARENT,
+
+    /* IPC */
+    SYS_IPC_SEND,
+    SYS_IPC_RECEIVE,
+    SYS_IPC_REPLY,
+    SYS_IPC_CALL,
+    SYS_IPC_PORT_CREATE,
+    SYS_IPC_PORT_DESTROY,
+    SYS_IPC_PORT_LOOKUP,
+    SYS_IPC_PORT_SEND,
+    SYS_IPC_PORT_RECEIVE,
+    SYS_IPC_QUEUE_DEPTH,
+
+    /* MSI */
+    SYS_MSI_VERSION,
+    SYS_MSI_CAPABILITIES,
+    SYS_MSI_EVENT_PUBLISH,
+    SYS_MSI_STATE_COMMIT,
+    SYS_MSI_ASSOC_PUT,
+    SYS_MSI_ASSOC_GET,
+    SYS_MSI_ASSOC_QUERY,
+    SYS_MSI_ASSOC_FORGET,
+
+    /* IPC endpoint capabilities */
+    SYS_IPC_ENDPOINT_CREATE,
+    SYS_IPC_ENDPOINT_GRANT,
+    SYS_IPC_ENDPOINT_DELETE,
+    SYS_IPC_ENDPOINT_SEND,
+
+    /* IPC wait sets */
+    SYS_IPC_WAITSET_CREATE,
+    SYS_IPC_WAITSET_DESTROY,
+    SYS_IPC_WAITSET_ADD,
+    SYS_IPC_WAITSET_REMOVE,
+    SYS_IPC_WAITSET_COLLECT,
+
+    SYS_COUNT
+} syscall_nr_t;
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef int64_t (*syscall_fn_t)(uint64_t a0, uint64_t a1, uint64_t a2,
+                                uint64_t a3, uint64_t a4, uint64_t a5);
+
+/**
+ * Per-CPU syscall area, addressed through GS after SWAPGS
+ *
+ * The entry stub uses fixed offsets into this structure; keep the
+ * leading fields in sync with syscall.S.
+ */
+typedef struct {
+    uint64_t kernel_rsp;            /* Top of this CPU's syscall stack */
+    uint64_t user_rsp;              /* Scratch for the caller's RSP */
+    uint64_t kernel_caller;         /* Non-zero: return with JMP, not SYSRET */
+    uint64_t count;                 /* System calls taken on this CPU */
+} ALIGNED(64) syscall_cpu_t;
+
+/**
+ * System call round-trip cost, in TSC cycles
+ */
+typedef struct {
+    uint64_t syscall_cycles;        /* SYSCALL entry stub + dispatch */
+    uint64_t int80_cycles;          /* int $SYSCALL_VECTOR through the IDT */
+} syscall_bench_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+status_t syscall_init(void);
+int64_t syscall_dispatch(uint64_t nr, uint64_t a0, uint64_t a1, uint64_t a2,
+                         uint64_t a3, uint64_t a4, uint64_t a5);
+uint64_t syscall_count(void);
+status_t syscall_benchmark(uint64_t nr, uint32_t iterations, syscall_bench_t *result);
+
+#endif /* SYSCALL_H */
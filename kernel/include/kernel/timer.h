@@ -0,0 +1,97 @@
+/**
+ * QuantumOS Kernel Timers
+ *
+ * One-shot kernel timers on a hierarchical timing wheel. Each CPU owns a
+ * wheel of TIMER_WHEEL_LEVELS levels with TIMER_WHEEL_SLOTS slots each;
+ * level L has a granularity of 64^L microseconds, so six levels cover
+ * 1 us up to ~19 hours. Longer timeouts are clamped to the last level
+ * and re-cascaded until due.
+ *
+ * Adding and cancelling a timer is O(1). Timers are cascaded towards
+ * level 0 as time advances and expire exactly on their microsecond tick.
+ * Expired timers run from the timer softirq with interrupts enabled; a
+ * timer already collected for expiry can no longer be cancelled.
+ *
+ * A per-level bitmap of non-empty slots lets the wheel skip idle time
+ * and report the next event for tickless idle.
+ *
+ * The wheel itself (timer_wheel_*) has no kernel dependencies so it can
+ * be built and benchmarked on the host.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define TIMER_WHEEL_BITS        6
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK        (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS      6
+#define TIMER_WHEEL_MAX_DELTA   ((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+#define TIMER_NO_EXPIRY         UINT64_MAX
+
+#define TIMER_HZ                1000    /* Periodic tick rate (PIT) */
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+struct timer_wheel;
+
+/**
+ * Kernel timer
+ *
+ * Embedded in the owner's structure; must stay valid while pending.
+ */
+typedef struct ktimer {
+    struct ktimer *next;            /* Slot list link */
+    struct ktimer **pprev;          /* Link pointing at this timer */
+    uint64_t expires;               /* Absolute expiry in microseconds */
+    void (*func)(uint64_t data);    /* Expiry callback */
+    uint64_t data;                  /* Callback argument */
+    struct timer_wheel *wheel;      /* Owning wheel while pending */
+    uint8_t level;                  /* Current level and slot */
+    uint8_t slot;
+} ktimer_t;
+
+/**
+ * Timing wheel
+ */
+typedef struct timer_wheel {
+    uint64_t clk;                   /* Next tick to process (us) */
+    uint64_t pending_count;         /* Timers on the wheel */
+    uint64_t bitmap[TIMER_WHEEL_LEVELS];    /* Non-empty slots */
+    ktimer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+} timer_wheel_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+/* Timing wheel (no kernel dependencies) */
+void timer_wheel_init(timer_wheel_t *wheel, uint64_t now);
+void timer_wheel_add(timer_wheel_t *wheel, ktimer_t *timer);
+bool timer_wheel_cancel(ktimer_t *timer);
+uint64_t timer_wheel_next_event(const timer_wheel_t *wheel);
+ktimer_t *timer_wheel_advance(timer_wheel_t *wheel, uint64_t now);
+
+/* Kernel timers (per-CPU wheels) */
+status_t timer_init(void);
+uint64_t timer_now_us(void);
+uint64_t timer_tsc_khz(void);
+void ktimer_init(ktimer_t *timer, void (*func)(uint64_t data), uint64_t data);
+status_t ktimer_add(ktimer_t *timer, uint64_t delay_us);
+bool ktimer_cancel(ktimer_t *timer);
+bool ktimer_pending(const ktimer_t *timer);
+uint64_t timer_next_expiry_us(void);
+void timer_run_expired(void);
+
+#endif /* TIMER_H */
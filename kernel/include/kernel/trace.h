@@ -0,0 +1,124 @@
+/**
+ * QuantumOS Kernel Trace Buffer
+ *
+ * Static tracepoints that record fixed-size binary events into per-CPU
+ * rings, for timelines of scheduling, IPC and interrupt activity without
+ * formatting text on hot paths.
+ *
+ * Each tracepoint tests one bit of a global key (trace_key) before doing
+ * anything else, so a disabled tracepoint costs a load, a test and a
+ * not-taken branch. An enabled one stores a 32-byte record into the
+ * executing CPU's ring, overwriting the oldest record once full (flight
+ * recorder mode).
+ *
+ * The rings are dumped over the serial console between marker lines:
+ *
+ *   #TRACE-BEGIN <version> <cpus> <tsc_khz>
+ *   #T <64 hex digits, one record in memory byte order>
+ *   #TRACE-END <records> <overwritten>
+ *
+ * and tools/trace2json.c turns a console capture into Chrome trace
+ * event JSON for chrome://tracing or ui.perfetto.dev. Console commands
+ * (single bytes received on COM1) control the facility:
+ *
+ *   T  enable all events     S  stop tracing     D  dump and clear
+ *
+ * The header is self-contained so the host decoder shares the record
+ * layout and event table.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define TRACE_VERSION           1
+#define TRACE_RING_RECORDS      2048    /* Per CPU, power of two */
+#define TRACE_RECORD_SIZE       32
+
+#define TRACE_CMD_START         'T'
+#define TRACE_CMD_STOP          'S'
+#define TRACE_CMD_DUMP          'D'
+
+/**
+ * Events
+ *
+ * Phases follow the Chrome trace format: B/E open and close a slice on
+ * the CPU's track, I marks an instant.
+ */
+typedef enum {
+    TRACE_SCHED_SWITCH = 0,     /* I  arg0 = previous pid, arg1 = next pid */
+    TRACE_IRQ_ENTRY,            /* B  arg0 = vector */
+    TRACE_IRQ_EXIT,             /* E  arg0 = vector */
+    TRACE_IPC_SEND,             /* I  arg0 = receiver, arg1 = result */
+    TRACE_IPC_RECEIVE,          /* I  arg0 = sender, arg1 = result */
+    TRACE_IPC_PORT_SEND,        /* I  arg0 = port, arg1 = result */
+    TRACE_IPC_PORT_RECEIVE,     /* I  arg0 = port, arg1 = result */
+    TRACE_RESONANT_SYNC_BEGIN,  /* B  arg0 = sync count */
+    TRACE_RESONANT_SYNC_END,    /* E  arg0 = active oscillators */
+    TRACE_EVENT_COUNT
+} trace_event_t;
+
+#define TRACE_ALL_EVENTS        ((uint32_t)(BIT(TRACE_EVENT_COUNT) - 1))
+
+_Static_assert(TRACE_EVENT_COUNT <= 32, "trace_key is a 32-bit mask");
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t tsc;               /* Time-stamp counter at the event */
+    uint16_t event;             /* trace_event_t */
+    uint8_t cpu;                /* Recording CPU */
+    uint8_t reserved;
+    uint32_t pid;               /* Process current at the event */
+    uint64_t arg0;
+    uint64_t arg1;
+} trace_record_t;
+
+_Static_assert(sizeof(trace_record_t) == TRACE_RECORD_SIZE, "record layout");
+
+typedef struct {
+    uint64_t recorded;          /* Records written since the last clear */
+    uint64_t overwritten;       /* Records lost to ring wrap-around */
+    uint32_t enabled;           /* Current trace_key */
+} trace_stats_t;
+
+/* ============================================================================
+ * Tracepoints
+ * ============================================================================ */
+
+extern volatile uint32_t trace_key;
+
+void trace_record(trace_event_t event, uint64_t arg0, uint64_t arg1);
+
+/**
+ * Record `event` if it is enabled
+ */
+#define trace_event(event, arg0, arg1)                                      \
+    do {                                                                    \
+        if (__builtin_expect(trace_key & BIT(event), 0)) {                  \
+            trace_record((event), (uint64_t)(arg0), (uint64_t)(arg1));      \
+        }                                                                   \
+    } while (0)
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+status_t trace_init(void);
+void trace_enable(uint32_t events);
+void trace_disable(uint32_t events);
+void trace_clear(void);
+void trace_dump(void);
+void trace_command(char c);
+void trace_get_stats(trace_stats_t *stats);
+
+#endif /* TRACE_H */
@@ -0,0 +1,181 @@
+/**
+ * QuantumOS vDSO Data Pages
+ *
+ * Read-only pages for mapping into every address space so user code
+ * can read the clock and poll its IPC queue without entering the kernel:
+ *
+ *   VDSO_CLOCK_ADDR   Clock page, shared by all processes
+ *   VDSO_PROC_ADDR    Status page of the owning process
+ *
+ * Each page is guarded by a sequence counter. The kernel makes it odd
+ * before updating and even afterwards; a reader retries if the counter
+ * was odd or changed while it copied the fields. Writers are serialised
+ * by the kernel (interrupts off on the updating CPU).
+ *
+ * There are no per-process page tables yet, so the pages are only
+ * reachable at their kernel addresses (vdso_clock_page(),
+ * vdso_proc_page()); the fixed user addresses are reserved for when
+ * address spaces are built. Status pages are indexed by PCB slot and
+ * allocated PROCESS_CHUNK_SIZE (kernel/process.h) at a time, the first
+ * time a process in the chunk publishes its queue state.
+ *
+ * The readers below are self-contained so the same header serves the
+ * kernel, user-space libraries and host builds.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef VDSO_H
+#define VDSO_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+#define VDSO_PAGE_SIZE          4096
+#define VDSO_VERSION            1
+
+/* Fixed user virtual addresses, just below the top of the lower half */
+#define VDSO_CLOCK_ADDR         0x00007FFFFFFFE000ULL
+#define VDSO_PROC_ADDR          0x00007FFFFFFFF000ULL
+
+/* vdso_proc_t.ipc_status bits */
+#define VDSO_IPC_OPEN           BIT(0)  /* Queue exists and accepts messages */
+#define VDSO_IPC_PENDING        BIT(1)  /* At least one message queued */
+#define VDSO_IPC_FULL           BIT(2)  /* Queue at capacity, sends will fail */
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+/**
+ * Clock page
+ *
+ * now_us = base_us + (((tsc - tsc_base) * tsc_mult) >> tsc_shift)
+ */
+typedef struct {
+    volatile uint32_t seq;          /* Sequence counter, odd while updating */
+    uint32_t version;               /* VDSO_VERSION */
+    uint64_t tsc_base;              /* TSC value at base_us */
+    uint64_t base_us;               /* Kernel time at tsc_base */
+    uint64_t tsc_mult;              /* TSC cycles to microseconds */
+    uint32_t tsc_shift;
+    uint32_t reserved;
+    uint64_t tsc_khz;               /* Calibrated TSC frequency */
+} ALIGNED(VDSO_PAGE_SIZE) vdso_clock_t;
+
+/**
+ * Per-process status page
+ */
+typedef struct {
+    volatile uint32_t seq;          /* Sequence counter, odd while updating */
+    uint32_t pid;                   /* Owning process */
+    uint32_t ipc_queue_depth;       /* Messages waiting in the process queue */
+    uint32_t ipc_queue_max;         /* Queue capacity */
+    uint32_t ipc_dropped;           /* Messages dropped on a full queue */
+    uint32_t ipc_status;            /* VDSO_IPC_* */
+} ALIGNED(VDSO_PAGE_SIZE) vdso_proc_t;
+
+/* ============================================================================
+ * Sequence Counter
+ * ============================================================================ */
+
+/* x86 keeps stores and loads in program order, so only the compiler
+ * needs fencing; ports to weaker memory models need real barriers. */
+#define vdso_barrier()          __asm__ volatile("" : : : "memory")
+
+static inline void vdso_write_begin(volatile uint32_t *seq) {
+    *seq = *seq + 1;
+    vdso_barrier();
+}
+
+static inline void vdso_write_end(volatile uint32_t *seq) {
+    vdso_barrier();
+    *seq = *seq + 1;
+}
+
+static inline uint32_t vdso_read_begin(const volatile uint32_t *seq) {
+    uint32_t s;
+
+    while ((s = *seq) & 1) {
+        __asm__ volatile("pause");
+    }
+    vdso_barrier();
+    return s;
+}
+
+static inline bool vdso_read_retry(const volatile uint32_t *seq, uint32_t start) {
+    vdso_barrier();
+    return *seq != start;
+}
+
+/* ============================================================================
+ * Readers
+ * ============================================================================ */
+
+/**
+ * Microseconds since boot, without a kernel entry
+ */
+static inline uint64_t vdso_time_us(const vdso_clock_t *clock) {
+    uint64_t tsc_base, base_us, mult, tsc;
+    uint32_t shift, seq;
+
+    do {
+        seq = vdso_read_begin(&clock->seq);
+        tsc_base = clock->tsc_base;
+        base_us = clock->base_us;
+        mult = clock->tsc_mult;
+        shift = clock->tsc_shift;
+        /* Read inside the section so a rebase cannot land in between */
+        uint32_t lo, hi;
+        __asm__ volatile("rdtsc" : "=a"(lo), "=d"(hi));
+        tsc = ((uint64_t)hi << 32) | lo;
+    } while (vdso_read_retry(&clock->seq, seq));
+
+    return base_us + (uint64_t)(((unsigned __int128)(tsc - tsc_base) * mult) >> shift);
+}
+
+/**
+ * Number of messages waiting in the caller's IPC queue
+ *
+ * A single aligned word needs no retry loop.
+ */
+static inline uint32_t vdso_ipc_queue_depth(const vdso_proc_t *proc) {
+    return *(const volatile uint32_t *)&proc->ipc_queue_depth;
+}
+
+/**
+ * Consistent snapshot of the IPC status words
+ */
+static inline void vdso_ipc_status(const vdso_proc_t *proc, uint32_t *depth, uint32_t *status) {
+    uint32_t seq;
+
+    do {
+        seq = vdso_read_begin(&proc->seq);
+        *depth = proc->ipc_queue_depth;
+        *status = proc->ipc_status;
+    } while (vdso_read_retry(&proc->seq, seq));
+}
+
+/* ============================================================================
+ * Kernel Interface
+ * ============================================================================ */
+
+/**
+ * Time-read and queue-poll cost, in TSC cycles per call
+ */
+typedef struct {
+    uint64_t time_read_cycles;      /* vdso_time_us() */
+    uint64_t queue_depth_cycles;    /* vdso_ipc_queue_depth() */
+} vdso_bench_t;
+
+void vdso_update_clock(uint64_t tsc_base, uint64_t base_us, uint64_t tsc_mult,
+                       uint32_t tsc_shift, uint64_t tsc_khz);
+void vdso_update_ipc(uint32_t pid, uint32_t depth, uint32_t max, uint32_t dropped, bool open);
+const vdso_clock_t *vdso_clock_page(void);
+const vdso_proc_t *vdso_proc_page(uint32_t pid);
+status_t vdso_benchmark(uint32_t iterations, vdso_bench_t *result);
+
+#endif /* VDSO_H */
@@ -0,0 +1,130 @@
+/**
+ * QuantumOS Wait Sets
+ *
+ * Readiness multiplexing: one waiter watches many sources (IPC queues,
+ * ports, channels, and anything else that embeds a waitset_source_t)
+ * and collects the ready ones in a batch.
+ *
+ * Each registration is an item linking one set to one source. A
+ * producer calls waitset_signal() when it makes data available; every
+ * item watching the source is appended to its set's ready list unless
+ * it is already there, so signalling is O(watchers) and independent of
+ * how many sources a set holds. waitset_collect() only visits the ready
+ * list, so waiting is O(ready), not O(registered).
+ *
+ * Level-triggered items (the default) stay on the ready list while the
+ * source's pending count is non-zero and are reported on every collect;
+ * an item whose source was drained between signal and collect is
+ * dropped without being reported. Edge-triggered items (WAITSET_EDGE)
+ * are reported once per batch of signals and leave the list until the
+ * next one. A source that closes reports WAITSET_HANGUP once; the
+ * registration is dropped when that event is collected.
+ *
+ * No locking: like the IPC queues that drive it, a set is used from
+ * one CPU at a time.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef WAITSET_H
+#define WAITSET_H
+
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Constants
+ * ============================================================================ */
+
+/* Registration flags */
+#define WAITSET_LEVEL           0x00
+#define WAITSET_EDGE            0x01
+
+/* Reported events */
+#define WAITSET_READABLE        0x01
+#define WAITSET_HANGUP          0x02
+
+/* ============================================================================
+ * Data Structures
+ * ============================================================================ */
+
+typedef struct waitset_item waitset_item_t;
+
+/**
+ * Embedded in a producer. `pending` is what a reader would get now
+ * (queued messages, say); level-triggered items read it at collect.
+ */
+typedef struct {
+    waitset_item_t *watchers;
+    const uint32_t *pending;
+} waitset_source_t;
+
+typedef struct {
+    waitset_item_t *ready_head;
+    waitset_item_t *ready_tail;
+    waitset_item_t *items;              /* Every registration, for destroy */
+    uint32_t ready_count;
+    uint32_t item_count;
+} waitset_t;
+
+typedef struct {
+    uint64_t cookie;                    /* Chosen at registration */
+    uint32_t events;                    /* WAITSET_READABLE | WAITSET_HANGUP */
+    uint32_t pending;                   /* Source's pending count when collected */
+} waitset_event_t;
+
+/* ============================================================================
+ * Function Declarations
+ * ============================================================================ */
+
+void waitset_init(waitset_t *set);
+
+/**
+ * Remove every registration
+ */
+void waitset_destroy(waitset_t *set);
+
+/**
+ * Prepare a source whose readiness is `*pending` > 0
+ */
+void waitset_source_init(waitset_source_t *source, const uint32_t *pending);
+
+/**
+ * Watch `source` from `set`. A source that is already pending makes
+ * the item ready at once.
+ *
+ * @param flags WAITSET_LEVEL or WAITSET_EDGE
+ * @param item Receives the registration, may be NULL
+ * @return STATUS_NO_MEMORY when no item can be allocated
+ */
+status_t waitset_add(waitset_t *set, waitset_source_t *source, uint32_t flags,
+                     uint64_t cookie, waitset_item_t **item);
+
+/**
+ * Registration of `set` on `source`, NULL if none
+ */
+waitset_item_t *waitset_find(const waitset_t *set, const waitset_source_t *source);
+
+/**
+ * Drop a registration
+ */
+void waitset_remove(waitset_item_t *item);
+
+/**
+ * Producer side: data became available on `source`
+ */
+void waitset_signal(waitset_source_t *source);
+
+/**
+ * Producer side: `source` is going away. Its items report
+ * WAITSET_HANGUP at the next collect and are dropped.
+ */
+void waitset_source_close(waitset_source_t *source);
+
+/**
+ * Take up to `max` ready events, in the order their sources became ready
+ *
+ * @return Number of events written
+ */
+uint32_t waitset_collect(waitset_t *set, waitset_event_t *events, uint32_t max);
+
+#endif /* WAITSET_H */
@@ -0,0 +1,116 @@
+/**
+ * QuantumOS Local APIC Support
+ *
+ * Minimal xAPIC support needed for message-signalled interrupts: the
+ * local APIC is software-enabled alongside the legacy PIC (which keeps
+ * delivering through LINT0 in virtual-wire mode), MSI/MSI-X vectors are
+ * acknowledged here, and self-IPIs are available for testing vectors.
+ *
+ * The APIC register page is accessed through the identity mapping set
+ * up by the boot loader.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/interrupts.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+#include <kernel/log.h>
+
+#define IA32_APIC_BASE_MSR      0x1B
+#define APIC_BASE_ENABLE        BIT(11)
+#define APIC_BASE_ADDR_MASK     0xFFFFFF000ULL
+
+/* Register offsets */
+#define APIC_REG_ID             0x020
+#define APIC_REG_EOI            0x0B0
+#define APIC_REG_SVR            0x0F0
+#define APIC_REG_ICR_LOW        0x300
+#define APIC_REG_ICR_HIGH       0x310
+#define APIC_REG_LVT_PERF       0x340
+
+#define APIC_SVR_ENABLE         BIT(8)
+#define APIC_ICR_PENDING        BIT(12)
+#define APIC_ICR_DEST_SELF      (1U << 18)
+#define APIC_LVT_DELIVERY_NMI   (4U << 8)
+#define APIC_LVT_MASKED         BIT(16)
+
+static volatile uint32_t *apic_regs;
+static uint32_t apic_ids[MAX_CPUS];
+static bool apic_enabled;
+
+static inline uint32_t apic_read(uint32_t reg) {
+    return apic_regs[reg / 4];
+}
+
+static inline void apic_write(uint32_t reg, uint32_t value) {
+    apic_regs[reg / 4] = value;
+}
+
+// Enable the local APIC of the calling CPU
+void apic_init(void) {
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1));
+    if (!(edx & BIT(9))) {
+        klog(LOG_WARN, "Local APIC not present");
+        return;
+    }
+
+    uint64_t base = cpu_rdmsr(IA32_APIC_BASE_MSR);
+    cpu_wrmsr(IA32_APIC_BASE_MSR, base | APIC_BASE_ENABLE);
+    apic_regs = (volatile uint32_t *)(uintptr_t)(base & APIC_BASE_ADDR_MASK);
+
+    apic_write(APIC_REG_SVR, APIC_SVR_ENABLE | APIC_SPURIOUS_VECTOR);
+
+    apic_ids[cpu_current_id()] = apic_read(APIC_REG_ID) >> 24;
+    apic_enabled = true;
+
+    klog_hex(LOG_INFO, "Local APIC enabled, ID: ", apic_ids[cpu_current_id()]);
+}
+
+// Acknowledge an APIC-delivered interrupt
+void apic_send_eoi(void) {
+    if (apic_enabled) {
+        apic_write(APIC_REG_EOI, 0);
+    }
+}
+
+// Check whether the local APIC is usable
+bool apic_is_enabled(void) {
+    return apic_enabled;
+}
+
+// APIC ID of a logical CPU, used as MSI destination
+uint32_t apic_get_id(uint32_t cpu) {
+    return (cpu < MAX_CPUS) ? apic_ids[cpu] : 0;
+}
+
+// Send a fixed-delivery IPI to the calling CPU
+irq_result_t apic_send_self_ipi(uint8_t vector) {
+    if (!apic_enabled) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+
+    apic_write(APIC_REG_ICR_HIGH, 0);
+    apic_write(APIC_REG_ICR_LOW, APIC_ICR_DEST_SELF | vector);
+    while (apic_read(APIC_REG_ICR_LOW) & APIC_ICR_PENDING) {
+        __asm__ volatile("pause");
+    }
+
+    return IRQ_SUCCESS;
+}
+
+// Deliver performance counter overflow as an NMI, or mask it. The NMI
+// can interrupt any instruction, including the SYSCALL window before the
+// kernel stack is loaded; interrupts_init() gives it an IST stack before
+// apic_init() runs, so it never uses the interrupted stack.
+irq_result_t apic_set_perf_nmi(bool enable) {
+    if (!apic_enabled) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+
+    /* Also clears the mask the CPU sets when it delivers a PMI */
+    apic_write(APIC_REG_LVT_PERF, enable ? APIC_LVT_DELIVERY_NMI : APIC_LVT_MASKED);
+    return IRQ_SUCCESS;
+}
@@ -0,0 +1,190 @@
+/**
+ * QuantumOS Boot Stage Runner
+ *
+ * Waves are computed by relaxation: a stage's wave is one more than the
+ * deepest of its prerequisites. If the waves have not settled after
+ * `count` passes the graph has a cycle.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/boot_stage.h>
+#include <kernel/timer.h>
+#include <kernel/boot.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+
+#define STAGE_MESSAGE_MAX       64
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Assign waves and check the graph
+ *
+ * @return STATUS_INVALID_ARG for a bad reference, a cycle, or a
+ *         critical stage that depends on a deferred one
+ */
+static status_t compute_waves(boot_stage_t *stages, uint32_t count) {
+    uint32_t valid = (count == BOOT_STAGE_MAX) ? 0xFFFFFFFFU : (BIT(count) - 1);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (stages[i].deps & ~valid) {
+            return STATUS_INVALID_ARG;
+        }
+        stages[i].wave = 0;
+    }
+
+    for (uint32_t pass = 0; pass <= count; pass++) {
+        bool changed = false;
+
+        for (uint32_t i = 0; i < count; i++) {
+            for (uint32_t d = 0; d < count; d++) {
+                if ((stages[i].deps & BIT(d)) && stages[i].wave <= stages[d].wave) {
+                    stages[i].wave = stages[d].wave + 1;
+                    changed = true;
+                }
+            }
+        }
+
+        if (!changed) {
+            for (uint32_t i = 0; i < count; i++) {
+                for (uint32_t d = 0; d < count; d++) {
+                    if ((stages[i].deps & BIT(d)) &&
+                        !(stages[i].flags & BOOT_STAGE_DEFERRED) &&
+                        (stages[d].flags & BOOT_STAGE_DEFERRED)) {
+                        return STATUS_INVALID_ARG;
+                    }
+                }
+            }
+            return STATUS_SUCCESS;
+        }
+    }
+
+    return STATUS_INVALID_ARG;
+}
+
+static void stage_message(char *buf, const char *prefix, const char *name, const char *suffix) {
+    uint32_t len = 0;
+    const char *parts[3] = { prefix, name, suffix };
+
+    for (uint32_t p = 0; p < 3; p++) {
+        for (const char *s = parts[p]; *s && len < STAGE_MESSAGE_MAX - 1; s++) {
+            buf[len++] = *s;
+        }
+    }
+    buf[len] = '\0';
+}
+
+static uint64_t cycles_to_us(uint64_t cycles) {
+    uint64_t khz = timer_tsc_khz();
+    return khz ? (cycles * 1000) / khz : cycles;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Record kernel entry; call first thing in kernel_main
+ */
+void boot_profile_start(boot_profile_t *profile) {
+    profile->start_tsc = cpu_rdtsc();
+    profile->ready_tsc = 0;
+    profile->deferred_tsc = 0;
+    profile->waves = 0;
+}
+
+/**
+ * Run the critical (deferred = false) or deferred stages of a graph
+ *
+ * @return STATUS_SUCCESS, STATUS_INVALID_ARG for a malformed graph, or
+ *         the result of the first failing non-optional stage
+ */
+status_t boot_stages_run(boot_stage_t *stages, uint32_t count, bool deferred,
+                         boot_profile_t *profile) {
+    if (!stages || count == 0 || count > BOOT_STAGE_MAX) {
+        return STATUS_INVALID_ARG;
+    }
+
+    status_t result = compute_waves(stages, count);
+    if (result != STATUS_SUCCESS) {
+        return result;
+    }
+
+    uint32_t last_wave = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (!(stages[i].flags & BOOT_STAGE_DEFERRED) == !deferred) {
+            last_wave = MAX(last_wave, stages[i].wave);
+        }
+    }
+
+    /* Each wave only needs the waves before it */
+    for (uint32_t wave = 0; wave <= last_wave; wave++) {
+        for (uint32_t i = 0; i < count; i++) {
+            boot_stage_t *stage = &stages[i];
+
+            if (stage->wave != wave || stage->done ||
+                !(stage->flags & BOOT_STAGE_DEFERRED) != !deferred) {
+                continue;
+            }
+
+            uint64_t start = cpu_rdtsc();
+            stage->result = stage->fn();
+            stage->cycles = cpu_rdtsc() - start;
+            stage->done = true;
+
+            if (stage->result != STATUS_SUCCESS) {
+                char message[STAGE_MESSAGE_MAX];
+                stage_message(message, "Boot stage ", stage->name, " failed: ");
+                klog_hex(LOG_ERR, message, (uint64_t)stage->result);
+                if (!(stage->flags & BOOT_STAGE_OPTIONAL)) {
+                    return stage->result;
+                }
+            }
+        }
+    }
+
+    if (deferred) {
+        profile->deferred_tsc = cpu_rdtsc();
+    } else {
+        profile->ready_tsc = cpu_rdtsc();
+        profile->waves = last_wave + 1;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Log the per-stage breakdown and the boot-to-ready time
+ *
+ * Times are in microseconds once the TSC is calibrated, else cycles.
+ */
+void boot_stages_report(const boot_stage_t *stages, uint32_t count,
+                        const boot_profile_t *profile) {
+    char message[STAGE_MESSAGE_MAX];
+    uint64_t staged = 0;
+
+    boot_log("=== Boot profile (us) ===");
+    for (uint32_t i = 0; i < count; i++) {
+        if (!stages[i].done) {
+            continue;
+        }
+        stage_message(message, (stages[i].flags & BOOT_STAGE_DEFERRED) ? "  deferred " : "  ",
+                      stages[i].name, ": ");
+        klog_hex(LOG_INFO, message, cycles_to_us(stages[i].cycles));
+        if (!(stages[i].flags & BOOT_STAGE_DEFERRED)) {
+            staged += stages[i].cycles;
+        }
+    }
+
+    uint64_t to_ready = profile->ready_tsc - profile->start_tsc;
+    klog_hex(LOG_INFO, "  outside stages: ", cycles_to_us(to_ready - staged));
+    klog_hex(LOG_INFO, "Boot to ready (us): ", cycles_to_us(to_ready));
+    klog_hex(LOG_INFO, "Critical path waves: ", profile->waves);
+    if (profile->deferred_tsc) {
+        klog_hex(LOG_INFO, "Deferred work (us): ", cycles_to_us(profile->deferred_tsc - profile->ready_tsc));
+    }
+}
@@ -0,0 +1,319 @@
+/**
+ * QuantumOS Capability Spaces
+ *
+ * Radix-tree CSpaces, the per-space rights cache and the registry that
+ * ties processes to spaces (kernel/capability.h).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/capability.h>
+#include <kernel/process.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/vdso.h>
+
+#define CSPACE_INDEX_MASK       0xFFFFU
+#define CSPACE_GEN_SHIFT        16
+
+_Static_assert(CSPACE_MAX_SPACES <= CSPACE_INDEX_MASK, "registry index field");
+
+/* Interior nodes hold children; the last level holds the slots */
+struct cspace_node {
+    union {
+        cspace_node_t *child[CSPACE_RADIX];
+        cap_t slot[CSPACE_RADIX];
+    };
+};
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static cspace_t *spaces[CSPACE_MAX_SPACES];
+static uint16_t generations[CSPACE_MAX_SPACES];
+
+/*
+ * Nodes of destroyed spaces, linked through child[0]. kfree() cannot
+ * return memory to the heap yet, so nodes are reused from here first.
+ */
+static cspace_node_t *node_cache;
+
+/* ============================================================================
+ * Internal Functions
+ * ============================================================================ */
+
+static inline uint32_t radix_index(uint32_t cptr, uint32_t level) {
+    return (cptr >> (CSPACE_RADIX_BITS * (CSPACE_LEVELS - 1 - level))) & (CSPACE_RADIX - 1);
+}
+
+/* Slot for `cptr`, or NULL where the tree has no node yet */
+static cap_t *slot_find(const cspace_t *cs, uint32_t cptr) {
+    cspace_node_t *node = __atomic_load_n(&cs->root, __ATOMIC_ACQUIRE);
+
+    for (uint32_t level = 0; node && level < CSPACE_LEVELS - 1; level++) {
+        node = __atomic_load_n(&node->child[radix_index(cptr, level)], __ATOMIC_ACQUIRE);
+    }
+    return node ? &node->slot[radix_index(cptr, CSPACE_LEVELS - 1)] : NULL;
+}
+
+static cspace_node_t *node_alloc(void) {
+    cspace_node_t *node = node_cache;
+
+    if (node) {
+        node_cache = node->child[0];
+    } else {
+        node = kmalloc(sizeof(*node));
+    }
+    if (node) {
+        memset(node, 0, sizeof(*node));
+    }
+    return node;
+}
+
+/* Slot for `cptr`, building the path down to it */
+static cap_t *slot_create(cspace_t *cs, uint32_t cptr) {
+    cspace_node_t **link = &cs->root;
+
+    for (uint32_t level = 0; level < CSPACE_LEVELS; level++) {
+        if (!*link) {
+            cspace_node_t *node = node_alloc();
+
+            if (!node) {
+                return NULL;
+            }
+            /* Readers may find the node as soon as it is linked */
+            __atomic_store_n(link, node, __ATOMIC_RELEASE);
+        }
+        if (level == CSPACE_LEVELS - 1) {
+            return &(*link)->slot[radix_index(cptr, level)];
+        }
+        link = &(*link)->child[radix_index(cptr, level)];
+    }
+    return NULL;
+}
+
+static void node_free(cspace_node_t *node, uint32_t level) {
+    if (!node) {
+        return;
+    }
+    if (level < CSPACE_LEVELS - 1) {
+        for (uint32_t i = 0; i < CSPACE_RADIX; i++) {
+            node_free(node->child[i], level + 1);
+        }
+    }
+    node->child[0] = node_cache;
+    node_cache = node;
+}
+
+static void right_add(cspace_t *cs, uint32_t right) {
+    if (cs->grants[right]++ == 0) {
+        __atomic_fetch_or(&cs->rights[right / 64], 1ULL << (right % 64), __ATOMIC_RELEASE);
+    }
+}
+
+static void right_drop(cspace_t *cs, uint32_t right) {
+    if (--cs->grants[right] == 0) {
+        __atomic_fetch_and(&cs->rights[right / 64], ~(1ULL << (right % 64)), __ATOMIC_RELEASE);
+    }
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+status_t cspace_init_table(cspace_t *cs) {
+    if (!cs) {
+        return STATUS_INVALID_ARG;
+    }
+    memset(cs, 0, sizeof(*cs));
+    cs->next_cptr = CAP_NULL + 1;
+    return STATUS_SUCCESS;
+}
+
+status_t cspace_init(cspace_t *cs) {
+    if (cspace_init_table(cs) != STATUS_SUCCESS) {
+        return STATUS_INVALID_ARG;
+    }
+
+    /* Index 0 is reserved so that capability_root 0 means "no space" */
+    for (uint32_t index = 1; index < CSPACE_MAX_SPACES; index++) {
+        if (!spaces[index]) {
+            cs->id = ((uint32_t)++generations[index] << CSPACE_GEN_SHIFT) | index;
+            spaces[index] = cs;
+            return STATUS_SUCCESS;
+        }
+    }
+    return STATUS_NO_MEMORY;
+}
+
+void cspace_destroy(cspace_t *cs) {
+    if (!cs) {
+        return;
+    }
+    if (cs->id) {
+        spaces[cs->id & CSPACE_INDEX_MASK] = NULL;
+        cs->id = 0;
+    }
+    node_free(cs->root, 0);
+    cs->root = NULL;
+    memset(cs->rights, 0, sizeof(cs->rights));
+}
+
+status_t cspace_insert(cspace_t *cs, const cap_t *cap, uint32_t *cptr) {
+    uint32_t slot_cptr;
+    cap_t *slot;
+
+    if (!cs || !cap || cap->type == CAP_TYPE_NULL ||
+        (cap->type == CAP_TYPE_RIGHT && cap->rights >= CAP_RIGHT_MAX)) {
+        return STATUS_INVALID_ARG;
+    }
+    if (cs->sealed) {
+        return STATUS_PERMISSION_DENIED;
+    }
+
+    if (cs->free_head != CAP_NULL) {
+        slot_cptr = cs->free_head;
+        slot = slot_find(cs, slot_cptr);
+        cs->free_head = (uint32_t)slot->badge;
+    } else {
+        if (cs->next_cptr >= CSPACE_SLOTS) {
+            return STATUS_NO_MEMORY;
+        }
+        slot_cptr = cs->next_cptr;
+        slot = slot_create(cs, slot_cptr);
+        if (!slot) {
+            return STATUS_NO_MEMORY;
+        }
+        cs->next_cptr++;
+    }
+
+    vdso_write_begin(&cs->seq);
+    *slot = *cap;
+    vdso_write_end(&cs->seq);
+
+    if (cap->type == CAP_TYPE_RIGHT) {
+        right_add(cs, cap->rights);
+    }
+    cs->count++;
+    if (cptr) {
+        *cptr = slot_cptr;
+    }
+    return STATUS_SUCCESS;
+}
+
+status_t cspace_grant(cspace_t *cs, uint32_t right, uint32_t *cptr) {
+    cap_t cap = { .object = NULL, .type = CAP_TYPE_RIGHT, .rights = right };
+
+    return cspace_insert(cs, &cap, cptr);
+}
+
+status_t cspace_delete(cspace_t *cs, uint32_t cptr) {
+    cap_t *slot;
+
+    if (!cs) {
+        return STATUS_INVALID_ARG;
+    }
+    if (cs->sealed) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    slot = cptr < cs->next_cptr ? slot_find(cs, cptr) : NULL;
+    if (!slot || slot->type == CAP_TYPE_NULL) {
+        return STATUS_NOT_FOUND;
+    }
+
+    if (slot->type == CAP_TYPE_RIGHT) {
+        right_drop(cs, slot->rights);
+    }
+    vdso_write_begin(&cs->seq);
+    slot->object = NULL;
+    slot->type = CAP_TYPE_NULL;
+    slot->rights = 0;
+    slot->badge = cs->free_head;
+    slot->generation = 0;
+    vdso_write_end(&cs->seq);
+
+    cs->free_head = cptr;
+    cs->count--;
+    return STATUS_SUCCESS;
+}
+
+status_t cspace_lookup(const cspace_t *cs, uint32_t cptr, cap_t *cap) {
+    const cap_t *slot;
+    uint32_t seq;
+
+    if (!cs || !cap) {
+        return STATUS_INVALID_ARG;
+    }
+    if (cptr == CAP_NULL || cptr >= CSPACE_SLOTS) {
+        return STATUS_NOT_FOUND;
+    }
+
+    if (__atomic_load_n(&cs->sealed, __ATOMIC_ACQUIRE)) {
+        slot = slot_find(cs, cptr);
+        if (!slot || slot->type == CAP_TYPE_NULL) {
+            return STATUS_NOT_FOUND;
+        }
+        *cap = *slot;
+        return STATUS_SUCCESS;
+    }
+
+    do {
+        seq = vdso_read_begin(&cs->seq);
+        slot = slot_find(cs, cptr);
+        if (slot) {
+            *cap = *slot;
+        }
+    } while (vdso_read_retry(&cs->seq, seq));
+
+    return slot && cap->type != CAP_TYPE_NULL ? STATUS_SUCCESS : STATUS_NOT_FOUND;
+}
+
+void cspace_seal(cspace_t *cs) {
+    if (cs) {
+        /* Everything written before is visible to whoever sees the flag */
+        __atomic_store_n(&cs->sealed, true, __ATOMIC_RELEASE);
+    }
+}
+
+cspace_t *cspace_get(uint32_t id) {
+    uint32_t index = id & CSPACE_INDEX_MASK;
+    cspace_t *cs;
+
+    if (index == 0 || index >= CSPACE_MAX_SPACES) {
+        return NULL;
+    }
+    cs = spaces[index];
+    return cs && cs->id == id ? cs : NULL;
+}
+
+status_t cspace_attach(cspace_t *cs, uint32_t pid) {
+    process_t *process;
+
+    if (!cs || !cs->id) {
+        return STATUS_INVALID_ARG;
+    }
+    process = process_get_by_pid(pid);
+    if (!process) {
+        return STATUS_NOT_FOUND;
+    }
+    process->capability_root = cs->id;
+    return STATUS_SUCCESS;
+}
+
+bool cap_process_has(const process_t *process, uint32_t right) {
+    const cspace_t *cs;
+
+    if (!process) {
+        return true;
+    }
+    if (process->capability_root == 0) {
+        return PROCESS_IS_KERNEL(process);     /* Default for unattached processes */
+    }
+    cs = cspace_get(process->capability_root);
+    return cs && cspace_has_right(cs, right);
+}
+
+bool cap_current_has(uint32_t right) {
+    return cap_process_has(process_get_current(), right);
+}
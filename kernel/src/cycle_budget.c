@@ -0,0 +1,350 @@
+/**
+ * QuantumOS Per-Process Cycle Budget Implementation
+ *
+ * Budget accounting for the context-switch path. All operations are
+ * O(1) on a table indexed by PCB slot so the switch path never walks
+ * lists; an entry also records its PID, so a budget is never applied to
+ * a later process reusing the slot. The table is chunked like the PCB
+ * table (PROCESS_CHUNK_SIZE in kernel/process.h), and a chunk is only
+ * allocated when a budget is first set in it.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/cycle_budget.h>
+#include <kernel/resonance/consciousness_process.h>
+#include <kernel/process.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+#include <kernel/log.h>
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+/* Budget table: chunk directory, grown on demand */
+static cycle_budget_t *budget_chunks[PROCESS_CHUNKS];
+static cycle_budget_stats_t budget_stats;
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Table entry for a PID's slot, NULL if its chunk was never allocated
+ */
+static cycle_budget_t *budget_slot(uint32_t pid) {
+    if (pid > PROCESS_PID_MAX) {
+        return NULL;
+    }
+
+    uint32_t slot = PROCESS_PID_INDEX(pid);
+    cycle_budget_t *chunk = budget_chunks[slot >> PROCESS_CHUNK_SHIFT];
+
+    return chunk ? &chunk[slot & (PROCESS_CHUNK_SIZE - 1)] : NULL;
+}
+
+/**
+ * Table entry for a PID's slot, allocating its chunk on first use
+ */
+static cycle_budget_t *budget_grow(uint32_t pid) {
+    uint32_t slot = PROCESS_PID_INDEX(pid);
+    cycle_budget_t **chunk = &budget_chunks[slot >> PROCESS_CHUNK_SHIFT];
+
+    if (!*chunk) {
+        *chunk = kmalloc(PROCESS_CHUNK_SIZE * sizeof(cycle_budget_t));
+        if (!*chunk) {
+            return NULL;
+        }
+        memset(*chunk, 0, PROCESS_CHUNK_SIZE * sizeof(cycle_budget_t));
+    }
+    return &(*chunk)[slot & (PROCESS_CHUNK_SIZE - 1)];
+}
+
+static cycle_budget_t *get_budget(uint32_t pid) {
+    cycle_budget_t *b = budget_slot(pid);
+
+    if (!b || !b->active || b->pid != pid) {
+        return NULL;
+    }
+    return b;
+}
+
+/**
+ * Start a new period if the current one has elapsed
+ *
+ * Overrun from the period that just ended is carried into the next one
+ * as debt (capped at one budget), so a process cannot gain by running
+ * long past its budget right before a period boundary. If more than one
+ * full period has elapsed the process was idle and the debt is dropped.
+ */
+static void replenish(cycle_budget_t *b, uint64_t now) {
+    if (now < b->period_start || now - b->period_start < b->period) {
+        return;
+    }
+
+    uint64_t elapsed_periods = (now - b->period_start) / b->period;
+    uint64_t debt = 0;
+
+    if (elapsed_periods == 1 && b->used > b->budget) {
+        debt = MIN(b->used - b->budget, b->budget);
+    }
+
+    b->period_start += elapsed_periods * b->period;
+    b->used = debt;
+    b->replenish_count++;
+
+    if (b->throttled && b->used < b->budget) {
+        b->throttled = false;
+        budget_stats.throttled_processes--;
+    }
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Initialize cycle budget accounting
+ */
+status_t cycle_budget_init(void) {
+    /* Chunks from an earlier init are kept and cleared */
+    for (uint32_t i = 0; i < PROCESS_CHUNKS; i++) {
+        if (budget_chunks[i]) {
+            memset(budget_chunks[i], 0, PROCESS_CHUNK_SIZE * sizeof(cycle_budget_t));
+        }
+    }
+    memset(&budget_stats, 0, sizeof(budget_stats));
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Set (or replace) the budget for a process
+ *
+ * A budget of CYCLE_BUDGET_UNLIMITED removes enforcement. A period of 0
+ * selects CYCLE_BUDGET_DEFAULT_PERIOD.
+ */
+status_t cycle_budget_set(uint32_t pid, uint64_t budget, uint64_t period) {
+    if (pid > PROCESS_PID_MAX) {
+        return STATUS_INVALID_ARG;
+    }
+
+    if (budget == CYCLE_BUDGET_UNLIMITED) {
+        return cycle_budget_clear(pid);
+    }
+
+    if (period == 0) {
+        period = CYCLE_BUDGET_DEFAULT_PERIOD;
+    }
+    if (period < CYCLE_BUDGET_MIN_PERIOD || budget > period) {
+        return STATUS_INVALID_ARG;
+    }
+
+    cycle_budget_t *b = budget_grow(pid);
+    if (!b) {
+        return STATUS_NO_MEMORY;
+    }
+
+    if (b->active && b->pid != pid) {
+        cycle_budget_clear(b->pid);     /* Left behind by the slot's last process */
+    }
+
+    if (!b->active) {
+        memset(b, 0, sizeof(*b));
+        b->pid = pid;
+        b->period_start = cpu_rdtsc();
+        b->active = true;
+        budget_stats.budgeted_processes++;
+    }
+
+    b->budget = budget;
+    b->period = period;
+
+    /* Re-evaluate throttling against the new budget */
+    if (b->throttled && b->used < b->budget) {
+        b->throttled = false;
+        budget_stats.throttled_processes--;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Remove the budget for a process
+ */
+status_t cycle_budget_clear(uint32_t pid) {
+    if (pid > PROCESS_PID_MAX) {
+        return STATUS_INVALID_ARG;
+    }
+
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        return STATUS_SUCCESS;
+    }
+
+    if (b->throttled) {
+        budget_stats.throttled_processes--;
+    }
+    budget_stats.budgeted_processes--;
+
+    memset(b, 0, sizeof(*b));
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Charge consumed cycles to a process
+ *
+ * Processes without a budget are accepted and ignored so the switch path
+ * can charge unconditionally.
+ */
+status_t cycle_budget_charge(uint32_t pid, uint64_t cycles, uint64_t now) {
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        return (pid <= PROCESS_PID_MAX) ? STATUS_SUCCESS : STATUS_INVALID_ARG;
+    }
+
+    replenish(b, now);
+
+    uint64_t before = b->used;
+    b->used += cycles;
+    b->total_used += cycles;
+
+    if (b->used < b->budget) {
+        return STATUS_SUCCESS;
+    }
+
+    /* Cycles beyond the budget in this charge are an overrun */
+    if (b->used > b->budget) {
+        uint64_t excess = b->used - MAX(before, b->budget);
+        if (before <= b->budget) {
+            b->overrun_count++;
+            budget_stats.total_overruns++;
+        }
+        b->overrun_cycles += excess;
+        budget_stats.total_overrun_cycles += excess;
+    }
+
+    if (!b->throttled) {
+        b->throttled = true;
+        b->throttle_count++;
+        budget_stats.throttled_processes++;
+
+        if (b->used > b->budget) {
+            klog_hex(LOG_DEBUG, "Cycle budget overrun, throttling PID: ", pid);
+        }
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Check whether a process is throttled, replenishing first
+ */
+bool cycle_budget_is_throttled(uint32_t pid, uint64_t now) {
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        return false;
+    }
+
+    replenish(b, now);
+    return b->throttled;
+}
+
+/**
+ * Cycles left in the current period (UINT64_MAX if unbudgeted)
+ */
+uint64_t cycle_budget_remaining(uint32_t pid, uint64_t now) {
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        return UINT64_MAX;
+    }
+
+    replenish(b, now);
+    return (b->used < b->budget) ? b->budget - b->used : 0;
+}
+
+/**
+ * Get budget state for a process
+ */
+status_t cycle_budget_get(uint32_t pid, cycle_budget_t *out) {
+    if (!out) {
+        return STATUS_INVALID_ARG;
+    }
+
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        return STATUS_NOT_FOUND;
+    }
+
+    *out = *b;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Get global budget statistics
+ */
+status_t cycle_budget_get_stats(cycle_budget_stats_t *stats) {
+    if (!stats) {
+        return STATUS_INVALID_ARG;
+    }
+
+    *stats = budget_stats;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Dump budget state for debugging
+ */
+void cycle_budget_dump(uint32_t pid) {
+    cycle_budget_t *b = get_budget(pid);
+    if (!b) {
+        klog(LOG_WARN, "No cycle budget for PID");
+        return;
+    }
+
+    boot_log("=== Cycle Budget ===");
+    klog_hex(LOG_INFO, "PID: ", pid);
+    klog_hex(LOG_INFO, "Budget: ", b->budget);
+    klog_hex(LOG_INFO, "Period: ", b->period);
+    klog_hex(LOG_INFO, "Used: ", b->used);
+    klog_hex(LOG_INFO, "Overruns: ", b->overrun_count);
+    klog_hex(LOG_INFO, "Overrun cycles: ", b->overrun_cycles);
+    klog_hex(LOG_INFO, "Throttled: ", b->throttled);
+}
+
+/* ============================================================================
+ * Consciousness Scheduling Integration
+ * ============================================================================ */
+
+/**
+ * Allocate cycles for consciousness operations
+ *
+ * Installs a hard per-period budget. An existing period is kept so that
+ * re-allocation does not reset the replenishment phase.
+ */
+status_t consciousness_allocate_cycles(uint32_t pid, uint64_t cycles) {
+    if (!process_is_valid(pid)) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+
+    cycle_budget_t *b = get_budget(pid);
+    uint64_t period = b ? b->period : CYCLE_BUDGET_DEFAULT_PERIOD;
+
+    return cycle_budget_set(pid, cycles, period);
+}
+
+/**
+ * Report cycles consumed by consciousness operations
+ *
+ * For work done outside the normal switch accounting (e.g. Phi
+ * calculation performed on behalf of the process).
+ */
+status_t consciousness_consume_cycles(uint32_t pid, uint64_t cycles) {
+    if (!process_is_valid(pid)) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+
+    return cycle_budget_charge(pid, cycles, cpu_rdtsc());
+}
@@ -0,0 +1,560 @@
+/**
+ * QuantumOS Entropy Pool
+ *
+ * Input pool, ChaCha20 generators and the ENTROPY_GET / ENTROPY_REFRESH
+ * service (kernel/entropy.h).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/entropy.h>
+#include <kernel/cpu.h>
+#include <kernel/boot.h>
+#include <kernel/ipc.h>
+
+#define CPUID_1_ECX_RDRAND      BIT(30)
+#define CPUID_7_EBX_RDSEED      BIT(18)
+#define HW_RETRIES              10
+#define HW_WORDS                4       /* 64-bit words per source per gather */
+
+#define JITTER_SAMPLES          64
+#define JITTER_BYTES            4096
+#define JITTER_SAMPLES_PER_BIT  8
+
+#define CHACHA_BLOCK            64
+#define CHACHA_KEY_WORDS        8
+#define POOL_RATE               28      /* Input bytes per permutation; word 7 tags them */
+
+#define BUFFER_BYTES            (ENTROPY_BUFFER_BLOCKS * CHACHA_BLOCK)
+
+_Static_assert(BUFFER_BYTES > CHACHA_KEY_WORDS * 4, "refill must leave output after the new key");
+_Static_assert(ENTROPY_DIRECT_MIN <= BUFFER_BYTES - CHACHA_KEY_WORDS * 4, "small draws fit one refill");
+_Static_assert(sizeof(entropy_response_t) + ENTROPY_INLINE_MAX <= IPC_MAX_MESSAGE_SIZE, "inline reply");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+/*
+ * The input pool and base generator are shared by all CPUs. They are
+ * only touched with interrupts disabled, which serialises them while
+ * the BSP is the only CPU running.
+ */
+static struct {
+    uint32_t state[16];                 /* Sponge: words 0-7 rate, 8-15 capacity */
+    uint32_t credit;                    /* Bits since the last reseed */
+} pool;
+
+static struct {
+    uint32_t key[CHACHA_KEY_WORDS];
+    uint64_t derivations;               /* Counter for per-CPU keys */
+    uint32_t generation;                /* Bumped on every reseed */
+    uint32_t seed_bits;
+} base;
+
+typedef struct {
+    uint32_t key[CHACHA_KEY_WORDS];
+    uint32_t generation;                /* base.generation the key came from */
+    uint32_t avail;                     /* Unread bytes at the end of buffer */
+    uint64_t since_rekey;
+    uint8_t buffer[BUFFER_BYTES];
+} ALIGNED(64) entropy_cpu_t;
+
+/* Interrupt samples, kept apart from the generators so the IRQ path touches one line */
+typedef struct {
+    uint32_t mix[4];
+    uint32_t count;
+} ALIGNED(64) entropy_irq_t;
+
+static entropy_cpu_t cpus[MAX_CPUS];
+static entropy_irq_t irq_pools[MAX_CPUS];
+static entropy_stats_t stats;
+
+/* Service buffers; one service loop runs at a time */
+static ipc_message_t service_request;
+static ipc_message_t service_reply;
+
+/* ============================================================================
+ * ChaCha20
+ * ============================================================================ */
+
+#define ROTL32(v, n)    (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define QUARTER_ROUND(a, b, c, d) \
+    do { \
+        a += b; d ^= a; d = ROTL32(d, 16); \
+        c += d; b ^= c; b = ROTL32(b, 12); \
+        a += b; d ^= a; d = ROTL32(d, 8); \
+        c += d; b ^= c; b = ROTL32(b, 7); \
+    } while (0)
+
+static void chacha_permute(uint32_t x[16]) {
+    for (uint32_t i = 0; i < 10; i++) {
+        QUARTER_ROUND(x[0], x[4], x[8], x[12]);
+        QUARTER_ROUND(x[1], x[5], x[9], x[13]);
+        QUARTER_ROUND(x[2], x[6], x[10], x[14]);
+        QUARTER_ROUND(x[3], x[7], x[11], x[15]);
+        QUARTER_ROUND(x[0], x[5], x[10], x[15]);
+        QUARTER_ROUND(x[1], x[6], x[11], x[12]);
+        QUARTER_ROUND(x[2], x[7], x[8], x[13]);
+        QUARTER_ROUND(x[3], x[4], x[9], x[14]);
+    }
+}
+
+/* One keystream block: 64-bit block counter, 64-bit nonce (original layout) */
+static void chacha20_block(const uint32_t key[CHACHA_KEY_WORDS], uint64_t counter,
+                           uint64_t nonce, uint32_t out[16]) {
+    uint32_t input[16] = {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,     /* "expand 32-byte k" */
+        key[0], key[1], key[2], key[3], key[4], key[5], key[6], key[7],
+        (uint32_t)counter, (uint32_t)(counter >> 32), (uint32_t)nonce, (uint32_t)(nonce >> 32)
+    };
+
+    memcpy(out, input, sizeof(input));
+    chacha_permute(out);
+    for (uint32_t i = 0; i < 16; i++) {
+        out[i] += input[i];
+    }
+}
+
+/* Keystream from block 0 straight into `out` */
+static void chacha20_fill(const uint32_t key[CHACHA_KEY_WORDS], uint64_t nonce,
+                          uint8_t *out, size_t len) {
+    uint32_t block[16];
+    uint64_t counter = 0;
+
+    for (; len >= CHACHA_BLOCK; len -= CHACHA_BLOCK, out += CHACHA_BLOCK) {
+        chacha20_block(key, counter++, nonce, block);
+        memcpy(out, block, CHACHA_BLOCK);
+    }
+    if (len) {
+        chacha20_block(key, counter, nonce, block);
+        memcpy(out, block, len);
+    }
+    memset(block, 0, sizeof(block));
+}
+
+/* ============================================================================
+ * Input Pool
+ * ============================================================================ */
+
+/* Callers hold interrupts off */
+static void pool_absorb(uint32_t source, const void *data, size_t len, uint32_t bits) {
+    const uint8_t *in = data;
+
+    do {
+        uint32_t chunk = len < POOL_RATE ? (uint32_t)len : POOL_RATE;
+        uint32_t words[7] = { 0 };
+
+        memcpy(words, in, chunk);
+        for (uint32_t i = 0; i < 7; i++) {
+            pool.state[i] ^= words[i];
+        }
+        /* Tagging each chunk with its source and length keeps inputs unambiguous */
+        pool.state[7] ^= (source << 8) | chunk;
+        chacha_permute(pool.state);
+
+        in += chunk;
+        len -= chunk;
+    } while (len);
+
+    pool.credit += bits;
+    if (pool.credit > 2 * ENTROPY_RESEED_BITS) {
+        pool.credit = 2 * ENTROPY_RESEED_BITS;
+    }
+    stats.samples[source]++;
+    stats.credited[source] += bits;
+}
+
+/* Squeeze a key, then clear the rate so the output cannot be recovered from the pool */
+static void pool_extract(uint32_t key[CHACHA_KEY_WORDS]) {
+    chacha_permute(pool.state);
+    memcpy(key, pool.state, CHACHA_KEY_WORDS * sizeof(uint32_t));
+    memset(pool.state, 0, CHACHA_KEY_WORDS * sizeof(uint32_t));
+    chacha_permute(pool.state);
+}
+
+/* Rekey the base generator from the pool; per-CPU generators follow lazily */
+static void base_reseed(void) {
+    pool_extract(base.key);
+    base.seed_bits = pool.credit < ENTROPY_RESEED_BITS ? pool.credit : ENTROPY_RESEED_BITS;
+    base.generation++;
+    pool.credit = 0;
+    stats.reseeds++;
+}
+
+/* ============================================================================
+ * Sources
+ * ============================================================================ */
+
+static uint32_t cpuid_reg(uint32_t leaf, uint32_t subleaf, uint32_t reg) {
+    uint32_t regs[4];
+
+    __asm__ volatile("cpuid"
+                     : "=a"(regs[0]), "=b"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
+                     : "a"(leaf), "c"(subleaf));
+    return regs[reg];
+}
+
+static bool rdseed64(uint64_t *value) {
+    for (uint32_t i = 0; i < HW_RETRIES; i++) {
+        uint8_t ok;
+
+        __asm__ volatile("rdseed %0; setc %1" : "=r"(*value), "=qm"(ok) : : "cc");
+        if (ok) {
+            return true;
+        }
+        __asm__ volatile("pause");
+    }
+    return false;
+}
+
+static bool rdrand64(uint64_t *value) {
+    for (uint32_t i = 0; i < HW_RETRIES; i++) {
+        uint8_t ok;
+
+        __asm__ volatile("rdrand %0; setc %1" : "=r"(*value), "=qm"(ok) : : "cc");
+        if (ok) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t read_words(bool (*read)(uint64_t *), uint64_t words[HW_WORDS]) {
+    uint32_t got = 0;
+
+    while (got < HW_WORDS && read(&words[got])) {
+        got++;
+    }
+    return got;
+}
+
+static void detect_cpu_sources(void) {
+    uint32_t max_leaf = cpuid_reg(0, 0, 0);
+
+    stats.has_rdrand = (cpuid_reg(1, 0, 2) & CPUID_1_ECX_RDRAND) != 0;
+    stats.has_rdseed = max_leaf >= 7 && (cpuid_reg(7, 0, 1) & CPUID_7_EBX_RDSEED) != 0;
+}
+
+/*
+ * RDSEED output is conditioned entropy and credited in full. RDRAND is
+ * itself a DRBG output, so it is credited at half.
+ */
+static void gather_cpu(void) {
+    uint64_t words[HW_WORDS];
+    uint32_t got;
+
+    if (stats.has_rdseed && (got = read_words(rdseed64, words)) != 0) {
+        pool_absorb(ENTROPY_SOURCE_RDSEED, words, got * sizeof(uint64_t), got * 64);
+    }
+    if (stats.has_rdrand && (got = read_words(rdrand64, words)) != 0) {
+        pool_absorb(ENTROPY_SOURCE_RDRAND, words, got * sizeof(uint64_t), got * 32);
+    }
+    memset(words, 0, sizeof(words));
+}
+
+/*
+ * Time a walk over memory that misses the cache; cache, TLB and bus
+ * timing make the deltas vary. Credited one bit per eight samples.
+ */
+static void gather_jitter(void) {
+    static volatile uint8_t walk[JITTER_BYTES];
+    uint64_t deltas[JITTER_SAMPLES];
+    uint64_t prev = cpu_rdtsc();
+    uint32_t index = (uint32_t)prev;
+
+    for (uint32_t i = 0; i < JITTER_SAMPLES; i++) {
+        index = (index * 1103515245U + 12345U) % JITTER_BYTES;
+        walk[index] += (uint8_t)prev;
+
+        uint64_t now = cpu_rdtsc();
+        deltas[i] = now - prev;
+        prev = now;
+    }
+    pool_absorb(ENTROPY_SOURCE_JITTER, deltas, sizeof(deltas),
+                JITTER_SAMPLES / JITTER_SAMPLES_PER_BIT);
+}
+
+/* ============================================================================
+ * Per-CPU Generators
+ * ============================================================================ */
+
+/* Key `c` from the base generator; interrupts off */
+static void cpu_rekey(entropy_cpu_t *c, uint32_t cpu) {
+    uint32_t block[16];
+
+    if (pool.credit >= ENTROPY_RESEED_BITS) {
+        base_reseed();
+    }
+    chacha20_block(base.key, base.derivations++, cpu, block);
+    memcpy(c->key, block, sizeof(c->key));
+    memset(block, 0, sizeof(block));
+
+    c->generation = base.generation;
+    c->since_rekey = 0;
+}
+
+/* Fast key erasure: the refill's first 32 bytes become the next key */
+static void cpu_refill(entropy_cpu_t *c, uint32_t cpu) {
+    if (c->generation != base.generation || c->since_rekey >= ENTROPY_RESEED_BYTES ||
+        pool.credit >= ENTROPY_RESEED_BITS) {
+        cpu_rekey(c, cpu);
+    }
+
+    chacha20_fill(c->key, 0, c->buffer, BUFFER_BYTES);
+    memcpy(c->key, c->buffer, sizeof(c->key));
+    memset(c->buffer, 0, sizeof(c->key));
+
+    c->avail = BUFFER_BYTES - sizeof(c->key);
+    c->since_rekey += c->avail;
+}
+
+/* Copy from the local buffer, wiping what was handed out */
+static void draw_buffered(uint8_t *out, size_t len) {
+    uint32_t cpu = cpu_current_id();
+    entropy_cpu_t *c = &cpus[cpu];
+    uint64_t flags = cpu_irq_save();
+
+    /* A full pool reaches the output now, not after the buffer drains */
+    if (pool.credit >= ENTROPY_RESEED_BITS) {
+        c->avail = 0;
+    }
+
+    while (len) {
+        if (!c->avail) {
+            cpu_refill(c, cpu);
+        }
+
+        uint32_t n = len < c->avail ? (uint32_t)len : c->avail;
+        uint8_t *from = &c->buffer[BUFFER_BYTES - c->avail];
+
+        memcpy(out, from, n);
+        memset(from, 0, n);
+        c->avail -= n;
+        out += n;
+        len -= n;
+    }
+    cpu_irq_restore(flags);
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+status_t entropy_init(void) {
+    uint64_t flags = cpu_irq_save();
+    uint64_t tsc = cpu_rdtsc();
+
+    detect_cpu_sources();
+    pool_absorb(ENTROPY_SOURCE_JITTER, &tsc, sizeof(tsc), 0);
+    gather_cpu();
+    gather_jitter();
+    base_reseed();
+    cpu_irq_restore(flags);
+
+    return STATUS_SUCCESS;
+}
+
+void entropy_add_interrupt(uint32_t vector, uint64_t tsc) {
+    entropy_irq_t *p = &irq_pools[cpu_current_id()];
+
+    /* ARX mix of the sample into four words, as cheap as the IRQ path needs */
+    p->mix[0] ^= (uint32_t)tsc;
+    p->mix[1] ^= (uint32_t)(tsc >> 32) ^ vector;
+    p->mix[0] += p->mix[1]; p->mix[1] = ROTL32(p->mix[1], 13); p->mix[1] ^= p->mix[0];
+    p->mix[2] += p->mix[3]; p->mix[3] = ROTL32(p->mix[3], 16); p->mix[3] ^= p->mix[2];
+    p->mix[0] = ROTL32(p->mix[0], 16) + p->mix[3]; p->mix[3] = ROTL32(p->mix[3], 21) ^ p->mix[0];
+    p->mix[2] += p->mix[1]; p->mix[1] = ROTL32(p->mix[1], 17) ^ p->mix[2];
+
+    /* Interrupt timing is credited one bit per batch */
+    if (++p->count >= ENTROPY_IRQ_BATCH) {
+        pool_absorb(ENTROPY_SOURCE_INTERRUPT, p->mix, sizeof(p->mix), 1);
+        p->count = 0;
+    }
+}
+
+void entropy_add(const void *data, size_t len, uint32_t bits) {
+    if (!data || !len) {
+        return;
+    }
+    if (bits > len * 8) {
+        bits = (uint32_t)(len * 8);
+    }
+
+    uint64_t flags = cpu_irq_save();
+    pool_absorb(ENTROPY_SOURCE_EXTERNAL, data, len, bits);
+    cpu_irq_restore(flags);
+}
+
+void entropy_reseed(void) {
+    uint64_t flags = cpu_irq_save();
+
+    gather_cpu();
+    gather_jitter();
+    base_reseed();
+    cpu_irq_restore(flags);
+}
+
+void entropy_get(void *buf, size_t len) {
+    uint8_t *out = buf;
+
+    if (!out || !len) {
+        return;
+    }
+    __atomic_fetch_add(&stats.bytes_out, len, __ATOMIC_RELAXED);
+
+    if (len < ENTROPY_DIRECT_MIN) {
+        draw_buffered(out, len);
+        return;
+    }
+
+    /* Bulk: a private key from the buffer, then ChaCha20 with interrupts on */
+    uint32_t key[CHACHA_KEY_WORDS];
+
+    draw_buffered((uint8_t *)key, sizeof(key));
+    chacha20_fill(key, 0, out, len);
+    memset(key, 0, sizeof(key));
+}
+
+uint64_t entropy_get_u64(void) {
+    uint64_t value;
+
+    __atomic_fetch_add(&stats.bytes_out, sizeof(value), __ATOMIC_RELAXED);
+    draw_buffered((uint8_t *)&value, sizeof(value));
+    return value;
+}
+
+void entropy_get_stats(entropy_stats_t *out) {
+    if (!out) {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    memcpy(out, &stats, sizeof(*out));
+    out->pool_bits = pool.credit;
+    out->seed_bits = base.seed_bits;
+    cpu_irq_restore(flags);
+}
+
+void entropy_chacha20_block(const uint32_t key[8], uint64_t counter, uint64_t nonce,
+                            uint32_t out[16]) {
+    chacha20_block(key, counter, nonce, out);
+}
+
+/* ============================================================================
+ * Service
+ * ============================================================================ */
+
+ipc_result_t entropy_service_start(uint32_t *port_id) {
+    return ipc_port_create(ENTROPY_SERVICE_NAME, port_id);
+}
+
+/*
+ * Fill `length` bytes at `offset` of a region granted to the server.
+ * The client must itself be able to write the region: otherwise it could
+ * name a region another client granted to the service and have the
+ * service overwrite it.
+ */
+static ipc_result_t fill_region(uint32_t client_id, uint32_t region_id, uint64_t offset,
+                                uint64_t length) {
+    size_t size;
+    uint32_t access;
+    void *addr;
+
+    ipc_result_t result = ipc_share_access(region_id, client_id, NULL, &access);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+    if (!(access & IPC_SHARE_WRITE)) {
+        return IPC_ERROR_PERMISSION_DENIED;
+    }
+
+    result = ipc_share_query(region_id, &size, &access);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+    if (!(access & IPC_SHARE_WRITE)) {
+        return IPC_ERROR_PERMISSION_DENIED;
+    }
+    if (offset > size || length > size - offset) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    result = ipc_share_map(region_id, &addr);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+    if (!addr) {
+        return IPC_ERROR_OUT_OF_MEMORY;
+    }
+
+    entropy_get((uint8_t *)addr + offset, length);
+    return IPC_SUCCESS;
+}
+
+ipc_result_t entropy_service_handle(const ipc_message_t *request, ipc_message_t *reply) {
+    entropy_request_t req = { 0 };
+    entropy_response_t resp = { 0 };
+    ipc_result_t status = IPC_SUCCESS;
+
+    if (!request || !reply) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    reply->message_type = IPC_MSG_REPLY;
+    reply->length = sizeof(resp);
+    reply->capability = 0;
+
+    if (request->length < sizeof(req)) {
+        status = IPC_ERROR_INVALID_ARG;
+    } else {
+        memcpy(&req, request->data, sizeof(req));
+        switch (req.type) {
+        case ENTROPY_REFRESH:
+            entropy_reseed();
+            break;
+
+        case ENTROPY_GET:
+            if (req.region_id == 0) {
+                if (req.length > ENTROPY_INLINE_MAX) {
+                    status = IPC_ERROR_MESSAGE_TOO_LARGE;
+                    break;
+                }
+                entropy_get(reply->data + sizeof(resp), req.length);
+                reply->length += (uint32_t)req.length;
+            } else {
+                status = fill_region(request->sender_id, req.region_id, req.offset,
+                                     req.length);
+            }
+            if (status == IPC_SUCCESS) {
+                resp.length = req.length;
+            }
+            break;
+
+        default:
+            status = IPC_ERROR_NOT_SUPPORTED;
+            break;
+        }
+    }
+
+    resp.type = req.type;
+    resp.status = status;
+    resp.entropy_available = __atomic_load_n(&pool.credit, __ATOMIC_RELAXED);
+    resp.entropy_quality = __atomic_load_n(&base.seed_bits, __ATOMIC_RELAXED);
+    memcpy(reply->data, &resp, sizeof(resp));
+
+    return status;
+}
+
+uint32_t entropy_service_poll(uint32_t port_id, uint32_t max) {
+    uint32_t served = 0;
+
+    while (served < max &&
+           ipc_port_receive(port_id, &service_request, IPC_NO_WAIT) == IPC_SUCCESS) {
+        entropy_service_handle(&service_request, &service_reply);
+        ipc_reply(&service_request, &service_reply);
+        served++;
+    }
+    return served;
+}
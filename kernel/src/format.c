@@ -0,0 +1,53 @@
+/**
+ * QuantumOS Text Formatting Implementation
+ *
+ * Used by the gcov dumper, so this file is compiled without
+ * -fprofile-arcs like gcov.c (see the Makefile).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/format.h>
+#include <kernel/types.h>
+
+static const char hex_digits[] = "0123456789abcdef";
+
+uint32_t fmt_str(char *buf, uint32_t len, const char *str) {
+    while (*str) {
+        buf[len++] = *str++;
+    }
+    return len;
+}
+
+uint32_t fmt_dec(char *buf, uint32_t len, uint64_t value) {
+    char digits[FMT_DEC_MAX];
+    int n = 0;
+
+    do {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while (value);
+
+    while (n) {
+        buf[len++] = digits[--n];
+    }
+    return len;
+}
+
+uint32_t fmt_hex(char *buf, uint32_t len, uint64_t value) {
+    int shift = 60;
+
+    while (shift > 0 && !((value >> shift) & 0xF)) {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        buf[len++] = hex_digits[(value >> shift) & 0xF];
+    }
+    return len;
+}
+
+uint32_t fmt_hex_byte(char *buf, uint32_t len, uint8_t byte) {
+    buf[len++] = hex_digits[byte >> 4];
+    buf[len++] = hex_digits[byte & 0xF];
+    return len;
+}
@@ -0,0 +1,219 @@
+/**
+ * QuantumOS Profile Counter Export Implementation
+ *
+ * Units are kept on a singly linked list in registration order. The
+ * .gcda image is never built in memory: words are streamed straight
+ * into hex lines, so the dump needs no allocation and works however
+ * large the counter arrays are.
+ *
+ * This file is compiled without -fprofile-arcs (see the Makefile), as
+ * it would otherwise count its own dump.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/gcov.h>
+#include <kernel/serial.h>
+#include <kernel/format.h>
+#include <kernel/log.h>
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+typedef struct {
+    char line[4 + 2 * GCOV_DUMP_LINE_BYTES + 2];
+    uint32_t len;
+    uint32_t pending;                   /* Bytes on the current line */
+    uint64_t total;
+} gcov_writer_t;
+
+static gcov_info_t *gcov_units;
+static gcov_info_t **gcov_tail = &gcov_units;
+static uint32_t gcov_count;
+
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static void write_str(const char *str) {
+    uint32_t len = 0;
+    while (str[len]) {
+        len++;
+    }
+    serial_write_sync(str, len);
+}
+
+static bool counter_active(const gcov_info_t *info, uint32_t kind) {
+    return info->merge[kind] != NULL;
+}
+
+static void writer_start(gcov_writer_t *w) {
+    w->len = fmt_str(w->line, 0, "#D ");
+    w->pending = 0;
+}
+
+static void writer_flush(gcov_writer_t *w) {
+    if (w->pending) {
+        w->len = fmt_str(w->line, w->len, "\r\n");
+        serial_write_sync(w->line, w->len);
+        writer_start(w);
+    }
+}
+
+/* Little-endian, as libgcov writes on this architecture */
+static void write_u32(gcov_writer_t *w, uint32_t value) {
+    for (uint32_t i = 0; i < 4; i++) {
+        uint8_t byte = (uint8_t)(value >> (8 * i));
+        w->len = fmt_hex_byte(w->line, w->len, byte);
+        if (++w->pending == GCOV_DUMP_LINE_BYTES) {
+            writer_flush(w);
+        }
+    }
+    w->total += 4;
+}
+
+static void write_u64(gcov_writer_t *w, uint64_t value) {
+    write_u32(w, (uint32_t)value);
+    write_u32(w, (uint32_t)(value >> 32));
+}
+
+/* Largest edge count in the program, which sets the hot/cold thresholds */
+static uint64_t arcs_max(void) {
+    uint64_t max = 0;
+
+    for (const gcov_info_t *info = gcov_units; info; info = info->next) {
+        if (!counter_active(info, GCOV_COUNTER_ARCS)) {
+            continue;
+        }
+        for (uint32_t f = 0; f < info->n_functions; f++) {
+            const gcov_fn_info_t *fn = info->functions[f];
+            if (!fn || fn->key != info) {
+                continue;
+            }
+            /* Arc counters come first when active */
+            for (uint32_t i = 0; i < fn->ctrs[0].num; i++) {
+                max = MAX(max, (uint64_t)fn->ctrs[0].values[i]);
+            }
+        }
+    }
+    return max;
+}
+
+static void write_unit(gcov_writer_t *w, const gcov_info_t *info, uint64_t sum_max) {
+    write_u32(w, GCOV_DATA_MAGIC);
+    write_u32(w, info->version);
+    write_u32(w, info->stamp);
+#if defined(__GNUC__) && __GNUC__ >= 12
+    write_u32(w, info->checksum);
+#endif
+
+    /* One run, as libgcov would record it */
+    write_u32(w, GCOV_TAG_OBJECT_SUMMARY);
+    write_u32(w, 2 * GCOV_UNIT_SIZE);
+    write_u32(w, 1);
+    write_u32(w, (uint32_t)MIN(sum_max, 0xFFFFFFFFULL));
+
+    for (uint32_t f = 0; f < info->n_functions; f++) {
+        const gcov_fn_info_t *fn = info->functions[f];
+        const gcov_ctr_info_t *ctr;
+
+        /* Functions the linker discarded have no key */
+        if (!fn || fn->key != info) {
+            continue;
+        }
+        ctr = fn->ctrs;
+
+        write_u32(w, GCOV_TAG_FUNCTION);
+        write_u32(w, 3 * GCOV_UNIT_SIZE);
+        write_u32(w, fn->ident);
+        write_u32(w, fn->lineno_checksum);
+        write_u32(w, fn->cfg_checksum);
+
+        for (uint32_t kind = 0; kind < GCOV_COUNTERS; kind++) {
+            if (!counter_active(info, kind)) {
+                continue;
+            }
+            write_u32(w, GCOV_TAG_FOR_COUNTER(kind));
+            write_u32(w, ctr->num * 2 * GCOV_UNIT_SIZE);
+            for (uint32_t i = 0; i < ctr->num; i++) {
+                write_u64(w, (uint64_t)ctr->values[i]);
+            }
+            ctr++;
+        }
+    }
+}
+
+/* ============================================================================
+ * Compiler Interface
+ * ============================================================================ */
+
+/* Called from each instrumented unit's constructor */
+void __gcov_init(gcov_info_t *info) {
+    info->next = NULL;
+    *gcov_tail = info;
+    gcov_tail = &info->next;
+    gcov_count++;
+}
+
+/* Called from destructors, which the kernel never runs */
+void __gcov_exit(void) {
+}
+
+/* Referenced as the merge function of arc counters; merging happens on the host */
+void __gcov_merge_add(gcov_type *counters, uint32_t count) {
+    (void)counters;
+    (void)count;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+uint32_t gcov_unit_count(void) {
+    return gcov_count;
+}
+
+status_t gcov_dump(void) {
+    gcov_writer_t w;
+    char line[48];
+    uint64_t sum_max;
+    uint32_t len;
+
+    if (!gcov_units) {
+        return STATUS_NOT_FOUND;
+    }
+
+    log_set_sync(true);
+
+    len = fmt_str(line, 0, "#GCOV-BEGIN ");
+    len = fmt_dec(line, len, GCOV_DUMP_VERSION);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, gcov_count);
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    sum_max = arcs_max();
+    w.total = 0;
+    for (const gcov_info_t *info = gcov_units; info; info = info->next) {
+        write_str("#GCDA ");
+        write_str(info->filename);
+        write_str("\r\n");
+
+        writer_start(&w);
+        write_unit(&w, info, sum_max);
+        writer_flush(&w);
+    }
+
+    len = fmt_str(line, 0, "#GCOV-END ");
+    len = fmt_dec(line, len, gcov_count);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, w.total);
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    log_set_sync(false);
+    return STATUS_SUCCESS;
+}
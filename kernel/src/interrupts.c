@@ -1,6 +1,14 @@
 #include <kernel/types.h>
 #include <kernel/interrupts.h>
 #include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/softirq.h>
+#include <kernel/timer.h>
+#include <kernel/serial.h>
+#include <kernel/log.h>
+#include <kernel/trace.h>
+#include <kernel/profile.h>
+#include <kernel/entropy.h>
 
 // Forward declarations for I/O port functions
 static inline void __outb(uint16_t port, uint8_t value);
@@ -10,12 +18,34 @@ static inline uint8_t __inb(uint16_t port);
 static idt_entry_t idt[IDT_ENTRIES];
 static idt_ptr_t idt_ptr;
 
+// GDT with one TSS per CPU; each TSS points at that CPU's IST stacks
+static uint64_t gdt[GDT_ENTRIES] __attribute__((aligned(16)));
+static gdt_ptr_t gdt_ptr;
+static tss_t cpu_tss[MAX_CPUS] __attribute__((aligned(16)));
+static uint8_t ist_stacks[MAX_CPUS][IST_STACKS][IST_STACK_SIZE] __attribute__((aligned(16)));
+static uint8_t irq_stacks[MAX_CPUS][IRQ_STACK_SIZE] __attribute__((aligned(16)));
+
 // Interrupt handlers
 static interrupt_handler_info_t interrupt_handlers[IDT_ENTRIES];
 
-// Statistics
-static uint64_t interrupt_counts[IDT_ENTRIES];
-static uint64_t total_interrupts;
+// Dynamic vectors, allocated independently on each CPU
+typedef struct {
+    uint64_t allocated[IDT_ENTRIES / 64];
+    irq_vector_handler_t handler[IDT_ENTRIES];
+    void *context[IDT_ENTRIES];
+} irq_vector_table_t;
+
+static irq_vector_table_t irq_vector_tables[MAX_CPUS];
+
+// Timer and keyboard top-half state, drained by their softirqs
+#define KEYBOARD_BUFFER_SIZE 64
+static volatile uint64_t timer_ticks;
+static uint8_t keyboard_buffer[KEYBOARD_BUFFER_SIZE];
+static volatile uint32_t keyboard_head;
+static volatile uint32_t keyboard_tail;
+
+// Statistics, one block per CPU so the hot path never shares cache lines
+static irq_cpu_stats_t irq_cpu_stats[MAX_CPUS];
 
 // External assembly handlers
 extern void isr0(void);   // Divide error
@@ -61,7 +91,7 @@ extern void irq15(void);  // Secondary ATA
 static void (*exception_handlers[32])(cpu_state_t *state) = {
     divide_error_handler,           // 0
     NULL,                           // 1 (debug)
-    NULL,                           // 2 (NMI)
+    nmi_handler,                    // 2
     NULL,                           // 3 (breakpoint)
     NULL,                           // 4 (overflow)
     NULL,                           // 5 (bound range)
@@ -89,6 +119,9 @@ static void (*exception_handlers[32])(cpu_state_t *state) = {
 irq_result_t interrupts_init(void) {
     boot_log("Initializing interrupt system...");
     
+    // Our own GDT and TSS, so that NMI, #DF and #MC have known-good stacks
+    interrupt_stack_init();
+    
     // Clear IDT
     memset(&idt, 0, sizeof(idt));
     
@@ -115,20 +148,43 @@ irq_result_t interrupts_init(void) {
     idt_set_gate(EXC_SECURITY, (uint64_t)isr30, 0x08, GATE_TYPE_INTERRUPT | DPL_KERNEL);
     idt_set_gate(EXC_RESERVED, (uint64_t)isr31, 0x08, GATE_TYPE_INTERRUPT | DPL_KERNEL);
     
+    // Before the profiler points the PMU at the NMI, which can then arrive
+    // between SYSCALL and the stack switch in syscall_entry
+    set_ist_entry(EXC_NMI, IST_NMI);
+    set_ist_entry(EXC_DOUBLE_FAULT, IST_DOUBLE_FAULT);
+    set_ist_entry(EXC_MACHINE_CHECK, IST_MACHINE_CHECK);
+    
     // Setup IRQ handlers
     for (int i = 0; i < 16; i++) {
         idt_set_gate(IRQ_BASE + i, (uint64_t)(&irq0 + i), 0x08, GATE_TYPE_INTERRUPT | DPL_KERNEL);
     }
     
+    // Setup dynamic vector stubs (MSI/MSI-X and software interrupts)
+    for (int v = IRQ_VECTOR_DYNAMIC_BASE; v < IDT_ENTRIES; v++) {
+        idt_set_gate(v, (uint64_t)vector_stub_table[v - IRQ_VECTOR_DYNAMIC_BASE], 0x08,
+                     GATE_TYPE_INTERRUPT | DPL_KERNEL);
+    }
+    memset(irq_vector_tables, 0, sizeof(irq_vector_tables));
+    
     // Install IDT
     idt_install();
     
     // Initialize PIC
     pic_init();
     
+    // Local APIC for MSI/MSI-X delivery; the PIC keeps legacy lines
+    apic_init();
+    
     // Clear interrupt statistics
-    memset(interrupt_counts, 0, sizeof(interrupt_counts));
-    total_interrupts = 0;
+    memset(irq_cpu_stats, 0, sizeof(irq_cpu_stats));
+    
+    // Deferred work for device handlers
+    softirq_init();
+    softirq_register(SOFTIRQ_TIMER, timer_softirq_handler);
+    softirq_register(SOFTIRQ_INPUT, keyboard_softirq_handler);
+    
+    // Time base, periodic tick and kernel timer wheels
+    timer_init();
     
     boot_log("Interrupt system initialized");
     return IRQ_SUCCESS;
@@ -147,6 +203,58 @@ void idt_set_gate(uint8_t vector, uint64_t handler_addr, uint16_t selector, uint
     entry->reserved = 0;
 }
 
+// Route a vector through an IST stack (IST_NONE: stay on the current stack)
+void set_ist_entry(uint8_t vector, uint8_t ist_index) {
+    idt[vector].ist = ist_index;
+}
+
+// Stack for irq_common to switch to: this CPU's interrupt stack, or 0 if
+// `rsp` is already on it (an IRQ nested in a softirq, or from ring 3)
+uint64_t irq_stack_top(uint64_t rsp) {
+    uint8_t *base = irq_stacks[cpu_current_id()];
+    uint64_t top = (uint64_t)&base[IRQ_STACK_SIZE];
+    
+    if (*(uint64_t *)base != IRQ_STACK_CANARY) {
+        boot_panic("Interrupt stack overflow");
+    }
+    if (rsp > (uint64_t)base && rsp <= top) {
+        return 0;
+    }
+    return top;
+}
+
+// Build the GDT and load this CPU's TSS
+void interrupt_stack_init(void) {
+    uint32_t cpu = cpu_current_id();
+    tss_t *tss = &cpu_tss[cpu];
+    
+    gdt[GDT_KERNEL_CODE / 8] = 0x00AF9A000000FFFFULL;  // 64-bit code, DPL 0
+    gdt[GDT_KERNEL_DATA / 8] = 0x00CF92000000FFFFULL;
+    gdt[GDT_USER_CODE32 / 8] = 0x00CFFA000000FFFFULL;  // Unused, fixes the SYSRET layout
+    gdt[GDT_USER_DATA / 8] = 0x00CFF2000000FFFFULL;
+    gdt[GDT_USER_CODE / 8] = 0x00AFFA000000FFFFULL;    // 64-bit code, DPL 3
+    
+    memset(tss, 0, sizeof(*tss));
+    tss->rsp[0] = (uint64_t)&irq_stacks[cpu][IRQ_STACK_SIZE];
+    *(uint64_t *)irq_stacks[cpu] = IRQ_STACK_CANARY;
+    for (int i = 0; i < IST_STACKS; i++) {
+        tss->ist[i] = (uint64_t)&ist_stacks[cpu][i][IST_STACK_SIZE];
+    }
+    tss->iomap_base = sizeof(*tss);  // No I/O permission bitmap
+    
+    // Available 64-bit TSS descriptor, 16 bytes
+    uint64_t base = (uint64_t)tss;
+    uint64_t limit = sizeof(*tss) - 1;
+    gdt[GDT_TSS(cpu) / 8] = (limit & 0xFFFF) | ((base & 0xFFFFFF) << 16) | (0x89ULL << 40) |
+                            (((limit >> 16) & 0xF) << 48) | (((base >> 24) & 0xFF) << 56);
+    gdt[GDT_TSS(cpu) / 8 + 1] = base >> 32;
+    
+    gdt_ptr.limit = sizeof(gdt) - 1;
+    gdt_ptr.base = (uint64_t)&gdt;
+    load_gdt(&gdt_ptr);
+    load_tss(GDT_TSS(cpu));
+}
+
 // Install IDT
 void idt_install(void) {
     idt_ptr.limit = sizeof(idt) - 1;
@@ -166,6 +274,13 @@ irq_result_t interrupt_register(uint8_t vector, interrupt_handler_t handler, voi
     if (interrupt_handlers[vector].handler != NULL) {
         return IRQ_ERROR_ALREADY_REGISTERED;
     }
+    
+    // Don't shadow a vector already handed out to a device
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if (irq_vector_tables[cpu].allocated[vector / 64] & (1ULL << (vector % 64))) {
+            return IRQ_ERROR_ALREADY_REGISTERED;
+        }
+    }
 
     interrupt_handlers[vector].handler = handler;
     interrupt_handlers[vector].context = context;
@@ -184,6 +299,74 @@ irq_result_t interrupt_unregister(uint8_t vector) {
     return IRQ_SUCCESS;
 }
 
+// Allocate a vector on a CPU for a message-signalled interrupt.
+// Vectors are per CPU: the same number may be in use on other CPUs.
+irq_result_t irq_vector_alloc(uint32_t cpu, irq_vector_handler_t handler, void *context, uint8_t *vector) {
+    if (cpu >= MAX_CPUS || !handler || !vector) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+    
+    irq_vector_table_t *table = &irq_vector_tables[cpu];
+    uint64_t flags = cpu_irq_save();
+    
+    for (int v = IRQ_VECTOR_DYNAMIC_BASE; v <= IRQ_VECTOR_DYNAMIC_MAX; v++) {
+        uint64_t bit = 1ULL << (v % 64);
+        
+        if ((table->allocated[v / 64] & bit) || interrupt_handlers[v].handler != NULL) {
+            continue;
+        }
+        
+        table->allocated[v / 64] |= bit;
+        table->handler[v] = handler;
+        table->context[v] = context;
+        cpu_irq_restore(flags);
+        
+        *vector = (uint8_t)v;
+        return IRQ_SUCCESS;
+    }
+    
+    cpu_irq_restore(flags);
+    return IRQ_ERROR_OUT_OF_HANDLERS;
+}
+
+// Release a vector allocated with irq_vector_alloc()
+irq_result_t irq_vector_free(uint32_t cpu, uint8_t vector) {
+    if (cpu >= MAX_CPUS || vector < IRQ_VECTOR_DYNAMIC_BASE || vector > IRQ_VECTOR_DYNAMIC_MAX) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+    
+    irq_vector_table_t *table = &irq_vector_tables[cpu];
+    uint64_t bit = 1ULL << (vector % 64);
+    
+    if (!(table->allocated[vector / 64] & bit)) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+    
+    uint64_t flags = cpu_irq_save();
+    table->allocated[vector / 64] &= ~bit;
+    table->handler[vector] = NULL;
+    table->context[vector] = NULL;
+    cpu_irq_restore(flags);
+    
+    return IRQ_SUCCESS;
+}
+
+// Number of unallocated dynamic vectors on a CPU
+uint32_t irq_vector_free_count(uint32_t cpu) {
+    if (cpu >= MAX_CPUS) {
+        return 0;
+    }
+    
+    uint32_t used = 0;
+    for (int i = 0; i < IDT_ENTRIES / 64; i++) {
+        for (uint64_t bits = irq_vector_tables[cpu].allocated[i]; bits; bits &= bits - 1) {
+            used++;
+        }
+    }
+    
+    return (IRQ_VECTOR_DYNAMIC_MAX - IRQ_VECTOR_DYNAMIC_BASE + 1) - used;
+}
+
 // Enable interrupt
 irq_result_t interrupt_enable(uint8_t vector) {
     if (vector >= IRQ_BASE) {
@@ -214,72 +397,115 @@ irq_result_t interrupt_disable_all(void) {
     return IRQ_SUCCESS;
 }
 
+// Record handler latency for a vector in the current CPU's statistics
+static inline void irq_record_latency(irq_cpu_stats_t *stats, uint8_t vector, uint64_t cycles) {
+    uint32_t bucket = 0;
+
+    if (cycles >> IRQ_LATENCY_BUCKET_SHIFT) {
+        bucket = (63 - __builtin_clzll(cycles)) - IRQ_LATENCY_BUCKET_SHIFT;
+        if (bucket >= IRQ_LATENCY_BUCKETS) {
+            bucket = IRQ_LATENCY_BUCKETS - 1;
+        }
+    }
+
+    stats->latency_hist[vector][bucket]++;
+    stats->latency_total[vector] += cycles;
+    if (cycles > stats->latency_max[vector]) {
+        stats->latency_max[vector] = cycles;
+    }
+}
+
 // Common interrupt handler
 void interrupt_handler(cpu_state_t *state) {
+    uint64_t entry_tsc = cpu_rdtsc();
     uint8_t vector = state->int_no;
+    irq_cpu_stats_t *stats = &irq_cpu_stats[cpu_current_id()];
     
     // Update statistics
-    interrupt_counts[vector]++;
-    total_interrupts++;
+    stats->count[vector]++;
+    
+    if (vector >= IRQ_BASE) {
+        irq_enter();
+        trace_event(TRACE_IRQ_ENTRY, vector, 0);
+        entropy_add_interrupt(vector, entry_tsc);
+    }
     
-    // Handle exceptions
     if (vector < 32) {
+        // Handle exceptions
         if (exception_handlers[vector] != NULL) {
             exception_handlers[vector](state);
         } else {
-            boot_log("Unhandled exception");
+            klog(LOG_EMERG, "Unhandled exception");
             dump_cpu_state(state);
             boot_panic("Unhandled exception");
         }
-        return;
-    }
-    
-    // Handle IRQs
-    if (vector >= IRQ_BASE && vector < IRQ_BASE + 16) {
+    } else if (vector >= IRQ_BASE && vector < IRQ_BASE + 16) {
+        // Handle IRQs
         irq_handler(state);
-        return;
-    }
-    
-    // Handle software interrupts
-    if (interrupt_handlers[vector].handler != NULL) {
+    } else if (vector >= IRQ_VECTOR_DYNAMIC_BASE &&
+               irq_vector_tables[cpu_current_id()].handler[vector] != NULL) {
+        // Handle MSI/MSI-X vectors
+        irq_vector_table_t *table = &irq_vector_tables[cpu_current_id()];
+        table->handler[vector](vector, table->context[vector]);
+        apic_send_eoi();
+    } else if (interrupt_handlers[vector].handler != NULL) {
+        // Handle software interrupts
         interrupt_handlers[vector].handler(state);
+    } else if (vector == APIC_SPURIOUS_VECTOR) {
+        // Spurious APIC interrupts need no EOI
     } else {
-        boot_log("Unhandled interrupt");
+        klog(LOG_WARN, "Unhandled interrupt");
         dump_cpu_state(state);
     }
+    
+    irq_record_latency(stats, vector, cpu_rdtsc() - entry_tsc);
+    
+    // Run bottom halves with interrupts enabled
+    if (vector >= IRQ_BASE) {
+        trace_event(TRACE_IRQ_EXIT, vector, 0);
+        irq_exit();
+    }
 }
 
 // Exception handlers
 void divide_error_handler(cpu_state_t *state) {
-    boot_log("Divide by zero exception");
+    klog(LOG_EMERG, "Divide by zero exception");
     dump_cpu_state(state);
     boot_panic("Divide by zero");
 }
 
+// NMI: claimed by the profiler on counter overflow, otherwise fatal
+void nmi_handler(cpu_state_t *state) {
+    if (profile_nmi(state)) {
+        return;
+    }
+
+    klog(LOG_EMERG, "Non-maskable interrupt");
+    dump_cpu_state(state);
+    boot_panic("Unhandled NMI");
+}
+
 void page_fault_handler(cpu_state_t *state) {
     uint64_t fault_addr;
     __asm__ volatile("mov %%cr2, %0" : "=r"(fault_addr));
     
-    boot_log("Page fault at address: ");
-    early_console_write_hex(fault_addr);
-    boot_log("Error code: ");
-    early_console_write_hex(state->err_code);
+    klog_hex(LOG_EMERG, "Page fault at address: ", fault_addr);
+    klog_hex(LOG_EMERG, "Error code: ", state->err_code);
     
     dump_cpu_state(state);
     boot_panic("Page fault");
 }
 
 void general_protection_fault_handler(cpu_state_t *state) {
-    boot_log("General protection fault");
-    boot_log("Error code: ");
-    early_console_write_hex(state->err_code);
+    klog(LOG_EMERG, "General protection fault");
+    klog_hex(LOG_EMERG, "Error code: ", state->err_code);
     
     dump_cpu_state(state);
     boot_panic("General protection fault");
 }
 
 void double_fault_handler(cpu_state_t *state) {
-    boot_log("Double fault");
+    klog(LOG_EMERG, "Double fault");
     dump_cpu_state(state);
     boot_panic("Double fault");
 }
@@ -296,9 +522,11 @@ void irq_handler(cpu_state_t *state) {
         case IRQ_KEYBOARD:
             keyboard_irq_handler(state);
             break;
+        case IRQ_COM1:
+            serial_irq_handler();
+            break;
         default:
-            boot_log("Unhandled IRQ: ");
-            early_console_write_hex(irq);
+            klog_hex(LOG_WARN, "Unhandled IRQ: ", irq);
             break;
     }
     
@@ -308,16 +536,23 @@ void irq_handler(cpu_state_t *state) {
 
 // Timer IRQ handler
 void timer_irq_handler(cpu_state_t *state) {
-    (void)state;  // Unused for now
+    timer_ticks++;
+    profile_timer_tick(state);
+    softirq_raise(SOFTIRQ_TIMER);
+}
 
-    static uint64_t tick_count = 0;
-    tick_count++;
+// Timer bottom half
+void timer_softirq_handler(void) {
+    static uint64_t last_logged = 0;
+    uint64_t ticks = timer_ticks;
 
-    // TODO: Update system time, scheduler, etc.
+    timer_run_expired();
 
-    if (tick_count % 100 == 0) {
-        boot_log("Timer tick: ");
-        early_console_write_hex(tick_count);
+    // TODO: Scheduler tick
+
+    if (ticks / TIMER_HZ != last_logged / TIMER_HZ) {
+        last_logged = ticks;
+        klog_hex(LOG_DEBUG, "Timer tick: ", ticks);
     }
 }
 
@@ -327,8 +562,24 @@ void keyboard_irq_handler(cpu_state_t *state) {
 
     uint8_t scancode = __inb(0x60);
 
-    // TODO: Handle keyboard input
-    (void)scancode;
+    // Queue for the bottom half; drop on overflow
+    uint32_t next = (keyboard_head + 1) % KEYBOARD_BUFFER_SIZE;
+    if (next != keyboard_tail) {
+        keyboard_buffer[keyboard_head] = scancode;
+        keyboard_head = next;
+    }
+    softirq_raise(SOFTIRQ_INPUT);
+}
+
+// Keyboard bottom half
+void keyboard_softirq_handler(void) {
+    while (keyboard_tail != keyboard_head) {
+        uint8_t scancode = keyboard_buffer[keyboard_tail];
+        keyboard_tail = (keyboard_tail + 1) % KEYBOARD_BUFFER_SIZE;
+
+        // TODO: Handle keyboard input
+        (void)scancode;
+    }
 }
 
 // PIC initialization
@@ -411,31 +662,110 @@ static inline uint8_t __inb(uint16_t port) {
 
 // Debug functions
 void dump_cpu_state(cpu_state_t *state) {
-    boot_log("=== CPU State ===");
-    boot_log("RAX: "); early_console_write_hex(state->rax);
-    boot_log("RBX: "); early_console_write_hex(state->rbx);
-    boot_log("RCX: "); early_console_write_hex(state->rcx);
-    boot_log("RDX: "); early_console_write_hex(state->rdx);
-    boot_log("RSI: "); early_console_write_hex(state->rsi);
-    boot_log("RDI: "); early_console_write_hex(state->rdi);
-    boot_log("RSP: "); early_console_write_hex(state->rsp);
-    boot_log("RBP: "); early_console_write_hex(state->rbp);
-    boot_log("RIP: "); early_console_write_hex(state->rip);
-    boot_log("CS:  "); early_console_write_hex(state->cs);
-    boot_log("SS:  "); early_console_write_hex(state->ss);
-    boot_log("RFLAGS: "); early_console_write_hex(state->eflags);
-    boot_log("Interrupt: "); early_console_write_hex(state->int_no);
-    boot_log("Error Code: "); early_console_write_hex(state->err_code);
+    klog(LOG_EMERG, "=== CPU State ===");
+    klog_hex(LOG_EMERG, "RAX: ", state->rax);
+    klog_hex(LOG_EMERG, "RBX: ", state->rbx);
+    klog_hex(LOG_EMERG, "RCX: ", state->rcx);
+    klog_hex(LOG_EMERG, "RDX: ", state->rdx);
+    klog_hex(LOG_EMERG, "RSI: ", state->rsi);
+    klog_hex(LOG_EMERG, "RDI: ", state->rdi);
+    klog_hex(LOG_EMERG, "RSP: ", state->rsp);
+    klog_hex(LOG_EMERG, "RBP: ", state->rbp);
+    klog_hex(LOG_EMERG, "RIP: ", state->rip);
+    klog_hex(LOG_EMERG, "CS:  ", state->cs);
+    klog_hex(LOG_EMERG, "SS:  ", state->ss);
+    klog_hex(LOG_EMERG, "RFLAGS: ", state->eflags);
+    klog_hex(LOG_EMERG, "Interrupt: ", state->int_no);
+    klog_hex(LOG_EMERG, "Error Code: ", state->err_code);
+}
+
+// Aggregate per-CPU statistics for one vector
+irq_result_t interrupt_get_vector_stats(uint8_t vector, irq_vector_stats_t *out) {
+    if (!out) {
+        return IRQ_ERROR_INVALID_VECTOR;
+    }
+    
+    memset(out, 0, sizeof(*out));
+    
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        irq_cpu_stats_t *stats = &irq_cpu_stats[cpu];
+        
+        out->count += stats->count[vector];
+        out->latency_total += stats->latency_total[vector];
+        out->latency_max = MAX(out->latency_max, stats->latency_max[vector]);
+        for (int b = 0; b < IRQ_LATENCY_BUCKETS; b++) {
+            out->latency_hist[b] += stats->latency_hist[vector][b];
+        }
+    }
+    
+    return IRQ_SUCCESS;
+}
+
+// Total interrupts across all CPUs and vectors
+uint64_t interrupt_total_count(void) {
+    uint64_t total = 0;
+    
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        for (int i = 0; i < IDT_ENTRIES; i++) {
+            total += irq_cpu_stats[cpu].count[i];
+        }
+    }
+    
+    return total;
+}
+
+// Measure the cost of the statistics path in TSC cycles per interrupt.
+// Runs the same entry/exit sequence as interrupt_handler(), RDTSC pair
+// included, against a scratch block and subtracts the cost of an empty
+// loop of the same length.
+uint64_t interrupt_measure_overhead(uint32_t iterations) {
+    static irq_cpu_stats_t scratch;
+    
+    if (iterations == 0) {
+        return 0;
+    }
+    
+    uint64_t start = cpu_rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        __asm__ volatile("" ::: "memory");
+    }
+    uint64_t baseline = cpu_rdtsc() - start;
+    
+    start = cpu_rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t entry_tsc = cpu_rdtsc();
+        irq_cpu_stats_t *stats = &scratch;
+        uint8_t vector = (uint8_t)(IRQ_BASE + (i & 15));
+        
+        stats->count[vector]++;
+        __asm__ volatile("" ::: "memory");
+        irq_record_latency(stats, vector, cpu_rdtsc() - entry_tsc);
+    }
+    uint64_t measured = cpu_rdtsc() - start;
+    
+    return (measured > baseline) ? (measured - baseline) / iterations : 0;
 }
 
 void interrupt_stats(void) {
     boot_log("=== Interrupt Statistics ===");
-    boot_log("Total interrupts: "); early_console_write_hex(total_interrupts);
+    klog_hex(LOG_INFO, "Total interrupts: ", interrupt_total_count());
     
     for (int i = 0; i < IDT_ENTRIES; i++) {
-        if (interrupt_counts[i] > 0) {
-            boot_log("IRQ "); early_console_write_hex(i);
-            boot_log(": "); early_console_write_hex(interrupt_counts[i]);
+        irq_vector_stats_t vs;
+        interrupt_get_vector_stats((uint8_t)i, &vs);
+        if (vs.count == 0) {
+            continue;
+        }
+        
+        klog_hex(LOG_INFO, "IRQ ", i);
+        klog_hex(LOG_INFO, ": ", vs.count);
+        klog_hex(LOG_INFO, "  avg cycles: ", vs.latency_total / vs.count);
+        klog_hex(LOG_INFO, "  max cycles: ", vs.latency_max);
+        for (int b = 0; b < IRQ_LATENCY_BUCKETS; b++) {
+            if (vs.latency_hist[b] > 0) {
+                klog_hex(LOG_INFO, "  >= cycles: ", b ? 1ULL << (b + IRQ_LATENCY_BUCKET_SHIFT) : 0);
+                klog_hex(LOG_INFO, "     count: ", vs.latency_hist[b]);
+            }
         }
     }
 }
@@ -11,24 +11,49 @@
 #include <kernel/ipc.h>
 #include <kernel/types.h>
 #include <kernel/boot.h>
+#include <kernel/memory.h>
+#include <kernel/vdso.h>
+#include <kernel/trace.h>
+#include <kernel/capability.h>
+#include <kernel/process.h>
+#include <kernel/waitset.h>
 
 /* ============================================================================
  * Internal Constants
  * ============================================================================ */
 
-#define MAX_PROCESSES       256
+#define PROC_CHUNK_SHIFT    6       /* Per-process records are allocated 64 at a time */
+#define PROC_CHUNK_SIZE     (1U << PROC_CHUNK_SHIFT)
 #define MAX_PORTS           128
 #define MAX_SHARED_REGIONS  64
-#define MAX_CHANNELS        64
+#define MAX_CHANNELS        1024    /* Power of two: low id bits are the slot */
 #define MAX_GRANTS_PER_REGION 16
+#define REGION_CLASS_MIN    6       /* Smallest region buffer: 64 bytes */
+#define REGION_CLASSES      48
+#define QUEUE_RESERVE       4       /* Entries a port or channel queue is opened with */
+#define WAITSET_INDEX_BITS  8
+
+_Static_assert((MAX_CHANNELS & (MAX_CHANNELS - 1)) == 0, "channel slot mask");
+_Static_assert(IPC_MAX_WAITSETS <= (1U << WAITSET_INDEX_BITS), "wait set index field");
 
 /* ============================================================================
  * Internal State
  * ============================================================================ */
 
-/* Per-process message queues */
-static ipc_queue_t process_queues[MAX_PROCESSES];
-static uint8_t queue_initialized[MAX_PROCESSES];
+/*
+ * Per-process state, one record per PCB slot (PROCESS_PID_INDEX). A
+ * record answers only for the PID that opened it, so a stale PID whose
+ * slot has been reused finds nothing.
+ */
+typedef struct {
+    ipc_queue_t queue;          /* Message queue */
+    cspace_t *endpoints;        /* Endpoint capability table, made on first use and
+                                   kept for the slot's later processes */
+    uint32_t pid;
+    bool open;
+} ipc_process_t;
+
+static ipc_process_t *proc_chunks[MAX_PROCESSES / PROC_CHUNK_SIZE];
 
 /* Named ports */
 static ipc_port_t ports[MAX_PORTS];
@@ -41,9 +66,24 @@ static uint32_t next_region_id = 1;
 /* Region grants */
 static ipc_region_grant_t region_grants[MAX_SHARED_REGIONS][MAX_GRANTS_PER_REGION];
 
-/* Channels */
+/*
+ * Buffers of destroyed regions, one list per power-of-two size class,
+ * linked through their first word. kfree() cannot return memory to the
+ * heap yet, so the heap only grows to the peak of live regions per class.
+ */
+static void *region_cache[REGION_CLASSES];
+
+/* Channels; id = serial * MAX_CHANNELS + slot */
 static ipc_channel_t channels[MAX_CHANNELS];
-static uint32_t next_channel_id = 1;
+static uint32_t next_channel_serial = 1;
+
+/* Wait sets; id = generation << WAITSET_INDEX_BITS | slot */
+static struct {
+    uint32_t id;                /* 0 while free */
+    uint32_t owner_id;
+    uint32_t generation;
+    waitset_t set;
+} waitsets[IPC_MAX_WAITSETS];
 
 /* Global message ID counter */
 static uint32_t next_message_id = 1;
@@ -64,26 +104,28 @@ static uint8_t ipc_initialized = 0;
 
 static uint32_t get_current_pid(void);
 static uint64_t get_timestamp_ns(void);
-static ipc_queue_entry_t *queue_alloc_entry(void);
-static void queue_free_entry(ipc_queue_entry_t *entry);
+static ipc_queue_entry_t *queue_alloc_entry(ipc_queue_t *queue);
+static void queue_free_entry(ipc_queue_t *queue, ipc_queue_entry_t *entry);
 static ipc_result_t queue_enqueue(ipc_queue_t *queue, const ipc_message_t *msg);
 static ipc_result_t queue_dequeue(ipc_queue_t *queue, ipc_message_t *msg, uint32_t *filter_sender);
 static ipc_port_t *find_port_by_id(uint32_t port_id);
 static ipc_port_t *find_port_by_name(const char *name);
 static ipc_shared_region_t *find_region(uint32_t region_id);
 static ipc_channel_t *find_channel(uint32_t channel_id);
+static ipc_process_t *proc_find(uint32_t pid);
+static void publish_queue_status(const ipc_process_t *proc);
 
 /* ============================================================================
  * Utility Implementations
  * ============================================================================ */
 
 /**
- * Get current process ID
- * TODO: Integrate with process management system
+ * Get current process ID; the kernel until the first process runs
  */
 static uint32_t get_current_pid(void) {
-    /* Placeholder - return kernel PID for now */
-    return IPC_PID_KERNEL;
+    process_t *current = process_get_current();
+
+    return current ? current->pid : IPC_PID_KERNEL;
 }
 
 /**
@@ -123,32 +165,102 @@ static void str_copy(char *dest, const char *src, size_t max) {
  * Queue Entry Management
  * ============================================================================ */
 
-/* Simple entry pool for queue entries */
-#define ENTRY_POOL_SIZE (MAX_PROCESSES * IPC_MAX_QUEUE_SIZE)
-static ipc_queue_entry_t entry_pool[ENTRY_POOL_SIZE];
-static uint8_t entry_in_use[ENTRY_POOL_SIZE];
-
-static ipc_queue_entry_t *queue_alloc_entry(void) {
-    for (uint32_t i = 0; i < ENTRY_POOL_SIZE; i++) {
-        if (!entry_in_use[i]) {
-            entry_in_use[i] = 1;
-            entry_pool[i].next = NULL;
-            entry_pool[i].prev = NULL;
-            return &entry_pool[i];
+/*
+ * Entries handed back by closed queues. kfree() cannot return memory to
+ * the heap yet, so released entries are kept here and reused before the
+ * heap is asked for more.
+ */
+static ipc_queue_entry_t *entry_cache;
+
+/**
+ * Take an entry from the queue's own free list, growing the queue's
+ * storage by one entry (cache first, then heap) while under max_size
+ */
+static ipc_queue_entry_t *queue_alloc_entry(ipc_queue_t *queue) {
+    ipc_queue_entry_t *entry = queue->free;
+
+    if (entry) {
+        queue->free = entry->next;
+    } else {
+        if (queue->reserved >= queue->max_size) {
+            return NULL;
         }
+        if (entry_cache) {
+            entry = entry_cache;
+            entry_cache = entry->next;
+        } else {
+            entry = kmalloc(sizeof(ipc_queue_entry_t));
+            if (!entry) {
+                return NULL;
+            }
+        }
+        queue->reserved++;
     }
-    return NULL;
+
+    entry->next = NULL;
+    entry->prev = NULL;
+    return entry;
 }
 
-static void queue_free_entry(ipc_queue_entry_t *entry) {
+static void queue_free_entry(ipc_queue_t *queue, ipc_queue_entry_t *entry) {
     if (!entry) return;
 
-    uint32_t idx = (uint32_t)(entry - entry_pool);
-    if (idx < ENTRY_POOL_SIZE) {
-        entry_in_use[idx] = 0;
+    entry->prev = NULL;
+    entry->next = queue->free;
+    queue->free = entry;
+}
+
+/**
+ * Open a queue with `reserve` entries of storage
+ *
+ * Running short of heap here is not fatal: the queue grows on first use.
+ */
+static void queue_open(ipc_queue_t *queue, uint32_t reserve) {
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->free = NULL;
+    queue->count = 0;
+    queue->reserved = 0;
+    queue->max_size = IPC_MAX_QUEUE_SIZE;
+    queue->dropped = 0;
+    queue->state = IPC_PORT_OPEN;
+    waitset_source_init(&queue->ready, &queue->count);
+
+    for (uint32_t i = 0; i < reserve; i++) {
+        ipc_queue_entry_t *entry = queue_alloc_entry(queue);
+        if (!entry) {
+            break;
+        }
+        queue_free_entry(queue, entry);
     }
 }
 
+/**
+ * Close a queue, dropping queued messages and returning all of its
+ * storage to the entry cache
+ */
+static void queue_close(ipc_queue_t *queue) {
+    ipc_queue_entry_t *lists[2] = { queue->head, queue->free };
+
+    for (uint32_t i = 0; i < 2; i++) {
+        while (lists[i]) {
+            ipc_queue_entry_t *entry = lists[i];
+            lists[i] = entry->next;
+            entry->next = entry_cache;
+            entry_cache = entry;
+        }
+    }
+
+    queue->head = NULL;
+    queue->tail = NULL;
+    queue->free = NULL;
+    queue->count = 0;
+    queue->reserved = 0;
+    queue->generation++;
+    queue->state = IPC_PORT_CLOSED;
+    waitset_source_close(&queue->ready);
+}
+
 /* ============================================================================
  * Queue Operations
  * ============================================================================ */
@@ -164,7 +276,7 @@ static ipc_result_t queue_enqueue(ipc_queue_t *queue, const ipc_message_t *msg)
         return IPC_ERROR_BUFFER_FULL;
     }
 
-    ipc_queue_entry_t *entry = queue_alloc_entry();
+    ipc_queue_entry_t *entry = queue_alloc_entry(queue);
     if (!entry) {
         queue->dropped++;
         ipc_global_stats.total_dropped++;
@@ -186,6 +298,10 @@ static ipc_result_t queue_enqueue(ipc_queue_t *queue, const ipc_message_t *msg)
     queue->tail = entry;
     queue->count++;
 
+    if (queue->ready.watchers) {
+        waitset_signal(&queue->ready);
+    }
+
     return IPC_SUCCESS;
 }
 
@@ -238,15 +354,48 @@ static ipc_result_t queue_dequeue(ipc_queue_t *queue, ipc_message_t *msg, uint32
     }
 
     queue->count--;
-    queue_free_entry(entry);
+    queue_free_entry(queue, entry);
 
     return IPC_SUCCESS;
 }
 
+/**
+ * Mirror a process queue into its vDSO status page
+ */
+static void publish_queue_status(const ipc_process_t *proc) {
+    const ipc_queue_t *queue = &proc->queue;
+
+    vdso_update_ipc(proc->pid, queue->count, queue->max_size, queue->dropped,
+                    proc->open && queue->state == IPC_PORT_OPEN);
+}
+
 /* ============================================================================
  * Lookup Helpers
  * ============================================================================ */
 
+/**
+ * Record in the slot of `pid`, whoever holds it; NULL if never allocated
+ */
+static ipc_process_t *proc_slot(uint32_t pid) {
+    uint32_t slot = PROCESS_PID_INDEX(pid);
+    ipc_process_t *chunk = proc_chunks[slot >> PROC_CHUNK_SHIFT];
+
+    return chunk ? &chunk[slot & (PROC_CHUNK_SIZE - 1)] : NULL;
+}
+
+/**
+ * Open record of process `pid`
+ */
+static ipc_process_t *proc_find(uint32_t pid) {
+    ipc_process_t *proc;
+
+    if (pid > PROCESS_PID_MAX) {
+        return NULL;
+    }
+    proc = proc_slot(pid);
+    return (proc && proc->open && proc->pid == pid) ? proc : NULL;
+}
+
 static ipc_port_t *find_port_by_id(uint32_t port_id) {
     for (uint32_t i = 0; i < MAX_PORTS; i++) {
         if (ports[i].port_id == port_id && ports[i].state != IPC_PORT_CLOSED) {
@@ -275,10 +424,10 @@ static ipc_shared_region_t *find_region(uint32_t region_id) {
 }
 
 static ipc_channel_t *find_channel(uint32_t channel_id) {
-    for (uint32_t i = 0; i < MAX_CHANNELS; i++) {
-        if (channels[i].channel_id == channel_id && channels[i].is_active) {
-            return &channels[i];
-        }
+    ipc_channel_t *ch = &channels[channel_id & (MAX_CHANNELS - 1)];
+
+    if (channel_id != 0 && ch->channel_id == channel_id && ch->is_active) {
+        return ch;
     }
     return NULL;
 }
@@ -292,53 +441,12 @@ ipc_result_t ipc_init(void) {
         return IPC_SUCCESS;
     }
 
-    /* Initialize all queues */
-    for (uint32_t i = 0; i < MAX_PROCESSES; i++) {
-        process_queues[i].head = NULL;
-        process_queues[i].tail = NULL;
-        process_queues[i].count = 0;
-        process_queues[i].max_size = IPC_MAX_QUEUE_SIZE;
-        process_queues[i].dropped = 0;
-        process_queues[i].state = IPC_PORT_CLOSED;
-        queue_initialized[i] = 0;
-    }
-
-    /* Initialize ports */
-    for (uint32_t i = 0; i < MAX_PORTS; i++) {
-        ports[i].port_id = 0;
-        ports[i].owner_id = 0;
-        ports[i].name[0] = '\0';
-        ports[i].state = IPC_PORT_CLOSED;
-    }
-
-    /* Initialize shared regions */
-    for (uint32_t i = 0; i < MAX_SHARED_REGIONS; i++) {
-        shared_regions[i].region_id = 0;
-        shared_regions[i].is_active = 0;
-    }
-
-    /* Initialize grants */
-    for (uint32_t i = 0; i < MAX_SHARED_REGIONS; i++) {
-        for (uint32_t j = 0; j < MAX_GRANTS_PER_REGION; j++) {
-            region_grants[i][j].is_active = 0;
-        }
-    }
-
-    /* Initialize channels */
-    for (uint32_t i = 0; i < MAX_CHANNELS; i++) {
-        channels[i].channel_id = 0;
-        channels[i].is_active = 0;
-    }
-
-    /* Initialize entry pool */
-    for (uint32_t i = 0; i < ENTRY_POOL_SIZE; i++) {
-        entry_in_use[i] = 0;
-    }
-
-    /* Clear statistics */
-    ipc_global_stats.total_sent = 0;
-    ipc_global_stats.total_received = 0;
-    ipc_global_stats.total_dropped = 0;
+    /*
+     * Ports, regions, grants, channels and the statistics are static and
+     * start zeroed (boot.S clears BSS), which is their closed/free state.
+     * Per-process records and message storage are taken from the heap as
+     * processes and queues are opened, so there is nothing to sweep here.
+     */
 
     /* Initialize kernel process queue */
     ipc_process_init(IPC_PID_KERNEL);
@@ -348,45 +456,60 @@ ipc_result_t ipc_init(void) {
 }
 
 ipc_result_t ipc_process_init(uint32_t pid) {
-    if (pid >= MAX_PROCESSES) {
+    if (pid > PROCESS_PID_MAX) {
         return IPC_ERROR_INVALID_ARG;
     }
 
-    if (queue_initialized[pid]) {
-        return IPC_SUCCESS;
+    ipc_process_t **chunk = &proc_chunks[PROCESS_PID_INDEX(pid) >> PROC_CHUNK_SHIFT];
+    if (!*chunk) {
+        *chunk = kmalloc(PROC_CHUNK_SIZE * sizeof(ipc_process_t));
+        if (!*chunk) {
+            return IPC_ERROR_OUT_OF_MEMORY;
+        }
+        memset(*chunk, 0, PROC_CHUNK_SIZE * sizeof(ipc_process_t));
+    }
+
+    ipc_process_t *proc = proc_slot(pid);
+    if (proc->open) {
+        if (proc->pid == pid) {
+            return IPC_SUCCESS;
+        }
+        /* The slot's previous process was never cleaned up */
+        ipc_process_cleanup(proc->pid);
     }
 
-    process_queues[pid].head = NULL;
-    process_queues[pid].tail = NULL;
-    process_queues[pid].count = 0;
-    process_queues[pid].max_size = IPC_MAX_QUEUE_SIZE;
-    process_queues[pid].dropped = 0;
-    process_queues[pid].state = IPC_PORT_OPEN;
-    queue_initialized[pid] = 1;
+    /* No reserve: most processes never receive, and 64k of them may live */
+    queue_open(&proc->queue, 0);
+    proc->pid = pid;
+    proc->open = true;
+    publish_queue_status(proc);
 
     return IPC_SUCCESS;
 }
 
 ipc_result_t ipc_process_cleanup(uint32_t pid) {
-    if (pid >= MAX_PROCESSES) {
+    if (pid > PROCESS_PID_MAX) {
         return IPC_ERROR_INVALID_ARG;
     }
 
-    if (!queue_initialized[pid]) {
+    ipc_process_t *proc = proc_find(pid);
+    if (!proc) {
         return IPC_SUCCESS;
     }
 
-    /* Free all queued messages */
-    ipc_queue_t *queue = &process_queues[pid];
-    while (queue->head) {
-        ipc_queue_entry_t *entry = queue->head;
-        queue->head = entry->next;
-        queue_free_entry(entry);
+    /* Drop queued messages and release the queue's storage */
+    queue_close(&proc->queue);
+    proc->open = false;
+    publish_queue_status(proc);
+
+    /*
+     * Capabilities the process held; those naming its queue are now stale.
+     * The emptied table stays with the record for the slot's next process.
+     */
+    if (proc->endpoints) {
+        cspace_destroy(proc->endpoints);
+        cspace_init_table(proc->endpoints);
     }
-    queue->tail = NULL;
-    queue->count = 0;
-    queue->state = IPC_PORT_CLOSED;
-    queue_initialized[pid] = 0;
 
     /* Cleanup owned ports */
     for (uint32_t i = 0; i < MAX_PORTS; i++) {
@@ -395,6 +518,13 @@ ipc_result_t ipc_process_cleanup(uint32_t pid) {
         }
     }
 
+    /* Cleanup owned wait sets */
+    for (uint32_t i = 0; i < IPC_MAX_WAITSETS; i++) {
+        if (waitsets[i].id && waitsets[i].owner_id == pid) {
+            ipc_waitset_destroy(waitsets[i].id);
+        }
+    }
+
     /* Cleanup owned shared regions */
     for (uint32_t i = 0; i < MAX_SHARED_REGIONS; i++) {
         if (shared_regions[i].owner_id == pid && shared_regions[i].is_active) {
@@ -420,11 +550,8 @@ ipc_result_t ipc_send(uint32_t receiver_id, const ipc_message_t *msg, uint64_t t
         return IPC_ERROR_INVALID_ARG;
     }
 
-    if (receiver_id >= MAX_PROCESSES) {
-        return IPC_ERROR_INVALID_RECEIVER;
-    }
-
-    if (!queue_initialized[receiver_id]) {
+    ipc_process_t *receiver = proc_find(receiver_id);
+    if (!receiver) {
         return IPC_ERROR_INVALID_RECEIVER;
     }
 
@@ -438,10 +565,13 @@ ipc_result_t ipc_send(uint32_t receiver_id, const ipc_message_t *msg, uint64_t t
     send_msg.sender_id = get_current_pid();
     send_msg.receiver_id = receiver_id;
     send_msg.message_id = next_message_id++;
+    send_msg.capability = CAP_NULL;
     send_msg.timestamp = get_timestamp_ns();
 
     /* Enqueue to receiver */
-    ipc_result_t result = queue_enqueue(&process_queues[receiver_id], &send_msg);
+    ipc_result_t result = queue_enqueue(&receiver->queue, &send_msg);
+    publish_queue_status(receiver);
+    trace_event(TRACE_IPC_SEND, receiver_id, (int64_t)result);
 
     if (result == IPC_SUCCESS) {
         ipc_global_stats.total_sent++;
@@ -461,12 +591,14 @@ ipc_result_t ipc_receive(uint32_t *sender_id, ipc_message_t *msg, uint64_t timeo
         return IPC_ERROR_INVALID_ARG;
     }
 
-    uint32_t pid = get_current_pid();
-    if (pid >= MAX_PROCESSES || !queue_initialized[pid]) {
+    ipc_process_t *proc = proc_find(get_current_pid());
+    if (!proc) {
         return IPC_ERROR_INVALID_RECEIVER;
     }
 
-    ipc_result_t result = queue_dequeue(&process_queues[pid], msg, sender_id);
+    ipc_result_t result = queue_dequeue(&proc->queue, msg, sender_id);
+    publish_queue_status(proc);
+    trace_event(TRACE_IPC_RECEIVE, result == IPC_SUCCESS ? msg->sender_id : 0, (int64_t)result);
 
     if (result == IPC_SUCCESS) {
         ipc_global_stats.total_received++;
@@ -543,12 +675,7 @@ ipc_result_t ipc_port_create(const char *name, uint32_t *port_id) {
     port->owner_id = get_current_pid();
     str_copy(port->name, name, sizeof(port->name));
     port->state = IPC_PORT_LISTENING;
-    port->queue.head = NULL;
-    port->queue.tail = NULL;
-    port->queue.count = 0;
-    port->queue.max_size = IPC_MAX_QUEUE_SIZE;
-    port->queue.dropped = 0;
-    port->queue.state = IPC_PORT_OPEN;
+    queue_open(&port->queue, QUEUE_RESERVE);
 
     *port_id = port->port_id;
     return IPC_SUCCESS;
@@ -566,11 +693,7 @@ ipc_result_t ipc_port_destroy(uint32_t port_id) {
     }
 
     /* Free queued messages */
-    while (port->queue.head) {
-        ipc_queue_entry_t *entry = port->queue.head;
-        port->queue.head = entry->next;
-        queue_free_entry(entry);
-    }
+    queue_close(&port->queue);
 
     port->state = IPC_PORT_CLOSED;
     port->port_id = 0;
@@ -609,9 +732,11 @@ ipc_result_t ipc_port_send(uint32_t port_id, const ipc_message_t *msg) {
     send_msg.sender_id = get_current_pid();
     send_msg.receiver_id = port->owner_id;
     send_msg.message_id = next_message_id++;
+    send_msg.capability = CAP_NULL;
     send_msg.timestamp = get_timestamp_ns();
 
     ipc_result_t result = queue_enqueue(&port->queue, &send_msg);
+    trace_event(TRACE_IPC_PORT_SEND, port_id, (int64_t)result);
 
     if (result == IPC_SUCCESS) {
         ipc_global_stats.total_sent++;
@@ -635,6 +760,7 @@ ipc_result_t ipc_port_receive(uint32_t port_id, ipc_message_t *msg, uint64_t tim
 
     uint32_t any_sender = IPC_PID_ANY;
     ipc_result_t result = queue_dequeue(&port->queue, msg, &any_sender);
+    trace_event(TRACE_IPC_PORT_RECEIVE, port_id, (int64_t)result);
 
     if (result == IPC_SUCCESS) {
         ipc_global_stats.total_received++;
@@ -643,10 +769,245 @@ ipc_result_t ipc_port_receive(uint32_t port_id, ipc_message_t *msg, uint64_t tim
     return result;
 }
 
+/* ============================================================================
+ * Endpoint Capabilities
+ * ============================================================================ */
+
+static cspace_t *endpoint_table(ipc_process_t *proc, bool create) {
+    if (!proc->endpoints && create) {
+        cspace_t *table = kmalloc(sizeof(*table));
+        if (table) {
+            cspace_init_table(table);
+            proc->endpoints = table;
+        }
+    }
+    return proc->endpoints;
+}
+
+/**
+ * Process a queue delivers to: its port's owner, or the queue's own process
+ */
+static uint32_t queue_owner(const ipc_queue_t *queue) {
+    uintptr_t addr = (uintptr_t)queue;
+
+    if (addr >= (uintptr_t)ports && addr < (uintptr_t)(ports + MAX_PORTS)) {
+        return ((const ipc_port_t *)(addr - offsetof(ipc_port_t, queue)))->owner_id;
+    }
+    return ((const ipc_process_t *)(addr - offsetof(ipc_process_t, queue)))->pid;
+}
+
+/**
+ * Endpoint capability at `cptr` in the table of process `pid`
+ */
+static ipc_result_t endpoint_resolve(uint32_t pid, uint32_t cptr, cap_t *cap) {
+    ipc_process_t *proc = proc_find(pid);
+    cspace_t *table = proc ? proc->endpoints : NULL;
+
+    if (!table || cspace_lookup(table, cptr, cap) != STATUS_SUCCESS ||
+        cap->type != CAP_TYPE_ENDPOINT) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+    return IPC_SUCCESS;
+}
+
+static ipc_result_t endpoint_insert(uint32_t pid, const cap_t *cap, uint32_t *cptr) {
+    ipc_process_t *proc = proc_find(pid);
+    if (!proc) {
+        return IPC_ERROR_INVALID_RECEIVER;
+    }
+
+    cspace_t *table = endpoint_table(proc, true);
+    if (!table) {
+        return IPC_ERROR_OUT_OF_MEMORY;
+    }
+    return cspace_insert(table, cap, cptr) == STATUS_SUCCESS ? IPC_SUCCESS
+                                                             : IPC_ERROR_OUT_OF_MEMORY;
+}
+
+ipc_result_t ipc_endpoint_create(uint32_t port_id, uint32_t rights, uint32_t *cptr) {
+    uint32_t pid = get_current_pid();
+    ipc_queue_t *queue;
+
+    if (!ipc_initialized) {
+        return IPC_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!cptr || (rights & ~IPC_ENDPOINT_ALL)) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    if (port_id == IPC_ENDPOINT_SELF) {
+        ipc_process_t *proc = proc_find(pid);
+        if (!proc) {
+            return IPC_ERROR_INVALID_RECEIVER;
+        }
+        queue = &proc->queue;
+    } else {
+        ipc_port_t *port = find_port_by_id(port_id);
+        if (!port) {
+            return IPC_ERROR_INVALID_PORT;
+        }
+        if (port->owner_id != pid && pid != IPC_PID_KERNEL) {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+        queue = &port->queue;
+    }
+
+    cap_t cap = {
+        .object = queue,
+        .type = CAP_TYPE_ENDPOINT,
+        .rights = rights,
+        .generation = queue->generation,
+    };
+    return endpoint_insert(pid, &cap, cptr);
+}
+
+ipc_result_t ipc_endpoint_grant(uint32_t cptr, uint32_t grantee_id, uint32_t rights,
+                                uint32_t *grantee_cptr) {
+    cap_t cap;
+
+    if (!proc_find(grantee_id)) {
+        return IPC_ERROR_INVALID_RECEIVER;
+    }
+
+    ipc_result_t result = endpoint_resolve(get_current_pid(), cptr, &cap);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+    if (!(cap.rights & IPC_ENDPOINT_GRANT)) {
+        return IPC_ERROR_PERMISSION_DENIED;
+    }
+
+    cap.rights &= rights;
+    return endpoint_insert(grantee_id, &cap, grantee_cptr);
+}
+
+ipc_result_t ipc_endpoint_delete(uint32_t cptr) {
+    ipc_process_t *proc = proc_find(get_current_pid());
+    cspace_t *table = proc ? proc->endpoints : NULL;
+
+    if (!table || cspace_delete(table, cptr) != STATUS_SUCCESS) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+    return IPC_SUCCESS;
+}
+
+ipc_result_t ipc_endpoint_send(uint32_t cptr, const ipc_message_t *msg, uint32_t transfer) {
+    uint32_t pid = get_current_pid();
+    uint32_t handed_cptr = CAP_NULL;
+    cap_t cap;
+
+    if (!ipc_initialized) {
+        return IPC_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!msg) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    if (msg->length > IPC_MAX_MESSAGE_SIZE) {
+        return IPC_ERROR_MESSAGE_TOO_LARGE;
+    }
+
+    /* The slot is the authority: no PID lookup or validation */
+    ipc_result_t result = endpoint_resolve(pid, cptr, &cap);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+    if (!(cap.rights & IPC_ENDPOINT_SEND)) {
+        return IPC_ERROR_PERMISSION_DENIED;
+    }
+
+    ipc_queue_t *queue = cap.object;
+    if (queue->state == IPC_PORT_CLOSED || queue->generation != cap.generation) {
+        return IPC_ERROR_PORT_CLOSED;
+    }
+    uint32_t receiver_id = queue_owner(queue);
+
+    /* Prepare message with sender info */
+    ipc_message_t send_msg;
+    memcpy(&send_msg, msg, sizeof(ipc_message_t));
+    send_msg.sender_id = pid;
+    send_msg.receiver_id = receiver_id;
+    send_msg.message_id = next_message_id++;
+    send_msg.timestamp = get_timestamp_ns();
+
+    /* Copy the transferred capability now; undone if the send fails */
+    if (transfer != CAP_NULL) {
+        cap_t handed;
+
+        if (!(cap.rights & IPC_ENDPOINT_GRANT)) {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+        result = endpoint_resolve(pid, transfer, &handed);
+        if (result != IPC_SUCCESS) {
+            return result;
+        }
+        if (!(handed.rights & IPC_ENDPOINT_GRANT)) {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+        result = endpoint_insert(receiver_id, &handed, &handed_cptr);
+        if (result != IPC_SUCCESS) {
+            return result;
+        }
+    }
+    send_msg.capability = handed_cptr;
+
+    result = queue_enqueue(queue, &send_msg);
+    ipc_process_t *receiver = proc_find(receiver_id);
+    if (receiver && queue == &receiver->queue) {
+        publish_queue_status(receiver);
+    }
+    trace_event(TRACE_IPC_SEND, receiver_id, (int64_t)result);
+
+    if (result == IPC_SUCCESS) {
+        ipc_global_stats.total_sent++;
+    } else if (handed_cptr != CAP_NULL) {
+        cspace_delete(receiver->endpoints, handed_cptr);
+    }
+
+    return result;
+}
+
 /* ============================================================================
  * Shared Memory Operations
  * ============================================================================ */
 
+/* Size class of a region buffer: log2 of its capacity */
+static uint32_t region_class(size_t size) {
+    if (size <= (1ULL << REGION_CLASS_MIN)) {
+        return REGION_CLASS_MIN;
+    }
+    return 64 - (uint32_t)__builtin_clzll((uint64_t)size - 1);
+}
+
+static void *region_buffer_alloc(size_t size) {
+    uint32_t cls = region_class(size);
+    void *buf;
+
+    if (cls >= REGION_CLASSES) {
+        return NULL;
+    }
+    buf = region_cache[cls];
+    if (buf) {
+        region_cache[cls] = *(void **)buf;
+    } else {
+        buf = kmalloc(1ULL << cls);
+        if (!buf) {
+            return NULL;
+        }
+    }
+    memset(buf, 0, size);
+    return buf;
+}
+
+static void region_buffer_free(void *buf, size_t size) {
+    uint32_t cls = region_class(size);
+
+    *(void **)buf = region_cache[cls];
+    region_cache[cls] = buf;
+}
+
 ipc_result_t ipc_share_create(size_t size, ipc_shared_region_t *region) {
     if (!ipc_initialized) {
         return IPC_ERROR_NOT_SUPPORTED;
@@ -671,9 +1032,14 @@ ipc_result_t ipc_share_create(size_t size, ipc_shared_region_t *region) {
         return IPC_ERROR_OUT_OF_MEMORY;
     }
 
-    /* Allocate physical memory */
-    /* TODO: Integrate with memory manager */
-    void *phys = NULL; /* pmm_alloc_pages(size / PAGE_SIZE); */
+    /*
+     * Backing store from the kernel heap, zeroed. There are no per-process
+     * address spaces yet, so owner and grantees share the kernel mapping.
+     */
+    void *phys = region_buffer_alloc(size);
+    if (!phys) {
+        return IPC_ERROR_OUT_OF_MEMORY;
+    }
 
     reg->region_id = next_region_id++;
     reg->owner_id = get_current_pid();
@@ -712,8 +1078,7 @@ ipc_result_t ipc_share_destroy(uint32_t region_id) {
         region_grants[slot][i].is_active = 0;
     }
 
-    /* Free physical memory */
-    /* TODO: pmm_free_pages(reg->physical_addr, reg->size / PAGE_SIZE); */
+    region_buffer_free(reg->physical_addr, reg->size);
 
     reg->is_active = 0;
     reg->region_id = 0;
@@ -834,6 +1199,44 @@ ipc_result_t ipc_share_map(uint32_t region_id, void **addr) {
     return IPC_ERROR_PERMISSION_DENIED;
 }
 
+ipc_result_t ipc_share_query(uint32_t region_id, size_t *size, uint32_t *permissions) {
+    return ipc_share_access(region_id, get_current_pid(), size, permissions);
+}
+
+ipc_result_t ipc_share_access(uint32_t region_id, uint32_t pid, size_t *size,
+                              uint32_t *permissions) {
+    ipc_shared_region_t *reg = find_region(region_id);
+    if (!reg) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    uint32_t access = 0;
+
+    if (reg->owner_id == pid) {
+        access = reg->permissions;
+    } else {
+        uint32_t slot = (uint32_t)(reg - shared_regions);
+        for (uint32_t i = 0; i < MAX_GRANTS_PER_REGION; i++) {
+            if (region_grants[slot][i].is_active &&
+                region_grants[slot][i].grantee_id == pid) {
+                access = region_grants[slot][i].permissions;
+                break;
+            }
+        }
+        if (!access) {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+    }
+
+    if (size) {
+        *size = reg->size;
+    }
+    if (permissions) {
+        *permissions = access;
+    }
+    return IPC_SUCCESS;
+}
+
 ipc_result_t ipc_share_unmap(uint32_t region_id) {
     ipc_shared_region_t *reg = find_region(region_id);
     if (!reg) {
@@ -877,7 +1280,7 @@ ipc_result_t ipc_channel_create(uint32_t endpoint_a, uint32_t endpoint_b,
         return IPC_ERROR_INVALID_ARG;
     }
 
-    if (endpoint_a >= MAX_PROCESSES || endpoint_b >= MAX_PROCESSES) {
+    if (endpoint_a > PROCESS_PID_MAX || endpoint_b > PROCESS_PID_MAX) {
         return IPC_ERROR_INVALID_ARG;
     }
 
@@ -894,25 +1297,17 @@ ipc_result_t ipc_channel_create(uint32_t endpoint_a, uint32_t endpoint_b,
         return IPC_ERROR_OUT_OF_MEMORY;
     }
 
-    ch->channel_id = next_channel_id++;
+    ch->channel_id = next_channel_serial++ * MAX_CHANNELS + (uint32_t)(ch - channels);
+    if (next_channel_serial >= 0xFFFFFFFFU / MAX_CHANNELS) {
+        next_channel_serial = 1;
+    }
     ch->endpoint_a = endpoint_a;
     ch->endpoint_b = endpoint_b;
     ch->is_active = 1;
 
     /* Initialize queues */
-    ch->queue_a_to_b.head = NULL;
-    ch->queue_a_to_b.tail = NULL;
-    ch->queue_a_to_b.count = 0;
-    ch->queue_a_to_b.max_size = IPC_MAX_QUEUE_SIZE;
-    ch->queue_a_to_b.dropped = 0;
-    ch->queue_a_to_b.state = IPC_PORT_OPEN;
-
-    ch->queue_b_to_a.head = NULL;
-    ch->queue_b_to_a.tail = NULL;
-    ch->queue_b_to_a.count = 0;
-    ch->queue_b_to_a.max_size = IPC_MAX_QUEUE_SIZE;
-    ch->queue_b_to_a.dropped = 0;
-    ch->queue_b_to_a.state = IPC_PORT_OPEN;
+    queue_open(&ch->queue_a_to_b, QUEUE_RESERVE);
+    queue_open(&ch->queue_b_to_a, QUEUE_RESERVE);
 
     *channel_id = ch->channel_id;
     return IPC_SUCCESS;
@@ -925,17 +1320,8 @@ ipc_result_t ipc_channel_destroy(uint32_t channel_id) {
     }
 
     /* Free queued messages */
-    while (ch->queue_a_to_b.head) {
-        ipc_queue_entry_t *entry = ch->queue_a_to_b.head;
-        ch->queue_a_to_b.head = entry->next;
-        queue_free_entry(entry);
-    }
-
-    while (ch->queue_b_to_a.head) {
-        ipc_queue_entry_t *entry = ch->queue_b_to_a.head;
-        ch->queue_b_to_a.head = entry->next;
-        queue_free_entry(entry);
-    }
+    queue_close(&ch->queue_a_to_b);
+    queue_close(&ch->queue_b_to_a);
 
     ch->is_active = 0;
     ch->channel_id = 0;
@@ -966,6 +1352,7 @@ ipc_result_t ipc_channel_send(uint32_t channel_id, const ipc_message_t *msg) {
     send_msg.sender_id = pid;
     send_msg.receiver_id = (pid == ch->endpoint_a) ? ch->endpoint_b : ch->endpoint_a;
     send_msg.message_id = next_message_id++;
+    send_msg.capability = CAP_NULL;
     send_msg.timestamp = get_timestamp_ns();
 
     ipc_result_t result = queue_enqueue(queue, &send_msg);
@@ -1007,6 +1394,175 @@ ipc_result_t ipc_channel_receive(uint32_t channel_id, ipc_message_t *msg,
     return result;
 }
 
+/* ============================================================================
+ * Wait Sets
+ * ============================================================================ */
+
+static waitset_t *find_waitset(uint32_t waitset_id, uint32_t pid) {
+    uint32_t slot = waitset_id & ((1U << WAITSET_INDEX_BITS) - 1);
+
+    if (waitset_id == 0 || slot >= IPC_MAX_WAITSETS || waitsets[slot].id != waitset_id) {
+        return NULL;
+    }
+    if (waitsets[slot].owner_id != pid && pid != IPC_PID_KERNEL) {
+        return NULL;
+    }
+    return &waitsets[slot].set;
+}
+
+/**
+ * Queue process `pid` receives from for a wait set source
+ */
+static ipc_result_t waitset_queue(uint32_t pid, uint32_t source, uint32_t id,
+                                  ipc_queue_t **queue) {
+    switch (source) {
+    case IPC_WAIT_QUEUE: {
+        ipc_process_t *proc = proc_find(pid);
+        if (!proc) {
+            return IPC_ERROR_INVALID_RECEIVER;
+        }
+        *queue = &proc->queue;
+        return IPC_SUCCESS;
+    }
+
+    case IPC_WAIT_PORT: {
+        ipc_port_t *port = find_port_by_id(id);
+
+        if (!port) {
+            return IPC_ERROR_INVALID_PORT;
+        }
+        if (port->owner_id != pid) {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+        *queue = &port->queue;
+        return IPC_SUCCESS;
+    }
+
+    case IPC_WAIT_CHANNEL: {
+        ipc_channel_t *ch = find_channel(id);
+
+        if (!ch) {
+            return IPC_ERROR_NOT_FOUND;
+        }
+        if (pid == ch->endpoint_a) {
+            *queue = &ch->queue_b_to_a;
+        } else if (pid == ch->endpoint_b) {
+            *queue = &ch->queue_a_to_b;
+        } else {
+            return IPC_ERROR_PERMISSION_DENIED;
+        }
+        return IPC_SUCCESS;
+    }
+
+    default:
+        return IPC_ERROR_INVALID_ARG;
+    }
+}
+
+ipc_result_t ipc_waitset_create(uint32_t *waitset_id) {
+    if (!ipc_initialized) {
+        return IPC_ERROR_NOT_SUPPORTED;
+    }
+
+    if (!waitset_id) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    for (uint32_t i = 0; i < IPC_MAX_WAITSETS; i++) {
+        if (waitsets[i].id == 0) {
+            /* Generation 0 is skipped so no id is 0 */
+            if (++waitsets[i].generation >= (1U << (32 - WAITSET_INDEX_BITS))) {
+                waitsets[i].generation = 1;
+            }
+            waitsets[i].id = (waitsets[i].generation << WAITSET_INDEX_BITS) | i;
+            waitsets[i].owner_id = get_current_pid();
+            waitset_init(&waitsets[i].set);
+
+            *waitset_id = waitsets[i].id;
+            return IPC_SUCCESS;
+        }
+    }
+
+    return IPC_ERROR_OUT_OF_MEMORY;
+}
+
+ipc_result_t ipc_waitset_destroy(uint32_t waitset_id) {
+    waitset_t *set = find_waitset(waitset_id, get_current_pid());
+    if (!set) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    waitset_destroy(set);
+    waitsets[waitset_id & ((1U << WAITSET_INDEX_BITS) - 1)].id = 0;
+
+    return IPC_SUCCESS;
+}
+
+ipc_result_t ipc_waitset_add(uint32_t waitset_id, uint32_t source, uint32_t id,
+                             uint32_t flags, uint64_t cookie) {
+    uint32_t pid = get_current_pid();
+    waitset_t *set = find_waitset(waitset_id, pid);
+    if (!set) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    ipc_queue_t *queue;
+    ipc_result_t result = waitset_queue(pid, source, id, &queue);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+
+    if (waitset_find(set, &queue->ready)) {
+        return IPC_ERROR_ALREADY_EXISTS;
+    }
+
+    switch (waitset_add(set, &queue->ready, flags, cookie, NULL)) {
+    case STATUS_SUCCESS:
+        return IPC_SUCCESS;
+    case STATUS_NO_MEMORY:
+        return IPC_ERROR_OUT_OF_MEMORY;
+    default:
+        return IPC_ERROR_INVALID_ARG;
+    }
+}
+
+ipc_result_t ipc_waitset_remove(uint32_t waitset_id, uint32_t source, uint32_t id) {
+    uint32_t pid = get_current_pid();
+    waitset_t *set = find_waitset(waitset_id, pid);
+    if (!set) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    ipc_queue_t *queue;
+    ipc_result_t result = waitset_queue(pid, source, id, &queue);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+
+    waitset_item_t *item = waitset_find(set, &queue->ready);
+    if (!item) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    waitset_remove(item);
+    return IPC_SUCCESS;
+}
+
+ipc_result_t ipc_waitset_collect(uint32_t waitset_id, waitset_event_t *events, uint32_t max,
+                                 uint32_t *count) {
+    if (!events || !count || max == 0) {
+        return IPC_ERROR_INVALID_ARG;
+    }
+
+    waitset_t *set = find_waitset(waitset_id, get_current_pid());
+    if (!set) {
+        return IPC_ERROR_NOT_FOUND;
+    }
+
+    *count = waitset_collect(set, events, max);
+    return *count ? IPC_SUCCESS : IPC_ERROR_NO_MESSAGE;
+}
+
 /* ============================================================================
  * Quantum IPC Extensions
  * ============================================================================ */
@@ -1056,11 +1612,9 @@ ipc_result_t ipc_quantum_measurement_result(uint32_t receiver_id,
  * ============================================================================ */
 
 uint32_t ipc_get_queue_depth(void) {
-    uint32_t pid = get_current_pid();
-    if (pid >= MAX_PROCESSES || !queue_initialized[pid]) {
-        return 0;
-    }
-    return process_queues[pid].count;
+    ipc_process_t *proc = proc_find(get_current_pid());
+
+    return proc ? proc->queue.count : 0;
 }
 
 int ipc_has_messages(void) {
@@ -0,0 +1,428 @@
+/**
+ * QuantumOS In-kernel Benchmark Suite Implementation
+ *
+ * Every case fills the same sample buffer, one TSC delta per operation,
+ * and the summary is computed after an insertion sort. No floating
+ * point: the mean is truncated to whole cycles.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/kbench.h>
+#include <kernel/interrupts.h>
+#include <kernel/process.h>
+#include <kernel/serial.h>
+#include <kernel/pci.h>
+#include <kernel/memory.h>
+#include <kernel/timer.h>
+#include <kernel/syscall.h>
+#include <kernel/vdso.h>
+#include <kernel/ipc.h>
+#include <kernel/format.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/io.h>
+
+#define KBENCH_PROCESSES        32      /* Live at once in the process cases */
+#define KBENCH_MESSAGE_LEN      64
+#define KBENCH_LINE_MAX         256
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+typedef status_t (*kbench_fn_t)(uint64_t *samples, uint32_t count);
+
+typedef struct {
+    const char *name;
+    kbench_fn_t fn;                     /* NULL if not available in this kernel */
+    const char *skip_reason;
+} kbench_case_t;
+
+static uint64_t samples[KBENCH_SAMPLES];
+static ipc_message_t message;
+static ipc_message_t reply;
+static uint8_t process_stack[4096] ALIGNED(16);
+static uint32_t pids[KBENCH_PROCESSES];
+
+/* ============================================================================
+ * Output
+ * ============================================================================ */
+
+static uint32_t put_field(char *buf, uint32_t len, const char *key, uint64_t value) {
+    len = fmt_str(buf, len, ",\"");
+    len = fmt_str(buf, len, key);
+    len = fmt_str(buf, len, "\":");
+    return fmt_dec(buf, len, value);
+}
+
+static uint32_t put_header(char *buf, const char *key, const char *value) {
+    uint32_t len = fmt_str(buf, 0, "{\"suite\":\"kernel\",\"");
+    len = fmt_str(buf, len, key);
+    len = fmt_str(buf, len, "\":\"");
+    len = fmt_str(buf, len, value);
+    return fmt_str(buf, len, "\"");
+}
+
+static void emit(char *buf, uint32_t len) {
+    len = fmt_str(buf, len, "}\r\n");
+    serial_write_sync(buf, len);
+}
+
+/* ============================================================================
+ * Statistics
+ * ============================================================================ */
+
+static void sort_samples(uint64_t *values, uint32_t count) {
+    for (uint32_t i = 1; i < count; i++) {
+        uint64_t v = values[i];
+        uint32_t j = i;
+        while (j && values[j - 1] > v) {
+            values[j] = values[j - 1];
+            j--;
+        }
+        values[j] = v;
+    }
+}
+
+/* Nearest-rank percentile of sorted samples */
+static uint64_t percentile(const uint64_t *sorted, uint32_t count, uint32_t pct) {
+    uint32_t rank = (count * pct + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static void report(const char *name, uint64_t *values, uint32_t count) {
+    char line[KBENCH_LINE_MAX];
+    uint64_t total = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        total += values[i];
+    }
+    sort_samples(values, count);
+
+    uint32_t len = put_header(line, "bench", name);
+    len = fmt_str(line, len, ",\"unit\":\"cycles\"");
+    len = put_field(line, len, "samples", count);
+    len = put_field(line, len, "mean", total / count);
+    len = put_field(line, len, "min", values[0]);
+    len = put_field(line, len, "p50", percentile(values, count, 50));
+    len = put_field(line, len, "p90", percentile(values, count, 90));
+    len = put_field(line, len, "p99", percentile(values, count, 99));
+    len = put_field(line, len, "max", values[count - 1]);
+    emit(line, len);
+}
+
+/* A case without numbers: "skipped" or "error" and why */
+static void report_note(const char *name, const char *key, const char *reason) {
+    char line[KBENCH_LINE_MAX];
+    uint32_t len = put_header(line, "bench", name);
+    len = fmt_str(line, len, ",\"");
+    len = fmt_str(line, len, key);
+    len = fmt_str(line, len, "\":\"");
+    len = fmt_str(line, len, reason);
+    len = fmt_str(line, len, "\"");
+    emit(line, len);
+}
+
+/* Cheapest of a few back-to-back cpu_rdtsc() pairs */
+static uint64_t rdtsc_overhead(void) {
+    uint64_t best = ~0ULL;
+    for (uint32_t i = 0; i < KBENCH_WARMUP; i++) {
+        uint64_t start = cpu_rdtsc();
+        uint64_t cycles = cpu_rdtsc() - start;
+        best = MIN(best, cycles);
+    }
+    return best;
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void bench_process_entry(void) {
+    while (1) {
+        __asm__ volatile("hlt");
+    }
+}
+
+/*
+ * Creation and destruction are timed in rounds of KBENCH_PROCESSES so
+ * the process table never fills; `destroy` picks which one is recorded.
+ */
+static status_t bench_process(uint64_t *out, uint32_t count, bool destroy) {
+    process_create_params_t params = {
+        .name = "kbench",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)bench_process_entry,
+        .stack_address = process_stack,
+        .stack_size = sizeof(process_stack),
+        .is_quantum_aware = false,
+    };
+    uint32_t taken = 0;
+
+    while (taken < count) {
+        uint32_t round = MIN(count - taken, KBENCH_PROCESSES);
+
+        for (uint32_t i = 0; i < round; i++) {
+            process_t *process;
+            uint64_t start = cpu_rdtsc();
+            status_t result = process_create(&params, &process);
+            uint64_t cycles = cpu_rdtsc() - start;
+            if (result != STATUS_SUCCESS) {
+                while (i) {
+                    process_destroy(pids[--i]);
+                }
+                return result;
+            }
+            pids[i] = process->pid;
+            if (!destroy) {
+                out[taken + i] = cycles;
+            }
+        }
+        for (uint32_t i = 0; i < round; i++) {
+            uint64_t start = cpu_rdtsc();
+            process_destroy(pids[i]);
+            uint64_t cycles = cpu_rdtsc() - start;
+            if (destroy) {
+                out[taken + i] = cycles;
+            }
+        }
+        taken += round;
+    }
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_process_create(uint64_t *out, uint32_t count) {
+    return bench_process(out, count, false);
+}
+
+static status_t bench_process_destroy(uint64_t *out, uint32_t count) {
+    return bench_process(out, count, true);
+}
+
+/* process_create() printing at LOG_DEBUG, through the polled UART or the log ring */
+static status_t bench_process_logged(uint64_t *out, uint32_t count, bool sync) {
+    log_level_t saved = log_get_level();
+
+    log_set_level(LOG_DEBUG);
+    log_set_sync(sync);
+    status_t result = bench_process(out, count, false);
+    log_set_sync(true);
+    log_set_level(saved);
+    return result;
+}
+
+static status_t bench_process_log_polled(uint64_t *out, uint32_t count) {
+    return bench_process_logged(out, count, true);
+}
+
+static status_t bench_process_log_ring(uint64_t *out, uint32_t count) {
+    return bench_process_logged(out, count, false);
+}
+
+static status_t bench_ipc_round_trip(uint64_t *out, uint32_t count) {
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = KBENCH_MESSAGE_LEN;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t sender;
+        uint64_t start = cpu_rdtsc();
+        ipc_result_t sent = ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+        ipc_result_t received = ipc_receive(&sender, &reply, IPC_NO_WAIT);
+        out[i] = cpu_rdtsc() - start;
+        if (sent != IPC_SUCCESS || received != IPC_SUCCESS) {
+            return STATUS_ERROR;
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_pmm_alloc_frame(uint64_t *out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t start = cpu_rdtsc();
+        void *frame = pmm_alloc_frame();
+        out[i] = cpu_rdtsc() - start;
+        if (!frame) {
+            return STATUS_NO_MEMORY;
+        }
+        pmm_free_frame(frame);
+    }
+    return STATUS_SUCCESS;
+}
+
+/* The first mapping allocates the intermediate tables; warmup absorbs it */
+static status_t bench_memory_map_page(uint64_t *out, uint32_t count) {
+    void *virt = (void *)KBENCH_MAP_VADDR;
+    void *frame = pmm_alloc_frame();
+    if (!frame) {
+        return STATUS_NO_MEMORY;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t start = cpu_rdtsc();
+        mem_result_t result = memory_map_page(virt, frame, MEM_READ | MEM_WRITE);
+        out[i] = cpu_rdtsc() - start;
+        if (result != MEM_SUCCESS) {
+            pmm_free_frame(frame);
+            return STATUS_ERROR;
+        }
+        memory_unmap_page(virt);
+    }
+
+    pmm_free_frame(frame);
+    return STATUS_SUCCESS;
+}
+
+static void bench_irq_handler(cpu_state_t *state) {
+    (void)state;
+}
+
+static status_t bench_irq_entry_exit(uint64_t *out, uint32_t count) {
+    if (interrupt_register(KBENCH_IRQ_VECTOR, bench_irq_handler, NULL) != IRQ_SUCCESS) {
+        return STATUS_BUSY;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t start = cpu_rdtsc();
+        __asm__ volatile("int %0" : : "i"(KBENCH_IRQ_VECTOR) : "memory");
+        out[i] = cpu_rdtsc() - start;
+    }
+
+    interrupt_unregister(KBENCH_IRQ_VECTOR);
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_irq_stats_overhead(uint64_t *out, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        out[i] = interrupt_measure_overhead(1);
+    }
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_msi_vector(uint64_t *out, uint32_t count) {
+    return pci_msi_selftest(out, count);
+}
+
+/* One call per sample; `via_int` picks the int $SYSCALL_VECTOR figure */
+static status_t bench_syscall(uint64_t *out, uint32_t count, uint64_t nr, bool via_int) {
+    syscall_bench_t bench;
+
+    for (uint32_t i = 0; i < count; i++) {
+        status_t result = syscall_benchmark(nr, 1, &bench);
+        if (result != STATUS_SUCCESS) {
+            return result;
+        }
+        out[i] = via_int ? bench.int80_cycles : bench.syscall_cycles;
+        if (!out[i]) {
+            return STATUS_NOT_IMPLEMENTED;      /* No SYSCALL fast path */
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_syscall_null(uint64_t *out, uint32_t count) {
+    return bench_syscall(out, count, SYS_NULL, false);
+}
+
+static status_t bench_int80_null(uint64_t *out, uint32_t count) {
+    return bench_syscall(out, count, SYS_NULL, true);
+}
+
+static status_t bench_syscall_queue_depth(uint64_t *out, uint32_t count) {
+    return bench_syscall(out, count, SYS_IPC_QUEUE_DEPTH, false);
+}
+
+static status_t bench_vdso(uint64_t *out, uint32_t count, bool queue_depth) {
+    vdso_bench_t bench;
+
+    for (uint32_t i = 0; i < count; i++) {
+        status_t result = vdso_benchmark(1, &bench);
+        if (result != STATUS_SUCCESS) {
+            return result;
+        }
+        out[i] = queue_depth ? bench.queue_depth_cycles : bench.time_read_cycles;
+    }
+    return STATUS_SUCCESS;
+}
+
+static status_t bench_vdso_time_read(uint64_t *out, uint32_t count) {
+    return bench_vdso(out, count, false);
+}
+
+static status_t bench_vdso_queue_depth(uint64_t *out, uint32_t count) {
+    return bench_vdso(out, count, true);
+}
+
+static const kbench_case_t cases[] = {
+    { "process_create",            bench_process_create,       NULL },
+    { "process_destroy",           bench_process_destroy,      NULL },
+    { "process_create_log_polled", bench_process_log_polled,   NULL },
+    { "process_create_log_ring",   bench_process_log_ring,     NULL },
+    { "ipc_round_trip",            bench_ipc_round_trip,       NULL },
+    { "pmm_alloc_frame",           bench_pmm_alloc_frame,      NULL },
+    { "memory_map_page",           bench_memory_map_page,      NULL },
+    { "irq_entry_exit",            bench_irq_entry_exit,       NULL },
+    { "irq_stats_overhead",        bench_irq_stats_overhead,   NULL },
+    { "msi_vector",                bench_msi_vector,           NULL },
+    { "syscall_null",              bench_syscall_null,         NULL },
+    { "int80_null",                bench_int80_null,           NULL },
+    { "syscall_queue_depth",       bench_syscall_queue_depth,  NULL },
+    { "vdso_time_read",            bench_vdso_time_read,       NULL },
+    { "vdso_queue_depth",          bench_vdso_queue_depth,     NULL },
+    { "resonant_sync",   NULL, "resonant scheduler is not built into the kernel" },
+};
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+status_t kbench_run(void) {
+    char line[KBENCH_LINE_MAX];
+    uint32_t failed = 0;
+    uint32_t len;
+
+    /* Drain pending log output and keep it from splitting a result line */
+    log_set_sync(true);
+
+    len = put_header(line, "event", "begin");
+    len = put_field(line, len, "samples", KBENCH_SAMPLES);
+    len = put_field(line, len, "tsc_khz", timer_tsc_khz());
+    len = put_field(line, len, "rdtsc_overhead", rdtsc_overhead());
+    emit(line, len);
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(cases); i++) {
+        const kbench_case_t *c = &cases[i];
+
+        if (!c->fn) {
+            report_note(c->name, "skipped", c->skip_reason);
+            continue;
+        }
+        if (c->fn(samples, KBENCH_WARMUP) != STATUS_SUCCESS ||
+            c->fn(samples, KBENCH_SAMPLES) != STATUS_SUCCESS) {
+            report_note(c->name, "error", "operation failed");
+            failed++;
+            continue;
+        }
+        report(c->name, samples, KBENCH_SAMPLES);
+    }
+
+    len = put_header(line, "event", "end");
+    len = put_field(line, len, "cases", ARRAY_SIZE(cases));
+    len = put_field(line, len, "failed", failed);
+    emit(line, len);
+
+    log_set_sync(false);
+    return failed ? STATUS_ERROR : STATUS_SUCCESS;
+}
+
+void kbench_exit(uint32_t code) {
+    outl(KBENCH_EXIT_PORT, code);
+
+    /* No isa-debug-exit device: stay down */
+    __asm__ volatile("cli");
+    while (1) {
+        __asm__ volatile("hlt");
+    }
+}
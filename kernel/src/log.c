@@ -0,0 +1,305 @@
+/**
+ * QuantumOS Kernel Log
+ *
+ * Producers format a complete line into a claimed ring slot; the serial
+ * driver consumes the ring a byte at a time from its transmit interrupt.
+ * Slot claiming follows the bounded MPMC queue scheme: a slot is free
+ * for position p when its sequence number equals p.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/log.h>
+#include <kernel/serial.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+
+#define LOG_RING_MASK           (LOG_RING_SLOTS - 1)
+
+_Static_assert((LOG_RING_SLOTS & LOG_RING_MASK) == 0, "ring size must be a power of two");
+_Static_assert(sizeof(log_slot_t) == LOG_SLOT_SIZE, "slot layout");
+_Static_assert(LOG_TEXT_MAX <= 255, "slot length is a byte");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static log_slot_t log_ring[LOG_RING_SLOTS] ALIGNED(64);
+static uint32_t ring_head;              /* Next position to claim */
+static uint32_t ring_tail;              /* Next position to transmit */
+static uint32_t tail_offset;            /* Bytes of the tail record sent */
+
+static log_level_t console_level = LOG_DEFAULT_LEVEL;
+static volatile bool log_sync = true;   /* Bypass the ring */
+static log_stats_t log_stats;
+
+static const char *const level_prefix[] = {
+    [LOG_EMERG] = "[EMERG] ",
+    [LOG_ERR]   = "[ERROR] ",
+    [LOG_WARN]  = "[WARN] ",
+    [LOG_INFO]  = "[BOOT] ",
+    [LOG_DEBUG] = "[DEBUG] ",
+};
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static uint32_t append(char *buf, uint32_t len, uint32_t max, const char *str) {
+    while (*str && len < max) {
+        buf[len++] = *str++;
+    }
+    return len;
+}
+
+static uint32_t append_hex(char *buf, uint32_t len, uint32_t max, uint64_t value) {
+    len = append(buf, len, max, "0x");
+    for (int shift = 60; shift >= 0 && len < max; shift -= 4) {
+        buf[len++] = hex_digits[(value >> shift) & 0xF];
+    }
+    return len;
+}
+
+/**
+ * Format "<prefix><message>[0x<hex>]\r\n" into buf, truncating the body
+ */
+static uint32_t format_line(char *buf, const char *prefix, const char *message,
+                            bool with_hex, uint64_t value) {
+    uint32_t max = LOG_TEXT_MAX - 2;    /* Room for the line ending */
+    uint32_t len = 0;
+
+    if (prefix) {
+        len = append(buf, len, max, prefix);
+    }
+    len = append(buf, len, max, message);
+    if (with_hex) {
+        len = append_hex(buf, len, max, value);
+    }
+    if (prefix) {
+        buf[len++] = '\r';
+        buf[len++] = '\n';
+    }
+
+    return len;
+}
+
+/**
+ * Claim the next free slot
+ *
+ * @return Slot and its position, or NULL if the ring is full
+ */
+static log_slot_t *ring_claim(uint32_t *position) {
+    uint32_t pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+
+    for (;;) {
+        log_slot_t *slot = &log_ring[pos & LOG_RING_MASK];
+        uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(seq - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring_head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *position = pos;
+                return slot;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&ring_head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * Emit one line through the ring, or directly in synchronous mode
+ */
+static void log_emit(log_level_t level, const char *prefix, const char *message,
+                     bool with_hex, uint64_t value) {
+    if (!prefix && !with_hex && !*message) {
+        return;
+    }
+
+    if (level > console_level) {
+        __atomic_fetch_add(&log_stats.filtered, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (log_sync) {
+        char line[LOG_TEXT_MAX];
+        uint32_t len = format_line(line, prefix, message, with_hex, value);
+        serial_write_sync(line, len);
+        __atomic_fetch_add(&log_stats.written, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t pos;
+    log_slot_t *slot = ring_claim(&pos);
+    if (!slot) {
+        __atomic_fetch_add(&log_stats.dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    slot->level = level;
+    slot->len = format_line(slot->text, prefix, message, with_hex, value);
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&log_stats.written, 1, __ATOMIC_RELAXED);
+
+    serial_tx_kick();
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Reset the ring; output stays synchronous until log_set_sync(false)
+ */
+void log_init(void) {
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+        log_ring[i].seq = i;
+        log_ring[i].len = 0;
+    }
+
+    ring_head = 0;
+    ring_tail = 0;
+    tail_offset = 0;
+    log_sync = true;
+}
+
+/**
+ * Log a line at `level`
+ */
+void klog(log_level_t level, const char *message) {
+    log_emit(level, level_prefix[level], message, false, 0);
+}
+
+/**
+ * Log a line at `level` ending in a 64-bit hex value
+ */
+void klog_hex(log_level_t level, const char *message, uint64_t value) {
+    log_emit(level, level_prefix[level], message, true, value);
+}
+
+void log_set_level(log_level_t level) {
+    console_level = level;
+}
+
+log_level_t log_get_level(void) {
+    return console_level;
+}
+
+/**
+ * Check whether a message at `level` would be printed
+ *
+ * Lets callers skip building expensive output that would be filtered.
+ */
+bool log_enabled(log_level_t level) {
+    return level <= console_level;
+}
+
+/**
+ * Select synchronous output (true) or the interrupt-driven ring (false)
+ *
+ * Switching to synchronous output first drains anything still queued.
+ */
+void log_set_sync(bool sync) {
+    if (sync) {
+        log_sync = true;
+        log_flush();
+    } else {
+        log_sync = false;
+        serial_tx_kick();
+    }
+}
+
+/**
+ * Transmit everything in the ring by polling the UART
+ */
+void log_flush(void) {
+    uint64_t flags = cpu_irq_save();
+    char c;
+
+    while (log_ring_pop(&c)) {
+        serial_putc_sync(c);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Drain the ring, print the panic message synchronously and halt
+ */
+void log_panic(const char *message) {
+    __asm__ volatile("cli");
+
+    log_sync = true;
+    serial_disable_irq();
+
+    char c;
+    while (log_ring_pop(&c)) {
+        serial_putc_sync(c);
+    }
+
+    char line[LOG_TEXT_MAX];
+    uint32_t len = format_line(line, "\r\n*** KERNEL PANIC *** ", message, false, 0);
+    for (uint32_t i = 0; i < len; i++) {
+        serial_putc_sync(line[i]);
+    }
+
+    for (;;) {
+        __asm__ volatile("hlt");
+    }
+}
+
+void log_get_stats(log_stats_t *stats) {
+    stats->written = __atomic_load_n(&log_stats.written, __ATOMIC_RELAXED);
+    stats->dropped = __atomic_load_n(&log_stats.dropped, __ATOMIC_RELAXED);
+    stats->filtered = __atomic_load_n(&log_stats.filtered, __ATOMIC_RELAXED);
+}
+
+/**
+ * Take the next byte to transmit (single consumer)
+ */
+bool log_ring_pop(char *c) {
+    log_slot_t *slot = &log_ring[ring_tail & LOG_RING_MASK];
+
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring_tail + 1) {
+        return false;
+    }
+
+    *c = slot->text[tail_offset++];
+
+    if (tail_offset >= slot->len) {
+        tail_offset = 0;
+        __atomic_store_n(&slot->seq, ring_tail + LOG_RING_SLOTS, __ATOMIC_RELEASE);
+        ring_tail++;
+    }
+
+    return true;
+}
+
+bool log_ring_empty(void) {
+    log_slot_t *slot = &log_ring[ring_tail & LOG_RING_MASK];
+    return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != ring_tail + 1;
+}
+
+/* ============================================================================
+ * Early Console Compatibility
+ * ============================================================================ */
+
+/**
+ * Raw text, no prefix or line ending
+ */
+void early_console_write(const char *str) {
+    log_emit(LOG_INFO, NULL, str, false, 0);
+}
+
+/**
+ * A hex value on a line of its own
+ */
+void early_console_write_hex(uint64_t value) {
+    log_emit(LOG_INFO, "", "", true, value);
+}
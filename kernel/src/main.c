@@ -4,6 +4,16 @@
 #include <kernel/interrupts.h>
 #include <kernel/ipc.h>
 #include <kernel/process.h>
+#include <kernel/pci.h>
+#include <kernel/syscall.h>
+#include <kernel/log.h>
+#include <kernel/serial.h>
+#include <kernel/trace.h>
+#include <kernel/profile.h>
+#include <kernel/boot_stage.h>
+#include <kernel/kbench.h>
+#include <kernel/gcov.h>
+#include <kernel/entropy.h>
 
 // External symbols from linker script
 extern uint8_t __bss_start;
@@ -17,16 +27,63 @@ static boot_config_t boot_config;
 // Forward declarations
 static void kernel_init(void);
 static void early_init(void);
-static void hal_init(void);
-static void memory_subsystem_init(void);
-static void interrupts_subsystem_init(void);
-static void core_services_init(void);
-static void ipc_subsystem_init(void);
-static void process_subsystem_init(void);
+static status_t hal_init(void);
+static status_t memory_subsystem_init(void);
+static status_t interrupts_subsystem_init(void);
+static status_t entropy_subsystem_init(void);
+static status_t process_subsystem_init(void);
+static status_t ipc_subsystem_init(void);
+static status_t syscall_subsystem_init(void);
+
+// Boot stages (see kernel/boot_stage.h)
+enum {
+    STAGE_MEMORY = 0,
+    STAGE_PCI,
+    STAGE_INTERRUPTS,
+    STAGE_ENTROPY,
+    STAGE_PROCESS,
+    STAGE_IPC,
+    STAGE_SYSCALL,
+    STAGE_COUNT
+};
+
+// TODO: quantum subsystem stages
+static boot_stage_t boot_stages[STAGE_COUNT] = {
+    [STAGE_MEMORY] = {
+        .name = "memory", .fn = memory_subsystem_init,
+    },
+    [STAGE_PCI] = {
+        .name = "pci", .fn = hal_init,
+    },
+    [STAGE_INTERRUPTS] = {
+        .name = "interrupts", .fn = interrupts_subsystem_init,
+        .deps = BOOT_STAGE_DEP(STAGE_MEMORY),
+    },
+    [STAGE_ENTROPY] = {
+        .name = "entropy", .fn = entropy_subsystem_init,
+        .deps = BOOT_STAGE_DEP(STAGE_INTERRUPTS),
+    },
+    [STAGE_PROCESS] = {
+        .name = "process", .fn = process_subsystem_init,
+        .deps = BOOT_STAGE_DEP(STAGE_MEMORY) | BOOT_STAGE_DEP(STAGE_INTERRUPTS),
+    },
+    [STAGE_IPC] = {
+        .name = "ipc", .fn = ipc_subsystem_init,
+        .deps = BOOT_STAGE_DEP(STAGE_MEMORY),
+    },
+    [STAGE_SYSCALL] = {
+        .name = "syscall", .fn = syscall_subsystem_init,
+        .deps = BOOT_STAGE_DEP(STAGE_PROCESS) | BOOT_STAGE_DEP(STAGE_IPC),
+    },
+};
+
+static boot_profile_t boot_profile;
 
 // Kernel main entry point
 void kernel_main(uint32_t magic, uint32_t info_addr) {
+    boot_profile_start(&boot_profile);
     current_boot_state = BOOT_STATE_KERNEL_ENTRY;
+    boot_run_constructors();
     
     // Validate multiboot
     if (!boot_validate_multiboot(magic, info_addr)) {
@@ -68,21 +125,27 @@ static void early_init(void) {
 static void kernel_init(void) {
     boot_log("Starting kernel initialization...");
     
-    // Initialize HAL
-    hal_init();
-    
-    // Initialize memory management
-    memory_subsystem_init();
-
-    // Initialize interrupt system
-    interrupts_subsystem_init();
-    
-    // Initialize core services
-    core_services_init();
+    // Everything needed to reach "ready", in dependency order
+    if (boot_stages_run(boot_stages, STAGE_COUNT, false, &boot_profile) != STATUS_SUCCESS) {
+        boot_panic("Kernel initialization failed");
+    }
+    current_boot_state = BOOT_STATE_COMPLETE;
     
     boot_log("Kernel initialization complete");
     boot_log("QuantumOS ready");
     
+    // Deferred stages, off the critical path
+    boot_stages_run(boot_stages, STAGE_COUNT, true, &boot_profile);
+    boot_stages_report(boot_stages, STAGE_COUNT, &boot_profile);
+    
+#ifdef KERNEL_BENCH
+    // Benchmark kernel (make bench-qemu): run the suite, export profile
+    // counters if instrumented (make pgo) and leave QEMU
+    status_t bench_result = kbench_run();
+    gcov_dump();
+    kbench_exit(bench_result == STATUS_SUCCESS ? KBENCH_EXIT_SUCCESS : KBENCH_EXIT_FAILURE);
+#endif
+    
     // Enter idle loop (for now)
     while (1) {
         __asm__ volatile("hlt");
@@ -90,7 +153,7 @@ static void kernel_init(void) {
 }
 
 // HAL initialization
-static void hal_init(void) {
+static status_t hal_init(void) {
     current_boot_state = BOOT_STATE_HAL_INIT;
     boot_log("Initializing HAL...");
     
@@ -99,79 +162,108 @@ static void hal_init(void) {
     // - Feature detection
     // - Basic hardware setup
     
+    // Enumerate PCI devices (MSI/MSI-X is set up per driver)
+    pci_init();
+    
     boot_log("HAL initialization complete");
+    return STATUS_SUCCESS;
 }
 
 // Memory management initialization
-static void memory_subsystem_init(void) {
+static status_t memory_subsystem_init(void) {
     current_boot_state = BOOT_STATE_MEMORY_INIT;
     boot_log("Initializing memory management...");
 
     // Call the real memory_init from memory.h
     mem_result_t result = memory_init();
     if (result != MEM_SUCCESS) {
-        boot_log("Warning: Memory init returned non-success");
+        klog(LOG_WARN, "Memory init returned non-success");
     }
 
     boot_log("Memory management initialization complete");
+    return STATUS_SUCCESS;
 }
 
 // Interrupt system initialization
-static void interrupts_subsystem_init(void) {
+static status_t interrupts_subsystem_init(void) {
     current_boot_state = BOOT_STATE_INTERRUPTS_INIT;
     boot_log("Initializing interrupt system...");
 
     // Call the real interrupts_init from interrupts.h
     irq_result_t result = interrupts_init();
     if (result != IRQ_SUCCESS) {
-        boot_log("Warning: Interrupts init returned non-success");
+        klog(LOG_WARN, "Interrupts init returned non-success");
     }
 
-    boot_log("Interrupt system initialization complete");
-}
+    // Binary tracepoints, controlled from the serial console
+    trace_init();
 
-// Core services initialization
-static void core_services_init(void) {
-    current_boot_state = BOOT_STATE_CORE_SERVICES;
-    boot_log("Initializing core services...");
+    // Sampling profiler (PMU overflow NMI, or the timer tick)
+    profile_init();
 
-    // Initialize process management system
-    process_subsystem_init();
+    // Console output is buffered and drained by the UART from here on
+    serial_enable_irq();
+    log_set_sync(false);
 
-    // Initialize IPC system
-    ipc_subsystem_init();
+    boot_log("Interrupt system initialization complete");
+    return STATUS_SUCCESS;
+}
 
-    // TODO: Initialize remaining core services
-    // - Capability system
-    // - Quantum subsystem
+// Entropy pool, seeded from the CPU and TSC jitter; interrupts feed it from here on
+static status_t entropy_subsystem_init(void) {
+    entropy_stats_t stats;
+
+    status_t result = entropy_init();
+    if (result != STATUS_SUCCESS) {
+        return result;
+    }
 
-    boot_log("Core services initialization complete");
+    entropy_get_stats(&stats);
+    klog_hex(LOG_INFO, "Entropy seed bits: ", stats.seed_bits);
+    if (!stats.has_rdseed && !stats.has_rdrand) {
+        klog(LOG_WARN, "No RDSEED/RDRAND: entropy pool seeded from TSC jitter only");
+    }
+    return STATUS_SUCCESS;
 }
 
 // IPC subsystem initialization
-static void ipc_subsystem_init(void) {
+static status_t ipc_subsystem_init(void) {
     boot_log("Initializing IPC subsystem...");
 
     ipc_result_t result = ipc_init();
     if (result != IPC_SUCCESS) {
-        boot_panic("Failed to initialize IPC subsystem");
-        return;
+        return STATUS_ERROR;
     }
 
     boot_log("IPC subsystem initialized");
+    return STATUS_SUCCESS;
+}
+
+// System call initialization
+static status_t syscall_subsystem_init(void) {
+    boot_log("Initializing system calls...");
+
+    status_t result = syscall_init();
+    if (result != STATUS_SUCCESS && result != STATUS_NOT_IMPLEMENTED) {
+        return result;
+    }
+
+    boot_log("System calls initialized");
+    return STATUS_SUCCESS;
 }
 
 // Process subsystem initialization
-static void process_subsystem_init(void) {
+static status_t process_subsystem_init(void) {
+    current_boot_state = BOOT_STATE_CORE_SERVICES;
     boot_log("Initializing process subsystem...");
 
     status_t result = process_init();
     if (result != STATUS_SUCCESS) {
-        boot_panic("Failed to initialize process subsystem");
-        return;
+        return result;
     }
 
     boot_log("Process subsystem initialized");
+    return STATUS_SUCCESS;
 }
 
 // Boot validation
@@ -188,36 +280,49 @@ bool boot_validate_multiboot(uint32_t magic, uint32_t info_addr) {
     return true;
 }
 
+// Run .init_array constructors (profile counters register here under PGO=gen)
+void boot_run_constructors(void) {
+    extern void (*__init_array_start[])(void);
+    extern void (*__init_array_end[])(void);
+
+    for (void (**ctor)(void) = __init_array_start; ctor < __init_array_end; ctor++) {
+        (*ctor)();
+    }
+}
+
 // Boot logging
 void boot_log(const char *message) {
-    early_console_write("[BOOT] ");
-    early_console_write(message);
-    early_console_write("\r\n");
+    klog(LOG_INFO, message);
 }
 
-// boot_panic is provided by boot.S (assembly implementation)
+// Flush pending log output, report and halt
+void boot_panic(const char *message) {
+    log_panic(message);
+}
 
 // Early console initialization
 void early_console_init(void) {
-    // Initialize COM1 serial port (0x3F8)
-    // TODO: Proper serial port initialization
+    // COM1 with polled output until the UART interrupt is available
+    serial_init();
+    log_init();
 }
 
 // Utility functions
 void *memset(void *ptr, int value, size_t num) {
-    uint8_t *p = (uint8_t*)ptr;
-    while (num--) {
-        *p++ = (uint8_t)value;
-    }
+    void *dest = ptr;
+    __asm__ volatile("rep stosb"
+                     : "+D"(dest), "+c"(num)
+                     : "a"(value)
+                     : "memory");
     return ptr;
 }
 
 void *memcpy(void *dest, const void *src, size_t num) {
-    uint8_t *d = (uint8_t*)dest;
-    const uint8_t *s = (const uint8_t*)src;
-    while (num--) {
-        *d++ = *s++;
-    }
+    void *d = dest;
+    __asm__ volatile("rep movsb"
+                     : "+D"(d), "+S"(src), "+c"(num)
+                     :
+                     : "memory");
     return dest;
 }
 
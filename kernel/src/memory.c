@@ -1,6 +1,7 @@
 #include <kernel/types.h>
 #include <kernel/memory.h>
 #include <kernel/boot.h>
+#include <kernel/log.h>
 
 // External symbols
 extern uint8_t __end;
@@ -30,7 +31,7 @@ mem_result_t pmm_init(uint64_t total_memory) {
     
     // Reserve frames used by kernel
     uint64_t kernel_end = (uint64_t)pmm.frame_bitmap + bitmap_size;
-    uint64_t kernel_frames = (kernel_end + PAGE_SIZE - 1) / PAGE_SIZE;
+    uint64_t kernel_frames = MIN((kernel_end + PAGE_SIZE - 1) / PAGE_SIZE, total_frames);
     
     for (uint64_t i = 0; i < kernel_frames; i++) {
         uint32_t frame = i;
@@ -42,8 +43,8 @@ mem_result_t pmm_init(uint64_t total_memory) {
     }
     
     boot_log("Physical memory manager initialized");
-    boot_log("Total frames: "); early_console_write_hex(pmm.total_frames);
-    boot_log("Free frames: "); early_console_write_hex(pmm.free_frames);
+    klog_hex(LOG_INFO, "Total frames: ", pmm.total_frames);
+    klog_hex(LOG_INFO, "Free frames: ", pmm.free_frames);
     
     return MEM_SUCCESS;
 }
@@ -323,7 +324,7 @@ mem_result_t memory_init(void) {
     
     // Initialize physical memory manager
     // TODO: Get actual memory size from multiboot
-    uint64_t total_memory = 128 * 1024 * 1024; // 128MB for testing
+    uint64_t total_memory = 64 * 1024 * 1024; // 64MB, the QEMU -m used by the Makefile
     mem_result_t result = pmm_init(total_memory);
     if (result != MEM_SUCCESS) {
         return result;
@@ -0,0 +1,194 @@
+/**
+ * QuantumOS MSI Associative Memory
+ *
+ * msi_assoc_put/get/query/forget (msi/include/msi.h) over a single
+ * assoc_index_t. The store is created on the first put, or earlier by
+ * msi_assoc_configure(), in one allocation from the kernel heap; its
+ * dimension is fixed from then on and vectors of any other length are
+ * rejected.
+ *
+ * Entries handed back by get and query point into the store. Their
+ * vectors and payloads are read-only and stay valid until the entry is
+ * forgotten and put again with a larger payload.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/assoc_index.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/capability.h>
+#include <kernel/types.h>
+#include <msi.h>
+
+#define MSI_ASSOC_DEFAULT_CAPACITY      4096
+#define MSI_ASSOC_DEFAULT_PAYLOAD       (256 * 1024)
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static assoc_index_t *assoc_store;
+static assoc_match_t assoc_matches[ASSOC_MAX_EF];
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static msi_result_t to_msi_result(status_t status) {
+    switch (status) {
+    case STATUS_SUCCESS:            return MSI_SUCCESS;
+    case STATUS_INVALID_ARG:        return MSI_ERROR_INVALID_ARG;
+    case STATUS_NO_MEMORY:          return MSI_ERROR_NO_MEMORY;
+    case STATUS_NOT_FOUND:          return MSI_ERROR_NOT_FOUND;
+    case STATUS_PERMISSION_DENIED:  return MSI_ERROR_PERMISSION_DENIED;
+    case STATUS_BUSY:               return MSI_ERROR_ASSOC_COLLISION;
+    default:                        return MSI_ERROR_INVALID_ARG;
+    }
+}
+
+static status_t store_create(const assoc_config_t *config) {
+    size_t size = assoc_index_arena_size(config);
+    uint8_t *arena;
+
+    if (!size) {
+        return STATUS_INVALID_ARG;
+    }
+    /* kmalloc only guarantees 8-byte alignment */
+    arena = kmalloc(size + ASSOC_VECTOR_ALIGN);
+    if (!arena) {
+        return STATUS_NO_MEMORY;
+    }
+    arena = (uint8_t *)ALIGN_UP((uintptr_t)arena, ASSOC_VECTOR_ALIGN);
+    return assoc_index_create(arena, size, config, &assoc_store);
+}
+
+static void fill_entry(uint32_t id, msi_assoc_entry_t *entry) {
+    uint32_t size = 0;
+
+    entry->vector = (uint8_t *)assoc_index_vector(assoc_store, id);
+    entry->payload = (void *)assoc_index_payload(assoc_store, id, &size);
+    entry->payload_size = size;
+    entry->dimensions = entry->vector ? assoc_index_dimensions(assoc_store) : 0;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+status_t msi_assoc_configure(const assoc_config_t *config) {
+    if (!config) {
+        return STATUS_INVALID_ARG;
+    }
+    if (assoc_store) {
+        return STATUS_BUSY;
+    }
+    return store_create(config);
+}
+
+assoc_index_t *msi_assoc_index(void) {
+    return assoc_store;
+}
+
+msi_result_t msi_assoc_put(const msi_assoc_entry_t *entry) {
+    if (!cap_current_has(CAP_RIGHT_MSI_ASSOC)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!entry || !entry->vector || !entry->dimensions ||
+        entry->payload_size > 0xFFFFFFFFULL || (entry->payload_size && !entry->payload)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+
+    if (!assoc_store) {
+        assoc_config_t config = {
+            .dimensions = (uint32_t)MIN(entry->dimensions, (size_t)ASSOC_MAX_DIMENSIONS + 1),
+            .capacity = MSI_ASSOC_DEFAULT_CAPACITY,
+            .payload_bytes = MSI_ASSOC_DEFAULT_PAYLOAD,
+            .metric = ASSOC_METRIC_L2,
+        };
+        status_t result = store_create(&config);
+        if (result != STATUS_SUCCESS) {
+            return to_msi_result(result);
+        }
+    }
+    if (entry->dimensions != assoc_index_dimensions(assoc_store)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+
+    return to_msi_result(assoc_index_insert(assoc_store, entry->vector, entry->payload,
+                                            (uint32_t)entry->payload_size, NULL));
+}
+
+msi_result_t msi_assoc_get(const uint8_t *vector, msi_assoc_entry_t *result) {
+    uint32_t id;
+    status_t status;
+
+    if (!cap_current_has(CAP_RIGHT_MSI_ASSOC)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!vector || !result) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (!assoc_store) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+
+    status = assoc_index_lookup(assoc_store, vector, &id);
+    if (status != STATUS_SUCCESS) {
+        return to_msi_result(status);
+    }
+    fill_entry(id, result);
+    return MSI_SUCCESS;
+}
+
+/* Unused result slots are zeroed; MSI_ERROR_NOT_FOUND if there are no matches */
+msi_result_t msi_assoc_query(const uint8_t *vector, msi_assoc_entry_t *results,
+                             size_t max_results) {
+    uint32_t found = 0;
+
+    if (!cap_current_has(CAP_RIGHT_MSI_ASSOC)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!vector || !results || !max_results) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (assoc_store) {
+        found = assoc_index_search(assoc_store, vector,
+                                   (uint32_t)MIN(max_results, (size_t)ASSOC_MAX_EF), 0,
+                                   assoc_matches);
+    }
+
+    for (size_t i = 0; i < max_results; i++) {
+        if (i < found) {
+            fill_entry(assoc_matches[i].id, &results[i]);
+        } else {
+            memset(&results[i], 0, sizeof(results[i]));
+        }
+    }
+    return found ? MSI_SUCCESS : MSI_ERROR_NOT_FOUND;
+}
+
+msi_result_t msi_assoc_forget(const uint8_t *vector) {
+    uint32_t id;
+    status_t status;
+
+    if (!cap_current_has(CAP_RIGHT_MSI_ASSOC)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!vector) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (!assoc_store) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+
+    status = assoc_index_lookup(assoc_store, vector, &id);
+    if (status == STATUS_SUCCESS) {
+        status = assoc_index_remove(assoc_store, id);
+    }
+    return to_msi_result(status);
+}
@@ -0,0 +1,1330 @@
+/**
+ * QuantumOS Associative Memory Index Implementation
+ *
+ * HNSW as described by Malkov and Yashunin, with the neighbour
+ * selection heuristic and without extending candidates. Levels are
+ * drawn so that P(level >= l) = M^-l, which needs no floating point.
+ * Search heaps and the selection buffers are fixed arrays in the arena;
+ * the visited set is a per-node tag compared against an epoch that is
+ * bumped once per layer search, so it never has to be cleared.
+ *
+ * Nodes are stored first and linked into the graph separately. Below
+ * the flat threshold nothing is linked and queries scan the vector
+ * matrix; the insert that reaches the threshold links every node, and
+ * from then on each insert links its own. Should linking run out of
+ * arena the node stays unlinked and queries scan until a later insert
+ * manages to link the backlog.
+ *
+ * A quantised store writes each vector's code next to it on insert.
+ * Its flat scan runs the code kernels (nibble L2/dot, or Hamming over
+ * the bit codes) into a heap of rerank * k candidates and computes full
+ * distances for those only. Padding codes are zero on both sides, so
+ * they add nothing to any distance.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/assoc_index.h>
+#include <kernel/boot.h>
+#include <kernel/types.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#define ASSOC_MAGIC             0x43535341U     /* "ASSC" */
+#define ASSOC_NODE_DELETED      0x01
+#define ASSOC_DOT_MAX           (255U * 255U)   /* Largest product of two bytes */
+#define ASSOC_NIBBLE_DOT_MAX    (15U * 15U)     /* Largest product of two 4-bit codes */
+#define ASSOC_MAX_OFFSET        0xFFFFFFFFULL
+
+/* CPUID leaf 1, ECX */
+#define CPUID_1_ECX_SSE42       BIT(20)         /* CRC32 instruction */
+#define CPUID_1_ECX_POPCNT      BIT(23)
+
+#define CRC32C_POLY             0x82F63B78U     /* Castagnoli, reflected */
+
+/* ============================================================================
+ * Internal Types
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t upper;                     /* Offset of layer 1..level links, 0 if none */
+    uint32_t payload;                   /* Offset of the payload copy, 0 if none */
+    uint32_t payload_size;
+    uint8_t level;
+    uint8_t flags;
+    uint16_t reserved;
+} assoc_node_t;
+
+/* Candidate heaps hold up to twice ef; see push_candidate() */
+typedef struct {
+    assoc_match_t candidates[2 * ASSOC_MAX_EF];
+    assoc_match_t results[ASSOC_MAX_EF + 1];
+    assoc_match_t sorted[ASSOC_MAX_EF + 1];
+    assoc_match_t prune[2 * ASSOC_MAX_M + 1];
+    uint32_t selected[2 * ASSOC_MAX_M];
+    uint8_t query_code[ASSOC_MAX_DIMENSIONS / 2];
+} assoc_scratch_t;
+
+struct assoc_index {
+    uint32_t magic;
+    uint32_t dimensions;
+    uint32_t stride;                    /* Bytes between vectors */
+    uint32_t capacity;
+    uint32_t m;
+    uint32_t m0;                        /* Layer-0 link limit, 2 * m */
+    uint32_t ef_construction;
+    uint32_t ef_search;
+    assoc_metric_t metric;
+    assoc_quant_t quant;
+    uint32_t code_bytes;                /* Quantised length, 0 if not quantised */
+    uint32_t code_stride;
+    uint32_t rerank;
+    uint32_t flat_threshold;
+    uint32_t count;                     /* Nodes allocated, ids 0..count-1 */
+    uint32_t linked;                    /* Nodes 0..linked-1 are in the graph */
+    uint32_t live;
+    uint32_t deleted;
+    uint32_t entry;                     /* Top-level entry point */
+    uint32_t max_level;
+    uint32_t hash_mask;
+    uint32_t epoch;                     /* Visited tag of the current search */
+    uint64_t rng;
+    uint64_t size;
+    uint64_t used;                      /* Bump pointer of the upper links */
+    uint64_t upper_end;
+    uint64_t payload_used;              /* Bump pointer of the payload slab */
+    uint64_t distance_evals;
+
+    /* Region offsets from the start of the arena */
+    uint32_t nodes;
+    uint32_t vectors;
+    uint32_t codes;
+    uint32_t links0;
+    uint32_t hash;
+    uint32_t visited;
+    uint32_t scratch;
+    uint32_t payloads;
+};
+
+typedef uint32_t (*assoc_kernel_t)(const uint8_t *a, const uint8_t *b, uint32_t n);
+typedef uint32_t (*assoc_hash_t)(const uint8_t *data, uint32_t n);
+
+static assoc_kernel_t assoc_kernels[ASSOC_METRIC_COUNT];
+static assoc_kernel_t assoc_nibble_kernels[ASSOC_METRIC_COUNT];     /* L2 and DOT */
+static assoc_hash_t assoc_hash;
+static uint32_t crc32c_table[256];
+
+/* ============================================================================
+ * Distance Kernels
+ * ============================================================================ */
+
+static uint32_t l2_scalar(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    uint32_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        int32_t d0 = (int32_t)a[i] - b[i];
+        int32_t d1 = (int32_t)a[i + 1] - b[i + 1];
+        int32_t d2 = (int32_t)a[i + 2] - b[i + 2];
+        int32_t d3 = (int32_t)a[i + 3] - b[i + 3];
+        s0 += (uint32_t)(d0 * d0);
+        s1 += (uint32_t)(d1 * d1);
+        s2 += (uint32_t)(d2 * d2);
+        s3 += (uint32_t)(d3 * d3);
+    }
+    for (; i < n; i++) {
+        int32_t d = (int32_t)a[i] - b[i];
+        s0 += (uint32_t)(d * d);
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+static uint32_t dot_scalar(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    uint32_t i = 0;
+
+    for (; i + 4 <= n; i += 4) {
+        s0 += (uint32_t)a[i] * b[i];
+        s1 += (uint32_t)a[i + 1] * b[i + 1];
+        s2 += (uint32_t)a[i + 2] * b[i + 2];
+        s3 += (uint32_t)a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++) {
+        s0 += (uint32_t)a[i] * b[i];
+    }
+    return s0 + s1 + s2 + s3;
+}
+
+/* 4-bit codes, two dimensions per byte */
+static uint32_t nibble_l2_scalar(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    uint32_t s0 = 0, s1 = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t lo = (int32_t)(a[i] & 0x0F) - (b[i] & 0x0F);
+        int32_t hi = (int32_t)(a[i] >> 4) - (b[i] >> 4);
+        s0 += (uint32_t)(lo * lo);
+        s1 += (uint32_t)(hi * hi);
+    }
+    return s0 + s1;
+}
+
+static uint32_t nibble_dot_scalar(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    uint32_t s0 = 0, s1 = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        s0 += (uint32_t)(a[i] & 0x0F) * (b[i] & 0x0F);
+        s1 += (uint32_t)(a[i] >> 4) * (b[i] >> 4);
+    }
+    return s0 + s1;
+}
+
+static inline uint64_t load64(const uint8_t *p) {
+    uint64_t value;
+    __builtin_memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t popcount64_swar(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (uint32_t)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static inline uint32_t popcount64_hw(uint64_t x) {
+    uint64_t count;
+    __asm__("popcnt %1, %0" : "=r"(count) : "rm"(x));
+    return (uint32_t)count;
+}
+
+#define DEFINE_HAMMING(name, popcount)                                      \
+    static uint32_t name(const uint8_t *a, const uint8_t *b, uint32_t n) {  \
+        uint32_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;                            \
+        uint32_t i = 0;                                                     \
+        for (; i + 32 <= n; i += 32) {                                      \
+            s0 += popcount(load64(a + i) ^ load64(b + i));                  \
+            s1 += popcount(load64(a + i + 8) ^ load64(b + i + 8));          \
+            s2 += popcount(load64(a + i + 16) ^ load64(b + i + 16));        \
+            s3 += popcount(load64(a + i + 24) ^ load64(b + i + 24));        \
+        }                                                                   \
+        for (; i + 8 <= n; i += 8) {                                        \
+            s0 += popcount(load64(a + i) ^ load64(b + i));                  \
+        }                                                                   \
+        for (; i < n; i++) {                                                \
+            s0 += popcount((uint64_t)(a[i] ^ b[i]));                        \
+        }                                                                   \
+        return s0 + s1 + s2 + s3;                                           \
+    }
+
+DEFINE_HAMMING(hamming_swar, popcount64_swar)
+DEFINE_HAMMING(hamming_popcnt, popcount64_hw)
+
+#if defined(__SSE2__)
+
+static inline uint32_t hsum_epi32(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0x4E));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, 0xB1));
+    return (uint32_t)_mm_cvtsi128_si32(v);
+}
+
+static uint32_t l2_sse2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i d = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+        __m128i lo = _mm_unpacklo_epi8(d, zero);
+        __m128i hi = _mm_unpackhi_epi8(d, zero);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, lo));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, hi));
+    }
+    return hsum_epi32(acc) + l2_scalar(a + i, b + i, n - i);
+}
+
+static uint32_t dot_sse2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(va, zero),
+                                                _mm_unpacklo_epi8(vb, zero)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(va, zero),
+                                                _mm_unpackhi_epi8(vb, zero)));
+    }
+    return hsum_epi32(acc) + dot_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static uint32_t l2_avx2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i d = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+        __m256i lo = _mm256_unpacklo_epi8(d, zero);
+        __m256i hi = _mm256_unpackhi_epi8(d, zero);
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(lo, lo));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(hi, hi));
+    }
+    uint32_t sum = hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(acc),
+                                            _mm256_extracti128_si256(acc, 1)));
+    /* Legacy SSE code after this pays a state transition otherwise */
+    _mm256_zeroupper();
+    return sum + l2_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static uint32_t dot_avx2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_unpacklo_epi8(va, zero),
+                                                      _mm256_unpacklo_epi8(vb, zero)));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(_mm256_unpackhi_epi8(va, zero),
+                                                      _mm256_unpackhi_epi8(vb, zero)));
+    }
+    uint32_t sum = hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(acc),
+                                            _mm256_extracti128_si256(acc, 1)));
+    /* Legacy SSE code after this pays a state transition otherwise */
+    _mm256_zeroupper();
+    return sum + dot_sse2(a + i, b + i, n - i);
+}
+
+static inline __m128i abs_diff_epu8(__m128i a, __m128i b) {
+    return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+static inline __m128i sum_squares_epu8(__m128i acc, __m128i d) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_unpacklo_epi8(d, zero);
+    __m128i hi = _mm_unpackhi_epi8(d, zero);
+    return _mm_add_epi32(acc, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+}
+
+static uint32_t nibble_l2_sse2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i dlo = abs_diff_epu8(_mm_and_si128(va, mask), _mm_and_si128(vb, mask));
+        __m128i dhi = abs_diff_epu8(_mm_and_si128(_mm_srli_epi16(va, 4), mask),
+                                    _mm_and_si128(_mm_srli_epi16(vb, 4), mask));
+        acc = sum_squares_epu8(acc, dlo);
+        acc = sum_squares_epu8(acc, dhi);
+    }
+    return hsum_epi32(acc) + nibble_l2_scalar(a + i, b + i, n - i);
+}
+
+static uint32_t nibble_dot_sse2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+        __m128i alo = _mm_and_si128(va, mask), ahi = _mm_and_si128(_mm_srli_epi16(va, 4), mask);
+        __m128i blo = _mm_and_si128(vb, mask), bhi = _mm_and_si128(_mm_srli_epi16(vb, 4), mask);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(alo, zero),
+                                                _mm_unpacklo_epi8(blo, zero)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(alo, zero),
+                                                _mm_unpackhi_epi8(blo, zero)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpacklo_epi8(ahi, zero),
+                                                _mm_unpacklo_epi8(bhi, zero)));
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_unpackhi_epi8(ahi, zero),
+                                                _mm_unpackhi_epi8(bhi, zero)));
+    }
+    return hsum_epi32(acc) + nibble_dot_scalar(a + i, b + i, n - i);
+}
+
+/* Squares of 0..15 fit a byte, so a table shuffle squares 32 differences at once */
+__attribute__((target("avx2")))
+static uint32_t nibble_l2_avx2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i squares = _mm256_setr_epi8(
+        0, 1, 4, 9, 16, 25, 36, 49, 64, 81, 100, 121, (char)144, (char)169, (char)196, (char)225,
+        0, 1, 4, 9, 16, 25, 36, 49, 64, 81, 100, 121, (char)144, (char)169, (char)196, (char)225);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i acc = zero;
+    uint32_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i alo = _mm256_and_si256(va, mask);
+        __m256i blo = _mm256_and_si256(vb, mask);
+        __m256i ahi = _mm256_and_si256(_mm256_srli_epi16(va, 4), mask);
+        __m256i bhi = _mm256_and_si256(_mm256_srli_epi16(vb, 4), mask);
+        __m256i dlo = _mm256_or_si256(_mm256_subs_epu8(alo, blo), _mm256_subs_epu8(blo, alo));
+        __m256i dhi = _mm256_or_si256(_mm256_subs_epu8(ahi, bhi), _mm256_subs_epu8(bhi, ahi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_shuffle_epi8(squares, dlo), zero));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_shuffle_epi8(squares, dhi), zero));
+    }
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    uint32_t sum = (uint32_t)_mm_cvtsi128_si32(_mm_add_epi64(s, _mm_unpackhi_epi64(s, s)));
+    /* Legacy SSE code after this pays a state transition otherwise */
+    _mm256_zeroupper();
+    return sum + nibble_l2_sse2(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static uint32_t nibble_dot_avx2(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc = _mm256_setzero_si256();
+    uint32_t i = 0;
+
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+        __m256i alo = _mm256_and_si256(va, mask);
+        __m256i blo = _mm256_and_si256(vb, mask);
+        __m256i ahi = _mm256_and_si256(_mm256_srli_epi16(va, 4), mask);
+        __m256i bhi = _mm256_and_si256(_mm256_srli_epi16(vb, 4), mask);
+        /* Codes are below 16, so the signed operand of maddubs is safe and
+         * the four products per 16-bit lane stay under 1024 */
+        __m256i pairs = _mm256_add_epi16(_mm256_maddubs_epi16(alo, blo),
+                                         _mm256_maddubs_epi16(ahi, bhi));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+    }
+    uint32_t sum = hsum_epi32(_mm_add_epi32(_mm256_castsi256_si128(acc),
+                                            _mm256_extracti128_si256(acc, 1)));
+    /* Legacy SSE code after this pays a state transition otherwise */
+    _mm256_zeroupper();
+    return sum + nibble_dot_sse2(a + i, b + i, n - i);
+}
+
+#endif /* __SSE2__ */
+
+/* ============================================================================
+ * Vector Hashing
+ * ============================================================================ */
+
+/*
+ * CRC32C of the vector bytes. The CRC32 instruction works on general
+ * registers, so the kernel can use it too; the table version gives the
+ * same values on CPUs without SSE4.2.
+ */
+static uint32_t crc32c_hw(const uint8_t *data, uint32_t n) {
+    uint64_t crc = 0xFFFFFFFFU;
+    uint32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __asm__("crc32q %1, %0" : "+r"(crc) : "rm"(load64(data + i)));
+    }
+    for (; i < n; i++) {
+        __asm__("crc32b %1, %k0" : "+r"(crc) : "rm"(data[i]));
+    }
+    return (uint32_t)crc ^ 0xFFFFFFFFU;
+}
+
+static uint32_t crc32c_sw(const uint8_t *data, uint32_t n) {
+    uint32_t crc = 0xFFFFFFFFU;
+    for (uint32_t i = 0; i < n; i++) {
+        crc = crc32c_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+static void crc32c_init_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (uint32_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+        }
+        crc32c_table[i] = crc;
+    }
+}
+
+/* ============================================================================
+ * Kernel Selection
+ * ============================================================================ */
+
+static uint32_t cpuid_1_ecx(void) {
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+    return ecx;
+}
+
+static void kernels_init(void) {
+    uint32_t features;
+
+    if (assoc_kernels[ASSOC_METRIC_L2]) {
+        return;
+    }
+    features = cpuid_1_ecx();
+
+    crc32c_init_table();
+    assoc_hash = features & CPUID_1_ECX_SSE42 ? crc32c_hw : crc32c_sw;
+    assoc_kernels[ASSOC_METRIC_HAMMING] = features & CPUID_1_ECX_POPCNT ? hamming_popcnt
+                                                                          : hamming_swar;
+#if defined(__SSE2__)
+    if (__builtin_cpu_supports("avx2")) {
+        assoc_kernels[ASSOC_METRIC_DOT] = dot_avx2;
+        assoc_kernels[ASSOC_METRIC_L2] = l2_avx2;
+        assoc_nibble_kernels[ASSOC_METRIC_DOT] = nibble_dot_avx2;
+        assoc_nibble_kernels[ASSOC_METRIC_L2] = nibble_l2_avx2;
+    } else {
+        assoc_kernels[ASSOC_METRIC_DOT] = dot_sse2;
+        assoc_kernels[ASSOC_METRIC_L2] = l2_sse2;
+        assoc_nibble_kernels[ASSOC_METRIC_DOT] = nibble_dot_sse2;
+        assoc_nibble_kernels[ASSOC_METRIC_L2] = nibble_l2_sse2;
+    }
+#else
+    assoc_kernels[ASSOC_METRIC_DOT] = dot_scalar;
+    assoc_kernels[ASSOC_METRIC_L2] = l2_scalar;
+    assoc_nibble_kernels[ASSOC_METRIC_DOT] = nibble_dot_scalar;
+    assoc_nibble_kernels[ASSOC_METRIC_L2] = nibble_l2_scalar;
+#endif
+}
+
+static inline uint32_t kernel_distance(assoc_metric_t metric, const uint8_t *a,
+                                       const uint8_t *b, uint32_t dimensions) {
+    uint32_t value = assoc_kernels[metric](a, b, dimensions);
+    return metric == ASSOC_METRIC_DOT ? ASSOC_DOT_MAX * dimensions - value : value;
+}
+
+/* ============================================================================
+ * Arena Layout
+ * ============================================================================ */
+
+static inline uint8_t *arena_at(const assoc_index_t *index, uint64_t offset) {
+    return (uint8_t *)index + offset;
+}
+
+static inline assoc_node_t *node_at(const assoc_index_t *index, uint32_t id) {
+    return (assoc_node_t *)arena_at(index, index->nodes) + id;
+}
+
+static inline uint8_t *vector_at(const assoc_index_t *index, uint32_t id) {
+    return arena_at(index, index->vectors + (uint64_t)id * index->stride);
+}
+
+static inline uint8_t *code_at(const assoc_index_t *index, uint32_t id) {
+    return arena_at(index, index->codes + (uint64_t)id * index->code_stride);
+}
+
+/* Link list: a count followed by up to m (m0 on layer 0) ids */
+static inline uint32_t *links_at(const assoc_index_t *index, uint32_t id, uint32_t level) {
+    if (level == 0) {
+        return (uint32_t *)arena_at(index, index->links0 + (uint64_t)id * (1 + index->m0) * 4);
+    }
+    return (uint32_t *)arena_at(index, node_at(index, id)->upper +
+                                       (uint64_t)(level - 1) * (1 + index->m) * 4);
+}
+
+static inline uint32_t *hash_slots(const assoc_index_t *index) {
+    return (uint32_t *)arena_at(index, index->hash);
+}
+
+static inline uint32_t *visited_tags(const assoc_index_t *index) {
+    return (uint32_t *)arena_at(index, index->visited);
+}
+
+static inline assoc_scratch_t *scratch(const assoc_index_t *index) {
+    return (assoc_scratch_t *)arena_at(index, index->scratch);
+}
+
+static inline bool node_live(const assoc_index_t *index, uint32_t id) {
+    return !(node_at(index, id)->flags & ASSOC_NODE_DELETED);
+}
+
+static uint32_t round_pow2(uint64_t value) {
+    uint64_t pow2 = 1;
+    while (pow2 < value) {
+        pow2 <<= 1;
+    }
+    return (uint32_t)pow2;
+}
+
+/* Bump allocation from a tail region; 0 if it is exhausted */
+static uint32_t region_alloc(uint64_t *used, uint64_t end, uint64_t size) {
+    uint64_t offset = ALIGN_UP(*used, 8);
+    if (offset + size > end) {
+        return 0;
+    }
+    *used = offset + size;
+    return (uint32_t)offset;
+}
+
+static void apply_defaults(const assoc_config_t *config, assoc_config_t *out) {
+    *out = *config;
+    out->m = out->m ? out->m : ASSOC_DEFAULT_M;
+    out->ef_construction = out->ef_construction ? out->ef_construction
+                                                : ASSOC_DEFAULT_EF_CONSTRUCTION;
+    out->ef_search = out->ef_search ? out->ef_search : ASSOC_DEFAULT_EF_SEARCH;
+    out->flat_threshold = out->flat_threshold ? out->flat_threshold
+                                              : ASSOC_DEFAULT_FLAT_THRESHOLD;
+    if (!out->rerank) {
+        out->rerank = out->quantization == ASSOC_QUANT_BINARY ? ASSOC_DEFAULT_RERANK_BINARY
+                                                              : ASSOC_DEFAULT_RERANK;
+    }
+    out->seed = out->seed ? out->seed : 0x9E3779B97F4A7C15ULL;
+}
+
+static bool config_valid(const assoc_config_t *c) {
+    return c->dimensions && c->dimensions <= ASSOC_MAX_DIMENSIONS &&
+           c->capacity && c->capacity <= ASSOC_MAX_CAPACITY &&
+           c->m >= 2 && c->m <= ASSOC_MAX_M &&
+           c->ef_construction <= ASSOC_MAX_EF && c->ef_search <= ASSOC_MAX_EF &&
+           c->rerank <= ASSOC_MAX_EF &&
+           (uint32_t)c->metric < ASSOC_METRIC_COUNT &&
+           (uint32_t)c->quantization < ASSOC_QUANT_COUNT &&
+           !(c->quantization && c->metric == ASSOC_METRIC_HAMMING);
+}
+
+/* Bytes of one quantised vector */
+static uint32_t code_length(assoc_quant_t quant, uint32_t dimensions) {
+    switch (quant) {
+    case ASSOC_QUANT_4BIT:      return (dimensions + 1) / 2;
+    case ASSOC_QUANT_BINARY:    return (dimensions + 7) / 8;
+    default:                    return 0;
+    }
+}
+
+/*
+ * Region sizes in arena order. The upper-link region covers twice the
+ * expected 1/(m-1) share of nodes; the payload slab is payload_bytes
+ * plus 8-byte alignment slack per entry. Codes are packed at an 8-byte
+ * stride so a scan streams as few cache lines as possible.
+ */
+static uint64_t layout(const assoc_config_t *c, assoc_index_t *index) {
+    uint64_t cap = c->capacity;
+    uint64_t stride = ALIGN_UP((uint64_t)c->dimensions, ASSOC_VECTOR_ALIGN);
+    uint64_t code_stride = ALIGN_UP((uint64_t)code_length(c->quantization, c->dimensions), 8);
+    uint64_t offset = ALIGN_UP(sizeof(assoc_index_t), ASSOC_VECTOR_ALIGN);
+    uint64_t nodes, vectors, codes, links0, hash, visited, scratch_off, upper, payloads;
+
+    nodes = offset;
+    offset = ALIGN_UP(offset + cap * sizeof(assoc_node_t), ASSOC_VECTOR_ALIGN);
+    vectors = offset;
+    offset += cap * stride;
+    codes = offset;
+    offset = ALIGN_UP(offset + cap * code_stride, ASSOC_VECTOR_ALIGN);
+    links0 = offset;
+    offset = ALIGN_UP(offset + cap * (1 + 2 * (uint64_t)c->m) * 4, ASSOC_VECTOR_ALIGN);
+    hash = offset;
+    offset += (uint64_t)round_pow2(2 * cap) * 4;
+    visited = offset;
+    offset = ALIGN_UP(offset + cap * 4, ASSOC_VECTOR_ALIGN);
+    scratch_off = offset;
+    offset += sizeof(assoc_scratch_t);
+
+    upper = offset;
+    offset = ALIGN_UP(offset + (2 * cap / (c->m - 1) + ASSOC_MAX_LEVEL) *
+                               (1 + (uint64_t)c->m) * 4, ASSOC_VECTOR_ALIGN);
+    payloads = offset;
+    offset = ALIGN_UP(offset + (c->payload_bytes ? c->payload_bytes + cap * 8 : 0),
+                      ASSOC_VECTOR_ALIGN);
+
+    if (index) {
+        index->stride = (uint32_t)stride;
+        index->code_stride = (uint32_t)code_stride;
+        index->nodes = (uint32_t)nodes;
+        index->vectors = (uint32_t)vectors;
+        index->codes = (uint32_t)codes;
+        index->links0 = (uint32_t)links0;
+        index->hash = (uint32_t)hash;
+        index->hash_mask = round_pow2(2 * cap) - 1;
+        index->visited = (uint32_t)visited;
+        index->scratch = (uint32_t)scratch_off;
+        index->used = upper;
+        index->upper_end = payloads;
+        index->payloads = (uint32_t)payloads;
+        index->payload_used = payloads;
+        index->size = offset;
+    }
+    return offset;
+}
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static inline uint32_t distance(assoc_index_t *index, const uint8_t *query, uint32_t id) {
+    index->distance_evals++;
+    return kernel_distance(index->metric, query, vector_at(index, id), index->dimensions);
+}
+
+static uint64_t rng_next(assoc_index_t *index) {
+    index->rng ^= index->rng << 13;
+    index->rng ^= index->rng >> 7;
+    index->rng ^= index->rng << 17;
+    return index->rng;
+}
+
+/* P(level >= l) = m^-l */
+static uint32_t random_level(assoc_index_t *index) {
+    uint32_t level = 0;
+    while (level < ASSOC_MAX_LEVEL - 1 && rng_next(index) % index->m == 0) {
+        level++;
+    }
+    return level;
+}
+
+/* Code of `vector`, zero-padded to the code stride */
+static void quantize(const assoc_index_t *index, const uint8_t *vector, uint8_t *code) {
+    memset(code, 0, index->code_stride);
+    if (index->quant == ASSOC_QUANT_4BIT) {
+        for (uint32_t i = 0; i < index->dimensions; i++) {
+            code[i / 2] |= (uint8_t)((vector[i] >> 4) << (i & 1 ? 4 : 0));
+        }
+    } else {
+        for (uint32_t i = 0; i < index->dimensions; i++) {
+            code[i / 8] |= (uint8_t)((vector[i] >> 7) << (i & 7));
+        }
+    }
+}
+
+static bool vectors_equal(const uint8_t *a, const uint8_t *b, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (load64(a + i) != load64(b + i)) {
+            return false;
+        }
+    }
+    for (; i < n; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Slot holding `vector` (id + 1) or the empty slot where it would go.
+ * Slots are never cleared: forgotten entries keep theirs for revival.
+ */
+static uint32_t *hash_find(const assoc_index_t *index, const uint8_t *vector) {
+    uint32_t *slots = hash_slots(index);
+    uint32_t slot = assoc_hash(vector, index->dimensions) & index->hash_mask;
+
+    while (slots[slot] &&
+           !vectors_equal(vector_at(index, slots[slot] - 1), vector, index->dimensions)) {
+        slot = (slot + 1) & index->hash_mask;
+    }
+    return &slots[slot];
+}
+
+static uint32_t next_epoch(assoc_index_t *index) {
+    if (++index->epoch == 0) {
+        memset(visited_tags(index), 0, (size_t)index->capacity * 4);
+        index->epoch = 1;
+    }
+    return index->epoch;
+}
+
+/* Binary heaps of matches, nearest or farthest on top */
+static inline bool heap_before(const assoc_match_t *a, const assoc_match_t *b, bool max) {
+    return max ? a->distance > b->distance : a->distance < b->distance;
+}
+
+static inline void heap_push(assoc_match_t *heap, uint32_t *count, assoc_match_t item, bool max) {
+    uint32_t i = (*count)++;
+    while (i) {
+        uint32_t parent = (i - 1) / 2;
+        if (!heap_before(&item, &heap[parent], max)) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = item;
+}
+
+/* Restore the heap after heap[0] was replaced */
+static inline void heap_sift_down(assoc_match_t *heap, uint32_t n, bool max) {
+    assoc_match_t item = heap[0];
+    uint32_t i = 0;
+
+    while (2 * i + 1 < n) {
+        uint32_t child = 2 * i + 1;
+        if (child + 1 < n && heap_before(&heap[child + 1], &heap[child], max)) {
+            child++;
+        }
+        if (!heap_before(&heap[child], &item, max)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = item;
+}
+
+static inline assoc_match_t heap_pop(assoc_match_t *heap, uint32_t *count, bool max) {
+    assoc_match_t top = heap[0];
+
+    if (--(*count)) {
+        heap[0] = heap[*count];
+        heap_sift_down(heap, *count, max);
+    }
+    return top;
+}
+
+/*
+ * A candidate farther than the current worst result can never be
+ * expanded, so when the heap is full those are dropped. What remains is
+ * a subset of the results plus forgotten nodes; if forgotten nodes
+ * still fill it the new candidate is dropped instead.
+ */
+static void push_candidate(assoc_match_t *heap, uint32_t *count, assoc_match_t item,
+                           uint32_t bound) {
+    if (*count == 2 * ASSOC_MAX_EF) {
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < *count; i++) {
+            if (heap[i].distance < bound) {
+                heap_push(heap, &kept, heap[i], false);
+            }
+        }
+        *count = kept;
+        if (kept == 2 * ASSOC_MAX_EF) {
+            return;
+        }
+    }
+    heap_push(heap, count, item, false);
+}
+
+/* Greedy walk on an upper layer */
+static uint32_t search_greedy(assoc_index_t *index, const uint8_t *query, uint32_t entry,
+                              uint32_t level) {
+    uint32_t best = entry;
+    uint32_t best_distance = distance(index, query, entry);
+    bool changed = true;
+
+    while (changed) {
+        const uint32_t *links = links_at(index, best, level);
+        changed = false;
+        for (uint32_t i = 0; i < links[0]; i++) {
+            uint32_t d = distance(index, query, links[1 + i]);
+            if (d < best_distance) {
+                best_distance = d;
+                best = links[1 + i];
+                changed = true;
+            }
+        }
+    }
+    return best;
+}
+
+/*
+ * Best-first search of one layer. The up to `ef` closest nodes found
+ * end up in scratch->sorted, nearest first; with `live_only` forgotten
+ * nodes are walked through but not collected.
+ */
+static uint32_t search_layer(assoc_index_t *index, const uint8_t *query, uint32_t entry,
+                             uint32_t ef, uint32_t level, bool live_only) {
+    assoc_scratch_t *s = scratch(index);
+    uint32_t *visited = visited_tags(index);
+    uint32_t epoch = next_epoch(index);
+    uint32_t candidates = 0, results = 0;
+    assoc_match_t item = { entry, distance(index, query, entry) };
+
+    visited[entry] = epoch;
+    heap_push(s->candidates, &candidates, item, false);
+    if (!live_only || node_live(index, entry)) {
+        heap_push(s->results, &results, item, true);
+    }
+
+    while (candidates) {
+        assoc_match_t current = heap_pop(s->candidates, &candidates, false);
+        if (results == ef && current.distance > s->results[0].distance) {
+            break;
+        }
+
+        const uint32_t *links = links_at(index, current.id, level);
+        for (uint32_t i = 0; i < links[0]; i++) {
+            uint32_t id = links[1 + i];
+            if (i + 1 < links[0]) {
+                __builtin_prefetch(vector_at(index, links[2 + i]));
+            }
+            if (visited[id] == epoch) {
+                continue;
+            }
+            visited[id] = epoch;
+
+            uint32_t d = distance(index, query, id);
+            if (results < ef || d < s->results[0].distance) {
+                uint32_t bound = results == ef ? s->results[0].distance : 0xFFFFFFFFU;
+                item.id = id;
+                item.distance = d;
+                push_candidate(s->candidates, &candidates, item, bound);
+                if (!live_only || node_live(index, id)) {
+                    heap_push(s->results, &results, item, true);
+                    if (results > ef) {
+                        heap_pop(s->results, &results, true);
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t found = results;
+    while (results) {
+        s->sorted[results - 1] = heap_pop(s->results, &results, true);
+    }
+    return found;
+}
+
+/*
+ * Neighbour selection heuristic: walking candidates nearest first, keep
+ * one only if it is closer to the base than to every one already kept,
+ * so links spread in different directions.
+ */
+static uint32_t select_neighbors(assoc_index_t *index, const assoc_match_t *sorted,
+                                 uint32_t count, uint32_t max, uint32_t *out) {
+    uint32_t selected = 0;
+
+    for (uint32_t i = 0; i < count && selected < max; i++) {
+        const uint8_t *candidate = vector_at(index, sorted[i].id);
+        bool keep = true;
+        for (uint32_t j = 0; j < selected; j++) {
+            if (distance(index, candidate, out[j]) < sorted[i].distance) {
+                keep = false;
+                break;
+            }
+        }
+        if (keep) {
+            out[selected++] = sorted[i].id;
+        }
+    }
+    return selected;
+}
+
+static void sort_matches(assoc_match_t *matches, uint32_t count) {
+    for (uint32_t i = 1; i < count; i++) {
+        assoc_match_t m = matches[i];
+        uint32_t j = i;
+        while (j && matches[j - 1].distance > m.distance) {
+            matches[j] = matches[j - 1];
+            j--;
+        }
+        matches[j] = m;
+    }
+}
+
+/* Add a back link from `id` to `new_id`, re-selecting if the list is full */
+static void link_back(assoc_index_t *index, uint32_t id, uint32_t new_id, uint32_t level) {
+    assoc_scratch_t *s = scratch(index);
+    uint32_t *links = links_at(index, id, level);
+    uint32_t max = level ? index->m : index->m0;
+    const uint8_t *base = vector_at(index, id);
+
+    if (links[0] < max) {
+        links[1 + links[0]++] = new_id;
+        return;
+    }
+
+    for (uint32_t i = 0; i < links[0]; i++) {
+        s->prune[i].id = links[1 + i];
+        s->prune[i].distance = distance(index, base, links[1 + i]);
+    }
+    s->prune[links[0]].id = new_id;
+    s->prune[links[0]].distance = distance(index, base, new_id);
+    sort_matches(s->prune, links[0] + 1);
+    links[0] = select_neighbors(index, s->prune, links[0] + 1, max, links + 1);
+}
+
+static status_t store_payload(assoc_index_t *index, assoc_node_t *node,
+                              const void *payload, uint32_t size) {
+    if (size > node->payload_size || !node->payload) {
+        uint32_t offset = size ? region_alloc(&index->payload_used, index->size, size) : 0;
+        if (size && !offset) {
+            return STATUS_NO_MEMORY;
+        }
+        node->payload = offset;
+    }
+    if (size) {
+        memcpy(arena_at(index, node->payload), payload, size);
+    }
+    node->payload_size = size;
+    return STATUS_SUCCESS;
+}
+
+/*
+ * Link a stored node into the graph. Its upper-layer lists are
+ * allocated first, so running out of arena changes nothing.
+ */
+static status_t link_node(assoc_index_t *index, uint32_t id) {
+    assoc_scratch_t *s = scratch(index);
+    assoc_node_t *node = node_at(index, id);
+    const uint8_t *vector = vector_at(index, id);
+    uint32_t level = random_level(index);
+    uint32_t entry;
+
+    node->upper = 0;
+    if (level) {
+        node->upper = region_alloc(&index->used, index->upper_end,
+                                   (uint64_t)level * (1 + index->m) * 4);
+        if (!node->upper) {
+            return STATUS_NO_MEMORY;
+        }
+    }
+    node->level = (uint8_t)level;
+    for (uint32_t l = 0; l <= level; l++) {
+        links_at(index, id, l)[0] = 0;
+    }
+
+    if (index->entry == ASSOC_INVALID_ID) {
+        index->entry = id;
+        index->max_level = level;
+        return STATUS_SUCCESS;
+    }
+
+    /* Descend to the node's top layer, then link it on each below */
+    entry = index->entry;
+    for (uint32_t l = index->max_level; l > level; l--) {
+        entry = search_greedy(index, vector, entry, l);
+    }
+    for (uint32_t l = MIN(level, index->max_level) + 1; l-- > 0;) {
+        uint32_t found = search_layer(index, vector, entry, index->ef_construction, l, false);
+        uint32_t *links = links_at(index, id, l);
+
+        links[0] = select_neighbors(index, s->sorted, found, index->m, s->selected);
+        for (uint32_t i = 0; i < links[0]; i++) {
+            links[1 + i] = s->selected[i];
+            link_back(index, s->selected[i], id, l);
+        }
+        entry = s->sorted[0].id;
+    }
+
+    if (level > index->max_level) {
+        index->max_level = level;
+        index->entry = id;
+    }
+    return STATUS_SUCCESS;
+}
+
+/* Keep the k nearest in a max-heap */
+static inline void keep_nearest(assoc_match_t *heap, uint32_t *count, uint32_t k,
+                                assoc_match_t item) {
+    if (*count < k) {
+        heap_push(heap, count, item, true);
+    } else if (item.distance < heap[0].distance) {
+        heap[0] = item;
+        heap_sift_down(heap, *count, true);
+    }
+}
+
+/*
+ * k nearest live rows of a matrix by one streaming pass, left as a
+ * max-heap in scratch->results. `bias` turns a dot product into a
+ * distance.
+ */
+static uint32_t scan_rows(assoc_index_t *index, assoc_kernel_t kernel, const uint8_t *query,
+                          const uint8_t *row, uint32_t stride, uint32_t length,
+                          uint32_t bias, uint32_t k) {
+    assoc_scratch_t *s = scratch(index);
+    const assoc_node_t *nodes = node_at(index, 0);
+    bool tombstones = index->deleted != 0;     /* Else the node table is not read at all */
+    uint32_t results = 0;
+
+    for (uint32_t id = 0; id < index->count; id++, row += stride) {
+        __builtin_prefetch(row + 4 * stride);
+        if (tombstones && (nodes[id].flags & ASSOC_NODE_DELETED)) {
+            continue;
+        }
+        uint32_t d = kernel(query, row, length);
+        assoc_match_t item = { id, bias ? bias - d : d };
+        keep_nearest(s->results, &results, k, item);
+    }
+    index->distance_evals += index->live;
+    return results;
+}
+
+static uint32_t drain_nearest(assoc_index_t *index, uint32_t results, assoc_match_t *matches) {
+    assoc_scratch_t *s = scratch(index);
+    uint32_t found = results;
+
+    while (results) {
+        matches[results - 1] = heap_pop(s->results, &results, true);
+    }
+    return found;
+}
+
+/*
+ * Exact k nearest live nodes by scanning the vector matrix, nearest
+ * first in `matches`
+ */
+static uint32_t scan_matrix(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                            assoc_match_t *matches) {
+    uint32_t bias = index->metric == ASSOC_METRIC_DOT ? ASSOC_DOT_MAX * index->dimensions : 0;
+    uint32_t results = scan_rows(index, assoc_kernels[index->metric], vector,
+                                 vector_at(index, 0), index->stride, index->dimensions,
+                                 bias, k);
+    return drain_nearest(index, results, matches);
+}
+
+/*
+ * Approximate k nearest by scanning the code matrix for rerank * k
+ * candidates, then ordering those by full distance
+ */
+static uint32_t scan_codes(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                           assoc_match_t *matches) {
+    assoc_scratch_t *s = scratch(index);
+    uint32_t wide = MIN(MAX(k * index->rerank, k), ASSOC_MAX_EF);
+    uint32_t bias = 0, candidates, results = 0;
+    assoc_kernel_t kernel;
+
+    if (index->quant == ASSOC_QUANT_4BIT) {
+        kernel = assoc_nibble_kernels[index->metric];
+        if (index->metric == ASSOC_METRIC_DOT) {
+            bias = ASSOC_NIBBLE_DOT_MAX * 2 * index->code_bytes;
+        }
+    } else {
+        kernel = assoc_kernels[ASSOC_METRIC_HAMMING];
+    }
+
+    quantize(index, vector, s->query_code);
+    candidates = scan_rows(index, kernel, s->query_code, code_at(index, 0), index->code_stride,
+                           index->code_bytes, bias, wide);
+
+    memcpy(s->sorted, s->results, candidates * sizeof(assoc_match_t));
+    for (uint32_t i = 0; i < candidates; i++) {
+        assoc_match_t item = { s->sorted[i].id, distance(index, vector, s->sorted[i].id) };
+        keep_nearest(s->results, &results, k, item);
+    }
+    return drain_nearest(index, results, matches);
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+size_t assoc_index_arena_size(const assoc_config_t *config) {
+    assoc_config_t c;
+    uint64_t size;
+
+    if (!config) {
+        return 0;
+    }
+    apply_defaults(config, &c);
+    if (!config_valid(&c)) {
+        return 0;
+    }
+    size = layout(&c, NULL);
+    return size > ASSOC_MAX_OFFSET ? 0 : (size_t)size;
+}
+
+status_t assoc_index_create(void *arena, size_t size, const assoc_config_t *config,
+                            assoc_index_t **index) {
+    assoc_config_t c;
+    assoc_index_t *ix = arena;
+    size_t needed = assoc_index_arena_size(config);
+
+    if (!arena || !index || !needed || !IS_ALIGNED((uintptr_t)arena, ASSOC_VECTOR_ALIGN)) {
+        return STATUS_INVALID_ARG;
+    }
+    if (size < needed) {
+        return STATUS_NO_MEMORY;
+    }
+    apply_defaults(config, &c);
+    kernels_init();
+
+    memset(ix, 0, sizeof(*ix));
+    layout(&c, ix);
+    ix->dimensions = c.dimensions;
+    ix->capacity = c.capacity;
+    ix->m = c.m;
+    ix->m0 = 2 * c.m;
+    ix->ef_construction = MAX(c.ef_construction, c.m);
+    ix->ef_search = c.ef_search;
+    ix->flat_threshold = c.flat_threshold;
+    ix->metric = c.metric;
+    ix->quant = c.quantization;
+    ix->code_bytes = code_length(c.quantization, c.dimensions);
+    ix->rerank = c.rerank;
+    ix->rng = c.seed;
+    ix->entry = ASSOC_INVALID_ID;
+    memset(hash_slots(ix), 0, (size_t)(ix->hash_mask + 1) * 4);
+    memset(visited_tags(ix), 0, (size_t)ix->capacity * 4);
+    ix->magic = ASSOC_MAGIC;
+
+    *index = ix;
+    return STATUS_SUCCESS;
+}
+
+status_t assoc_index_insert(assoc_index_t *index, const uint8_t *vector,
+                            const void *payload, uint32_t payload_size, uint32_t *id) {
+    assoc_node_t *node;
+    uint32_t *slot, new_id;
+
+    if (!index || index->magic != ASSOC_MAGIC || !vector || (payload_size && !payload)) {
+        return STATUS_INVALID_ARG;
+    }
+
+    slot = hash_find(index, vector);
+    if (*slot) {
+        new_id = *slot - 1;
+        node = node_at(index, new_id);
+        if (!(node->flags & ASSOC_NODE_DELETED)) {
+            return STATUS_BUSY;
+        }
+        if (store_payload(index, node, payload, payload_size) != STATUS_SUCCESS) {
+            return STATUS_NO_MEMORY;
+        }
+        node->flags &= ~ASSOC_NODE_DELETED;
+        index->deleted--;
+        index->live++;
+        if (id) {
+            *id = new_id;
+        }
+        return STATUS_SUCCESS;
+    }
+    if (index->count == index->capacity) {
+        return STATUS_NO_MEMORY;
+    }
+
+    new_id = index->count;
+    node = node_at(index, new_id);
+    memset(node, 0, sizeof(*node));
+    if (store_payload(index, node, payload, payload_size) != STATUS_SUCCESS) {
+        return STATUS_NO_MEMORY;
+    }
+    memcpy(vector_at(index, new_id), vector, index->dimensions);
+    memset(vector_at(index, new_id) + index->dimensions, 0, index->stride - index->dimensions);
+    if (index->quant) {
+        quantize(index, vector, code_at(index, new_id));
+    }
+    index->count++;
+    index->live++;
+    *slot = new_id + 1;
+    if (id) {
+        *id = new_id;
+    }
+
+    /* Promotion links the whole backlog in this call */
+    if (index->count >= index->flat_threshold) {
+        while (index->linked < index->count && link_node(index, index->linked) == STATUS_SUCCESS) {
+            index->linked++;
+        }
+    }
+    return STATUS_SUCCESS;
+}
+
+status_t assoc_index_lookup(const assoc_index_t *index, const uint8_t *vector, uint32_t *id) {
+    const uint32_t *slot;
+
+    if (!index || index->magic != ASSOC_MAGIC || !vector || !id) {
+        return STATUS_INVALID_ARG;
+    }
+    slot = hash_find(index, vector);
+    if (!*slot || !node_live(index, *slot - 1)) {
+        return STATUS_NOT_FOUND;
+    }
+    *id = *slot - 1;
+    return STATUS_SUCCESS;
+}
+
+status_t assoc_index_remove(assoc_index_t *index, uint32_t id) {
+    if (!index || index->magic != ASSOC_MAGIC) {
+        return STATUS_INVALID_ARG;
+    }
+    if (id >= index->count || !node_live(index, id)) {
+        return STATUS_NOT_FOUND;
+    }
+    node_at(index, id)->flags |= ASSOC_NODE_DELETED;
+    index->live--;
+    index->deleted++;
+    return STATUS_SUCCESS;
+}
+
+uint32_t assoc_index_search(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                            uint32_t ef, assoc_match_t *matches) {
+    uint32_t entry, found;
+
+    if (!index || index->magic != ASSOC_MAGIC || !vector || !matches || !k || !index->live) {
+        return 0;
+    }
+    k = MIN(k, ASSOC_MAX_EF);
+    ef = MIN(MAX(ef ? ef : index->ef_search, k), ASSOC_MAX_EF);
+
+    if (index->linked < index->count) {
+        return index->quant ? scan_codes(index, vector, k, matches)
+                            : scan_matrix(index, vector, k, matches);
+    }
+
+    entry = index->entry;
+    for (uint32_t l = index->max_level; l > 0; l--) {
+        entry = search_greedy(index, vector, entry, l);
+    }
+    found = MIN(search_layer(index, vector, entry, ef, 0, true), k);
+    memcpy(matches, scratch(index)->sorted, found * sizeof(assoc_match_t));
+    return found;
+}
+
+uint32_t assoc_index_search_exact(assoc_index_t *index, const uint8_t *vector, uint32_t k,
+                                  assoc_match_t *matches) {
+    if (!index || index->magic != ASSOC_MAGIC || !vector || !matches || !k) {
+        return 0;
+    }
+    return scan_matrix(index, vector, MIN(k, ASSOC_MAX_EF), matches);
+}
+
+uint32_t assoc_index_dimensions(const assoc_index_t *index) {
+    return index ? index->dimensions : 0;
+}
+
+const uint8_t *assoc_index_vector(const assoc_index_t *index, uint32_t id) {
+    if (!index || id >= index->count) {
+        return NULL;
+    }
+    return vector_at(index, id);
+}
+
+const void *assoc_index_payload(const assoc_index_t *index, uint32_t id, uint32_t *size) {
+    const assoc_node_t *node;
+
+    if (!index || id >= index->count) {
+        return NULL;
+    }
+    node = node_at(index, id);
+    if (size) {
+        *size = node->payload_size;
+    }
+    return node->payload ? arena_at(index, node->payload) : NULL;
+}
+
+void assoc_index_get_stats(const assoc_index_t *index, assoc_stats_t *stats) {
+    if (!index || !stats) {
+        return;
+    }
+    stats->count = index->live;
+    stats->deleted = index->deleted;
+    stats->linked = index->linked;
+    stats->max_level = index->max_level;
+    stats->arena_size = index->size;
+    stats->payload_used = index->payload_used - index->payloads;
+    stats->arena_used = index->used + stats->payload_used;
+    stats->vector_bytes = index->stride;
+    stats->code_bytes = index->quant ? index->code_stride : 0;
+    stats->distance_evals = index->distance_evals;
+}
+
+uint32_t assoc_distance(assoc_metric_t metric, const uint8_t *a, const uint8_t *b,
+                        uint32_t dimensions) {
+    if ((uint32_t)metric >= ASSOC_METRIC_COUNT || !a || !b) {
+        return 0xFFFFFFFFU;
+    }
+    kernels_init();
+    return kernel_distance(metric, a, b, dimensions);
+}
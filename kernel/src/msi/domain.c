@@ -0,0 +1,132 @@
+/**
+ * QuantumOS MSI Domains
+ *
+ * msi_domain_create/grant/seal/destroy (msi/include/msi.h). Domains come
+ * from the kernel heap, or from the recycle list of destroyed ones, and
+ * are numbered in creation order.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/msi_domain.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/lane.h>
+#include <kernel/capability.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static uint32_t next_domain_id = 1;
+
+/*
+ * Destroyed domains, linked through cache_next. kfree() cannot return
+ * memory to the heap yet, so creation takes from here first.
+ */
+static msi_domain_t *domain_cache;
+
+static msi_domain_t *domain_alloc(void) {
+    msi_domain_t *d = domain_cache;
+
+    if (d) {
+        domain_cache = d->cache_next;
+    } else {
+        d = kmalloc(sizeof(*d));
+    }
+    if (d) {
+        memset(d, 0, sizeof(*d));
+    }
+    return d;
+}
+
+static void domain_free(msi_domain_t *d) {
+    d->cache_next = domain_cache;
+    domain_cache = d;
+}
+
+static msi_result_t to_msi_result(status_t status) {
+    switch (status) {
+    case STATUS_SUCCESS:            return MSI_SUCCESS;
+    case STATUS_NO_MEMORY:          return MSI_ERROR_NO_MEMORY;
+    case STATUS_PERMISSION_DENIED:  return MSI_ERROR_PERMISSION_DENIED;
+    case STATUS_NOT_FOUND:          return MSI_ERROR_NOT_FOUND;
+    default:                        return MSI_ERROR_INVALID_ARG;
+    }
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+msi_result_t msi_domain_create(msi_domain_t **domain) {
+    msi_domain_t *d;
+
+    if (!domain) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    d = domain_alloc();
+    if (!d) {
+        return MSI_ERROR_NO_MEMORY;
+    }
+    if (cspace_init(&d->caps) != STATUS_SUCCESS) {
+        domain_free(d);
+        return MSI_ERROR_NO_MEMORY;
+    }
+    d->magic = MSI_DOMAIN_MAGIC;
+    d->id = next_domain_id++;
+    lane_domain_init(d);
+
+    *domain = d;
+    return MSI_SUCCESS;
+}
+
+/**
+ * Grant a right (a cap_right_t). Rights are a set: granting one the
+ * domain already holds changes nothing.
+ */
+msi_result_t msi_domain_grant(msi_domain_t *domain, uint32_t capability) {
+    if (!msi_domain_valid(domain) || capability >= CAP_RIGHT_MAX) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (domain->caps.sealed) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+    if (cspace_has_right(&domain->caps, capability)) {
+        return MSI_SUCCESS;
+    }
+    return to_msi_result(cspace_grant(&domain->caps, capability, NULL));
+}
+
+/**
+ * Freeze the domain's rights; later grants are refused. Idempotent.
+ */
+msi_result_t msi_domain_seal(msi_domain_t *domain) {
+    if (!msi_domain_valid(domain)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    cspace_seal(&domain->caps);
+    return MSI_SUCCESS;
+}
+
+msi_result_t msi_domain_attach(msi_domain_t *domain, uint32_t pid) {
+    if (!msi_domain_valid(domain)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    return to_msi_result(cspace_attach(&domain->caps, pid));
+}
+
+msi_result_t msi_domain_destroy(msi_domain_t *domain) {
+    if (!msi_domain_valid(domain)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    lane_domain_teardown(domain);
+    if (domain->lanes.live) {
+        return MSI_ERROR_PERMISSION_DENIED;     /* Destroyed from one of its own lanes */
+    }
+    cspace_destroy(&domain->caps);
+    domain->magic = 0;
+    domain_free(domain);
+    return MSI_SUCCESS;
+}
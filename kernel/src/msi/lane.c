@@ -0,0 +1,582 @@
+/**
+ * QuantumOS Lanes Implementation
+ *
+ * A switched-out lane's stack holds, from its saved stack pointer up,
+ * r15 r14 r13 r12 rbx rbp and a return address, which is all
+ * lane_switch() needs to resume it. A new lane gets a hand-made frame
+ * of the same shape whose return address is lane_trampoline and whose
+ * r12 is the lane, so its first switch-in lands in lane_start(). The
+ * kernel is built without SSE, so there is no vector state to carry;
+ * the host build leaves MXCSR and the x87 control word shared.
+ *
+ * A yield switches straight to the next ready lane. Switches go back to
+ * the carrier's context in lane_run() only when nothing else is ready
+ * or a lane has exited, since an exited lane's stack can only be
+ * released once execution has left it.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/msi_domain.h>
+#include <kernel/process.h>
+#include <kernel/memory.h>
+#include <kernel/timer.h>
+#include <kernel/boot.h>
+#include <kernel/vdso.h>
+#include <kernel/lane.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/capability.h>
+#include <msi.h>
+
+#define LANE_STACK_CANARY       0x454E414C4B434154ULL   /* "TACKLANE" */
+#define LANE_STACK_MIN_SHIFT    10
+
+/* ============================================================================
+ * Context Switch
+ * ============================================================================ */
+
+void lane_switch(uint64_t *save_sp, uint64_t sp);
+void lane_trampoline(void);
+void lane_start(msi_lane_t *lane) __attribute__((used, noreturn));
+
+/*
+ * lane_switch(save_sp, sp): push the callee-saved registers, store the
+ * stack pointer through save_sp, load sp and pop what was saved there.
+ * lane_trampoline is where a new lane's frame returns to.
+ */
+__asm__(
+    ".pushsection .text\n"
+    ".globl lane_switch\n"
+    ".type lane_switch, @function\n"
+    "lane_switch:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size lane_switch, . - lane_switch\n"
+    "\n"
+    ".globl lane_trampoline\n"
+    ".type lane_trampoline, @function\n"
+    "lane_trampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    call lane_start\n"
+    "    ud2\n"
+    ".size lane_trampoline, . - lane_trampoline\n"
+    ".popsection\n");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static lane_cpu_t *active_cpus[MAX_CPUS];                   /* Inside lane_run() */
+static msi_lane_t *free_stacks[LANE_STACK_CLASSES];
+static lane_stats_t lane_statistics;
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static inline lane_cpu_t *lane_cpu(const msi_lane_t *lane) {
+    return &lane->domain->lanes.cpus[lane->cpu];
+}
+
+static inline uint64_t now_us(void) {
+    return vdso_time_us(vdso_clock_page());
+}
+
+static inline void queue_push(lane_queue_t *queue, msi_lane_t *lane) {
+    lane->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = lane;
+    } else {
+        queue->head = lane;
+    }
+    queue->tail = lane;
+    queue->count++;
+}
+
+static inline msi_lane_t *queue_pop(lane_queue_t *queue) {
+    msi_lane_t *lane = queue->head;
+
+    if (lane) {
+        queue->head = lane->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+        queue->count--;
+    }
+    return lane;
+}
+
+static void queue_remove(lane_queue_t *queue, msi_lane_t *lane) {
+    msi_lane_t *prev = NULL;
+
+    for (msi_lane_t *l = queue->head; l; prev = l, l = l->next) {
+        if (l != lane) {
+            continue;
+        }
+        if (prev) {
+            prev->next = l->next;
+        } else {
+            queue->head = l->next;
+        }
+        if (queue->tail == l) {
+            queue->tail = prev;
+        }
+        queue->count--;
+        return;
+    }
+}
+
+/* Smallest class whose block holds `size` bytes, or -1 if too large */
+static int stack_class(uint32_t size) {
+    int cls = 0;
+
+    size = size ? size : LANE_STACK_DEFAULT;
+    if (size > LANE_STACK_MAX) {
+        return -1;
+    }
+    while ((1U << (cls + LANE_STACK_MIN_SHIFT)) < size) {
+        cls++;
+    }
+    return cls;
+}
+
+static msi_lane_t *stack_alloc(int cls) {
+    uint32_t size = 1U << (cls + LANE_STACK_MIN_SHIFT);
+    msi_lane_t *lane = free_stacks[cls];
+    uint8_t *block;
+
+    if (lane) {
+        free_stacks[cls] = lane->next;
+        return lane;
+    }
+
+    block = kmalloc(size);
+    if (!block) {
+        return NULL;
+    }
+    lane_statistics.stack_bytes += size;
+    lane = (msi_lane_t *)ALIGN_DOWN((uintptr_t)block + size - sizeof(msi_lane_t), 16);
+    lane->stack = block;
+    lane->stack_size = size;
+    lane->stack_class = (uint8_t)cls;
+    return lane;
+}
+
+/* The lane must not be running, queued or on a wheel */
+static void lane_release(msi_lane_t *lane) {
+    lane_cpu_t *cpu = lane_cpu(lane);
+
+    *lane->all_pprev = lane->all_next;
+    if (lane->all_next) {
+        lane->all_next->all_pprev = lane->all_pprev;
+    }
+    cpu->lanes--;
+    lane->domain->lanes.live--;
+    lane->domain = NULL;
+    lane_statistics.exited++;
+
+    lane->next = free_stacks[lane->stack_class];
+    free_stacks[lane->stack_class] = lane;
+}
+
+static inline bool stack_intact(const msi_lane_t *lane) {
+    return *(const uint64_t *)lane->stack == LANE_STACK_CANARY;
+}
+
+/* The carrier leaves the CPU to the kernel until a lane is runnable */
+static void carrier_unpark(lane_cpu_t *cpu) {
+    if (!cpu->parked) {
+        return;
+    }
+    cpu->parked = false;
+    if (cpu->carrier_pid != KERNEL_PROCESS_ID) {
+        process_unblock(cpu->carrier_pid);
+    }
+}
+
+static void make_ready(msi_lane_t *lane) {
+    lane_cpu_t *cpu = lane_cpu(lane);
+
+    lane->state = LANE_STATE_READY;
+    queue_push(&cpu->ready, lane);
+    carrier_unpark(cpu);
+}
+
+/* Move sleepers that are due onto the run queue */
+static void poll_sleepers(lane_cpu_t *cpu) {
+    ktimer_t *timer;
+
+    if (!cpu->sleepers.pending_count) {
+        return;
+    }
+    timer = timer_wheel_advance(&cpu->sleepers, now_us());
+    while (timer) {
+        ktimer_t *next = timer->next;
+        timer->next = NULL;
+        make_ready((msi_lane_t *)(uintptr_t)timer->data);
+        timer = next;
+    }
+}
+
+/*
+ * Leave the running lane, whose state the caller has already set, for
+ * the next ready lane or the carrier. Returns when the lane is switched
+ * back in.
+ */
+static void switch_away(lane_cpu_t *cpu, msi_lane_t *self) {
+    msi_lane_t *next;
+
+    if (!stack_intact(self)) {
+        klog_hex(LOG_ERR, "Lane overflowed its stack, killed: ", self->id);
+        lane_statistics.overflows++;
+        lane_exit();
+    }
+
+    poll_sleepers(cpu);
+    next = queue_pop(&cpu->ready);
+    if (next == self) {
+        /* A sleep that expired before the switch: keep running */
+        self->state = LANE_STATE_RUNNING;
+        return;
+    }
+    lane_statistics.switches++;
+    if (next) {
+        next->state = LANE_STATE_RUNNING;
+        cpu->current = next;
+        lane_switch(&self->sp, next->sp);
+    } else {
+        cpu->current = NULL;
+        lane_switch(&self->sp, cpu->sched_sp);
+    }
+}
+
+void lane_start(msi_lane_t *lane) {
+    lane->entry(lane, lane->arg);
+    lane_exit();
+}
+
+static inline lane_cpu_t *active_cpu(void) {
+    return active_cpus[cpu_current_id()];
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+void lane_domain_init(msi_domain_t *domain) {
+    uint64_t now = now_us();
+
+    memset(&domain->lanes, 0, sizeof(domain->lanes));
+    for (uint32_t i = 0; i < MAX_CPUS; i++) {
+        domain->lanes.cpus[i].carrier_pid = KERNEL_PROCESS_ID;
+        timer_wheel_init(&domain->lanes.cpus[i].sleepers, now);
+    }
+}
+
+void lane_domain_set_entry(msi_domain_t *domain, lane_entry_t entry, void *arg,
+                           uint32_t stack_size) {
+    if (!msi_domain_valid(domain)) {
+        return;
+    }
+    domain->lanes.entry = entry;
+    domain->lanes.arg = arg;
+    domain->lanes.stack_size = stack_size;
+}
+
+status_t lane_spawn(msi_domain_t *domain, lane_entry_t entry, void *arg,
+                    uint32_t stack_size, msi_lane_t **lane) {
+    int cls = stack_class(stack_size);
+    lane_cpu_t *cpu;
+    msi_lane_t *l;
+    uint64_t *frame;
+
+    if (!msi_domain_valid(domain) || !entry || cls < 0) {
+        return STATUS_INVALID_ARG;
+    }
+    l = stack_alloc(cls);
+    if (!l) {
+        return STATUS_NO_MEMORY;
+    }
+
+    l->domain = domain;
+    l->entry = entry;
+    l->arg = arg;
+    l->id = ++domain->lanes.next_id;
+    l->cpu = (uint16_t)cpu_current_id();
+    memset(&l->timer, 0, sizeof(l->timer));
+    l->timer.data = (uint64_t)(uintptr_t)l;
+    *(uint64_t *)l->stack = LANE_STACK_CANARY;
+
+    /* r15 r14 r13 r12 rbx rbp, return address, then padding so that
+     * lane_trampoline calls lane_start() with a 16-byte aligned stack */
+    frame = (uint64_t *)ALIGN_DOWN((uintptr_t)l, 16) - 9;
+    memset(frame, 0, 9 * sizeof(uint64_t));
+    frame[3] = (uint64_t)(uintptr_t)l;
+    frame[6] = (uint64_t)(uintptr_t)lane_trampoline;
+    l->sp = (uint64_t)(uintptr_t)frame;
+
+    cpu = lane_cpu(l);
+    l->all_next = cpu->all;
+    if (cpu->all) {
+        cpu->all->all_pprev = &l->all_next;
+    }
+    l->all_pprev = &cpu->all;
+    cpu->all = l;
+    cpu->lanes++;
+    domain->lanes.live++;
+    lane_statistics.spawned++;
+    make_ready(l);
+
+    if (lane) {
+        *lane = l;
+    }
+    return STATUS_SUCCESS;
+}
+
+uint64_t lane_run(msi_domain_t *domain) {
+    uint32_t id = cpu_current_id();
+    lane_cpu_t *cpu, *outer;
+    process_t *carrier;
+
+    if (!msi_domain_valid(domain)) {
+        return 0;
+    }
+    cpu = &domain->lanes.cpus[id];
+    if (cpu->in_run) {
+        return LANE_NO_WAKE;
+    }
+    carrier = process_get_current();
+    cpu->carrier_pid = carrier ? carrier->pid : KERNEL_PROCESS_ID;
+    cpu->in_run = true;
+    cpu->parked = false;
+    outer = active_cpus[id];
+    active_cpus[id] = cpu;
+
+    for (;;) {
+        msi_lane_t *lane;
+
+        poll_sleepers(cpu);
+        lane = queue_pop(&cpu->ready);
+        if (!lane) {
+            break;
+        }
+        lane->state = LANE_STATE_RUNNING;
+        cpu->current = lane;
+        lane_statistics.switches++;
+        lane_switch(&cpu->sched_sp, lane->sp);
+
+        /* Back on the carrier's stack, so exited lanes can go */
+        while (cpu->zombies) {
+            msi_lane_t *dead = cpu->zombies;
+            cpu->zombies = dead->next;
+            lane_release(dead);
+        }
+    }
+
+    cpu->current = NULL;
+    cpu->in_run = false;
+    active_cpus[id] = outer;
+    if (!cpu->lanes) {
+        return 0;
+    }
+
+    /* Every lane left waits: hand the CPU back to the kernel */
+    cpu->parked = true;
+    lane_statistics.parks++;
+    if (cpu->carrier_pid != KERNEL_PROCESS_ID) {
+        process_block(cpu->carrier_pid);
+    }
+    return timer_wheel_next_event(&cpu->sleepers);
+}
+
+msi_lane_t *lane_current(void) {
+    lane_cpu_t *cpu = active_cpu();
+    return cpu ? cpu->current : NULL;
+}
+
+void lane_yield(void) {
+    lane_cpu_t *cpu = active_cpu();
+    msi_lane_t *self, *next;
+
+    if (!cpu || !(self = cpu->current)) {
+        return;
+    }
+    poll_sleepers(cpu);
+    if (!cpu->ready.head) {
+        return;
+    }
+    if (!stack_intact(self)) {
+        switch_away(cpu, self);
+    }
+
+    /* Straight to the next lane; the carrier is not involved */
+    next = queue_pop(&cpu->ready);
+    self->state = LANE_STATE_READY;
+    queue_push(&cpu->ready, self);
+    next->state = LANE_STATE_RUNNING;
+    cpu->current = next;
+    lane_statistics.switches++;
+    lane_switch(&self->sp, next->sp);
+}
+
+void lane_sleep_us(uint64_t micros) {
+    lane_cpu_t *cpu = active_cpu();
+    msi_lane_t *self;
+
+    if (!cpu || !(self = cpu->current)) {
+        return;
+    }
+    if (!micros) {
+        lane_yield();
+        return;
+    }
+    self->timer.expires = now_us() + micros;
+    timer_wheel_add(&cpu->sleepers, &self->timer);
+    self->state = LANE_STATE_SLEEPING;
+    switch_away(cpu, self);
+}
+
+void lane_block(void) {
+    lane_cpu_t *cpu = active_cpu();
+    msi_lane_t *self;
+
+    if (!cpu || !(self = cpu->current)) {
+        return;
+    }
+    self->state = LANE_STATE_BLOCKED;
+    switch_away(cpu, self);
+}
+
+void lane_exit(void) {
+    lane_cpu_t *cpu = active_cpu();
+    msi_lane_t *self = cpu ? cpu->current : NULL;
+
+    if (!self) {
+        boot_panic("lane_exit outside a lane");
+    }
+    self->state = LANE_STATE_DEAD;
+    self->next = cpu->zombies;
+    cpu->zombies = self;
+    cpu->current = NULL;
+    lane_statistics.switches++;
+    lane_switch(&self->sp, cpu->sched_sp);
+    __builtin_unreachable();
+}
+
+status_t lane_wake(msi_lane_t *lane) {
+    if (!lane || !lane->domain) {
+        return STATUS_INVALID_ARG;
+    }
+    if (lane->state == LANE_STATE_SLEEPING) {
+        timer_wheel_cancel(&lane->timer);
+    } else if (lane->state != LANE_STATE_BLOCKED) {
+        return STATUS_SUCCESS;
+    }
+    make_ready(lane);
+    return STATUS_SUCCESS;
+}
+
+status_t lane_kill(msi_lane_t *lane) {
+    if (!lane || !lane->domain || lane->state == LANE_STATE_DEAD) {
+        return STATUS_NOT_FOUND;
+    }
+    if (lane == lane_current()) {
+        lane_exit();
+    }
+    if (lane->state == LANE_STATE_READY) {
+        queue_remove(&lane_cpu(lane)->ready, lane);
+    } else if (lane->state == LANE_STATE_SLEEPING) {
+        timer_wheel_cancel(&lane->timer);
+    } else if (lane->state == LANE_STATE_RUNNING) {
+        return STATUS_BUSY;             /* Current on another CPU */
+    }
+    lane->state = LANE_STATE_DEAD;
+    lane_release(lane);
+    return STATUS_SUCCESS;
+}
+
+void lane_domain_teardown(msi_domain_t *domain) {
+    if (!msi_domain_valid(domain)) {
+        return;
+    }
+    for (uint32_t i = 0; i < MAX_CPUS; i++) {
+        msi_lane_t *lane = domain->lanes.cpus[i].all;
+        while (lane) {
+            msi_lane_t *next = lane->all_next;
+            if (lane->state != LANE_STATE_RUNNING) {
+                lane_kill(lane);
+            }
+            lane = next;
+        }
+    }
+}
+
+void lane_get_stats(lane_stats_t *stats) {
+    if (stats) {
+        *stats = lane_statistics;
+    }
+}
+
+/* ============================================================================
+ * MSI Binding
+ * ============================================================================ */
+
+static msi_result_t to_msi_result(status_t status) {
+    switch (status) {
+    case STATUS_SUCCESS:    return MSI_SUCCESS;
+    case STATUS_NO_MEMORY:  return MSI_ERROR_NO_MEMORY;
+    case STATUS_NOT_FOUND:  return MSI_ERROR_NOT_FOUND;
+    case STATUS_BUSY:       return MSI_ERROR_PERMISSION_DENIED;
+    default:                return MSI_ERROR_INVALID_ARG;
+    }
+}
+
+msi_result_t msi_lane_spawn(msi_domain_t *domain, msi_lane_t **lane) {
+    if (!cap_current_has(CAP_RIGHT_MSI_LANE)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!msi_domain_valid(domain) || !lane) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (!domain->lanes.entry) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+    return to_msi_result(lane_spawn(domain, domain->lanes.entry, domain->lanes.arg,
+                                    domain->lanes.stack_size, lane));
+}
+
+/* Yield and sleep act on the calling lane, which `lane` must be */
+msi_result_t msi_lane_yield(msi_lane_t *lane) {
+    if (!lane || lane != lane_current()) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    lane_yield();
+    return MSI_SUCCESS;
+}
+
+msi_result_t msi_lane_sleep(msi_lane_t *lane, uint64_t nanos) {
+    if (!lane || lane != lane_current()) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    lane_sleep_us((nanos + 999) / 1000);
+    return MSI_SUCCESS;
+}
+
+msi_result_t msi_lane_kill(msi_lane_t *lane) {
+    return to_msi_result(lane_kill(lane));
+}
@@ -0,0 +1,612 @@
+/**
+ * QuantumOS Transactional State Implementation
+ *
+ * Frames (roots, tables, pages and garbage lists alike) come from a
+ * per-region pool carved out of page-aligned kmalloc chunks and are
+ * recycled, since kfree() does not return memory yet. Free frames are
+ * kept in the same blocks as garbage, so reclaiming a version splices
+ * its garbage blocks into the pool without touching the frames they
+ * list. A write reserves the frames its fault can need before touching
+ * any tree, so a copy-on-write fault either completes or changes
+ * nothing.
+ *
+ * Pinning follows the usual load, increment, re-check pattern. All
+ * three steps and the writer's publish and reader-count check are
+ * sequentially consistent: if the writer sees no readers on a retired
+ * version, any reader still about to pin it will see the newer pointer
+ * on its re-check and retry.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/memory.h>
+#include <kernel/state.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <kernel/capability.h>
+#include <msi.h>
+
+#define STATE_CHUNK_FRAMES      64
+#define STATE_FAULT_FRAMES      4       /* Root, table, page and a garbage block */
+#define GARBAGE_SLOTS           ((PAGE_SIZE - 2 * sizeof(uint64_t)) / sizeof(void *))
+
+/* Frames the next commit supersedes, kept in frames from the pool */
+struct state_garbage {
+    state_garbage_t *next;
+    uint64_t count;
+    void *frames[GARBAGE_SLOTS];
+};
+
+struct state_chunk {
+    state_chunk_t *next;
+    void *memory;
+};
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static state_region_t *msi_regions[STATE_MAX_REGIONS];
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/* pte_t.frame holds address bits 12-51; the rest is sign extension */
+static inline void *frame_ptr(pte_t entry) {
+    return (void *)(uintptr_t)((int64_t)((uint64_t)entry.frame << (PAGE_SHIFT + 12)) >> 12);
+}
+
+static inline pte_t private_entry(void *frame) {
+    pte_t entry = { 0 };
+
+    entry.present = 1;
+    entry.read_write = 1;
+    entry.dirty = 1;
+    entry.nx = 1;
+    entry.frame = (uintptr_t)frame >> PAGE_SHIFT;
+    return entry;
+}
+
+static inline void frame_free(state_region_t *region, void *frame) {
+    state_garbage_t *block = region->free_blocks;
+
+    if (block && block->count < GARBAGE_SLOTS) {
+        block->frames[block->count++] = frame;
+    } else {
+        block = frame;
+        block->next = region->free_blocks;
+        block->count = 0;
+        region->free_blocks = block;
+    }
+    region->free_count++;
+}
+
+static status_t frames_reserve(state_region_t *region, uint32_t count) {
+    state_chunk_t *chunk;
+    uint8_t *base;
+
+    if (region->free_count >= count) {
+        return STATUS_SUCCESS;
+    }
+
+    chunk = kmalloc(sizeof(*chunk));
+    base = kmalloc((STATE_CHUNK_FRAMES + 1) * PAGE_SIZE);
+    if (!chunk || !base) {
+        kfree(chunk);
+        kfree(base);
+        return STATUS_NO_MEMORY;
+    }
+    chunk->memory = base;
+    chunk->next = region->chunks;
+    region->chunks = chunk;
+
+    base = (uint8_t *)ALIGN_UP((uintptr_t)base, PAGE_SIZE);
+    for (uint32_t i = STATE_CHUNK_FRAMES; i-- > 0;) {
+        frame_free(region, base + (uint64_t)i * PAGE_SIZE);
+    }
+    region->stats.frames += STATE_CHUNK_FRAMES;
+    return STATUS_SUCCESS;
+}
+
+/* Only after frames_reserve() */
+static inline void *frame_take(state_region_t *region) {
+    state_garbage_t *block = region->free_blocks;
+
+    region->free_count--;
+    if (block->count) {
+        return block->frames[--block->count];
+    }
+    region->free_blocks = block->next;
+    return block;
+}
+
+static void garbage_add(state_region_t *region, void *frame) {
+    state_garbage_t *block = region->txn_garbage;
+
+    if (!block || block->count == GARBAGE_SLOTS) {
+        state_garbage_t *fresh = frame_take(region);
+        fresh->next = block;
+        fresh->count = 0;
+        region->txn_garbage = block = fresh;
+    }
+    block->frames[block->count++] = frame;
+}
+
+/* Hand a version's garbage, blocks and listed frames, to the pool */
+static void garbage_reclaim(state_region_t *region, state_garbage_t *block) {
+    while (block) {
+        state_garbage_t *next = block->next;
+        block->next = region->free_blocks;
+        region->free_blocks = block;
+        region->free_count += (uint32_t)block->count + 1;
+        region->stats.reclaimed += block->count;
+        block = next;
+    }
+}
+
+/* Free only the blocks; the frames they list are still in use */
+static void garbage_drop(state_region_t *region, state_garbage_t *block) {
+    while (block) {
+        state_garbage_t *next = block->next;
+        frame_free(region, block);
+        block = next;
+    }
+}
+
+/* Copy a shared table, clearing the previous commit's dirty bits */
+static void table_copy(pte_t *dst, const pte_t *src) {
+    for (uint32_t i = 0; i < STATE_PTES_PER_TABLE; i++) {
+        dst[i] = src[i];
+        dst[i].dirty = 0;
+    }
+}
+
+/*
+ * The software write fault: make `page` private to the pending version,
+ * copying the root, its table and the page itself as needed
+ */
+static uint8_t *cow_page(state_region_t *region, uint32_t page) {
+    pte_t *root = region->work_root;
+    pte_t *dir_entry, *entry, *table;
+
+    if (frames_reserve(region, STATE_FAULT_FRAMES) != STATUS_SUCCESS) {
+        return NULL;
+    }
+
+    if (!root) {
+        root = frame_take(region);
+        table_copy(root, region->current->root);
+        garbage_add(region, region->current->root);
+        region->work_root = root;
+        region->stats.cow_tables++;
+    }
+
+    dir_entry = &root[page / STATE_PTES_PER_TABLE];
+    if (dir_entry->dirty) {
+        table = frame_ptr(*dir_entry);
+    } else {
+        table = frame_take(region);
+        if (dir_entry->present) {
+            table_copy(table, frame_ptr(*dir_entry));
+            garbage_add(region, frame_ptr(*dir_entry));
+        } else {
+            memset(table, 0, PAGE_SIZE);
+        }
+        *dir_entry = private_entry(table);
+        region->stats.cow_tables++;
+    }
+
+    entry = &table[page % STATE_PTES_PER_TABLE];
+    if (!entry->dirty) {
+        uint8_t *copy = frame_take(region);
+        if (entry->present) {
+            memcpy(copy, frame_ptr(*entry), PAGE_SIZE);
+            garbage_add(region, frame_ptr(*entry));
+        } else {
+            memset(copy, 0, PAGE_SIZE);
+        }
+        *entry = private_entry(copy);
+        region->stats.cow_pages++;
+        region->stats.pending++;
+    }
+    return frame_ptr(*entry);
+}
+
+static inline const pte_t *page_entry(const pte_t *root, uint32_t page) {
+    const pte_t *dir_entry = &root[page / STATE_PTES_PER_TABLE];
+
+    if (!dir_entry->present) {
+        return NULL;
+    }
+    return &((const pte_t *)frame_ptr(*dir_entry))[page % STATE_PTES_PER_TABLE];
+}
+
+/* Free what retired versions superseded, oldest first, up to a pinned one */
+static void reclaim(state_region_t *region) {
+    state_version_t *version;
+
+    while ((version = region->oldest) &&
+           __atomic_load_n(&version->readers, __ATOMIC_SEQ_CST) == 0) {
+        garbage_reclaim(region, version->garbage);
+        region->oldest = version->next;
+        if (!region->oldest) {
+            region->newest = NULL;
+        }
+        region->stats.retired--;
+
+        /* `readers` is left alone: a late pin may still be backing off */
+        version->next = region->free_versions;
+        region->free_versions = version;
+    }
+}
+
+static state_version_t *version_alloc(state_region_t *region) {
+    state_version_t *version = region->free_versions;
+
+    if (version) {
+        region->free_versions = version->next;
+    } else {
+        version = kmalloc(sizeof(*version));
+        if (!version) {
+            return NULL;
+        }
+        version->readers = 0;
+    }
+    version->garbage = NULL;
+    version->next = NULL;
+    return version;
+}
+
+static inline bool range_valid(const state_region_t *region, uint64_t offset, uint64_t len) {
+    return offset <= region->size && len <= region->size - offset;
+}
+
+/* ============================================================================
+ * Public Interface
+ * ============================================================================ */
+
+status_t state_region_create(uint64_t size, uint32_t flags, state_region_t **region) {
+    state_region_t *r;
+    state_version_t *initial;
+
+    if (!region || !size || size > STATE_MAX_SIZE || (flags & ~(STATE_READ | STATE_WRITE))) {
+        return STATUS_INVALID_ARG;
+    }
+    r = kmalloc(sizeof(*r));
+    if (!r) {
+        return STATUS_NO_MEMORY;
+    }
+    memset(r, 0, sizeof(*r));
+    r->size = size;
+    r->pages = (uint32_t)(ALIGN_UP(size, PAGE_SIZE) >> PAGE_SHIFT);
+    r->flags = flags;
+
+    initial = version_alloc(r);
+    if (!initial || frames_reserve(r, 1) != STATUS_SUCCESS) {
+        kfree(initial);
+        kfree(r);
+        return STATUS_NO_MEMORY;
+    }
+    initial->root = frame_take(r);
+    memset(initial->root, 0, PAGE_SIZE);
+    initial->seq = 0;
+    initial->changed = 0;
+    r->current = initial;
+
+    *region = r;
+    return STATUS_SUCCESS;
+}
+
+status_t state_region_destroy(state_region_t *region) {
+    if (!region) {
+        return STATUS_INVALID_ARG;
+    }
+    reclaim(region);
+    if (region->oldest || __atomic_load_n(&region->current->readers, __ATOMIC_SEQ_CST)) {
+        return STATUS_BUSY;
+    }
+    state_abort(region);
+
+    kfree(region->current);
+    while (region->free_versions) {
+        state_version_t *next = region->free_versions->next;
+        kfree(region->free_versions);
+        region->free_versions = next;
+    }
+    while (region->chunks) {
+        state_chunk_t *next = region->chunks->next;
+        kfree(region->chunks->memory);
+        kfree(region->chunks);
+        region->chunks = next;
+    }
+    kfree(region);
+    return STATUS_SUCCESS;
+}
+
+status_t state_write(state_region_t *region, uint64_t offset, const void *data, uint64_t len) {
+    const uint8_t *src = data;
+
+    if (!region || (!data && len) || !range_valid(region, offset, len)) {
+        return STATUS_INVALID_ARG;
+    }
+    if (!(region->flags & STATE_WRITE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+
+    while (len) {
+        uint64_t in_page = offset & (PAGE_SIZE - 1);
+        uint64_t chunk = MIN(len, PAGE_SIZE - in_page);
+        uint8_t *page = cow_page(region, (uint32_t)(offset >> PAGE_SHIFT));
+
+        if (!page) {
+            return STATUS_NO_MEMORY;
+        }
+        memcpy(page + in_page, src, chunk);
+        src += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return STATUS_SUCCESS;
+}
+
+status_t state_commit(state_region_t *region, uint64_t *seq) {
+    state_version_t *old, *version;
+
+    if (!region) {
+        return STATUS_INVALID_ARG;
+    }
+
+    old = region->current;
+    if (region->work_root) {
+        version = version_alloc(region);
+        if (!version) {
+            return STATUS_NO_MEMORY;
+        }
+        version->root = region->work_root;
+        version->seq = old->seq + 1;
+        version->changed = region->stats.pending;
+        old->garbage = region->txn_garbage;
+        region->txn_garbage = NULL;
+        region->work_root = NULL;
+        region->stats.pending = 0;
+
+        /* The whole commit: readers pinning from here on get `version` */
+        __atomic_store_n(&region->current, version, __ATOMIC_SEQ_CST);
+
+        if (region->newest) {
+            region->newest->next = old;
+        } else {
+            region->oldest = old;
+        }
+        region->newest = old;
+        region->stats.retired++;
+        region->stats.commits++;
+    }
+
+    reclaim(region);
+    if (seq) {
+        *seq = region->current->seq;
+    }
+    return STATUS_SUCCESS;
+}
+
+void state_abort(state_region_t *region) {
+    pte_t *root;
+
+    if (!region || !(root = region->work_root)) {
+        return;
+    }
+
+    /* Dirty entries are the pending version's own frames */
+    for (uint32_t i = 0; i < STATE_PTES_PER_TABLE; i++) {
+        pte_t *table;
+        if (!root[i].dirty) {
+            continue;
+        }
+        table = frame_ptr(root[i]);
+        for (uint32_t j = 0; j < STATE_PTES_PER_TABLE; j++) {
+            if (table[j].dirty) {
+                frame_free(region, frame_ptr(table[j]));
+            }
+        }
+        frame_free(region, table);
+    }
+    frame_free(region, root);
+
+    /* What the pending version would have superseded is still live */
+    garbage_drop(region, region->txn_garbage);
+    region->txn_garbage = NULL;
+    region->work_root = NULL;
+    region->stats.pending = 0;
+    region->stats.aborts++;
+}
+
+const state_version_t *state_snapshot_acquire(state_region_t *region) {
+    state_version_t *version;
+
+    if (!region) {
+        return NULL;
+    }
+    for (;;) {
+        version = __atomic_load_n(&region->current, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&version->readers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&region->current, __ATOMIC_SEQ_CST) == version) {
+            return version;
+        }
+        __atomic_fetch_sub(&version->readers, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+void state_snapshot_release(const state_version_t *snapshot) {
+    if (snapshot) {
+        __atomic_fetch_sub(&((state_version_t *)snapshot)->readers, 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+status_t state_snapshot_read(const state_region_t *region, const state_version_t *snapshot,
+                             uint64_t offset, void *buf, uint64_t len) {
+    uint8_t *dst = buf;
+
+    if (!region || !snapshot || (!buf && len) || !range_valid(region, offset, len)) {
+        return STATUS_INVALID_ARG;
+    }
+
+    while (len) {
+        uint64_t in_page = offset & (PAGE_SIZE - 1);
+        uint64_t chunk = MIN(len, PAGE_SIZE - in_page);
+        const pte_t *entry = page_entry(snapshot->root, (uint32_t)(offset >> PAGE_SHIFT));
+
+        if (entry && entry->present) {
+            memcpy(dst, (const uint8_t *)frame_ptr(*entry) + in_page, chunk);
+        } else {
+            memset(dst, 0, chunk);
+        }
+        dst += chunk;
+        offset += chunk;
+        len -= chunk;
+    }
+    return STATUS_SUCCESS;
+}
+
+bool state_snapshot_changed(const state_version_t *snapshot, uint64_t offset) {
+    const pte_t *entry;
+
+    if (!snapshot || offset >= STATE_MAX_SIZE) {
+        return false;
+    }
+    entry = page_entry(snapshot->root, (uint32_t)(offset >> PAGE_SHIFT));
+    return entry && entry->dirty;
+}
+
+status_t state_read(state_region_t *region, uint64_t offset, void *buf, uint64_t len) {
+    const state_version_t *snapshot;
+    status_t status;
+
+    if (!region) {
+        return STATUS_INVALID_ARG;
+    }
+    snapshot = state_snapshot_acquire(region);
+    status = state_snapshot_read(region, snapshot, offset, buf, len);
+    state_snapshot_release(snapshot);
+    return status;
+}
+
+void state_get_stats(const state_region_t *region, state_stats_t *stats) {
+    if (region && stats) {
+        *stats = region->stats;
+    }
+}
+
+/* ============================================================================
+ * MSI Binding
+ * ============================================================================ */
+
+static msi_result_t to_msi_result(status_t status) {
+    switch (status) {
+    case STATUS_SUCCESS:            return MSI_SUCCESS;
+    case STATUS_NO_MEMORY:          return MSI_ERROR_NO_MEMORY;
+    case STATUS_PERMISSION_DENIED:  return MSI_ERROR_PERMISSION_DENIED;
+    default:                        return MSI_ERROR_INVALID_ARG;
+    }
+}
+
+state_region_t *msi_state_region(const void *addr, uint64_t *offset) {
+    uint64_t rel = (uint64_t)(uintptr_t)addr - STATE_WINDOW_BASE;
+    uint64_t slot = rel / STATE_MAX_SIZE;
+    state_region_t *region;
+
+    if ((uint64_t)(uintptr_t)addr < STATE_WINDOW_BASE || slot >= STATE_MAX_REGIONS) {
+        return NULL;
+    }
+    region = msi_regions[slot];
+    rel %= STATE_MAX_SIZE;
+    if (!region || rel >= region->size) {
+        return NULL;
+    }
+    if (offset) {
+        *offset = rel;
+    }
+    return region;
+}
+
+msi_result_t msi_state_map(void **addr, size_t size, uint32_t flags) {
+    uint32_t state_flags = 0;
+    status_t status;
+
+    if (!cap_current_has(CAP_RIGHT_MSI_STATE)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!addr || (flags & MSI_STATE_EXECUTE) ||
+        (flags & ~(MSI_STATE_READ | MSI_STATE_WRITE | MSI_STATE_SHARED))) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    if (flags & MSI_STATE_READ) {
+        state_flags |= STATE_READ;
+    }
+    if (flags & MSI_STATE_WRITE) {
+        state_flags |= STATE_WRITE;
+    }
+
+    for (uint32_t slot = 0; slot < STATE_MAX_REGIONS; slot++) {
+        if (msi_regions[slot]) {
+            continue;
+        }
+        status = state_region_create(size, state_flags, &msi_regions[slot]);
+        if (status != STATUS_SUCCESS) {
+            return to_msi_result(status);
+        }
+        *addr = (void *)(uintptr_t)(STATE_WINDOW_BASE + slot * STATE_MAX_SIZE);
+        return MSI_SUCCESS;
+    }
+    return MSI_ERROR_NO_MEMORY;
+}
+
+msi_result_t msi_state_read(const void *addr, void *buf, size_t len) {
+    uint64_t offset;
+    state_region_t *region = msi_state_region(addr, &offset);
+
+    if (!cap_current_has(CAP_RIGHT_MSI_STATE)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!region) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+    if (!(region->flags & STATE_READ)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+    return to_msi_result(state_read(region, offset, buf, len));
+}
+
+msi_result_t msi_state_write(void *addr, const void *data, size_t len) {
+    uint64_t offset;
+    state_region_t *region = msi_state_region(addr, &offset);
+
+    if (!cap_current_has(CAP_RIGHT_MSI_STATE)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!region) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+    return to_msi_result(state_write(region, offset, data, len));
+}
+
+msi_result_t msi_state_commit(void *addr, size_t size) {
+    uint64_t offset;
+    state_region_t *region = msi_state_region(addr, &offset);
+
+    if (!cap_current_has(CAP_RIGHT_MSI_STATE)) {
+        return MSI_ERROR_PERMISSION_DENIED;
+    }
+
+    if (!region) {
+        return MSI_ERROR_NOT_FOUND;
+    }
+    if (!range_valid(region, offset, size)) {
+        return MSI_ERROR_INVALID_ARG;
+    }
+    return to_msi_result(state_commit(region, NULL));
+}
@@ -12,7 +12,12 @@
 #include <kernel/memory.h>
 #include <kernel/ipc.h>
 #include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/cycle_budget.h>
+#include <kernel/softirq.h>
 #include <kernel/types.h>
+#include <kernel/log.h>
+#include <kernel/trace.h>
 
 /* Local strncpy implementation (no libc in freestanding kernel) */
 static char *strncpy_local(char *dest, const char *src, size_t n) {
@@ -30,24 +35,30 @@ static char *strncpy_local(char *dest, const char *src, size_t n) {
  * Internal Constants
  * ============================================================================ */
 
-#define PROCESS_STACK_SIZE    8192    /* Default kernel stack size */
 #define KERNEL_STACK_BASE     0xFFFF800000000000  /* High half kernel stack */
 
+/* Slot bitmap words, and summary words with one bit per full bitmap word */
+#define SLOT_WORDS            (MAX_PROCESSES / 64)
+#define SUMMARY_WORDS         (SLOT_WORDS / 64)
+
+#define PID_GENERATION_MASK   ((1U << PROCESS_PID_GENERATION_BITS) - 1)
+
 /* ============================================================================
  * Internal State
  * ============================================================================ */
 
-/* Process table - all processes in the system */
-static process_t process_table[MAX_PROCESSES];
+/* Process table: chunk directory, grown on demand */
+static process_t *pcb_chunks[PROCESS_CHUNKS];
 static bool process_table_initialized = false;
 
+/* Slot allocation: a set bit is a slot in use */
+static uint64_t slot_used[SLOT_WORDS];
+static uint64_t slot_full[SUMMARY_WORDS];
+
 /* Current running process */
 static process_t *current_process = NULL;
 static uint32_t current_pid = KERNEL_PROCESS_ID;
 
-/* Next available PID (TODO: use for sequential PID allocation) */
-static uint32_t next_pid __attribute__((unused)) = INIT_PROCESS_ID;
-
 /* Scheduling queues */
 static process_t *ready_queue[PRIORITY_KERNEL + 1];
 static process_t *current_queue __attribute__((unused)) = NULL;
@@ -63,17 +74,112 @@ static uint8_t kernel_stack[PROCESS_STACK_SIZE] ALIGNED(PAGE_SIZE);
  * ============================================================================ */
 
 /**
- * Find an unused process slot
+ * PCB in a slot, NULL if its chunk was never allocated
+ */
+static inline process_t *slot_pcb(uint32_t slot) {
+    process_t *chunk = pcb_chunks[slot >> PROCESS_CHUNK_SHIFT];
+
+    return chunk ? &chunk[slot & (PROCESS_CHUNK_SIZE - 1)] : NULL;
+}
+
+/**
+ * PCB of a live process, NULL for an unused slot or a stale PID
+ */
+static inline process_t *lookup(uint32_t pid) {
+    if (pid > PROCESS_PID_MAX) {
+        return NULL;
+    }
+
+    process_t *process = slot_pcb(PROCESS_PID_INDEX(pid));
+    if (!process || process->pid != pid || process->magic != PROCESS_MAGIC ||
+        process->state == PROCESS_STATE_UNUSED) {
+        return NULL;
+    }
+    return process;
+}
+
+/**
+ * Claim the lowest free slot
+ *
+ * Find-first-zero over the summary words, then over the one slot word
+ * they point at: at most SUMMARY_WORDS + 1 word reads.
  */
-static uint32_t find_free_pid(void) {
-    for (uint32_t i = 0; i < MAX_PROCESSES; i++) {
-        if (process_table[i].state == PROCESS_STATE_UNUSED) {
-            return i;
+static uint32_t slot_alloc(void) {
+    for (uint32_t s = 0; s < SUMMARY_WORDS; s++) {
+        if (slot_full[s] == ~0ULL) {
+            continue;
+        }
+
+        uint32_t word = s * 64 + __builtin_ctzll(~slot_full[s]);
+        uint32_t bit = __builtin_ctzll(~slot_used[word]);
+
+        slot_used[word] |= 1ULL << bit;
+        if (slot_used[word] == ~0ULL) {
+            slot_full[s] |= 1ULL << (word % 64);
         }
+        return word * 64 + bit;
     }
     return MAX_PROCESSES; /* No free slots */
 }
 
+static void slot_free(uint32_t slot) {
+    uint32_t word = slot / 64;
+
+    slot_used[word] &= ~(1ULL << (slot % 64));
+    slot_full[word / 64] &= ~(1ULL << (word % 64));
+}
+
+/**
+ * Back a slot with memory, allocating its chunk on first use
+ */
+static process_t *slot_grow(uint32_t slot) {
+    process_t **chunk = &pcb_chunks[slot >> PROCESS_CHUNK_SHIFT];
+
+    if (!*chunk) {
+        *chunk = kmalloc(PROCESS_CHUNK_SIZE * sizeof(process_t));
+        if (!*chunk) {
+            return NULL;
+        }
+        memset(*chunk, 0, PROCESS_CHUNK_SIZE * sizeof(process_t));
+        process_statistics.pcb_capacity += PROCESS_CHUNK_SIZE;
+    }
+    return &(*chunk)[slot & (PROCESS_CHUNK_SIZE - 1)];
+}
+
+/**
+ * PID for the next process in a slot: the generation after the last
+ * one, or 0 for a slot never used (its PCB is still zeroed)
+ */
+static uint32_t slot_next_pid(const process_t *pcb, uint32_t slot) {
+    uint32_t generation = 0;
+
+    if (pcb->pid != 0) {
+        generation = (PROCESS_PID_GENERATION(pcb->pid) + 1) & PID_GENERATION_MASK;
+    }
+    return (generation << PROCESS_PID_INDEX_BITS) | slot;
+}
+
+/**
+ * Unlink a process from its parent's child list
+ */
+static void child_unlink(process_t *child) {
+    process_t *parent = child->parent;
+
+    if (child->prev_sibling) {
+        child->prev_sibling->next_sibling = child->next_sibling;
+    } else {
+        parent->first_child = child->next_sibling;
+    }
+    if (child->next_sibling) {
+        child->next_sibling->prev_sibling = child->prev_sibling;
+    }
+    parent->child_count--;
+
+    child->parent = NULL;
+    child->next_sibling = NULL;
+    child->prev_sibling = NULL;
+}
+
 /**
  * Validate process parameters
  */
@@ -220,8 +326,10 @@ status_t process_init(void) {
     
     boot_log("Initializing process management system...");
     
-    /* Clear process table */
-    memset(&process_table, 0, sizeof(process_table));
+    /* Clear process table; chunks are allocated as slots are first used */
+    memset(pcb_chunks, 0, sizeof(pcb_chunks));
+    memset(slot_used, 0, sizeof(slot_used));
+    memset(slot_full, 0, sizeof(slot_full));
     
     /* Initialize ready queues */
     for (int i = 0; i <= PRIORITY_KERNEL; i++) {
@@ -231,6 +339,12 @@ status_t process_init(void) {
     /* Initialize statistics */
     memset(&process_statistics, 0, sizeof(process_statistics));
     
+    /* Initialize cycle budget accounting */
+    cycle_budget_init();
+    
+    /* process_create() refuses to run before this is set */
+    process_table_initialized = true;
+    
     /* Create kernel process */
     status_t result = process_init_kernel_process();
     if (result != STATUS_SUCCESS) {
@@ -245,10 +359,9 @@ status_t process_init(void) {
         return result;
     }
     
-    current_process = &process_table[KERNEL_PROCESS_ID];
+    current_process = slot_pcb(KERNEL_PROCESS_ID);
     current_pid = KERNEL_PROCESS_ID;
-    
-    process_table_initialized = true;
+    current_process->last_scheduled = cpu_rdtsc();
     
     boot_log("Process management system initialized");
     return STATUS_SUCCESS;
@@ -267,60 +380,70 @@ status_t process_create(const process_create_params_t *params, process_t **proce
         return result;
     }
     
-    /* Find free PID */
-    uint32_t pid = find_free_pid();
-    if (pid >= MAX_PROCESSES) {
+    /* Claim a free slot */
+    uint32_t slot = slot_alloc();
+    if (slot >= MAX_PROCESSES) {
         return PROCESS_ERROR_TOO_MANY_PROCESSES;
     }
     
+    process_t *pcb = slot_grow(slot);
+    if (!pcb) {
+        slot_free(slot);
+        return STATUS_NO_MEMORY;
+    }
+    uint32_t pid = slot_next_pid(pcb, slot);
+    
     /* Allocate memory for process */
     void *stack_memory = NULL;
     if (params->type != PROCESS_TYPE_KERNEL) {
         /* TODO: Allocate from user memory pool */
-        stack_memory = (void*)((uintptr_t)0x400000 + (pid * PROCESS_STACK_SIZE));
+        stack_memory = (void*)((uintptr_t)0x400000 + (slot * PROCESS_STACK_SIZE));
     } else {
         stack_memory = &kernel_stack;
     }
     (void)stack_memory; /* TODO: Use for stack setup */
     
     /* Initialize PCB */
-    result = init_process_pcb(&process_table[pid], params, pid);
+    result = init_process_pcb(pcb, params, pid);
     if (result != STATUS_SUCCESS) {
+        slot_free(slot);
         return result;
     }
     
     /* Set up memory management */
     if (params->type != PROCESS_TYPE_KERNEL) {
         /* TODO: Create page directory for user process */
-        process_table[pid].cr3 = 0; /* Physical address of page directory */
+        pcb->cr3 = 0; /* Physical address of page directory */
     } else {
-        process_table[pid].cr3 = 0; /* Use kernel page directory */
-    }
-    
-    /* Add to parent's children list */
-    if (params->parent_pid != KERNEL_PROCESS_ID) {
-        process_add_child(params->parent_pid, pid);
+        pcb->cr3 = 0; /* Use kernel page directory */
     }
     
     /* Initialize IPC for this process */
     ipc_result_t ipc_result = ipc_process_init(pid);
     if (ipc_result != IPC_SUCCESS) {
-        /* Clean up */
-        process_table[pid].state = PROCESS_STATE_UNUSED;
+        /* Clean up; the PID stays recorded so the slot's next one differs */
+        pcb->state = PROCESS_STATE_UNUSED;
+        pcb->magic = 0;
+        slot_free(slot);
         return STATUS_ERROR;
     }
     
+    /* Add to parent's children list */
+    if (params->parent_pid != KERNEL_PROCESS_ID) {
+        process_add_child(params->parent_pid, pid);
+    }
+    
     /* Update statistics */
     process_statistics.total_processes++;
     process_statistics.active_processes++;
     
     /* Set process state to ready */
-    process_table[pid].state = PROCESS_STATE_READY;
-    add_to_ready_queue(&process_table[pid]);
+    pcb->state = PROCESS_STATE_READY;
+    add_to_ready_queue(pcb);
     
-    *process = &process_table[pid];
+    *process = pcb;
     
-    boot_log("Process created successfully");
+    klog(LOG_DEBUG, "Process created successfully");
     return STATUS_SUCCESS;
 }
 
@@ -332,12 +455,11 @@ status_t process_destroy(uint32_t pid) {
         return STATUS_ERROR;
     }
     
-    if (!process_is_valid(pid)) {
+    process_t *process = lookup(pid);
+    if (!process) {
         return PROCESS_ERROR_INVALID_PID;
     }
     
-    process_t *process = &process_table[pid];
-    
     /* Cannot destroy running process */
     if (process == current_process) {
         return PROCESS_ERROR_INVALID_STATE;
@@ -349,14 +471,25 @@ status_t process_destroy(uint32_t pid) {
     /* Clean up IPC resources */
     ipc_process_cleanup(process->pid);
     
+    /* Drop any cycle budget */
+    cycle_budget_clear(process->pid);
+    
     /* Free memory */
     if (process->type != PROCESS_TYPE_KERNEL) {
         /* TODO: Free user memory */
     }
     
     /* Remove from parent's children list */
-    if (process->parent_pid != KERNEL_PROCESS_ID) {
-        process_remove_child(process->parent_pid, pid);
+    if (process->parent) {
+        child_unlink(process);
+    }
+    
+    /* Children are handed to the kernel */
+    while (process->first_child) {
+        process_t *child = process->first_child;
+        
+        child_unlink(child);
+        child->parent_pid = KERNEL_PROCESS_ID;
     }
     
     /* Update statistics */
@@ -364,11 +497,12 @@ status_t process_destroy(uint32_t pid) {
         process_statistics.active_processes--;
     }
     
-    /* Mark process as unused */
+    /* Mark process as unused; the PID stays recorded so the slot's next one differs */
     process->state = PROCESS_STATE_UNUSED;
     process->magic = 0;
+    slot_free(PROCESS_PID_INDEX(pid));
     
-    boot_log("Process destroyed");
+    klog(LOG_DEBUG, "Process destroyed");
     return STATUS_SUCCESS;
 }
 
@@ -380,12 +514,11 @@ status_t process_exit(uint32_t pid, int32_t exit_code) {
         return STATUS_ERROR;
     }
     
-    if (!process_is_valid(pid)) {
+    process_t *process = lookup(pid);
+    if (!process) {
         return PROCESS_ERROR_INVALID_PID;
     }
     
-    process_t *process = &process_table[pid];
-    
     /* Set exit information */
     process->exit_code = exit_code;
     process->has_exited = true;
@@ -401,19 +534,36 @@ status_t process_exit(uint32_t pid, int32_t exit_code) {
     process_statistics.zombie_processes++;
     
     (void)exit_code; /* Exit code stored in PCB */
-    boot_log("Process exited");
+    klog(LOG_DEBUG, "Process exited");
     return STATUS_SUCCESS;
 }
 
+/**
+ * Kill a process
+ *
+ * There is no signal delivery yet: the target exits with -signal.
+ */
+status_t process_kill(uint32_t pid, int32_t signal) {
+    if (pid == KERNEL_PROCESS_ID) {
+        return PROCESS_ERROR_PERMISSION_DENIED;
+    }
+
+    if (process_get_state(pid) == PROCESS_STATE_ZOMBIE) {
+        return PROCESS_ERROR_INVALID_STATE;
+    }
+
+    return process_exit(pid, -signal);
+}
+
 /**
  * Set process state
  */
 status_t process_set_state(uint32_t pid, process_state_t new_state) {
-    if (!process_is_valid(pid)) {
+    process_t *process = lookup(pid);
+    if (!process) {
         return PROCESS_ERROR_INVALID_PID;
     }
     
-    process_t *process = &process_table[pid];
     process_state_t old_state = process->state;
     
     /* Handle queue transitions */
@@ -430,26 +580,53 @@ status_t process_set_state(uint32_t pid, process_state_t new_state) {
     return STATUS_SUCCESS;
 }
 
+/**
+ * Block a process until process_unblock()
+ */
+status_t process_block(uint32_t pid) {
+    process_t *process = lookup(pid);
+    if (!process) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+    
+    process_state_t state = process->state;
+    if (state != PROCESS_STATE_READY && state != PROCESS_STATE_RUNNING) {
+        return PROCESS_ERROR_INVALID_STATE;
+    }
+    
+    return process_set_state(pid, PROCESS_STATE_BLOCKED);
+}
+
+/**
+ * Make a blocked process ready again
+ */
+status_t process_unblock(uint32_t pid) {
+    process_t *process = lookup(pid);
+    if (!process) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+    
+    if (process->state != PROCESS_STATE_BLOCKED) {
+        return PROCESS_ERROR_INVALID_STATE;
+    }
+    
+    return process_set_state(pid, PROCESS_STATE_READY);
+}
+
 /**
  * Get process state
  */
 process_state_t process_get_state(uint32_t pid) {
-    if (!process_is_valid(pid)) {
-        return PROCESS_STATE_UNUSED;
-    }
+    process_t *process = lookup(pid);
     
-    return process_table[pid].state;
+    return process ? process->state : PROCESS_STATE_UNUSED;
 }
 
 /**
  * Get process by PID
  */
 process_t *process_get_by_pid(uint32_t pid) {
-    if (!process_is_valid(pid)) {
-        return NULL;
-    }
-    
-    return &process_table[pid];
+    return lookup(pid);
 }
 
 /**
@@ -459,19 +636,39 @@ process_t *process_get_current(void) {
     return current_process;
 }
 
+/**
+ * Get PID of a process
+ */
+uint32_t process_get_pid(process_t *process) {
+    return process ? process->pid : 0;
+}
+
+/**
+ * Get parent PID (0 if none or invalid)
+ */
+uint32_t process_get_parent(uint32_t pid) {
+    process_t *process = lookup(pid);
+
+    return process ? process->parent_pid : 0;
+}
+
 /**
  * Get next ready process for scheduling
  */
 process_t *process_get_next_ready(void) {
-    /* Find highest priority ready process */
+    uint64_t now = cpu_rdtsc();
+    
+    /* Find highest priority ready process that is not budget-throttled */
     for (int priority = PRIORITY_KERNEL; priority >= 0; priority--) {
-        if (ready_queue[priority]) {
-            return ready_queue[priority];
+        for (process_t *p = ready_queue[priority]; p; p = p->next) {
+            if (!cycle_budget_is_throttled(p->pid, now)) {
+                return p;
+            }
         }
     }
     
     /* No ready processes, return idle process */
-    return &process_table[KERNEL_PROCESS_ID + 1]; /* Assume PID 1 is idle */
+    return slot_pcb(KERNEL_PROCESS_ID + 1); /* Idle takes the slot after the kernel */
 }
 
 /**
@@ -515,17 +712,26 @@ status_t process_switch_to(process_t *process) {
     */
     
     process_t *old_process = current_process;
+    trace_event(TRACE_SCHED_SWITCH, old_process ? old_process->pid : KERNEL_PROCESS_ID, process->pid);
+
+    /* Only READY processes sit on the ready queues */
+    if (old_process && old_process->state == PROCESS_STATE_RUNNING) {
+        process_set_state(old_process->pid, PROCESS_STATE_READY);
+    }
+    process_set_state(process->pid, PROCESS_STATE_RUNNING);
+
     current_process = process;
     current_pid = process->pid;
     
     /* Update statistics */
     process_statistics.context_switches++;
     
-    /* Update timing */
-    uint64_t now = 0; /* TODO: Get system time */
+    /* Update timing and charge the outgoing process's cycle budget */
+    uint64_t now = cpu_rdtsc();
     if (old_process) {
         old_process->runtime_last = now - old_process->last_scheduled;
         old_process->runtime_total += old_process->runtime_last;
+        cycle_budget_charge(old_process->pid, old_process->runtime_last, now);
     }
     process->last_scheduled = now;
     
@@ -536,30 +742,61 @@ status_t process_switch_to(process_t *process) {
  * Check if process is valid
  */
 bool process_is_valid(uint32_t pid) {
-    if (pid >= MAX_PROCESSES) {
-        return false;
-    }
-    
-    process_t *process = &process_table[pid];
-    return (process->magic == PROCESS_MAGIC && 
-            process->state != PROCESS_STATE_UNUSED);
+    return lookup(pid) != NULL;
 }
 
 /**
- * Add child to parent
+ * Check if process is ready to run
+ */
+bool process_is_ready(uint32_t pid) {
+    process_t *process = lookup(pid);
+
+    return process && process->state == PROCESS_STATE_READY;
+}
+
+/**
+ * Check if process is the one running
+ */
+bool process_is_running(uint32_t pid) {
+    process_t *process = lookup(pid);
+
+    return process && process->state == PROCESS_STATE_RUNNING;
+}
+
+/**
+ * Check if process has terminated (zombies included)
+ */
+bool process_is_terminated(uint32_t pid) {
+    process_t *process = lookup(pid);
+
+    return process && (process->state == PROCESS_STATE_TERMINATED ||
+                       process->state == PROCESS_STATE_ZOMBIE);
+}
+
+/**
+ * Add child to parent (at the head of its child list)
  */
 status_t process_add_child(uint32_t parent_pid, uint32_t child_pid) {
-    if (!process_is_valid(parent_pid) || !process_is_valid(child_pid)) {
+    process_t *parent = lookup(parent_pid);
+    process_t *child = lookup(child_pid);
+    
+    if (!parent || !child || parent == child) {
         return PROCESS_ERROR_INVALID_PID;
     }
     
-    process_t *parent = &process_table[parent_pid];
-    
-    if (parent->child_count >= MAX_PROCESSES) {
-        return STATUS_ERROR;
+    /* A process is on at most one child list */
+    if (child->parent) {
+        return PROCESS_ERROR_ALREADY_EXISTS;
     }
     
-    parent->children[parent->child_count++] = child_pid;
+    child->parent = parent;
+    child->prev_sibling = NULL;
+    child->next_sibling = parent->first_child;
+    if (parent->first_child) {
+        parent->first_child->prev_sibling = child;
+    }
+    parent->first_child = child;
+    parent->child_count++;
     return STATUS_SUCCESS;
 }
 
@@ -567,25 +804,19 @@ status_t process_add_child(uint32_t parent_pid, uint32_t child_pid) {
  * Remove child from parent
  */
 status_t process_remove_child(uint32_t parent_pid, uint32_t child_pid) {
-    if (!process_is_valid(parent_pid) || !process_is_valid(child_pid)) {
+    process_t *parent = lookup(parent_pid);
+    process_t *child = lookup(child_pid);
+    
+    if (!parent || !child) {
         return PROCESS_ERROR_INVALID_PID;
     }
     
-    process_t *parent = &process_table[parent_pid];
-    
-    /* Find and remove child */
-    for (uint32_t i = 0; i < parent->child_count; i++) {
-        if (parent->children[i] == child_pid) {
-            /* Shift remaining children */
-            for (uint32_t j = i; j < parent->child_count - 1; j++) {
-                parent->children[j] = parent->children[j + 1];
-            }
-            parent->child_count--;
-            return STATUS_SUCCESS;
-        }
+    if (child->parent != parent) {
+        return PROCESS_ERROR_NOT_FOUND;
     }
     
-    return PROCESS_ERROR_NOT_FOUND;
+    child_unlink(child);
+    return STATUS_SUCCESS;
 }
 
 /**
@@ -609,8 +840,9 @@ status_t process_init_kernel_process(void) {
         return result;
     }
     
-    /* Set kernel process as running */
+    /* Set kernel process as running; the running process is not queued */
     kernel_process->state = PROCESS_STATE_RUNNING;
+    remove_from_ready_queue(kernel_process);
     
     return STATUS_SUCCESS;
 }
@@ -639,6 +871,8 @@ status_t process_init_idle_process(void) {
  */
 void process_idle_task(void) {
     while (1) {
+        /* Pick up softirq work left behind by the restart limit */
+        softirq_run_pending();
         __asm__ volatile("hlt");
     }
 }
@@ -655,25 +889,76 @@ status_t process_get_stats(process_stats_t *stats) {
     return STATUS_SUCCESS;
 }
 
+/**
+ * Mark a process as able (or not) to use quantum resources
+ */
+status_t process_set_quantum_aware(uint32_t pid, bool aware) {
+    process_t *process = lookup(pid);
+
+    if (!process) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+
+    process->quantum.is_quantum_aware = aware;
+    return STATUS_SUCCESS;
+}
+
+bool process_is_quantum_aware(uint32_t pid) {
+    process_t *process = lookup(pid);
+
+    return process && process->quantum.is_quantum_aware;
+}
+
+/**
+ * Add qubits to a quantum-aware process's allocation
+ */
+status_t process_allocate_qubits(uint32_t pid, uint32_t count) {
+    process_t *process = lookup(pid);
+
+    if (!process) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+    if (!process->quantum.is_quantum_aware) {
+        return STATUS_PERMISSION_DENIED;
+    }
+
+    process->quantum.qubit_allocation += count;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Return qubits from a process's allocation
+ */
+status_t process_deallocate_qubits(uint32_t pid, uint32_t count) {
+    process_t *process = lookup(pid);
+
+    if (!process) {
+        return PROCESS_ERROR_INVALID_PID;
+    }
+    if (count > process->quantum.qubit_allocation) {
+        return STATUS_INVALID_ARG;
+    }
+
+    process->quantum.qubit_allocation -= count;
+    return STATUS_SUCCESS;
+}
+
 /**
  * Dump process information for debugging
  */
 void process_dump_info(uint32_t pid) {
-    if (!process_is_valid(pid)) {
-        boot_log("Invalid PID for dump");
+    process_t *process = lookup(pid);
+
+    if (!process) {
+        klog(LOG_WARN, "Invalid PID for dump");
         return;
     }
 
-    process_t *process = &process_table[pid];
-
     boot_log("=== Process Info ===");
     boot_log(process->name);
-    boot_log("State: ");
-    early_console_write_hex(process->state);
-    boot_log("Priority: ");
-    early_console_write_hex(process->priority);
-    boot_log("RIP: ");
-    early_console_write_hex(process->rip);
+    klog_hex(LOG_INFO, "State: ", process->state);
+    klog_hex(LOG_INFO, "Priority: ", process->priority);
+    klog_hex(LOG_INFO, "RIP: ", process->rip);
 }
 
 /**
@@ -681,14 +966,12 @@ void process_dump_info(uint32_t pid) {
  */
 void process_dump_all(void) {
     boot_log("=== Process Table ===");
-    boot_log("Total processes: ");
-    early_console_write_hex(process_statistics.total_processes);
-    boot_log("Active: ");
-    early_console_write_hex(process_statistics.active_processes);
-
-    for (uint32_t i = 0; i < MAX_PROCESSES; i++) {
-        if (process_is_valid(i)) {
-            process_dump_info(i);
+    klog_hex(LOG_INFO, "Total processes: ", process_statistics.total_processes);
+    klog_hex(LOG_INFO, "Active: ", process_statistics.active_processes);
+
+    for (uint32_t word = 0; word < SLOT_WORDS; word++) {
+        for (uint64_t used = slot_used[word]; used; used &= used - 1) {
+            process_dump_info(slot_pcb(word * 64 + __builtin_ctzll(used))->pid);
         }
     }
 }
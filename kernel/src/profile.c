@@ -0,0 +1,406 @@
+/**
+ * QuantumOS Sampling Profiler Implementation
+ *
+ * Uses architectural performance monitoring (CPUID leaf 0xA), which
+ * KVM exposes with -cpu host. Counter 0 is loaded with -period so it
+ * overflows after `period` events; the NMI handler records a sample,
+ * reloads the counter and re-arms the APIC LVT entry, which the CPU
+ * masks on every delivery.
+ *
+ * Sample buffers are written only by their own CPU from NMI or timer
+ * interrupt context, which do not nest with themselves, and are read
+ * only while sampling is stopped.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/profile.h>
+#include <kernel/interrupts.h>
+#include <kernel/serial.h>
+#include <kernel/softirq.h>
+#include <kernel/process.h>
+#include <kernel/boot.h>
+#include <kernel/format.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+
+/* Architectural performance monitoring MSRs */
+#define IA32_PMC0                   0x0C1
+#define IA32_PERFEVTSEL0            0x186
+#define IA32_PERF_GLOBAL_STATUS     0x38E
+#define IA32_PERF_GLOBAL_CTRL       0x38F
+#define IA32_PERF_GLOBAL_OVF_CTRL   0x390
+
+#define PERFEVTSEL_USR              BIT(16)
+#define PERFEVTSEL_OS               BIT(17)
+#define PERFEVTSEL_INT              BIT(20)
+#define PERFEVTSEL_EN               BIT(22)
+
+#define EVENT_CORE_CYCLES           0x003C  /* Event 0x3C, umask 0x00 */
+#define EVENT_INST_RETIRED          0x00C0  /* Event 0xC0, umask 0x00 */
+
+#define CPUID_PERFMON               0x0A
+
+/* Linker symbols bounding code and the memory kernel stacks live in */
+extern char __text_start[], __text_end[];
+extern char __kernel_start[], __heap_end[];
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+typedef struct {
+    profile_sample_t samples[PROFILE_SAMPLES];
+    uint32_t count;
+    uint64_t dropped;
+    uint64_t spurious;
+} ALIGNED(64) profile_cpu_t;
+
+static profile_cpu_t profile_cpus[MAX_CPUS];
+
+static bool pmu_available;
+static uint8_t pmu_version;
+static uint8_t pmu_width;               /* Counter width in bits */
+static uint32_t pmu_missing_events;     /* CPUID.0AH:EBX, set bit = unavailable */
+
+static volatile profile_source_t active_source;
+static profile_event_t active_event;
+static uint64_t active_period;
+
+static tasklet_t dump_tasklet;
+
+static const char *const source_names[] = { "none", "pmu", "timer" };
+static const char *const event_names[] = { "cycles", "instructions" };
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static void pmu_detect(void) {
+    uint32_t eax, ebx, ecx, edx;
+
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0), "c"(0));
+    if (eax < CPUID_PERFMON) {
+        return;
+    }
+
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(CPUID_PERFMON), "c"(0));
+    pmu_version = eax & 0xFF;
+    pmu_width = (eax >> 16) & 0xFF;
+    pmu_missing_events = ebx;
+
+    /* Version, at least one counter, and a usable width */
+    pmu_available = pmu_version >= 1 && ((eax >> 8) & 0xFF) >= 1 &&
+                    pmu_width > 32 && pmu_width <= 64 && apic_is_enabled();
+}
+
+/**
+ * Load counter 0 so it overflows after `period` more events
+ *
+ * A 32-bit write sign-extends into the full counter width.
+ */
+static void pmu_reload(void) {
+    cpu_wrmsr(IA32_PMC0, (uint32_t)-(int32_t)active_period);
+}
+
+static void pmu_program(profile_event_t event) {
+    uint64_t select = (event == PROFILE_EVENT_INSTRUCTIONS) ? EVENT_INST_RETIRED : EVENT_CORE_CYCLES;
+
+    cpu_wrmsr(IA32_PERFEVTSEL0, 0);
+    pmu_reload();
+    if (pmu_version >= 2) {
+        cpu_wrmsr(IA32_PERF_GLOBAL_OVF_CTRL, BIT(0));
+        cpu_wrmsr(IA32_PERF_GLOBAL_CTRL, cpu_rdmsr(IA32_PERF_GLOBAL_CTRL) | BIT(0));
+    }
+    apic_set_perf_nmi(true);
+    cpu_wrmsr(IA32_PERFEVTSEL0, select | PERFEVTSEL_USR | PERFEVTSEL_OS |
+                                PERFEVTSEL_INT | PERFEVTSEL_EN);
+}
+
+static void pmu_disable(void) {
+    cpu_wrmsr(IA32_PERFEVTSEL0, 0);
+    if (pmu_version >= 2) {
+        cpu_wrmsr(IA32_PERF_GLOBAL_CTRL, cpu_rdmsr(IA32_PERF_GLOBAL_CTRL) & ~1ULL);
+        cpu_wrmsr(IA32_PERF_GLOBAL_OVF_CTRL, BIT(0));
+    }
+    apic_set_perf_nmi(false);
+}
+
+/**
+ * Check whether counter 0 has overflowed since it was loaded
+ */
+static bool pmu_overflowed(void) {
+    if (pmu_version >= 2) {
+        return cpu_rdmsr(IA32_PERF_GLOBAL_STATUS) & BIT(0);
+    }
+
+    /* Version 1: the counter started negative, so a clear top bit means it wrapped */
+    return !(cpu_rdmsr(IA32_PMC0) & (1ULL << (pmu_width - 1)));
+}
+
+static bool frame_valid(uint64_t fp) {
+    return (fp & 7) == 0 &&
+           fp >= (uint64_t)(uintptr_t)__kernel_start &&
+           fp + 16 <= (uint64_t)(uintptr_t)__heap_end;
+}
+
+static bool text_address(uint64_t addr) {
+    return addr >= (uint64_t)(uintptr_t)__text_start &&
+           addr < (uint64_t)(uintptr_t)__text_end;
+}
+
+/**
+ * Record the interrupted context into this CPU's buffer
+ */
+static void record_sample(const cpu_state_t *state) {
+    uint32_t cpu = cpu_current_id();
+    profile_cpu_t *buf = &profile_cpus[cpu];
+
+    if (buf->count >= PROFILE_SAMPLES) {
+        buf->dropped++;
+        return;
+    }
+
+    profile_sample_t *sample = &buf->samples[buf->count];
+    process_t *current = process_get_current();
+
+    sample->rip = state->rip;
+    sample->pid = current ? current->pid : KERNEL_PROCESS_ID;
+    sample->cpu = (uint8_t)cpu;
+    sample->depth = 0;
+    sample->flags = 0;
+
+    if (state->cs & 3) {
+        sample->flags |= PROFILE_SAMPLE_USER;
+    } else {
+        /* Frame layout: [fp] = caller's fp, [fp + 8] = return address */
+        uint64_t fp = state->rbp;
+        while (sample->depth < PROFILE_MAX_DEPTH && frame_valid(fp)) {
+            const uint64_t *frame = (const uint64_t *)(uintptr_t)fp;
+            if (!text_address(frame[1])) {
+                break;
+            }
+            sample->frames[sample->depth++] = frame[1];
+            if (frame[0] <= fp) {
+                break;
+            }
+            fp = frame[0];
+        }
+    }
+
+    buf->count++;
+}
+
+static void dump_tasklet_fn(uint64_t data) {
+    (void)data;
+    profile_dump();
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Detect the PMU and accept console commands (local APIC must be up)
+ */
+status_t profile_init(void) {
+    pmu_detect();
+    active_source = PROFILE_SOURCE_NONE;
+    profile_reset();
+
+    tasklet_init(&dump_tasklet, dump_tasklet_fn, 0);
+    serial_register_rx_handler(profile_command);
+
+    if (pmu_available) {
+        klog_hex(LOG_INFO, "Profiler: PMU version ", pmu_version);
+    } else {
+        klog(LOG_INFO, "Profiler: no PMU, timer-tick sampling only");
+    }
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Start sampling every `period` events, or every timer tick without a PMU
+ *
+ * @return STATUS_BUSY if already running
+ */
+status_t profile_start(profile_event_t event, uint64_t period) {
+    if (active_source != PROFILE_SOURCE_NONE) {
+        return STATUS_BUSY;
+    }
+    if (period == 0 || period > PROFILE_MAX_PERIOD) {
+        return STATUS_INVALID_ARG;
+    }
+
+    active_event = event;
+    active_period = period;
+
+    bool missing = (event == PROFILE_EVENT_INSTRUCTIONS) ? (pmu_missing_events & BIT(1))
+                                                         : (pmu_missing_events & BIT(0));
+    if (pmu_available && !missing) {
+        active_source = PROFILE_SOURCE_PMU;
+        pmu_program(event);
+    } else {
+        active_source = PROFILE_SOURCE_TIMER;
+    }
+
+    return STATUS_SUCCESS;
+}
+
+void profile_stop(void) {
+    if (active_source == PROFILE_SOURCE_PMU) {
+        pmu_disable();
+    }
+    active_source = PROFILE_SOURCE_NONE;
+}
+
+/**
+ * Discard all samples (sampling must be stopped)
+ */
+void profile_reset(void) {
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        profile_cpus[cpu].count = 0;
+        profile_cpus[cpu].dropped = 0;
+        profile_cpus[cpu].spurious = 0;
+    }
+}
+
+/**
+ * Write every sample to the serial console, then reset the buffers
+ *
+ * Sampling is paused for the dump and resumed afterwards.
+ */
+void profile_dump(void) {
+    profile_source_t source = active_source;
+    uint64_t total = 0, dropped = 0;
+    char line[48 + 17 * (PROFILE_MAX_DEPTH + 1)];
+    uint32_t len;
+
+    profile_stop();
+    log_set_sync(true);
+
+    len = fmt_str(line, 0, "#PROFILE-BEGIN ");
+    len = fmt_dec(line, len, PROFILE_VERSION);
+    line[len++] = ' ';
+    len = fmt_str(line, len, source_names[source]);
+    line[len++] = ' ';
+    len = fmt_str(line, len, source == PROFILE_SOURCE_TIMER ? "tick" : event_names[active_event]);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, source == PROFILE_SOURCE_TIMER ? 1 : active_period);
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        profile_cpu_t *buf = &profile_cpus[cpu];
+
+        for (uint32_t i = 0; i < buf->count; i++) {
+            const profile_sample_t *sample = &buf->samples[i];
+
+            len = fmt_str(line, 0, "#S ");
+            len = fmt_hex(line, len, sample->cpu);
+            line[len++] = ' ';
+            len = fmt_hex(line, len, sample->pid);
+            line[len++] = ' ';
+            len = fmt_hex(line, len, sample->flags);
+            line[len++] = ' ';
+            len = fmt_hex(line, len, sample->rip);
+            for (uint32_t f = 0; f < sample->depth; f++) {
+                line[len++] = ' ';
+                len = fmt_hex(line, len, sample->frames[f]);
+            }
+            len = fmt_str(line, len, "\r\n");
+            serial_write_sync(line, len);
+        }
+
+        total += buf->count;
+        dropped += buf->dropped;
+    }
+
+    len = fmt_str(line, 0, "#PROFILE-END ");
+    len = fmt_dec(line, len, total);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, dropped);
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    log_set_sync(false);
+    profile_reset();
+
+    if (source != PROFILE_SOURCE_NONE) {
+        profile_start(active_event, active_period);
+    }
+}
+
+/**
+ * Console command handler (serial receive interrupt)
+ */
+void profile_command(char c) {
+    switch (c) {
+        case PROFILE_CMD_START:
+            profile_start(PROFILE_EVENT_CYCLES, PROFILE_DEFAULT_PERIOD);
+            break;
+        case PROFILE_CMD_STOP:
+            profile_stop();
+            break;
+        case PROFILE_CMD_DUMP:
+            tasklet_schedule(&dump_tasklet);
+            break;
+        default:
+            break;
+    }
+}
+
+void profile_get_stats(profile_stats_t *stats) {
+    stats->samples = 0;
+    stats->dropped = 0;
+    stats->spurious = 0;
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        stats->samples += profile_cpus[cpu].count;
+        stats->dropped += profile_cpus[cpu].dropped;
+        stats->spurious += profile_cpus[cpu].spurious;
+    }
+
+    stats->source = active_source;
+    stats->pmu_available = pmu_available;
+}
+
+/**
+ * NMI path: claim the NMI if counter 0 overflowed
+ *
+ * @return true if the NMI came from the profiler
+ */
+bool profile_nmi(cpu_state_t *state) {
+    if (!pmu_available || !pmu_overflowed()) {
+        return false;
+    }
+
+    if (active_source != PROFILE_SOURCE_PMU) {
+        /* Overflow raced with profile_stop() */
+        profile_cpus[cpu_current_id()].spurious++;
+        if (pmu_version >= 2) {
+            cpu_wrmsr(IA32_PERF_GLOBAL_OVF_CTRL, BIT(0));
+        }
+        return true;
+    }
+
+    record_sample(state);
+
+    pmu_reload();
+    if (pmu_version >= 2) {
+        cpu_wrmsr(IA32_PERF_GLOBAL_OVF_CTRL, BIT(0));
+    }
+    apic_set_perf_nmi(true);
+
+    return true;
+}
+
+/**
+ * Timer path: sample when no PMU is driving the profile
+ */
+void profile_timer_tick(cpu_state_t *state) {
+    if (active_source == PROFILE_SOURCE_TIMER) {
+        record_sample(state);
+    }
+}
@@ -15,6 +15,8 @@
 #include <kernel/resonance/resonant_scheduler.h>
 #include <kernel/boot.h>
 #include <kernel/memory.h>
+#include <kernel/trace.h>
+#include <kernel/entropy.h>
 
 /* ============================================================================
  * Mathematical Helpers
@@ -66,11 +68,9 @@ static double clamp(double value, double min, double max) {
     return value;
 }
 
-/* Simple PRNG for noise injection */
-static uint32_t rng_state = 12345;
+/* Uniform in [0, 1) for noise injection, 53 bits from the entropy pool */
 static double random_double(void) {
-    rng_state = rng_state * 1103515245 + 12345;
-    return (double)(rng_state & 0x7FFFFFFF) / (double)0x7FFFFFFF;
+    return (double)(entropy_get_u64() >> 11) * (1.0 / 9007199254740992.0);
 }
 
 /* ============================================================================
@@ -107,10 +107,13 @@ static const resonant_config_t default_config = {
  * Internal Helpers
  * ============================================================================ */
 
+/* RPCBs are indexed by PCB slot and answer only for the PID they were made for */
 static resonant_pcb_t *get_rpcb_internal(uint32_t pid) {
-    if (pid >= MAX_RESONANT_PROCESSES) return NULL;
-    if (!RPCB_IS_VALID(&rpcb_table[pid])) return NULL;
-    return &rpcb_table[pid];
+    if (pid > PROCESS_PID_MAX || PROCESS_PID_INDEX(pid) >= MAX_RESONANT_PROCESSES) return NULL;
+
+    resonant_pcb_t *rpcb = &rpcb_table[PROCESS_PID_INDEX(pid)];
+    if (!RPCB_IS_VALID(rpcb) || rpcb->pid != pid) return NULL;
+    return rpcb;
 }
 
 static void init_oscillator(oscillator_state_t *osc, resonant_class_t rclass) {
@@ -361,7 +364,7 @@ resonant_result_t resonant_register(
         return RESONANT_ERROR_NOT_INITIALIZED;
     }
 
-    if (pid >= MAX_RESONANT_PROCESSES) {
+    if (pid > PROCESS_PID_MAX || PROCESS_PID_INDEX(pid) >= MAX_RESONANT_PROCESSES) {
         return RESONANT_ERROR_INVALID_PID;
     }
 
@@ -370,7 +373,7 @@ resonant_result_t resonant_register(
         return RESONANT_ERROR_INVALID_PID;
     }
 
-    resonant_pcb_t *rpcb = &rpcb_table[pid];
+    resonant_pcb_t *rpcb = &rpcb_table[PROCESS_PID_INDEX(pid)];
 
     /* Initialize RPCB */
     memset(rpcb, 0, sizeof(resonant_pcb_t));
@@ -686,14 +689,16 @@ resonant_result_t resonant_sync(void) {
         return RESONANT_ERROR_NOT_INITIALIZED;
     }
 
+    trace_event(TRACE_RESONANT_SYNC_BEGIN, queen_state.sync_count, 0);
+
     /* Update all oscillators */
     for (uint32_t i = 0; i < MAX_RESONANT_PROCESSES; i++) {
         resonant_pcb_t *rpcb = &rpcb_table[i];
         if (!RPCB_IS_VALID(rpcb)) continue;
         if (rpcb->rstate == RESONANT_STATE_DORMANT) continue;
 
-        resonant_update_oscillator(i, current_config.sync_interval_ns);
-        resonant_update_emergence(i);
+        resonant_update_oscillator(rpcb->pid, current_config.sync_interval_ns);
+        resonant_update_emergence(rpcb->pid);
     }
 
     /* Update Queen order parameter */
@@ -737,6 +742,8 @@ resonant_result_t resonant_sync(void) {
     queen_state.sync_count++;
     queen_state.last_sync = 0;  /* TODO: Get system time */
 
+    trace_event(TRACE_RESONANT_SYNC_END, count, 0);
+
     return RESONANT_SUCCESS;
 }
 
@@ -926,7 +933,7 @@ resonant_result_t resonant_reset_all(void) {
 
     for (uint32_t i = 0; i < MAX_RESONANT_PROCESSES; i++) {
         if (RPCB_IS_VALID(&rpcb_table[i])) {
-            resonant_reset_process(i);
+            resonant_reset_process(rpcb_table[i].pid);
         }
     }
 
@@ -967,7 +974,7 @@ void resonant_dump_state(int32_t pid) {
         boot_log("=== All Resonant Processes ===");
         for (uint32_t i = 0; i < MAX_RESONANT_PROCESSES; i++) {
             if (RPCB_IS_VALID(&rpcb_table[i])) {
-                resonant_dump_state((int32_t)i);
+                resonant_dump_state((int32_t)rpcb_table[i].pid);
             }
         }
     }
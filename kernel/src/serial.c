@@ -0,0 +1,180 @@
+/**
+ * QuantumOS Serial Console (16550 UART)
+ *
+ * Transmit pump for the log ring. The pump is single-entrant: whoever
+ * wins tx_busy moves up to one FIFO's worth of bytes and leaves the
+ * THRE interrupt enabled while the ring still holds data. A writer that
+ * loses the race relies on the winner re-checking the ring after it
+ * drops tx_busy, so no committed record is left behind. While the
+ * interrupt is armed, writers skip the port accesses altogether.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/serial.h>
+#include <kernel/log.h>
+#include <kernel/interrupts.h>
+#include <kernel/cpu.h>
+#include <kernel/io.h>
+#include <kernel/types.h>
+
+#define SERIAL_PORT(reg)        (SERIAL_COM1_BASE + (reg))
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static bool serial_irq_on;
+static uint8_t tx_busy;
+static volatile bool tx_armed;          /* THRE interrupt will refill the FIFO */
+static serial_rx_handler_t rx_handlers[SERIAL_RX_HANDLERS];
+static uint32_t rx_handler_count;
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static uint8_t rx_ier(void) {
+    return rx_handler_count ? SERIAL_IER_RDA : 0;
+}
+
+/**
+ * Move bytes from the log ring into the transmit FIFO
+ */
+static void serial_tx_pump(void) {
+    for (;;) {
+        if (__atomic_exchange_n(&tx_busy, 1, __ATOMIC_ACQUIRE)) {
+            return;
+        }
+
+        if (inb(SERIAL_PORT(SERIAL_LSR)) & SERIAL_LSR_THRE) {
+            char c;
+            for (int i = 0; i < SERIAL_FIFO_SIZE && log_ring_pop(&c); i++) {
+                outb(SERIAL_PORT(SERIAL_THR), (uint8_t)c);
+            }
+        }
+
+        bool more = !log_ring_empty();
+        tx_armed = more;
+        outb(SERIAL_PORT(SERIAL_IER), rx_ier() | (more ? SERIAL_IER_THRE : 0));
+
+        __atomic_store_n(&tx_busy, 0, __ATOMIC_RELEASE);
+
+        /* A record committed while we held tx_busy found us busy */
+        if (more || log_ring_empty()) {
+            return;
+        }
+    }
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Program COM1 for 115200 8N1 with FIFOs, interrupts off
+ */
+void serial_init(void) {
+    uint16_t divisor = 115200 / SERIAL_BAUD;
+
+    outb(SERIAL_PORT(SERIAL_IER), 0);
+    outb(SERIAL_PORT(SERIAL_LCR), SERIAL_LCR_DLAB);
+    outb(SERIAL_PORT(SERIAL_DLL), divisor & 0xFF);
+    outb(SERIAL_PORT(SERIAL_DLM), divisor >> 8);
+    outb(SERIAL_PORT(SERIAL_LCR), SERIAL_LCR_8N1);
+    outb(SERIAL_PORT(SERIAL_FCR), SERIAL_FCR_ENABLE);
+    outb(SERIAL_PORT(SERIAL_MCR), SERIAL_MCR_OUT2);
+
+    serial_irq_on = false;
+}
+
+/**
+ * Switch to interrupt-driven transmit (interrupt system must be up)
+ */
+void serial_enable_irq(void) {
+    serial_irq_on = true;
+    outb(SERIAL_PORT(SERIAL_IER), rx_ier());
+    pic_unmask_irq(IRQ_COM1);
+    serial_tx_kick();
+}
+
+/**
+ * Back to polled transmit (panic path); the caller drains the ring
+ */
+void serial_disable_irq(void) {
+    serial_irq_on = false;
+    tx_armed = false;
+    outb(SERIAL_PORT(SERIAL_IER), 0);
+}
+
+bool serial_irq_enabled(void) {
+    return serial_irq_on;
+}
+
+/**
+ * Write one byte, waiting for the transmitter
+ */
+void serial_putc_sync(char c) {
+    while (!(inb(SERIAL_PORT(SERIAL_LSR)) & SERIAL_LSR_THRE)) {
+        __asm__ volatile("pause");
+    }
+    outb(SERIAL_PORT(SERIAL_THR), (uint8_t)c);
+}
+
+/**
+ * Write a buffer synchronously, uninterrupted by other console output
+ */
+void serial_write_sync(const char *buf, uint32_t len) {
+    uint64_t flags = cpu_irq_save();
+    for (uint32_t i = 0; i < len; i++) {
+        serial_putc_sync(buf[i]);
+    }
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Deliver received bytes to `handler` (interrupt context)
+ *
+ * Register before serial_enable_irq(); handlers cannot be removed.
+ */
+status_t serial_register_rx_handler(serial_rx_handler_t handler) {
+    if (!handler) {
+        return STATUS_INVALID_ARG;
+    }
+    if (rx_handler_count >= SERIAL_RX_HANDLERS) {
+        return STATUS_BUSY;
+    }
+
+    rx_handlers[rx_handler_count++] = handler;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Start transmission of newly committed log data
+ */
+void serial_tx_kick(void) {
+    if (!serial_irq_on || tx_armed) {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    serial_tx_pump();
+    cpu_irq_restore(flags);
+}
+
+/**
+ * IRQ4: transmitter empty or received data
+ */
+void serial_irq_handler(void) {
+    /* Reading IIR acknowledges a THRE interrupt */
+    (void)inb(SERIAL_PORT(SERIAL_IIR));
+
+    while (inb(SERIAL_PORT(SERIAL_LSR)) & SERIAL_LSR_DR) {
+        char c = (char)inb(SERIAL_PORT(SERIAL_RBR));
+        for (uint32_t i = 0; i < rx_handler_count; i++) {
+            rx_handlers[i](c);
+        }
+    }
+
+    serial_tx_pump();
+}
@@ -0,0 +1,315 @@
+/**
+ * QuantumOS Deferred Interrupt Work Implementation
+ *
+ * Softirqs and tasklets run on the outermost IRQ exit with interrupts
+ * enabled, so the hard-IRQ window is only the top half plus the EOI.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/softirq.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+#include <kernel/log.h>
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+/**
+ * Per-CPU deferred work state
+ */
+typedef struct {
+    volatile uint32_t pending;      /* Raised softirq bits */
+    uint32_t irq_depth;             /* Hard-IRQ nesting depth */
+    bool in_softirq;                /* Softirq loop active */
+    uint64_t irq_entry_tsc;         /* TSC at outermost IRQ entry */
+
+    tasklet_t *tasklet_head[2];     /* [0] = HI, [1] = normal */
+    tasklet_t **tasklet_tail[2];
+
+    softirq_stats_t stats;
+} __attribute__((aligned(64))) softirq_cpu_t;
+
+static softirq_cpu_t softirq_cpu[MAX_CPUS];
+static softirq_handler_t softirq_handlers[SOFTIRQ_COUNT];
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static inline softirq_cpu_t *this_cpu(void) {
+    return &softirq_cpu[cpu_current_id()];
+}
+
+/**
+ * Run pending softirqs; called and returns with interrupts disabled
+ */
+static void do_softirq(softirq_cpu_t *cpu) {
+    uint32_t restart = SOFTIRQ_MAX_RESTART;
+
+    cpu->in_softirq = true;
+
+    do {
+        uint32_t pending = cpu->pending;
+        cpu->pending = 0;
+
+        cpu_irq_enable();
+
+        while (pending) {
+            uint32_t nr = __builtin_ctz(pending);
+            pending &= pending - 1;
+
+            if (softirq_handlers[nr]) {
+                softirq_handlers[nr]();
+                cpu->stats.softirq_runs[nr]++;
+            }
+        }
+
+        cpu_irq_disable();
+    } while (cpu->pending && --restart);
+
+    /* Anything still pending runs on the next IRQ exit or idle pass */
+    if (cpu->pending) {
+        cpu->stats.restart_limit_hits++;
+    }
+
+    cpu->in_softirq = false;
+}
+
+static void tasklet_enqueue(tasklet_t *t, uint32_t list, uint32_t nr) {
+    uint64_t flags = cpu_irq_save();
+    softirq_cpu_t *cpu = this_cpu();
+
+    if (!(t->state & TASKLET_STATE_SCHED)) {
+        t->state |= TASKLET_STATE_SCHED;
+        t->next = NULL;
+        *cpu->tasklet_tail[list] = t;
+        cpu->tasklet_tail[list] = &t->next;
+        cpu->pending |= BIT(nr);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Drain one tasklet list; runs from softirq context with interrupts on
+ */
+static void tasklet_action(uint32_t list) {
+    softirq_cpu_t *cpu = this_cpu();
+
+    uint64_t flags = cpu_irq_save();
+    tasklet_t *t = cpu->tasklet_head[list];
+    cpu->tasklet_head[list] = NULL;
+    cpu->tasklet_tail[list] = &cpu->tasklet_head[list];
+    cpu_irq_restore(flags);
+
+    while (t) {
+        tasklet_t *next = t->next;
+
+        /* Clear SCHED first so the callback may reschedule itself */
+        t->state |= TASKLET_STATE_RUN;
+        t->state &= ~TASKLET_STATE_SCHED;
+        t->func(t->data);
+        t->state &= ~TASKLET_STATE_RUN;
+
+        cpu->stats.tasklet_runs++;
+        t = next;
+    }
+}
+
+static void tasklet_hi_action(void) {
+    tasklet_action(0);
+}
+
+static void tasklet_normal_action(void) {
+    tasklet_action(1);
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Initialize deferred work
+ */
+status_t softirq_init(void) {
+    memset(softirq_cpu, 0, sizeof(softirq_cpu));
+    memset(softirq_handlers, 0, sizeof(softirq_handlers));
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        softirq_cpu[i].tasklet_tail[0] = &softirq_cpu[i].tasklet_head[0];
+        softirq_cpu[i].tasklet_tail[1] = &softirq_cpu[i].tasklet_head[1];
+    }
+
+    softirq_register(SOFTIRQ_HI, tasklet_hi_action);
+    softirq_register(SOFTIRQ_TASKLET, tasklet_normal_action);
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Install the handler for a softirq number
+ */
+status_t softirq_register(uint32_t nr, softirq_handler_t handler) {
+    if (nr >= SOFTIRQ_COUNT || !handler) {
+        return STATUS_INVALID_ARG;
+    }
+
+    if (softirq_handlers[nr]) {
+        return STATUS_BUSY;
+    }
+
+    softirq_handlers[nr] = handler;
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Mark a softirq pending on this CPU
+ *
+ * Safe from hard-IRQ context; the softirq runs on the next IRQ exit.
+ */
+void softirq_raise(uint32_t nr) {
+    if (nr >= SOFTIRQ_COUNT) {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    this_cpu()->pending |= BIT(nr);
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Check for pending softirqs on this CPU
+ */
+bool softirq_pending(void) {
+    return this_cpu()->pending != 0;
+}
+
+/**
+ * Run pending softirqs from process context (e.g. the idle loop)
+ */
+void softirq_run_pending(void) {
+    if (in_interrupt()) {
+        return;
+    }
+
+    uint64_t flags = cpu_irq_save();
+    softirq_cpu_t *cpu = this_cpu();
+
+    if (cpu->pending) {
+        do_softirq(cpu);
+    }
+
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Initialize a tasklet
+ */
+void tasklet_init(tasklet_t *t, void (*func)(uint64_t data), uint64_t data) {
+    t->next = NULL;
+    t->func = func;
+    t->data = data;
+    t->state = 0;
+}
+
+/**
+ * Queue a tasklet on this CPU (no-op if already queued)
+ */
+void tasklet_schedule(tasklet_t *t) {
+    tasklet_enqueue(t, 1, SOFTIRQ_TASKLET);
+}
+
+/**
+ * Queue a tasklet ahead of timer and normal tasklet work
+ */
+void tasklet_hi_schedule(tasklet_t *t) {
+    tasklet_enqueue(t, 0, SOFTIRQ_HI);
+}
+
+/**
+ * Note entry to hard-IRQ context
+ */
+void irq_enter(void) {
+    softirq_cpu_t *cpu = this_cpu();
+
+    if (cpu->irq_depth++ == 0) {
+        cpu->irq_entry_tsc = cpu_rdtsc();
+    }
+}
+
+/**
+ * Leave hard-IRQ context, running softirqs on the outermost exit
+ *
+ * Interrupts have been disabled since entry (interrupt gates), so the
+ * time from the outermost irq_enter() to here is the hard-IRQ window.
+ */
+void irq_exit(void) {
+    softirq_cpu_t *cpu = this_cpu();
+
+    if (--cpu->irq_depth != 0) {
+        return;
+    }
+
+    uint64_t irqoff = cpu_rdtsc() - cpu->irq_entry_tsc;
+    if (irqoff > cpu->stats.irqoff_max_cycles) {
+        cpu->stats.irqoff_max_cycles = irqoff;
+    }
+
+    if (cpu->pending && !cpu->in_softirq) {
+        do_softirq(cpu);
+    }
+}
+
+/**
+ * Check for hard-IRQ or softirq context
+ */
+bool in_interrupt(void) {
+    softirq_cpu_t *cpu = this_cpu();
+    return cpu->irq_depth != 0 || cpu->in_softirq;
+}
+
+/**
+ * Get deferred work statistics summed over all CPUs
+ */
+status_t softirq_get_stats(softirq_stats_t *stats) {
+    if (!stats) {
+        return STATUS_INVALID_ARG;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    for (int i = 0; i < MAX_CPUS; i++) {
+        softirq_stats_t *s = &softirq_cpu[i].stats;
+
+        for (int nr = 0; nr < SOFTIRQ_COUNT; nr++) {
+            stats->softirq_runs[nr] += s->softirq_runs[nr];
+        }
+        stats->tasklet_runs += s->tasklet_runs;
+        stats->restart_limit_hits += s->restart_limit_hits;
+        stats->irqoff_max_cycles = MAX(stats->irqoff_max_cycles, s->irqoff_max_cycles);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Dump deferred work statistics
+ */
+void softirq_dump_stats(void) {
+    softirq_stats_t stats;
+    softirq_get_stats(&stats);
+
+    boot_log("=== Softirq Statistics ===");
+    for (int nr = 0; nr < SOFTIRQ_COUNT; nr++) {
+        if (stats.softirq_runs[nr] > 0) {
+            klog_hex(LOG_INFO, "Softirq: ", nr);
+            klog_hex(LOG_INFO, "  runs: ", stats.softirq_runs[nr]);
+        }
+    }
+    klog_hex(LOG_INFO, "Tasklets run: ", stats.tasklet_runs);
+    klog_hex(LOG_INFO, "Restart limit hits: ", stats.restart_limit_hits);
+    klog_hex(LOG_INFO, "Max IRQ-off cycles: ", stats.irqoff_max_cycles);
+}
@@ -0,0 +1,503 @@
+/**
+ * QuantumOS System Call Dispatch
+ *
+ * Programs the SYSCALL MSRs, owns the per-CPU syscall stacks and the
+ * dispatch table shared by the SYSCALL fast path (syscall.S) and the
+ * `int $SYSCALL_VECTOR` gate.
+ *
+ * Handlers take raw register arguments and return a status code in RAX.
+ * There is no user address space yet, so pointer arguments are passed
+ * through unchecked; validation belongs here once user mappings exist.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/syscall.h>
+#include <kernel/interrupts.h>
+#include <kernel/process.h>
+#include <kernel/ipc.h>
+#include <kernel/capability.h>
+#include <kernel/boot.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+#include <msi.h>
+
+#define MSR_EFER                0xC0000080
+#define MSR_STAR                0xC0000081
+#define MSR_LSTAR               0xC0000082
+#define MSR_FMASK               0xC0000084
+#define MSR_KERNEL_GS_BASE      0xC0000102
+
+#define EFER_SCE                BIT(0)
+
+/* RFLAGS bits cleared on entry: TF, IF, DF, AC */
+#define SYSCALL_FMASK           (BIT(8) | BIT(9) | BIT(10) | BIT(18))
+
+#define CPUID_EXT_FEATURES      0x80000001
+#define CPUID_EXT_SYSCALL       BIT(11)
+
+extern void syscall_entry(void);
+
+/* Layout is hard-coded in syscall.S */
+_Static_assert(offsetof(syscall_cpu_t, kernel_rsp) == 0, "syscall.S offset");
+_Static_assert(offsetof(syscall_cpu_t, user_rsp) == 8, "syscall.S offset");
+_Static_assert(offsetof(syscall_cpu_t, kernel_caller) == 16, "syscall.S offset");
+_Static_assert(offsetof(syscall_cpu_t, count) == 24, "syscall.S offset");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static syscall_cpu_t syscall_cpus[MAX_CPUS];
+static uint8_t syscall_stacks[MAX_CPUS][SYSCALL_STACK_SIZE] ALIGNED(16);
+static bool syscall_fast_path;
+
+/* Per-call rights check (kernel/capability.h); both entries pass through it */
+static inline bool caller_may(uint32_t right) {
+    return cap_current_has(right);
+}
+
+/* ============================================================================
+ * System Call Handlers
+ * ============================================================================ */
+
+static int64_t sys_null(uint64_t a0, uint64_t a1, uint64_t a2,
+                        uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a0; (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return STATUS_SUCCESS;
+}
+
+/* Reserved numbers whose subsystem is not linked into the kernel */
+static int64_t sys_not_implemented(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a0; (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+static int64_t sys_process_getpid(uint64_t a0, uint64_t a1, uint64_t a2,
+                                  uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a0; (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return process_get_pid(process_get_current());
+}
+
+static int64_t sys_process_exit(uint64_t a0, uint64_t a1, uint64_t a2,
+                                uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return process_exit(process_get_pid(process_get_current()), (int32_t)a0);
+}
+
+static int64_t sys_process_kill(uint64_t a0, uint64_t a1, uint64_t a2,
+                                uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_PROCESS_KILL)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return process_kill((uint32_t)a0, (int32_t)a1);
+}
+
+static int64_t sys_process_yield(uint64_t a0, uint64_t a1, uint64_t a2,
+                                 uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a0; (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return process_schedule_next();
+}
+
+static int64_t sys_process_get_state(uint64_t a0, uint64_t a1, uint64_t a2,
+                                     uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return process_get_state((uint32_t)a0);
+}
+
+static int64_t sys_process_get_parent(uint64_t a0, uint64_t a1, uint64_t a2,
+                                      uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return process_get_parent((uint32_t)a0);
+}
+
+static int64_t sys_ipc_send(uint64_t a0, uint64_t a1, uint64_t a2,
+                            uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_SEND)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_send((uint32_t)a0, (const ipc_message_t *)a1, a2);
+}
+
+static int64_t sys_ipc_receive(uint64_t a0, uint64_t a1, uint64_t a2,
+                               uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_receive((uint32_t *)a0, (ipc_message_t *)a1, a2);
+}
+
+static int64_t sys_ipc_reply(uint64_t a0, uint64_t a1, uint64_t a2,
+                             uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_SEND)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_reply((const ipc_message_t *)a0, (const ipc_message_t *)a1);
+}
+
+static int64_t sys_ipc_call(uint64_t a0, uint64_t a1, uint64_t a2,
+                            uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_SEND)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_call((uint32_t)a0, (const ipc_message_t *)a1, (ipc_message_t *)a2, a3);
+}
+
+static int64_t sys_ipc_port_create(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_PORT)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_port_create((const char *)a0, (uint32_t *)a1);
+}
+
+static int64_t sys_ipc_port_destroy(uint64_t a0, uint64_t a1, uint64_t a2,
+                                    uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_PORT)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_port_destroy((uint32_t)a0);
+}
+
+static int64_t sys_ipc_port_lookup(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_PORT)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_port_lookup((const char *)a0, (uint32_t *)a1);
+}
+
+static int64_t sys_ipc_port_send(uint64_t a0, uint64_t a1, uint64_t a2,
+                                 uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_PORT)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_port_send((uint32_t)a0, (const ipc_message_t *)a1);
+}
+
+static int64_t sys_ipc_port_receive(uint64_t a0, uint64_t a1, uint64_t a2,
+                                    uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_PORT)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_port_receive((uint32_t)a0, (ipc_message_t *)a1, a2);
+}
+
+static int64_t sys_ipc_queue_depth(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a0; (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_get_queue_depth();
+}
+
+static int64_t sys_ipc_endpoint_create(uint64_t a0, uint64_t a1, uint64_t a2,
+                                       uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_endpoint_create((uint32_t)a0, (uint32_t)a1, (uint32_t *)a2);
+}
+
+static int64_t sys_ipc_endpoint_grant(uint64_t a0, uint64_t a1, uint64_t a2,
+                                      uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_SEND)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_endpoint_grant((uint32_t)a0, (uint32_t)a1, (uint32_t)a2, (uint32_t *)a3);
+}
+
+static int64_t sys_ipc_endpoint_delete(uint64_t a0, uint64_t a1, uint64_t a2,
+                                       uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_endpoint_delete((uint32_t)a0);
+}
+
+static int64_t sys_ipc_endpoint_send(uint64_t a0, uint64_t a1, uint64_t a2,
+                                     uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_SEND)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_endpoint_send((uint32_t)a0, (const ipc_message_t *)a1, (uint32_t)a2);
+}
+
+static int64_t sys_ipc_waitset_create(uint64_t a0, uint64_t a1, uint64_t a2,
+                                      uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_waitset_create((uint32_t *)a0);
+}
+
+static int64_t sys_ipc_waitset_destroy(uint64_t a0, uint64_t a1, uint64_t a2,
+                                       uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_waitset_destroy((uint32_t)a0);
+}
+
+static int64_t sys_ipc_waitset_add(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_waitset_add((uint32_t)a0, (uint32_t)a1, (uint32_t)a2, (uint32_t)a3, a4);
+}
+
+static int64_t sys_ipc_waitset_remove(uint64_t a0, uint64_t a1, uint64_t a2,
+                                      uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_waitset_remove((uint32_t)a0, (uint32_t)a1, (uint32_t)a2);
+}
+
+static int64_t sys_ipc_waitset_collect(uint64_t a0, uint64_t a1, uint64_t a2,
+                                       uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a4; (void)a5;
+    if (!caller_may(CAP_RIGHT_IPC_RECEIVE)) {
+        return STATUS_PERMISSION_DENIED;
+    }
+    return ipc_waitset_collect((uint32_t)a0, (waitset_event_t *)a1, (uint32_t)a2,
+                               (uint32_t *)a3);
+}
+
+/*
+ * MSI state and associative memory. The msi_* entry points check
+ * CAP_RIGHT_MSI_STATE and CAP_RIGHT_MSI_ASSOC themselves, so in-kernel
+ * callers are held to the same rights; results are msi_result_t.
+ */
+static int64_t sys_msi_state_commit(uint64_t a0, uint64_t a1, uint64_t a2,
+                                    uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    return msi_state_commit((void *)a0, a1);
+}
+
+static int64_t sys_msi_assoc_put(uint64_t a0, uint64_t a1, uint64_t a2,
+                                 uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return msi_assoc_put((const msi_assoc_entry_t *)a0);
+}
+
+static int64_t sys_msi_assoc_get(uint64_t a0, uint64_t a1, uint64_t a2,
+                                 uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a2; (void)a3; (void)a4; (void)a5;
+    return msi_assoc_get((const uint8_t *)a0, (msi_assoc_entry_t *)a1);
+}
+
+static int64_t sys_msi_assoc_query(uint64_t a0, uint64_t a1, uint64_t a2,
+                                   uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a3; (void)a4; (void)a5;
+    return msi_assoc_query((const uint8_t *)a0, (msi_assoc_entry_t *)a1, a2);
+}
+
+static int64_t sys_msi_assoc_forget(uint64_t a0, uint64_t a1, uint64_t a2,
+                                    uint64_t a3, uint64_t a4, uint64_t a5) {
+    (void)a1; (void)a2; (void)a3; (void)a4; (void)a5;
+    return msi_assoc_forget((const uint8_t *)a0);
+}
+
+/* ============================================================================
+ * Dispatch Table
+ * ============================================================================ */
+
+/* Indexed directly by syscall_entry; every slot must be populated */
+const syscall_fn_t syscall_table[SYS_COUNT] = {
+    [SYS_NULL]              = sys_null,
+
+    [SYS_PROCESS_GETPID]    = sys_process_getpid,
+    [SYS_PROCESS_EXIT]      = sys_process_exit,
+    [SYS_PROCESS_KILL]      = sys_process_kill,
+    [SYS_PROCESS_YIELD]     = sys_process_yield,
+    [SYS_PROCESS_GET_STATE] = sys_process_get_state,
+    [SYS_PROCESS_GET_PARENT] = sys_process_get_parent,
+
+    [SYS_IPC_SEND]          = sys_ipc_send,
+    [SYS_IPC_RECEIVE]       = sys_ipc_receive,
+    [SYS_IPC_REPLY]         = sys_ipc_reply,
+    [SYS_IPC_CALL]          = sys_ipc_call,
+    [SYS_IPC_PORT_CREATE]   = sys_ipc_port_create,
+    [SYS_IPC_PORT_DESTROY]  = sys_ipc_port_destroy,
+    [SYS_IPC_PORT_LOOKUP]   = sys_ipc_port_lookup,
+    [SYS_IPC_PORT_SEND]     = sys_ipc_port_send,
+    [SYS_IPC_PORT_RECEIVE]  = sys_ipc_port_receive,
+    [SYS_IPC_QUEUE_DEPTH]   = sys_ipc_queue_depth,
+
+    /* msi_version, msi_capabilities and msi_event_* have no kernel side yet */
+    [SYS_MSI_VERSION]       = sys_not_implemented,
+    [SYS_MSI_CAPABILITIES]  = sys_not_implemented,
+    [SYS_MSI_EVENT_PUBLISH] = sys_not_implemented,
+    [SYS_MSI_STATE_COMMIT]  = sys_msi_state_commit,
+    [SYS_MSI_ASSOC_PUT]     = sys_msi_assoc_put,
+    [SYS_MSI_ASSOC_GET]     = sys_msi_assoc_get,
+    [SYS_MSI_ASSOC_QUERY]   = sys_msi_assoc_query,
+    [SYS_MSI_ASSOC_FORGET]  = sys_msi_assoc_forget,
+
+    [SYS_IPC_ENDPOINT_CREATE] = sys_ipc_endpoint_create,
+    [SYS_IPC_ENDPOINT_GRANT]  = sys_ipc_endpoint_grant,
+    [SYS_IPC_ENDPOINT_DELETE] = sys_ipc_endpoint_delete,
+    [SYS_IPC_ENDPOINT_SEND]   = sys_ipc_endpoint_send,
+
+    [SYS_IPC_WAITSET_CREATE]  = sys_ipc_waitset_create,
+    [SYS_IPC_WAITSET_DESTROY] = sys_ipc_waitset_destroy,
+    [SYS_IPC_WAITSET_ADD]     = sys_ipc_waitset_add,
+    [SYS_IPC_WAITSET_REMOVE]  = sys_ipc_waitset_remove,
+    [SYS_IPC_WAITSET_COLLECT] = sys_ipc_waitset_collect,
+};
+
+const uint64_t syscall_table_size = SYS_COUNT;
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Legacy software-interrupt entry: same numbers and registers as SYSCALL
+ */
+static void syscall_int_handler(cpu_state_t *state) {
+    state->rax = (uint64_t)syscall_dispatch(state->rax, state->rdi, state->rsi,
+                                            state->rdx, state->r10, state->r8, state->r9);
+}
+
+static bool cpu_has_syscall(void) {
+    uint32_t eax, ebx, ecx, edx;
+    __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(CPUID_EXT_FEATURES), "c"(0));
+    return (edx & CPUID_EXT_SYSCALL) != 0;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Enable SYSCALL on this CPU and install the `int $SYSCALL_VECTOR` gate
+ *
+ * The kernel runs with GS base 0; SWAPGS exchanges it with
+ * IA32_KERNEL_GS_BASE, which points at this CPU's syscall_cpu_t.
+ */
+status_t syscall_init(void) {
+    uint32_t cpu = cpu_current_id();
+    syscall_cpu_t *pcpu = &syscall_cpus[cpu];
+
+    pcpu->kernel_rsp = (uint64_t)&syscall_stacks[cpu][SYSCALL_STACK_SIZE];
+    pcpu->user_rsp = 0;
+    pcpu->kernel_caller = 0;
+    pcpu->count = 0;
+
+    /* Reachable from ring 3 so user code without SYSCALL can still enter */
+    idt_set_gate(SYSCALL_VECTOR, (uint64_t)vector_stub_table[SYSCALL_VECTOR - IRQ_VECTOR_DYNAMIC_BASE],
+                 0x08, GATE_TYPE_INTERRUPT | DPL_USER);
+    if (interrupt_register(SYSCALL_VECTOR, syscall_int_handler, NULL) != IRQ_SUCCESS) {
+        klog(LOG_WARN, "Syscall vector already in use");
+    }
+
+    if (!cpu_has_syscall()) {
+        boot_log("SYSCALL not supported, using int 0x80 only");
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    cpu_wrmsr(MSR_STAR, ((uint64_t)SYSCALL_USER_BASE << 48) | ((uint64_t)SYSCALL_KERNEL_CS << 32));
+    cpu_wrmsr(MSR_LSTAR, (uint64_t)syscall_entry);
+    cpu_wrmsr(MSR_FMASK, SYSCALL_FMASK);
+    cpu_wrmsr(MSR_KERNEL_GS_BASE, (uint64_t)pcpu);
+    cpu_wrmsr(MSR_EFER, cpu_rdmsr(MSR_EFER) | EFER_SCE);
+
+    syscall_fast_path = true;
+    boot_log("SYSCALL/SYSRET entry enabled");
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Dispatch a system call by number (slow paths and in-kernel callers)
+ */
+int64_t syscall_dispatch(uint64_t nr, uint64_t a0, uint64_t a1, uint64_t a2,
+                         uint64_t a3, uint64_t a4, uint64_t a5) {
+    if (nr >= SYS_COUNT) {
+        return STATUS_NOT_IMPLEMENTED;
+    }
+
+    syscall_cpus[cpu_current_id()].count++;
+    return syscall_table[nr](a0, a1, a2, a3, a4, a5);
+}
+
+/**
+ * System calls taken on all CPUs through either entry
+ */
+uint64_t syscall_count(void) {
+    uint64_t total = 0;
+
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        total += syscall_cpus[cpu].count;
+    }
+
+    return total;
+}
+
+/**
+ * Measure round trips of argument-less call `nr` through both entries
+ *
+ * Runs in ring 0, so the SYSCALL figure covers the entry stub and
+ * dispatch but returns with a jump instead of SYSRET (which always
+ * lands in CPL 3). The int figure is a full IDT entry and IRETQ.
+ */
+status_t syscall_benchmark(uint64_t nr, uint32_t iterations, syscall_bench_t *result) {
+    if (!result || iterations == 0 || nr >= SYS_COUNT) {
+        return STATUS_INVALID_ARG;
+    }
+
+    result->syscall_cycles = 0;
+    result->int80_cycles = 0;
+
+    if (syscall_fast_path) {
+        syscall_cpu_t *pcpu = &syscall_cpus[cpu_current_id()];
+        pcpu->kernel_caller = 1;
+
+        uint64_t start = cpu_rdtsc();
+        for (uint32_t i = 0; i < iterations; i++) {
+            uint64_t rax = nr;
+            __asm__ volatile("syscall"
+                             : "+a"(rax)
+                             :
+                             : "rcx", "r11", "rdi", "rsi", "rdx", "r8", "r9", "r10", "memory");
+        }
+        result->syscall_cycles = (cpu_rdtsc() - start) / iterations;
+
+        pcpu->kernel_caller = 0;
+    }
+
+    uint64_t start = cpu_rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t rax = nr;
+        __asm__ volatile("int %1"
+                         : "+a"(rax)
+                         : "i"(SYSCALL_VECTOR)
+                         : "memory");
+    }
+    result->int80_cycles = (cpu_rdtsc() - start) / iterations;
+
+    return STATUS_SUCCESS;
+}
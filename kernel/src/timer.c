@@ -0,0 +1,204 @@
+/**
+ * QuantumOS Kernel Timer Implementation
+ *
+ * Time base and per-CPU timer wheels. Kernel time is the TSC scaled to
+ * microseconds with a mult/shift pair calibrated against PIT channel 2
+ * at boot. The PIT channel 0 tick raises the timer softirq, which
+ * advances the local wheel and runs expired timers with interrupts
+ * enabled.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/timer.h>
+#include <kernel/softirq.h>
+#include <kernel/vdso.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/io.h>
+#include <kernel/types.h>
+#include <kernel/log.h>
+
+#define PIT_FREQUENCY           1193182
+#define PIT_CHANNEL0            0x40
+#define PIT_CHANNEL2            0x42
+#define PIT_COMMAND             0x43
+#define PIT_GATE_PORT           0x61
+
+#define TSC_CALIBRATE_MS        10
+#define TSC_FALLBACK_KHZ        2000000     /* Used if calibration fails */
+#define TSC_US_SHIFT            32
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static timer_wheel_t timer_wheels[MAX_CPUS];
+static uint64_t tsc_khz;
+static uint64_t tsc_us_mult;
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Count TSC cycles across a PIT channel 2 one-shot of TSC_CALIBRATE_MS
+ */
+static uint64_t calibrate_tsc_khz(void) {
+    uint16_t count = PIT_FREQUENCY / (1000 / TSC_CALIBRATE_MS);
+
+    /* Gate channel 2 on, speaker off */
+    outb(PIT_GATE_PORT, (inb(PIT_GATE_PORT) & ~0x02) | 0x01);
+
+    /* Channel 2, lobyte/hibyte, mode 0 (interrupt on terminal count) */
+    outb(PIT_COMMAND, 0xB0);
+    outb(PIT_CHANNEL2, count & 0xFF);
+    outb(PIT_CHANNEL2, count >> 8);
+
+    /* Restart the count by toggling the gate */
+    uint8_t gate = inb(PIT_GATE_PORT) & ~0x01;
+    outb(PIT_GATE_PORT, gate);
+    outb(PIT_GATE_PORT, gate | 0x01);
+
+    uint64_t start = cpu_rdtsc();
+    uint32_t spins = 0;
+    while (!(inb(PIT_GATE_PORT) & 0x20)) {
+        if (++spins == 0x1000000) {
+            return 0;
+        }
+    }
+    uint64_t end = cpu_rdtsc();
+
+    return (end - start) / TSC_CALIBRATE_MS;
+}
+
+static void pit_set_periodic(uint32_t hz) {
+    uint16_t divisor = PIT_FREQUENCY / hz;
+
+    outb(PIT_COMMAND, 0x36);    /* Channel 0, lobyte/hibyte, mode 3 */
+    outb(PIT_CHANNEL0, divisor & 0xFF);
+    outb(PIT_CHANNEL0, divisor >> 8);
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Calibrate the time base, start the periodic tick and reset all wheels
+ */
+status_t timer_init(void) {
+    tsc_khz = calibrate_tsc_khz();
+    if (tsc_khz == 0) {
+        klog(LOG_WARN, "TSC calibration failed, assuming 2 GHz");
+        tsc_khz = TSC_FALLBACK_KHZ;
+    }
+
+    tsc_us_mult = (1000ULL << TSC_US_SHIFT) / tsc_khz;
+    vdso_update_clock(0, 0, tsc_us_mult, TSC_US_SHIFT, tsc_khz);
+
+    klog_hex(LOG_INFO, "TSC frequency (kHz): ", tsc_khz);
+
+    uint64_t now = timer_now_us();
+    for (int cpu = 0; cpu < MAX_CPUS; cpu++) {
+        timer_wheel_init(&timer_wheels[cpu], now);
+    }
+
+    pit_set_periodic(TIMER_HZ);
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Microseconds since boot (TSC based)
+ */
+uint64_t timer_now_us(void) {
+    return (uint64_t)(((unsigned __int128)cpu_rdtsc() * tsc_us_mult) >> TSC_US_SHIFT);
+}
+
+/**
+ * Calibrated TSC frequency in kHz
+ */
+uint64_t timer_tsc_khz(void) {
+    return tsc_khz;
+}
+
+/**
+ * Initialize a timer
+ */
+void ktimer_init(ktimer_t *timer, void (*func)(uint64_t data), uint64_t data) {
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expires = 0;
+    timer->func = func;
+    timer->data = data;
+    timer->wheel = NULL;
+    timer->level = 0;
+    timer->slot = 0;
+}
+
+/**
+ * Arm a timer on the current CPU, re-arming it if already pending
+ */
+status_t ktimer_add(ktimer_t *timer, uint64_t delay_us) {
+    if (!timer || !timer->func) {
+        return STATUS_INVALID_ARG;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    timer_wheel_cancel(timer);
+    timer->expires = timer_now_us() + delay_us;
+    timer_wheel_add(&timer_wheels[cpu_current_id()], timer);
+
+    cpu_irq_restore(flags);
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Cancel a timer
+ *
+ * @return true if the timer was pending
+ */
+bool ktimer_cancel(ktimer_t *timer) {
+    uint64_t flags = cpu_irq_save();
+    bool pending = timer_wheel_cancel(timer);
+    cpu_irq_restore(flags);
+
+    return pending;
+}
+
+/**
+ * Check whether a timer is armed
+ */
+bool ktimer_pending(const ktimer_t *timer) {
+    return timer->wheel != NULL;
+}
+
+/**
+ * Next timer event on this CPU, for programming a tickless idle wake-up
+ *
+ * @return Absolute microseconds, or TIMER_NO_EXPIRY if no timers
+ */
+uint64_t timer_next_expiry_us(void) {
+    uint64_t flags = cpu_irq_save();
+    uint64_t next = timer_wheel_next_event(&timer_wheels[cpu_current_id()]);
+    cpu_irq_restore(flags);
+
+    return next;
+}
+
+/**
+ * Run expired timers on this CPU (timer softirq)
+ */
+void timer_run_expired(void) {
+    uint64_t flags = cpu_irq_save();
+    ktimer_t *timer = timer_wheel_advance(&timer_wheels[cpu_current_id()], timer_now_us());
+    cpu_irq_restore(flags);
+
+    while (timer) {
+        ktimer_t *next = timer->next;
+        timer->next = NULL;
+        timer->func(timer->data);
+        timer = next;
+    }
+}
@@ -0,0 +1,228 @@
+/**
+ * QuantumOS Hierarchical Timing Wheel
+ *
+ * Level L slot s holds timers whose expiry, taken at level-L granularity,
+ * has index s. A timer lives at the lowest level whose range covers its
+ * remaining time, so when the clock reaches the start of a level-L slot
+ * every timer in it is due within one level-(L-1) rotation and is
+ * re-inserted (cascaded) one level down. Level-0 slots are exact.
+ *
+ * Pure data structure: no locking, allocation or kernel calls. Callers
+ * serialise access (kernel: interrupts off on the owning CPU).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/timer.h>
+#include <kernel/types.h>
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+#define LEVEL_SHIFT(level)  ((level) * TIMER_WHEEL_BITS)
+
+static inline uint64_t rotr64(uint64_t x, uint32_t r) {
+    return r ? (x >> r) | (x << (64 - r)) : x;
+}
+
+/**
+ * Link a timer into the slot matching its expiry relative to wheel->clk
+ */
+static void enqueue(timer_wheel_t *wheel, ktimer_t *timer) {
+    uint64_t expires = timer->expires;
+    uint32_t level = 0;
+
+    if (expires < wheel->clk) {
+        expires = wheel->clk;
+    }
+
+    uint64_t delta = expires - wheel->clk;
+    if (delta > TIMER_WHEEL_MAX_DELTA) {
+        delta = TIMER_WHEEL_MAX_DELTA;
+        expires = wheel->clk + delta;
+    }
+
+    if (delta) {
+        level = (63 - __builtin_clzll(delta)) / TIMER_WHEEL_BITS;
+    }
+
+    uint32_t slot = (expires >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+    ktimer_t **head = &wheel->slots[level][slot];
+
+    timer->next = *head;
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = head;
+    *head = timer;
+
+    timer->wheel = wheel;
+    timer->level = level;
+    timer->slot = slot;
+    wheel->bitmap[level] |= 1ULL << slot;
+}
+
+/**
+ * Detach a whole slot, clearing its bitmap bit
+ */
+static ktimer_t *detach_slot(timer_wheel_t *wheel, uint32_t level, uint32_t slot) {
+    ktimer_t *list = wheel->slots[level][slot];
+
+    wheel->slots[level][slot] = NULL;
+    wheel->bitmap[level] &= ~(1ULL << slot);
+
+    return list;
+}
+
+/**
+ * Re-insert every timer of the level's current slot one level down
+ */
+static void cascade(timer_wheel_t *wheel, uint32_t level) {
+    uint32_t slot = (wheel->clk >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+    ktimer_t *timer = detach_slot(wheel, level, slot);
+
+    while (timer) {
+        ktimer_t *next = timer->next;
+        enqueue(wheel, timer);
+        timer = next;
+    }
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Initialize an empty wheel starting at time `now`
+ */
+void timer_wheel_init(timer_wheel_t *wheel, uint64_t now) {
+    wheel->clk = now;
+    wheel->pending_count = 0;
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        wheel->bitmap[level] = 0;
+        for (uint32_t slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            wheel->slots[level][slot] = NULL;
+        }
+    }
+}
+
+/**
+ * Add a timer; timer->expires must be set and the timer not pending
+ *
+ * A timer that is already due fires on the next advance.
+ */
+void timer_wheel_add(timer_wheel_t *wheel, ktimer_t *timer) {
+    enqueue(wheel, timer);
+    wheel->pending_count++;
+}
+
+/**
+ * Remove a pending timer
+ *
+ * @return true if the timer was pending
+ */
+bool timer_wheel_cancel(ktimer_t *timer) {
+    timer_wheel_t *wheel = timer->wheel;
+    if (!wheel) {
+        return false;
+    }
+
+    *timer->pprev = timer->next;
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+
+    if (!wheel->slots[timer->level][timer->slot]) {
+        wheel->bitmap[timer->level] &= ~(1ULL << timer->slot);
+    }
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->wheel = NULL;
+    wheel->pending_count--;
+
+    return true;
+}
+
+/**
+ * Next tick at which the wheel has work: an expiry or a cascade
+ *
+ * Cascade points are never later than the expiries they lead to, so
+ * this is a safe wake-up time for tickless idle.
+ *
+ * @return Absolute time in microseconds, or TIMER_NO_EXPIRY if empty
+ */
+uint64_t timer_wheel_next_event(const timer_wheel_t *wheel) {
+    if (wheel->pending_count == 0) {
+        return TIMER_NO_EXPIRY;
+    }
+
+    uint64_t next = TIMER_NO_EXPIRY;
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        if (!wheel->bitmap[level]) {
+            continue;
+        }
+
+        uint64_t unit = 1ULL << LEVEL_SHIFT(level);
+        uint64_t start = ALIGN_UP(wheel->clk, unit);
+        uint32_t cur = (start >> LEVEL_SHIFT(level)) & TIMER_WHEEL_MASK;
+        uint32_t distance = __builtin_ctzll(rotr64(wheel->bitmap[level], cur));
+        uint64_t when = start + distance * unit;
+
+        if (when < next) {
+            next = when;
+        }
+    }
+
+    return next;
+}
+
+/**
+ * Advance the wheel to `now`, collecting every timer with expires <= now
+ *
+ * Idle stretches are skipped using the slot bitmaps, so the cost is
+ * proportional to the number of events, not elapsed time.
+ *
+ * @return Expired timers linked through ->next (detached, not pending)
+ */
+ktimer_t *timer_wheel_advance(timer_wheel_t *wheel, uint64_t now) {
+    ktimer_t *expired = NULL;
+    ktimer_t **tail = &expired;
+
+    while (wheel->clk <= now) {
+        uint64_t next = timer_wheel_next_event(wheel);
+        if (next > now) {
+            wheel->clk = now + 1;
+            break;
+        }
+
+        wheel->clk = next;
+
+        /* Cascade every level whose slot boundary is reached */
+        for (uint32_t level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (wheel->clk & ((1ULL << LEVEL_SHIFT(level)) - 1)) {
+                break;
+            }
+            cascade(wheel, level);
+        }
+
+        ktimer_t *timer = detach_slot(wheel, 0, wheel->clk & TIMER_WHEEL_MASK);
+        wheel->clk++;
+
+        while (timer) {
+            timer->pprev = NULL;
+            timer->wheel = NULL;
+            wheel->pending_count--;
+
+            *tail = timer;
+            tail = &timer->next;
+            timer = timer->next;
+        }
+    }
+
+    *tail = NULL;
+    return expired;
+}
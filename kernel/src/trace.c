@@ -0,0 +1,202 @@
+/**
+ * QuantumOS Kernel Trace Buffer Implementation
+ *
+ * One ring per CPU, written only by that CPU. A record position is
+ * reserved with an atomic increment so interrupts nesting on the same
+ * CPU get distinct slots; no other synchronisation is needed. Dumping
+ * stops tracing first so the rings are stable while they are read.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/trace.h>
+#include <kernel/serial.h>
+#include <kernel/softirq.h>
+#include <kernel/process.h>
+#include <kernel/timer.h>
+#include <kernel/boot.h>
+#include <kernel/format.h>
+#include <kernel/log.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+
+#define TRACE_RING_MASK         (TRACE_RING_RECORDS - 1)
+
+_Static_assert((TRACE_RING_RECORDS & TRACE_RING_MASK) == 0, "ring size must be a power of two");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+typedef struct {
+    trace_record_t records[TRACE_RING_RECORDS];
+    uint64_t head;                  /* Total records reserved */
+} ALIGNED(64) trace_cpu_t;
+
+volatile uint32_t trace_key;
+
+static trace_cpu_t trace_cpus[MAX_CPUS];
+static tasklet_t dump_tasklet;
+
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+static void dump_tasklet_fn(uint64_t data) {
+    (void)data;
+    trace_dump();
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Reset the rings and accept console commands; tracing starts disabled
+ */
+status_t trace_init(void) {
+    trace_key = 0;
+    trace_clear();
+
+    tasklet_init(&dump_tasklet, dump_tasklet_fn, 0);
+    serial_register_rx_handler(trace_command);
+
+    boot_log("Trace buffer ready (console: T start, S stop, D dump)");
+    return STATUS_SUCCESS;
+}
+
+/**
+ * Store one record in this CPU's ring (called through trace_event())
+ */
+void trace_record(trace_event_t event, uint64_t arg0, uint64_t arg1) {
+    uint32_t cpu = cpu_current_id();
+    trace_cpu_t *ring = &trace_cpus[cpu];
+    uint64_t pos = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_record_t *rec = &ring->records[pos & TRACE_RING_MASK];
+    process_t *current = process_get_current();
+
+    rec->tsc = cpu_rdtsc();
+    rec->event = (uint16_t)event;
+    rec->cpu = (uint8_t)cpu;
+    rec->reserved = 0;
+    rec->pid = current ? current->pid : KERNEL_PROCESS_ID;
+    rec->arg0 = arg0;
+    rec->arg1 = arg1;
+}
+
+void trace_enable(uint32_t events) {
+    __atomic_fetch_or(&trace_key, events & TRACE_ALL_EVENTS, __ATOMIC_RELAXED);
+}
+
+void trace_disable(uint32_t events) {
+    __atomic_fetch_and(&trace_key, ~events, __ATOMIC_RELAXED);
+}
+
+/**
+ * Discard all recorded events
+ */
+void trace_clear(void) {
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        __atomic_store_n(&trace_cpus[cpu].head, 0, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * Write every ring to the serial console and clear them
+ *
+ * Tracing is stopped for the duration and restored afterwards. Takes
+ * about 6 ms per record at 115200 baud, so this is for debugging only.
+ */
+void trace_dump(void) {
+    uint32_t saved = __atomic_exchange_n(&trace_key, 0, __ATOMIC_ACQ_REL);
+    uint64_t total = 0, overwritten = 0;
+    uint32_t cpus = 0;
+    char line[80];
+    uint32_t len;
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        if (trace_cpus[cpu].head) {
+            cpus = cpu + 1;
+        }
+    }
+
+    /* Keep log lines from interleaving with a record line */
+    log_set_sync(true);
+
+    len = fmt_str(line, 0, "#TRACE-BEGIN ");
+    len = fmt_dec(line, len, TRACE_VERSION);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, cpus);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, timer_tsc_khz());
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    for (uint32_t cpu = 0; cpu < cpus; cpu++) {
+        trace_cpu_t *ring = &trace_cpus[cpu];
+        uint64_t head = ring->head;
+        uint64_t first = head > TRACE_RING_RECORDS ? head - TRACE_RING_RECORDS : 0;
+
+        for (uint64_t pos = first; pos < head; pos++) {
+            const uint8_t *bytes = (const uint8_t *)&ring->records[pos & TRACE_RING_MASK];
+
+            len = fmt_str(line, 0, "#T ");
+            for (uint32_t i = 0; i < TRACE_RECORD_SIZE; i++) {
+                len = fmt_hex_byte(line, len, bytes[i]);
+            }
+            len = fmt_str(line, len, "\r\n");
+            serial_write_sync(line, len);
+        }
+
+        total += head - first;
+        overwritten += first;
+    }
+
+    len = fmt_str(line, 0, "#TRACE-END ");
+    len = fmt_dec(line, len, total);
+    line[len++] = ' ';
+    len = fmt_dec(line, len, overwritten);
+    len = fmt_str(line, len, "\r\n");
+    serial_write_sync(line, len);
+
+    log_set_sync(false);
+
+    trace_clear();
+    __atomic_store_n(&trace_key, saved, __ATOMIC_RELEASE);
+}
+
+/**
+ * Console command handler (serial receive interrupt)
+ */
+void trace_command(char c) {
+    switch (c) {
+        case TRACE_CMD_START:
+            trace_enable(TRACE_ALL_EVENTS);
+            break;
+        case TRACE_CMD_STOP:
+            trace_disable(TRACE_ALL_EVENTS);
+            break;
+        case TRACE_CMD_DUMP:
+            /* Far too slow for the interrupt; run it from a tasklet */
+            tasklet_schedule(&dump_tasklet);
+            break;
+        default:
+            break;
+    }
+}
+
+void trace_get_stats(trace_stats_t *stats) {
+    stats->recorded = 0;
+    stats->overwritten = 0;
+
+    for (uint32_t cpu = 0; cpu < MAX_CPUS; cpu++) {
+        uint64_t head = __atomic_load_n(&trace_cpus[cpu].head, __ATOMIC_RELAXED);
+        stats->recorded += head;
+        if (head > TRACE_RING_RECORDS) {
+            stats->overwritten += head - TRACE_RING_RECORDS;
+        }
+    }
+
+    stats->enabled = trace_key;
+}
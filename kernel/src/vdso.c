@@ -0,0 +1,164 @@
+/**
+ * QuantumOS vDSO Data Pages
+ *
+ * Kernel side of the clock and per-process status pages: the timer
+ * publishes its TSC conversion after calibration and the IPC layer
+ * publishes queue state whenever a process queue changes.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/vdso.h>
+#include <kernel/process.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+
+_Static_assert(sizeof(vdso_clock_t) == VDSO_PAGE_SIZE, "clock page must be one page");
+_Static_assert(sizeof(vdso_proc_t) == VDSO_PAGE_SIZE, "status page must be one page");
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+static vdso_clock_t vdso_clock;
+static vdso_proc_t *vdso_proc_chunks[PROCESS_CHUNKS];   /* By PCB slot, grown on demand */
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Status page for a PID's slot; with `grow`, the page-aligned chunk is
+ * allocated on first use, otherwise NULL if it never was
+ */
+static vdso_proc_t *proc_slot(uint32_t pid, bool grow) {
+    if (pid > PROCESS_PID_MAX) {
+        return NULL;
+    }
+
+    uint32_t slot = PROCESS_PID_INDEX(pid);
+    vdso_proc_t **chunk = &vdso_proc_chunks[slot >> PROCESS_CHUNK_SHIFT];
+
+    if (!*chunk) {
+        if (!grow) {
+            return NULL;
+        }
+        /* One spare page so the chunk can start on a page boundary */
+        uint8_t *base = kmalloc((PROCESS_CHUNK_SIZE + 1) * VDSO_PAGE_SIZE);
+        if (!base) {
+            return NULL;
+        }
+        *chunk = (vdso_proc_t *)ALIGN_UP((uintptr_t)base, VDSO_PAGE_SIZE);
+        memset(*chunk, 0, PROCESS_CHUNK_SIZE * VDSO_PAGE_SIZE);
+    }
+    return &(*chunk)[slot & (PROCESS_CHUNK_SIZE - 1)];
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+/**
+ * Publish the TSC-to-microseconds conversion
+ */
+void vdso_update_clock(uint64_t tsc_base, uint64_t base_us, uint64_t tsc_mult,
+                       uint32_t tsc_shift, uint64_t tsc_khz) {
+    uint64_t flags = cpu_irq_save();
+
+    vdso_write_begin(&vdso_clock.seq);
+    vdso_clock.version = VDSO_VERSION;
+    vdso_clock.tsc_base = tsc_base;
+    vdso_clock.base_us = base_us;
+    vdso_clock.tsc_mult = tsc_mult;
+    vdso_clock.tsc_shift = tsc_shift;
+    vdso_clock.tsc_khz = tsc_khz;
+    vdso_write_end(&vdso_clock.seq);
+
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Publish the state of a process's IPC queue
+ */
+void vdso_update_ipc(uint32_t pid, uint32_t depth, uint32_t max, uint32_t dropped, bool open) {
+    vdso_proc_t *proc = proc_slot(pid, true);
+    uint32_t status = 0;
+
+    if (!proc) {
+        return;
+    }
+
+    if (open) {
+        status |= VDSO_IPC_OPEN;
+    }
+    if (depth > 0) {
+        status |= VDSO_IPC_PENDING;
+    }
+    if (depth >= max) {
+        status |= VDSO_IPC_FULL;
+    }
+
+    uint64_t flags = cpu_irq_save();
+
+    vdso_write_begin(&proc->seq);
+    proc->pid = pid;
+    proc->ipc_queue_depth = depth;
+    proc->ipc_queue_max = max;
+    proc->ipc_dropped = dropped;
+    proc->ipc_status = status;
+    vdso_write_end(&proc->seq);
+
+    cpu_irq_restore(flags);
+}
+
+/**
+ * Kernel address of the clock page
+ */
+const vdso_clock_t *vdso_clock_page(void) {
+    return &vdso_clock;
+}
+
+/**
+ * Kernel address of a process's status page
+ */
+const vdso_proc_t *vdso_proc_page(uint32_t pid) {
+    /* The slot's page belongs to whichever process last published to it */
+    const vdso_proc_t *proc = proc_slot(pid, false);
+    return proc && proc->pid == pid ? proc : NULL;
+}
+
+/**
+ * Measure a clock read and a queue poll through the data pages
+ *
+ * Runs in the kernel against the current process's page; the reads are
+ * the same instructions user code executes once the pages are mapped.
+ */
+status_t vdso_benchmark(uint32_t iterations, vdso_bench_t *result) {
+    if (!result || iterations == 0) {
+        return STATUS_INVALID_ARG;
+    }
+
+    const vdso_proc_t *proc = vdso_proc_page(process_get_pid(process_get_current()));
+    if (!proc) {
+        return STATUS_NOT_FOUND;
+    }
+
+    volatile uint64_t sink = 0;
+
+    uint64_t start = cpu_rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink += vdso_time_us(&vdso_clock);
+    }
+    result->time_read_cycles = (cpu_rdtsc() - start) / iterations;
+
+    start = cpu_rdtsc();
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink += vdso_ipc_queue_depth(proc);
+    }
+    result->queue_depth_cycles = (cpu_rdtsc() - start) / iterations;
+
+    (void)sink;
+    return STATUS_SUCCESS;
+}
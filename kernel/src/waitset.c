@@ -0,0 +1,281 @@
+/**
+ * QuantumOS Wait Sets
+ *
+ * Ready lists and source hooks for readiness multiplexing
+ * (kernel/waitset.h).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/waitset.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+
+struct waitset_item {
+    waitset_t *set;
+    waitset_source_t *source;           /* NULL once the source closed */
+    uint64_t cookie;
+    uint32_t flags;
+    uint32_t events;                    /* Accumulated since last reported */
+    bool ready;                         /* On the set's ready list */
+
+    waitset_item_t *next_watcher;       /* Source's watcher list */
+    waitset_item_t *ready_prev;
+    waitset_item_t *ready_next;
+    waitset_item_t *set_prev;           /* Set's registration list */
+    waitset_item_t *set_next;
+};
+
+/* ============================================================================
+ * Internal State
+ * ============================================================================ */
+
+/*
+ * Removed items. kfree() cannot return memory to the heap yet, so they
+ * are kept here, linked through set_next, and reused first.
+ */
+static waitset_item_t *item_cache;
+
+/* ============================================================================
+ * Internal Functions
+ * ============================================================================ */
+
+static waitset_item_t *item_alloc(void) {
+    waitset_item_t *item = item_cache;
+
+    if (item) {
+        item_cache = item->set_next;
+    } else {
+        item = kmalloc(sizeof(*item));
+        if (!item) {
+            return NULL;
+        }
+    }
+    memset(item, 0, sizeof(*item));
+    return item;
+}
+
+static void ready_push(waitset_item_t *item) {
+    waitset_t *set = item->set;
+
+    item->ready = true;
+    item->ready_next = NULL;
+    item->ready_prev = set->ready_tail;
+    if (set->ready_tail) {
+        set->ready_tail->ready_next = item;
+    } else {
+        set->ready_head = item;
+    }
+    set->ready_tail = item;
+    set->ready_count++;
+}
+
+static void ready_unlink(waitset_item_t *item) {
+    waitset_t *set = item->set;
+
+    if (item->ready_prev) {
+        item->ready_prev->ready_next = item->ready_next;
+    } else {
+        set->ready_head = item->ready_next;
+    }
+    if (item->ready_next) {
+        item->ready_next->ready_prev = item->ready_prev;
+    } else {
+        set->ready_tail = item->ready_prev;
+    }
+    item->ready = false;
+    item->ready_prev = NULL;
+    item->ready_next = NULL;
+    set->ready_count--;
+}
+
+static void mark(waitset_item_t *item, uint32_t events) {
+    item->events |= events;
+    if (!item->ready) {
+        ready_push(item);
+    }
+}
+
+static void watcher_unlink(waitset_item_t *item) {
+    waitset_item_t **link = &item->source->watchers;
+
+    while (*link && *link != item) {
+        link = &(*link)->next_watcher;
+    }
+    if (*link) {
+        *link = item->next_watcher;
+    }
+    item->source = NULL;
+    item->next_watcher = NULL;
+}
+
+static inline uint32_t source_pending(const waitset_item_t *item) {
+    return item->source && item->source->pending ? *item->source->pending : 0;
+}
+
+/* ============================================================================
+ * Set Management
+ * ============================================================================ */
+
+void waitset_init(waitset_t *set) {
+    if (set) {
+        memset(set, 0, sizeof(*set));
+    }
+}
+
+void waitset_destroy(waitset_t *set) {
+    if (!set) {
+        return;
+    }
+    while (set->items) {
+        waitset_remove(set->items);
+    }
+}
+
+void waitset_source_init(waitset_source_t *source, const uint32_t *pending) {
+    source->watchers = NULL;
+    source->pending = pending;
+}
+
+status_t waitset_add(waitset_t *set, waitset_source_t *source, uint32_t flags,
+                     uint64_t cookie, waitset_item_t **item) {
+    if (!set || !source || (flags & ~WAITSET_EDGE)) {
+        return STATUS_INVALID_ARG;
+    }
+
+    waitset_item_t *it = item_alloc();
+    if (!it) {
+        return STATUS_NO_MEMORY;
+    }
+
+    it->set = set;
+    it->source = source;
+    it->cookie = cookie;
+    it->flags = flags;
+
+    it->next_watcher = source->watchers;
+    source->watchers = it;
+
+    it->set_next = set->items;
+    if (set->items) {
+        set->items->set_prev = it;
+    }
+    set->items = it;
+    set->item_count++;
+
+    /* Data queued before registration must not be missed */
+    if (source_pending(it)) {
+        mark(it, WAITSET_READABLE);
+    }
+
+    if (item) {
+        *item = it;
+    }
+    return STATUS_SUCCESS;
+}
+
+waitset_item_t *waitset_find(const waitset_t *set, const waitset_source_t *source) {
+    if (!set || !source) {
+        return NULL;
+    }
+    for (waitset_item_t *it = source->watchers; it; it = it->next_watcher) {
+        if (it->set == set) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+void waitset_remove(waitset_item_t *item) {
+    if (!item) {
+        return;
+    }
+
+    waitset_t *set = item->set;
+
+    if (item->source) {
+        watcher_unlink(item);
+    }
+    if (item->ready) {
+        ready_unlink(item);
+    }
+
+    if (item->set_prev) {
+        item->set_prev->set_next = item->set_next;
+    } else {
+        set->items = item->set_next;
+    }
+    if (item->set_next) {
+        item->set_next->set_prev = item->set_prev;
+    }
+    set->item_count--;
+
+    item->set = NULL;
+    item->set_next = item_cache;
+    item_cache = item;
+}
+
+/* ============================================================================
+ * Producer Side
+ * ============================================================================ */
+
+void waitset_signal(waitset_source_t *source) {
+    for (waitset_item_t *it = source->watchers; it; it = it->next_watcher) {
+        mark(it, WAITSET_READABLE);
+    }
+}
+
+void waitset_source_close(waitset_source_t *source) {
+    while (source->watchers) {
+        waitset_item_t *it = source->watchers;
+
+        source->watchers = it->next_watcher;
+        it->source = NULL;
+        it->next_watcher = NULL;
+        mark(it, WAITSET_HANGUP);
+    }
+}
+
+/* ============================================================================
+ * Consumer Side
+ * ============================================================================ */
+
+uint32_t waitset_collect(waitset_t *set, waitset_event_t *events, uint32_t max) {
+    if (!set || !events) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    /* Items re-queued for level triggering go to the tail; stop before them */
+    uint32_t budget = set->ready_count;
+
+    while (count < max && budget-- > 0) {
+        waitset_item_t *it = set->ready_head;
+        uint32_t pending = source_pending(it);
+        uint32_t reported = it->events;
+
+        ready_unlink(it);
+
+        if (!(it->flags & WAITSET_EDGE)) {
+            /* Level: readiness is whatever the source holds now */
+            reported = (reported & WAITSET_HANGUP) | (pending ? WAITSET_READABLE : 0);
+        }
+        it->events = 0;
+
+        if (!reported) {
+            continue;           /* Drained since it was signalled */
+        }
+
+        events[count].cookie = it->cookie;
+        events[count].events = reported;
+        events[count].pending = pending;
+        count++;
+
+        if (!it->source) {
+            waitset_remove(it);         /* Closed: nothing more to report */
+        } else if (!(it->flags & WAITSET_EDGE) && pending) {
+            ready_push(it);
+        }
+    }
+    return count;
+}
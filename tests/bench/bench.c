@@ -0,0 +1,210 @@
+/**
+ * QuantumOS Host Micro-benchmark Framework Implementation
+ *
+ * See bench.h.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const bench_case_t *current;
+static uint64_t op_calls;
+static uint32_t scale;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/* Nearest-rank percentile of sorted samples */
+static uint64_t percentile(const uint64_t *sorted, uint64_t n, uint32_t pct) {
+    uint64_t rank = (n * pct + 99) / 100;
+    return sorted[rank ? rank - 1 : 0];
+}
+
+int bench_run(const bench_case_t *bench, uint32_t warmup, uint32_t samples,
+              bench_result_t *result) {
+    uint32_t batch = bench->batch ? bench->batch : BENCH_DEFAULT_BATCH;
+    uint64_t *sample_ns = malloc((samples ? samples : 1) * sizeof(*sample_ns));
+    if (!sample_ns) {
+        return -1;
+    }
+
+    current = bench;
+    op_calls = warmup + (uint64_t)samples * batch;
+    scale = 1;
+    if (bench->setup) {
+        bench->setup();
+    }
+
+    for (uint32_t i = 0; i < warmup; i++) {
+        bench->op();
+    }
+
+    uint64_t total = 0;
+    for (uint32_t s = 0; s < samples; s++) {
+        uint64_t t0 = bench_now_ns();
+        for (uint32_t i = 0; i < batch; i++) {
+            bench->op();
+        }
+        sample_ns[s] = bench_now_ns() - t0;
+        total += sample_ns[s];
+    }
+
+    if (bench->teardown) {
+        bench->teardown();
+    }
+    current = NULL;
+
+    /* Operations per sample */
+    uint64_t per = (uint64_t)batch * scale;
+
+    memset(result, 0, sizeof(*result));
+    result->samples = samples;
+    result->ops = samples * per;
+    if (samples) {
+        qsort(sample_ns, samples, sizeof(*sample_ns), compare_u64);
+        result->mean_ns = (double)total / result->ops;
+        result->min_ns = (double)sample_ns[0] / per;
+        result->p50_ns = (double)percentile(sample_ns, samples, 50) / per;
+        result->p90_ns = (double)percentile(sample_ns, samples, 90) / per;
+        result->p99_ns = (double)percentile(sample_ns, samples, 99) / per;
+        result->max_ns = (double)sample_ns[samples - 1] / per;
+    }
+
+    free(sample_ns);
+    return 0;
+}
+
+const bench_case_t *bench_current(void) {
+    return current;
+}
+
+uint64_t bench_op_calls(void) {
+    return op_calls;
+}
+
+void bench_scale(uint32_t ops) {
+    scale = ops ? ops : 1;
+}
+
+uint64_t bench_rand(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static void write_json(FILE *out, const char *suite, uint32_t warmup, uint32_t samples,
+                       const bench_case_t *cases, const bench_result_t *results,
+                       const int *selected, uint32_t count) {
+    int first = 1;
+
+    fprintf(out, "{\n  \"suite\": \"%s\",\n  \"unit\": \"ns/op\",\n", suite);
+    fprintf(out, "  \"warmup\": %u,\n  \"samples\": %u,\n  \"results\": [", warmup, samples);
+    for (uint32_t i = 0; i < count; i++) {
+        if (!selected[i]) {
+            continue;
+        }
+        const bench_result_t *r = &results[i];
+        fprintf(out, "%s\n    {\"name\": \"%s\", \"batch\": %u, \"ops\": %llu, "
+                "\"mean\": %.2f, \"min\": %.2f, \"p50\": %.2f, \"p90\": %.2f, "
+                "\"p99\": %.2f, \"max\": %.2f}",
+                first ? "" : ",", cases[i].name,
+                cases[i].batch ? cases[i].batch : BENCH_DEFAULT_BATCH,
+                (unsigned long long)r->ops, r->mean_ns, r->min_ns, r->p50_ns,
+                r->p90_ns, r->p99_ns, r->max_ns);
+        first = 0;
+    }
+    fprintf(out, "\n  ]\n}\n");
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-n samples] [-w warmup] [-f filter] [-o file.json] [-j]\n", prog);
+}
+
+int bench_main(int argc, char **argv, const char *suite,
+               const bench_case_t *cases, uint32_t count) {
+    uint32_t samples = BENCH_DEFAULT_SAMPLES;
+    uint32_t warmup = BENCH_DEFAULT_WARMUP;
+    const char *filter = NULL;
+    const char *json_path = NULL;
+    int json_stdout = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0) {
+            json_stdout = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+            samples = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-w") == 0) {
+            warmup = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-f") == 0) {
+            filter = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "-o") == 0) {
+            json_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    bench_result_t *results = calloc(count, sizeof(*results));
+    int *selected = calloc(count, sizeof(*selected));
+    if (!results || !selected) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    if (!json_stdout) {
+        printf("%-28s %10s %10s %10s %10s %10s %10s  (ns/op)\n",
+               suite, "mean", "min", "p50", "p90", "p99", "max");
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (filter && !strstr(cases[i].name, filter)) {
+            continue;
+        }
+        if (bench_run(&cases[i], warmup, samples, &results[i]) != 0) {
+            fprintf(stderr, "%s: %s: out of memory\n", argv[0], cases[i].name);
+            return 1;
+        }
+        selected[i] = 1;
+
+        if (!json_stdout) {
+            const bench_result_t *r = &results[i];
+            printf("%-28s %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", cases[i].name,
+                   r->mean_ns, r->min_ns, r->p50_ns, r->p90_ns, r->p99_ns, r->max_ns);
+            fflush(stdout);
+        }
+    }
+
+    if (json_stdout) {
+        write_json(stdout, suite, warmup, samples, cases, results, selected, count);
+    }
+    if (json_path) {
+        FILE *f = fopen(json_path, "w");
+        if (!f) {
+            perror(json_path);
+            return 1;
+        }
+        write_json(f, suite, warmup, samples, cases, results, selected, count);
+        fclose(f);
+    }
+
+    free(results);
+    free(selected);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * QuantumOS Host Micro-benchmark Framework
+ *
+ * A benchmark is a table of cases, each an operation to time plus
+ * optional setup and teardown. For every case the runner
+ *
+ *   1. calls setup()
+ *   2. runs `warmup` untimed operations (caches, branch predictors and
+ *      any lazily allocated state settle)
+ *   3. takes `samples` timed samples of `batch` back-to-back operations
+ *      each, so clock overhead is amortised over the batch
+ *   4. calls teardown()
+ *
+ * and reports nanoseconds per operation as mean, min, p50, p90, p99 and
+ * max over the samples. An op() that performs several operations (a
+ * burst of yields, a page per dirty page) says how many with
+ * bench_scale() so the results stay per operation. Results print as a
+ * table or as JSON (one object per run, one entry per case) for
+ * comparing runs by script.
+ *
+ * Command line, handled by bench_main():
+ *
+ *   -n <samples>   timed samples per case     (default BENCH_DEFAULT_SAMPLES)
+ *   -w <ops>       warmup operations per case (default BENCH_DEFAULT_WARMUP)
+ *   -f <text>      only cases whose name contains <text>
+ *   -o <file>      also write JSON to <file>
+ *   -j             JSON on stdout instead of the table
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#define BENCH_DEFAULT_SAMPLES   10000
+#define BENCH_DEFAULT_WARMUP    1000
+#define BENCH_DEFAULT_BATCH     16
+
+typedef struct {
+    const char *name;
+    void (*setup)(void);        /* Optional */
+    void (*op)(void);           /* The operation being measured */
+    void (*teardown)(void);     /* Optional */
+    uint32_t batch;             /* Operations per sample, 0 for the default */
+} bench_case_t;
+
+typedef struct {
+    uint64_t samples;
+    uint64_t ops;               /* samples * batch */
+    double mean_ns;             /* Per operation */
+    double min_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double max_ns;
+} bench_result_t;
+
+/**
+ * Time one case
+ *
+ * @return 0, or -1 if the sample buffer cannot be allocated
+ */
+int bench_run(const bench_case_t *bench, uint32_t warmup, uint32_t samples,
+              bench_result_t *result);
+
+/**
+ * Parse the command line, run the matching cases and report
+ *
+ * @return Process exit status
+ */
+int bench_main(int argc, char **argv, const char *suite,
+               const bench_case_t *cases, uint32_t count);
+
+/*
+ * For setup(), op() and teardown() while their case runs
+ */
+
+/** The case being run */
+const bench_case_t *bench_current(void);
+
+/** op() calls the case makes, warmup included, to size what op() uses up */
+uint64_t bench_op_calls(void);
+
+/**
+ * From setup(): every op() call performs `ops` operations. Reset to 1
+ * for each case.
+ */
+void bench_scale(uint32_t ops);
+
+/** CLOCK_MONOTONIC in nanoseconds, the clock samples are taken with */
+uint64_t bench_now_ns(void);
+
+/** Deterministic xorshift64 sequence, the same on every run */
+uint64_t bench_rand(void);
+
+#endif /* BENCH_H */
@@ -0,0 +1,629 @@
+/**
+ * QuantumOS Associative Memory Index Host Benchmark
+ *
+ * Builds kernel/src/msi/assoc_index.c natively, fills an index in an
+ * anonymous mapping with clustered uint8 vectors and times, with the
+ * bench.h framework:
+ *
+ *   insert          one insert into a graph store that grows from empty
+ *   exact           one exact (linear scan) query of the -N entry store
+ *   hnsw_ef<n>      one HNSW query at search width n
+ *
+ * A tenth of the entries can be forgotten first (-d) to measure
+ * searching through tombstones. Recall@10 against the exact scan and
+ * distance evaluations per query are computed untimed afterwards and
+ * printed on stderr, so -j output stays pure JSON.
+ *
+ * With -s it instead times, for store sizes from 10 up to -N by factors
+ * of ten, exact gets from a flat store (get_<n>) and queries of a flat
+ * store (flat_<n>, matrix scan only) and of a graph store (graph_<n>,
+ * HNSW from the first entry), which is what
+ * ASSOC_DEFAULT_FLAT_THRESHOLD is chosen from. Graph recall per size
+ * goes to stderr.
+ *
+ * With -Q it compares flat scans of -N entries with a small payload
+ * each, one query per operation: one heap allocation per vector and per
+ * payload behind an msi_assoc_entry_t array (pointers), the contiguous
+ * matrix, and the 4-bit and binary code matrices with re-ranking.
+ * Bytes per entry, the bytes a scan streams per entry and recall@10 go
+ * to stderr; scan throughput is entries (or bytes) over ns/op.
+ *
+ * Build and run with: make bench-assoc, make bench-assoc-sizes,
+ * make bench-assoc-quant
+ * Usage: build/host/bench/bench_assoc [-N entries] [-D dims] [-q queries]
+ *                                     [-m l2|dot|hamming] [-d] [-s] [-Q]
+ *                                     [-r rerank] [bench options]
+ * where the bench options are bench_main()'s (bench.h).
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+
+#include <kernel/assoc_index.h>
+#include <kernel/types.h>
+#include <msi.h>
+
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#define DEFAULT_ENTRIES     100000
+#define DEFAULT_DIMENSIONS  128
+#define DEFAULT_QUERIES     1000
+#define NUM_CLUSTERS        256
+#define NOISE               48
+#define K                   10
+#define QUANT_PAYLOAD       16      /* Bytes of payload per entry with -Q */
+#define MAX_SIZES           9       /* 10 to 10^9 with -s */
+#define NAME_LEN            24
+
+static const uint32_t ef_values[] = { 10, 16, 32, 64, 128, 256 };
+#define EF_COUNT        (sizeof(ef_values) / sizeof(ef_values[0]))
+
+static assoc_config_t config = {
+    .dimensions = DEFAULT_DIMENSIONS,
+    .capacity = DEFAULT_ENTRIES,
+    .metric = ASSOC_METRIC_L2,
+};
+static uint32_t queries = DEFAULT_QUERIES;
+static uint32_t dims;
+static uint8_t *centers;
+static uint8_t *data;
+static uint8_t *query;
+static assoc_match_t *truth;        /* K per query */
+static assoc_match_t *found;        /* K per query */
+static uint32_t next_query;
+static volatile uint64_t sink;      /* Keeps results live */
+
+static void make_vector(uint8_t *out) {
+    const uint8_t *center = centers + (bench_rand() % NUM_CLUSTERS) * dims;
+    for (uint32_t i = 0; i < dims; i++) {
+        int value = center[i] + (int)(bench_rand() % (2 * NOISE + 1)) - NOISE;
+        out[i] = (uint8_t)(value < 0 ? 0 : value > 255 ? 255 : value);
+    }
+}
+
+static const uint8_t *next_vector(void) {
+    return query + (size_t)(next_query++ % queries) * dims;
+}
+
+/* An empty store for `capacity` entries; NULL if it cannot be mapped */
+static assoc_index_t *create(const assoc_config_t *base, uint32_t capacity, void **arena,
+                             size_t *size) {
+    assoc_config_t c = *base;
+    assoc_index_t *index;
+
+    c.capacity = capacity;
+    *size = assoc_index_arena_size(&c);
+    *arena = *size ? mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                          -1, 0) : MAP_FAILED;
+    if (*arena == MAP_FAILED) {
+        return NULL;
+    }
+    if (assoc_index_create(*arena, *size, &c, &index) != 0) {
+        munmap(*arena, *size);
+        return NULL;
+    }
+    return index;
+}
+
+/* Hits of found[] among truth[] for the first `count` queries, as a percentage */
+static double recall(uint32_t count, uint32_t k) {
+    uint64_t hits = 0;
+
+    for (uint32_t q = 0; q < count; q++) {
+        for (uint32_t i = 0; i < k; i++) {
+            for (uint32_t j = 0; j < k; j++) {
+                if (found[q * K + i].id == truth[q * K + j].id) {
+                    hits++;
+                    break;
+                }
+            }
+        }
+    }
+    return 100.0 * hits / ((double)count * k);
+}
+
+/* Sorted top-K through the entry pointers; the same work as the index's heap */
+static void scan_entries(const msi_assoc_entry_t *entries, uint32_t n, const uint8_t *v,
+                         assoc_match_t *top) {
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t d = assoc_distance(config.metric, v, entries[i].vector, dims);
+        if (count < K || d < top[K - 1].distance) {
+            uint32_t j = count < K ? count++ : K - 1;
+            while (j && top[j - 1].distance > d) {
+                top[j] = top[j - 1];
+                j--;
+            }
+            top[j].id = i;
+            top[j].distance = d;
+        }
+    }
+}
+
+/* ============================================================================
+ * Default: one store of -N entries
+ * ============================================================================ */
+
+static assoc_index_t *index_main;
+static assoc_index_t *index_insert;
+static void *insert_arena;
+static size_t insert_size;
+static uint8_t *insert_data;
+static uint64_t insert_next;
+
+static void setup_insert(void) {
+    uint64_t calls = bench_op_calls();
+    assoc_config_t c = config;
+
+    c.flat_threshold = 1;
+    insert_data = malloc(calls * dims);
+    index_insert = create(&c, (uint32_t)calls, &insert_arena, &insert_size);
+    if (!insert_data || !index_insert) {
+        fprintf(stderr, "bench_assoc: no room to insert %llu entries\n",
+                (unsigned long long)calls);
+        exit(1);
+    }
+    for (uint64_t i = 0; i < calls; i++) {
+        make_vector(insert_data + i * dims);
+    }
+    insert_next = 0;
+}
+
+static void op_insert(void) {
+    assoc_index_insert(index_insert, insert_data + insert_next++ * dims, NULL, 0, NULL);
+}
+
+static void teardown_insert(void) {
+    munmap(insert_arena, insert_size);
+    free(insert_data);
+}
+
+static void op_exact(void) {
+    assoc_match_t top[K];
+
+    sink += assoc_index_search_exact(index_main, next_vector(), K, top);
+}
+
+static void search_ef(uint32_t ef) {
+    assoc_match_t top[K];
+
+    sink += assoc_index_search(index_main, next_vector(), K, ef, top);
+}
+
+static void op_ef10(void)  { search_ef(10); }
+static void op_ef16(void)  { search_ef(16); }
+static void op_ef32(void)  { search_ef(32); }
+static void op_ef64(void)  { search_ef(64); }
+static void op_ef128(void) { search_ef(128); }
+static void op_ef256(void) { search_ef(256); }
+
+static const bench_case_t search_cases[] = {
+    { "insert",     setup_insert, op_insert, teardown_insert, 0 },
+    { "exact",      NULL,         op_exact,  NULL,            1 },
+    { "hnsw_ef10",  NULL,         op_ef10,   NULL,            1 },
+    { "hnsw_ef16",  NULL,         op_ef16,   NULL,            1 },
+    { "hnsw_ef32",  NULL,         op_ef32,   NULL,            1 },
+    { "hnsw_ef64",  NULL,         op_ef64,   NULL,            1 },
+    { "hnsw_ef128", NULL,         op_ef128,  NULL,            1 },
+    { "hnsw_ef256", NULL,         op_ef256,  NULL,            1 },
+};
+
+static int run_search(int argc, char **argv, int forget) {
+    void *arena;
+    size_t size;
+    assoc_stats_t stats;
+
+    index_main = create(&config, config.capacity, &arena, &size);
+    if (!index_main) {
+        fprintf(stderr, "bench_assoc: out of memory (%zu byte arena)\n", size);
+        return 1;
+    }
+    for (uint32_t i = 0; i < config.capacity; i++) {
+        assoc_index_insert(index_main, data + (size_t)i * dims, NULL, 0, NULL);
+    }
+    if (forget) {
+        for (uint32_t i = 0; i < config.capacity; i += 10) {
+            uint32_t id;
+            if (assoc_index_lookup(index_main, data + (size_t)i * dims, &id) == 0) {
+                assoc_index_remove(index_main, id);
+            }
+        }
+    }
+    assoc_index_get_stats(index_main, &stats);
+    fprintf(stderr, "assoc index: %u entries (%u forgotten), %u dims, M=%u, "
+            "ef_construction=%u, %u layers, %.1f MB of arena used\n",
+            stats.count, stats.deleted, dims, ASSOC_DEFAULT_M, ASSOC_DEFAULT_EF_CONSTRUCTION,
+            stats.max_level + 1, stats.arena_used / 1048576.0);
+
+    int status = bench_main(argc, argv, "assoc", search_cases,
+                            sizeof(search_cases) / sizeof(search_cases[0]));
+    if (status != 0) {
+        return status;
+    }
+
+    /* Ground truth and recall, untimed */
+    for (uint32_t q = 0; q < queries; q++) {
+        assoc_index_search_exact(index_main, query + (size_t)q * dims, K, truth + (size_t)q * K);
+    }
+    fprintf(stderr, "\n%-12s %10s %14s\n", "search", "recall@10", "distances/q");
+    fprintf(stderr, "%-12s %9.2f%% %14u\n", "exact", 100.0, stats.count + stats.deleted);
+    for (uint32_t e = 0; e < EF_COUNT; e++) {
+        uint64_t evals;
+
+        assoc_index_get_stats(index_main, &stats);
+        evals = stats.distance_evals;
+        for (uint32_t q = 0; q < queries; q++) {
+            memset(found + (size_t)q * K, 0xFF, K * sizeof(*found));
+            assoc_index_search(index_main, query + (size_t)q * dims, K, ef_values[e],
+                               found + (size_t)q * K);
+        }
+        assoc_index_get_stats(index_main, &stats);
+        fprintf(stderr, "hnsw ef=%-4u %9.2f%% %14.0f\n", ef_values[e], recall(queries, K),
+                (double)(stats.distance_evals - evals) / queries);
+    }
+
+    munmap(arena, size);
+    return 0;
+}
+
+/* ============================================================================
+ * -s: flat against graph by store size
+ * ============================================================================ */
+
+enum { SIZE_GET, SIZE_FLAT, SIZE_GRAPH, SIZE_KINDS };
+
+static bench_case_t size_cases[MAX_SIZES * SIZE_KINDS];
+static char size_names[MAX_SIZES * SIZE_KINDS][NAME_LEN];
+static uint32_t sizes[MAX_SIZES];
+static double size_recall[MAX_SIZES];
+static uint32_t size_built = MAX_SIZES;     /* Index into sizes[] of the stores below */
+static assoc_index_t *flat, *graph;
+static void *flat_arena, *graph_arena;
+static size_t flat_size, graph_size;
+static uint32_t size_n;
+static uint32_t next_get;
+static uint64_t get_misses;
+
+static void drop_stores(void) {
+    if (size_built < MAX_SIZES) {
+        munmap(flat_arena, flat_size);
+        munmap(graph_arena, graph_size);
+        size_built = MAX_SIZES;
+    }
+}
+
+/* Both stores for the running case's size; graph recall is measured once per size */
+static void setup_size(void) {
+    uint32_t s = (uint32_t)(bench_current() - size_cases) / SIZE_KINDS;
+    assoc_config_t c = config;
+
+    size_n = sizes[s];
+    next_get = 0;
+    if (size_built == s) {
+        return;
+    }
+    drop_stores();
+
+    c.flat_threshold = 0xFFFFFFFFU;
+    flat = create(&c, size_n, &flat_arena, &flat_size);
+    c.flat_threshold = 1;
+    graph = create(&c, size_n, &graph_arena, &graph_size);
+    if (!flat || !graph) {
+        fprintf(stderr, "bench_assoc: out of memory at %u entries\n", size_n);
+        exit(1);
+    }
+    for (uint32_t i = 0; i < size_n; i++) {
+        assoc_index_insert(flat, data + (size_t)i * dims, NULL, 0, NULL);
+        assoc_index_insert(graph, data + (size_t)i * dims, NULL, 0, NULL);
+    }
+    size_built = s;
+
+    for (uint32_t q = 0; q < queries; q++) {
+        memset(found + (size_t)q * K, 0xFF, K * sizeof(*found));
+        assoc_index_search(flat, query + (size_t)q * dims, K, 0, truth + (size_t)q * K);
+        assoc_index_search(graph, query + (size_t)q * dims, K, 0, found + (size_t)q * K);
+    }
+    size_recall[s] = recall(queries, MIN(K, size_n));
+}
+
+static void op_get(void) {
+    uint32_t id;
+
+    get_misses += assoc_index_lookup(flat, data + (size_t)(next_get++ % size_n) * dims,
+                                     &id) != 0;
+}
+
+static void op_flat(void) {
+    assoc_match_t top[K];
+
+    sink += assoc_index_search(flat, next_vector(), K, 0, top);
+}
+
+static void op_graph(void) {
+    assoc_match_t top[K];
+
+    sink += assoc_index_search(graph, next_vector(), K, 0, top);
+}
+
+static int run_sizes(int argc, char **argv) {
+    static const char *const kind_names[SIZE_KINDS] = { "get", "flat", "graph" };
+    static void (*const kind_ops[SIZE_KINDS])(void) = { op_get, op_flat, op_graph };
+    uint32_t count = 0, n_sizes = 0;
+
+    for (uint64_t n = 10; n <= config.capacity && n_sizes < MAX_SIZES; n *= 10) {
+        sizes[n_sizes] = (uint32_t)n;
+        for (uint32_t k = 0; k < SIZE_KINDS; k++) {
+            snprintf(size_names[count], NAME_LEN, "%s_%llu", kind_names[k],
+                     (unsigned long long)n);
+            size_cases[count] = (bench_case_t){ size_names[count], setup_size, kind_ops[k],
+                                                NULL, k == SIZE_GET ? 0 : 1 };
+            count++;
+        }
+        size_recall[n_sizes++] = -1.0;
+    }
+
+    int status = bench_main(argc, argv, "assoc_sizes", size_cases, count);
+    drop_stores();
+    if (status != 0) {
+        return status;
+    }
+
+    fprintf(stderr, "\n%9s %10s   (graph against flat, k=%u, default ef_search=%u)\n",
+            "entries", "recall@10", K, ASSOC_DEFAULT_EF_SEARCH);
+    for (uint32_t s = 0; s < n_sizes; s++) {
+        if (size_recall[s] >= 0.0) {
+            fprintf(stderr, "%9u %9.2f%%\n", sizes[s], size_recall[s]);
+        }
+    }
+    if (get_misses) {
+        fprintf(stderr, "bench_assoc: lookup missed %llu stored vectors\n",
+                (unsigned long long)get_misses);
+        return 1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * -Q: storage layouts
+ * ============================================================================ */
+
+enum { LAYOUT_POINTERS, LAYOUT_MATRIX, LAYOUT_4BIT, LAYOUT_BINARY, LAYOUTS };
+
+static const struct {
+    const char *name;
+    assoc_quant_t quant;
+} layouts[LAYOUTS] = {
+    { "pointers",      ASSOC_QUANT_NONE },
+    { "matrix",        ASSOC_QUANT_NONE },
+    { "4bit_rerank",   ASSOC_QUANT_4BIT },
+    { "binary_rerank", ASSOC_QUANT_BINARY },
+};
+
+static bench_case_t layout_cases[LAYOUTS];
+static double layout_bytes[LAYOUTS];
+static uint32_t layout_scan_bytes[LAYOUTS];
+static double layout_recall[LAYOUTS];
+static msi_assoc_entry_t *entries;
+static assoc_index_t *layout_index;
+static void *layout_arena;
+static size_t layout_size;
+
+static uint32_t running_layout(void) {
+    return (uint32_t)(bench_current() - layout_cases);
+}
+
+/*
+ * The first layout is what the store looked like as separate
+ * allocations: the entry array plus a heap block per vector and per
+ * payload, measured with mallinfo2().
+ */
+static void setup_pointers(void) {
+    uint8_t payload[QUANT_PAYLOAD] = { 0 };
+    uint32_t n = config.capacity;
+    size_t heap_before = mallinfo2().uordblks;
+
+    entries = malloc((size_t)n * sizeof(*entries));
+    if (!entries) {
+        fprintf(stderr, "bench_assoc: out of memory\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        entries[i].vector = malloc(dims);
+        entries[i].payload = malloc(QUANT_PAYLOAD);
+        if (!entries[i].vector || !entries[i].payload) {
+            fprintf(stderr, "bench_assoc: out of memory\n");
+            exit(1);
+        }
+        memcpy(entries[i].vector, data + (size_t)i * dims, dims);
+        memcpy(entries[i].payload, payload, QUANT_PAYLOAD);
+        entries[i].dimensions = dims;
+        entries[i].payload_size = QUANT_PAYLOAD;
+    }
+    layout_bytes[LAYOUT_POINTERS] = (double)(mallinfo2().uordblks - heap_before) / n;
+    layout_scan_bytes[LAYOUT_POINTERS] = dims;
+}
+
+static void op_pointers(void) {
+    assoc_match_t top[K];
+
+    scan_entries(entries, config.capacity, next_vector(), top);
+    sink += top[0].id;
+}
+
+static void teardown_pointers(void) {
+    for (uint32_t q = 0; q < queries; q++) {
+        scan_entries(entries, config.capacity, query + (size_t)q * dims, found + (size_t)q * K);
+    }
+    layout_recall[LAYOUT_POINTERS] = recall(queries, K);
+
+    for (uint32_t i = 0; i < config.capacity; i++) {
+        free(entries[i].vector);
+        free(entries[i].payload);
+    }
+    free(entries);
+}
+
+static void setup_layout(void) {
+    uint32_t l = running_layout();
+    uint8_t payload[QUANT_PAYLOAD] = { 0 };
+    assoc_config_t c = config;
+    assoc_stats_t stats;
+
+    c.quantization = layouts[l].quant;
+    c.flat_threshold = 0xFFFFFFFFU;
+    c.payload_bytes = config.capacity * QUANT_PAYLOAD;
+    layout_index = create(&c, config.capacity, &layout_arena, &layout_size);
+    if (!layout_index) {
+        fprintf(stderr, "bench_assoc: cannot create the %s store\n", layouts[l].name);
+        exit(1);
+    }
+    for (uint32_t i = 0; i < config.capacity; i++) {
+        assoc_index_insert(layout_index, data + (size_t)i * dims, payload, QUANT_PAYLOAD, NULL);
+    }
+    assoc_index_get_stats(layout_index, &stats);
+    layout_bytes[l] = (double)stats.arena_used / config.capacity;
+    layout_scan_bytes[l] = layouts[l].quant ? stats.code_bytes : stats.vector_bytes;
+}
+
+static void op_layout(void) {
+    assoc_match_t top[K];
+
+    sink += assoc_index_search(layout_index, next_vector(), K, 0, top);
+}
+
+static void teardown_layout(void) {
+    uint32_t l = running_layout();
+
+    for (uint32_t q = 0; q < queries; q++) {
+        assoc_index_search(layout_index, query + (size_t)q * dims, K, 0, found + (size_t)q * K);
+    }
+    layout_recall[l] = recall(queries, K);
+    munmap(layout_arena, layout_size);
+}
+
+static int run_storage(int argc, char **argv) {
+    msi_assoc_entry_t *rows = malloc((size_t)config.capacity * sizeof(*rows));
+
+    if (!rows) {
+        fprintf(stderr, "bench_assoc: out of memory\n");
+        return 1;
+    }
+    /* Ground truth: the pointer scan straight over data[] */
+    for (uint32_t i = 0; i < config.capacity; i++) {
+        rows[i].vector = data + (size_t)i * dims;
+    }
+    for (uint32_t q = 0; q < queries; q++) {
+        scan_entries(rows, config.capacity, query + (size_t)q * dims, truth + (size_t)q * K);
+    }
+    free(rows);
+
+    for (uint32_t l = 0; l < LAYOUTS; l++) {
+        layout_cases[l] = l == LAYOUT_POINTERS ?
+            (bench_case_t){ layouts[l].name, setup_pointers, op_pointers, teardown_pointers, 1 } :
+            (bench_case_t){ layouts[l].name, setup_layout, op_layout, teardown_layout, 1 };
+        layout_recall[l] = -1.0;
+    }
+
+    int status = bench_main(argc, argv, "assoc_quant", layout_cases, LAYOUTS);
+    if (status != 0) {
+        return status;
+    }
+
+    fprintf(stderr, "\n%u entries, %u dims, %u-byte payloads, k=%u, rerank=%u (binary %u)\n",
+            config.capacity, dims, QUANT_PAYLOAD, K,
+            config.rerank ? config.rerank : ASSOC_DEFAULT_RERANK,
+            config.rerank ? config.rerank : ASSOC_DEFAULT_RERANK_BINARY);
+    fprintf(stderr, "%-14s %11s %12s %10s\n", "layout", "bytes/entry", "scan B/entry",
+            "recall@10");
+    for (uint32_t l = 0; l < LAYOUTS; l++) {
+        if (layout_recall[l] >= 0.0) {
+            fprintf(stderr, "%-14s %11.1f %12u %9.2f%%\n", layouts[l].name, layout_bytes[l],
+                    layout_scan_bytes[l], layout_recall[l]);
+        }
+    }
+    fprintf(stderr, "bytes/entry counts everything the store holds; a flat store also\n"
+            "reserves its graph links.\n");
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-N entries] [-D dims] [-q queries] [-m l2|dot|hamming] [-d] "
+            "[-s] [-Q] [-r rerank] [bench options]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    char **rest = malloc(((size_t)argc + 1) * sizeof(*rest));
+    int forget = 0, sizes_mode = 0, quant = 0, nrest = 0;
+
+    if (!rest) {
+        return 1;
+    }
+    /* Ours are taken out; the rest go to bench_main() */
+    rest[nrest++] = argv[0];
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-N") == 0) {
+            config.capacity = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-D") == 0) {
+            config.dimensions = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-q") == 0) {
+            queries = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+            config.rerank = (uint32_t)strtoul(argv[++i], NULL, 0);
+        } else if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+            const char *m = argv[++i];
+            config.metric = strcmp(m, "dot") == 0 ? ASSOC_METRIC_DOT :
+                            strcmp(m, "hamming") == 0 ? ASSOC_METRIC_HAMMING : ASSOC_METRIC_L2;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            forget = 1;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            sizes_mode = 1;
+        } else if (strcmp(argv[i], "-Q") == 0) {
+            quant = 1;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 2;
+        } else {
+            rest[nrest++] = argv[i];
+        }
+    }
+    rest[nrest] = NULL;
+
+    if (!assoc_index_arena_size(&config) || !queries) {
+        fprintf(stderr, "%s: invalid configuration\n", argv[0]);
+        return 2;
+    }
+    dims = config.dimensions;
+    centers = malloc((size_t)NUM_CLUSTERS * dims);
+    data = malloc((size_t)config.capacity * dims);
+    query = malloc((size_t)queries * dims);
+    truth = malloc((size_t)queries * K * sizeof(*truth));
+    found = malloc((size_t)queries * K * sizeof(*found));
+    if (!centers || !data || !query || !truth || !found) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < NUM_CLUSTERS * dims; i++) {
+        centers[i] = (uint8_t)bench_rand();
+    }
+    for (uint32_t i = 0; i < config.capacity; i++) {
+        make_vector(data + (size_t)i * dims);
+    }
+    for (uint32_t i = 0; i < queries; i++) {
+        make_vector(query + (size_t)i * dims);
+    }
+
+    if (sizes_mode) {
+        return run_sizes(nrest, rest);
+    }
+    if (quant) {
+        return run_storage(nrest, rest);
+    }
+    return run_search(nrest, rest, forget);
+}
@@ -0,0 +1,202 @@
+/**
+ * QuantumOS Capability Check Host Benchmark
+ *
+ * Links the real capability.c, process.c and ipc.c against the host
+ * shims and times the checks IPC and MSI entry points make per call:
+ *
+ *   right_open          cspace_has_right() on an open space
+ *   right_sealed        the same on a sealed space
+ *   process_check       cap_process_has() for an attached process, the
+ *                       whole per-syscall check
+ *   lookup_open         cspace_lookup() of one of 4096 slots, open space
+ *                       (sequence-counter read)
+ *   lookup_sealed       the same, sealed (plain loads)
+ *   chain_8/64/512      finding a right by walking a linked list of that
+ *                       many grants, the layout the bitmap replaces
+ *   ipc_unchecked       64-byte message to self and back
+ *   ipc_checked         the same with the send and receive rights checked
+ *                       first, as the syscall handlers do
+ *
+ * Numbers are for the host CPU and compiler, not the kernel under QEMU.
+ *
+ * Build and run with: make bench-cap
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/capability.h>
+#include <kernel/process.h>
+#include <kernel/ipc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LOOKUP_SLOTS        4096
+#define BENCH_MESSAGE_LEN   64
+#define CHAIN_MAX           512
+
+typedef struct chain_link {
+    uint32_t right;
+    struct chain_link *next;
+} chain_link_t;
+
+static cspace_t open_space;
+static cspace_t sealed_space;
+static chain_link_t *chain_heads[3];
+static uint32_t lookup_cursor;
+static ipc_message_t message;
+static ipc_message_t reply;
+static volatile uint64_t sink;       /* Keeps results live */
+static volatile uint32_t probe = CAP_RIGHT_IPC_SEND;
+static int object;
+
+static void fill(cspace_t *cs) {
+    cap_t cap = { .object = &object, .type = CAP_TYPE_OBJECT, .rights = 1, .badge = 0 };
+
+    if (cspace_init(cs) != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_cap: cspace_init failed\n");
+        exit(1);
+    }
+    cspace_grant(cs, CAP_RIGHT_IPC_SEND, NULL);
+    cspace_grant(cs, CAP_RIGHT_IPC_RECEIVE, NULL);
+    for (uint32_t i = 0; i < LOOKUP_SLOTS; i++) {
+        cap.badge = i;
+        cspace_insert(cs, &cap, NULL);
+    }
+}
+
+/* Wanted right last, so the walk covers the whole chain */
+static chain_link_t *build_chain(uint32_t length) {
+    chain_link_t *head = NULL;
+
+    for (uint32_t i = 0; i < length; i++) {
+        chain_link_t *link = malloc(sizeof(*link));
+
+        link->right = i == 0 ? CAP_RIGHT_IPC_SEND : CAP_RIGHT_SERVICE + i % 128;
+        link->next = head;
+        head = link;
+    }
+    return head;
+}
+
+static bool chain_has(const chain_link_t *link, uint32_t right) {
+    for (; link; link = link->next) {
+        if (link->right == right) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void op_right_open(void) {
+    sink += cspace_has_right(&open_space, probe);
+}
+
+static void op_right_sealed(void) {
+    sink += cspace_has_right(&sealed_space, probe);
+}
+
+static void setup_attach(void) {
+    process_get_current()->capability_root = open_space.id;
+}
+
+static void teardown_attach(void) {
+    process_get_current()->capability_root = 0;
+}
+
+static void op_process_check(void) {
+    sink += cap_process_has(process_get_current(), probe);
+}
+
+static void op_lookup_open(void) {
+    cap_t cap;
+
+    lookup_cursor = (lookup_cursor + 97) % LOOKUP_SLOTS;
+    cspace_lookup(&open_space, lookup_cursor + 3, &cap);
+    sink += cap.badge;
+}
+
+static void op_lookup_sealed(void) {
+    cap_t cap;
+
+    lookup_cursor = (lookup_cursor + 97) % LOOKUP_SLOTS;
+    cspace_lookup(&sealed_space, lookup_cursor + 3, &cap);
+    sink += cap.badge;
+}
+
+static void op_chain_8(void) {
+    sink += chain_has(chain_heads[0], probe);
+}
+
+static void op_chain_64(void) {
+    sink += chain_has(chain_heads[1], probe);
+}
+
+static void op_chain_512(void) {
+    sink += chain_has(chain_heads[2], probe);
+}
+
+static void setup_message(void) {
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = BENCH_MESSAGE_LEN;
+}
+
+static void op_ipc_unchecked(void) {
+    uint32_t sender;
+
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    ipc_receive(&sender, &reply, IPC_NO_WAIT);
+}
+
+static void setup_ipc_checked(void) {
+    setup_message();
+    setup_attach();
+}
+
+static void op_ipc_checked(void) {
+    uint32_t sender;
+
+    if (cap_process_has(process_get_current(), CAP_RIGHT_IPC_SEND)) {
+        ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    }
+    if (cap_process_has(process_get_current(), CAP_RIGHT_IPC_RECEIVE)) {
+        ipc_receive(&sender, &reply, IPC_NO_WAIT);
+    }
+}
+
+static const bench_case_t cases[] = {
+    { "right_open",     NULL,              op_right_open,     NULL,            0 },
+    { "right_sealed",   NULL,              op_right_sealed,   NULL,            0 },
+    { "process_check",  setup_attach,      op_process_check,  teardown_attach, 0 },
+    { "lookup_open",    NULL,              op_lookup_open,    NULL,            0 },
+    { "lookup_sealed",  NULL,              op_lookup_sealed,  NULL,            0 },
+    { "chain_8",        NULL,              op_chain_8,        NULL,            0 },
+    { "chain_64",       NULL,              op_chain_64,       NULL,            0 },
+    { "chain_512",      NULL,              op_chain_512,      NULL,            0 },
+    { "ipc_unchecked",  setup_message,     op_ipc_unchecked,  NULL,            0 },
+    { "ipc_checked",    setup_ipc_checked, op_ipc_checked,    teardown_attach, 0 },
+};
+
+int main(int argc, char **argv) {
+    host_kernel_init(LOG_WARN);
+
+    if (process_init() != STATUS_SUCCESS || ipc_init() != IPC_SUCCESS) {
+        fprintf(stderr, "bench_cap: kernel initialisation failed\n");
+        return 1;
+    }
+    fill(&open_space);
+    fill(&sealed_space);
+    cspace_seal(&sealed_space);
+    chain_heads[0] = build_chain(8);
+    chain_heads[1] = build_chain(64);
+    chain_heads[2] = build_chain(CHAIN_MAX);
+
+    return bench_main(argc, argv, "cap", cases, sizeof(cases) / sizeof(cases[0]));
+}
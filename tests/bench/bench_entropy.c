@@ -0,0 +1,159 @@
+/**
+ * QuantumOS Entropy Pool Host Benchmark
+ *
+ * Links the real entropy.c, ipc.c and process.c against the host shims
+ * and times, with the bench.h framework:
+ *
+ *   get_<n>            entropy_get() of n bytes into one buffer, from
+ *                      small draws up to 1 MiB; n over ns/op is GB/s
+ *   get_u64            entropy_get_u64()
+ *   service_inline_<n> a full ENTROPY_GET round trip from a client
+ *                      process for n bytes returned in the reply: port
+ *                      send, entropy_service_poll() and reply receive
+ *   service_region_<n> the same with the bytes written into a 1 MiB
+ *                      region the client shared
+ *
+ * Numbers are for the host CPU and compiler, not the kernel under QEMU.
+ *
+ * Build and run with: make bench-entropy
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/entropy.h>
+#include <kernel/process.h>
+#include <kernel/ipc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_BYTES    (1u << 20)
+#define BATCH_BYTES     4096            /* Larger draws are timed one per sample */
+#define NAME_LEN        32
+
+static const uint32_t get_sizes[] = { 8, 16, 32, 64, 4096, 65536, 1u << 20 };
+#define GET_COUNT       (sizeof(get_sizes) / sizeof(get_sizes[0]))
+#define SERVICE_COUNT   4
+
+static uint8_t buffer[1u << 20];
+static process_t *kernel_process;
+static process_t *client;
+static uint32_t port_id;
+static ipc_message_t request;
+static ipc_message_t reply;
+static entropy_request_t requests[SERVICE_COUNT];
+static uint32_t draw;
+static const entropy_request_t *service_request;
+static volatile uint64_t sink;      /* Keeps results live */
+
+static bench_case_t cases[GET_COUNT + 1 + SERVICE_COUNT];
+static char names[GET_COUNT + 1 + SERVICE_COUNT][NAME_LEN];
+
+/* Client round trip; the kernel process serves in between */
+static bool service_call(const entropy_request_t *req) {
+    uint32_t sender = IPC_PID_ANY;
+    entropy_response_t resp;
+
+    request.message_type = IPC_MSG_NORMAL;
+    request.length = sizeof(*req);
+    memcpy(request.data, req, sizeof(*req));
+
+    process_switch_to(client);
+    if (ipc_port_send(port_id, &request) != IPC_SUCCESS) {
+        return false;
+    }
+    process_switch_to(kernel_process);
+    entropy_service_poll(port_id, 1);
+    process_switch_to(client);
+    if (ipc_receive(&sender, &reply, IPC_NO_WAIT) != IPC_SUCCESS) {
+        return false;
+    }
+    process_switch_to(kernel_process);
+
+    memcpy(&resp, reply.data, sizeof(resp));
+    return resp.status == IPC_SUCCESS && resp.length == req->length;
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void setup_get(void) {
+    draw = get_sizes[bench_current() - cases];
+}
+
+static void op_get(void) {
+    entropy_get(buffer, draw);
+}
+
+static void op_get_u64(void) {
+    sink += entropy_get_u64();
+}
+
+static void setup_service(void) {
+    service_request = &requests[bench_current() - cases - GET_COUNT - 1];
+}
+
+static void op_service(void) {
+    if (!service_call(service_request)) {
+        fprintf(stderr, "bench_entropy: %s failed\n", bench_current()->name);
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    process_create_params_t params = {
+        .name = "bench_client",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .stack_size = PROCESS_STACK_SIZE,
+    };
+    ipc_shared_region_t region;
+    ipc_region_grant_t grant;
+    uint32_t count = 0;
+
+    host_kernel_init(LOG_WARN);
+    if (process_init() != STATUS_SUCCESS || ipc_init() != IPC_SUCCESS ||
+        process_create(&params, &client) != STATUS_SUCCESS ||
+        entropy_init() != STATUS_SUCCESS || entropy_service_start(&port_id) != IPC_SUCCESS) {
+        fprintf(stderr, "bench_entropy: kernel initialisation failed\n");
+        return 1;
+    }
+    kernel_process = process_get_current();
+
+    process_switch_to(client);
+    if (ipc_share_create(REGION_BYTES, &region) != IPC_SUCCESS ||
+        ipc_share_grant(region.region_id, IPC_PID_KERNEL, IPC_SHARE_WRITE, &grant) !=
+            IPC_SUCCESS) {
+        fprintf(stderr, "bench_entropy: shared region not set up\n");
+        return 1;
+    }
+    process_switch_to(kernel_process);
+
+    for (uint32_t i = 0; i < GET_COUNT; i++) {
+        snprintf(names[count], NAME_LEN, "get_%u", get_sizes[i]);
+        cases[count] = (bench_case_t){ names[count], setup_get, op_get, NULL,
+                                       get_sizes[i] > BATCH_BYTES ? 1 : 0 };
+        count++;
+    }
+    cases[count++] = (bench_case_t){ "get_u64", NULL, op_get_u64, NULL, 0 };
+
+    requests[0] = (entropy_request_t){ ENTROPY_GET, 0, 0, 32 };
+    requests[1] = (entropy_request_t){ ENTROPY_GET, 0, 0, ENTROPY_INLINE_MAX };
+    requests[2] = (entropy_request_t){ ENTROPY_GET, region.region_id, 0, 4096 };
+    requests[3] = (entropy_request_t){ ENTROPY_GET, region.region_id, 0, REGION_BYTES };
+    for (uint32_t i = 0; i < SERVICE_COUNT; i++) {
+        snprintf(names[count], NAME_LEN, "service_%s_%llu", requests[i].region_id ? "region" :
+                 "inline", (unsigned long long)requests[i].length);
+        cases[count] = (bench_case_t){ names[count], setup_service, op_service, NULL,
+                                       requests[i].length > BATCH_BYTES ? 1 : 0 };
+        count++;
+    }
+
+    return bench_main(argc, argv, "entropy", cases, count);
+}
@@ -0,0 +1,227 @@
+/**
+ * QuantumOS Kernel Hot-path Host Benchmark
+ *
+ * Links the real memory.c, process.c, ipc.c, cycle_budget.c and
+ * resonant_scheduler.c against the host shims (tests/host) and times
+ * their hot paths with the bench.h framework:
+ *
+ *   kmalloc             bump allocation of 64 bytes
+ *   process_lifecycle   process_create() + process_destroy(), which
+ *                       also opens and closes the IPC queue
+ *   ipc_send_receive    64-byte message to self and back
+ *   ipc_endpoint        the same sent through an endpoint capability
+ *                       instead of to a PID
+ *   ipc_endpoint_transfer  the same carrying a capability, which the
+ *                       receiver then deletes
+ *   ipc_port            port send + receive
+ *   sched_next_ready    pick among 64 ready processes
+ *   cycle_budget_charge accounting on a context switch
+ *   resonant_schedule   resonant pick among 32 registered processes
+ *   resonant_sync       Kuramoto order-parameter update, 32 processes
+ *
+ * Numbers are for the host CPU and compiler, not the kernel under QEMU,
+ * so compare runs against each other rather than with in-kernel cycles.
+ * kmalloc never frees: samples * batch allocations must fit the 1 GB
+ * host heap (about 16 million at the default size).
+ *
+ * Build and run with: make bench
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/resonance/resonant_scheduler.h>
+#include <kernel/cycle_budget.h>
+#include <kernel/process.h>
+#include <kernel/memory.h>
+#include <kernel/boot.h>
+#include <kernel/ipc.h>
+#include <kernel/capability.h>
+#include <kernel/cpu.h>
+
+#include <stdio.h>
+
+#define SCHED_PROCESSES     64
+#define RESONANT_PROCESSES  32
+#define BENCH_MESSAGE_LEN   64
+#define BENCH_BUDGET_PID    (MAX_PROCESSES - 1)
+
+static process_t *procs[SCHED_PROCESSES];
+static uint32_t proc_count;
+static ipc_message_t message;
+static ipc_message_t reply;
+static uint32_t port_id;
+static uint32_t endpoint;
+static uint32_t handed;
+static volatile uint64_t sink;       /* Keeps results live */
+
+static void bench_entry(void) {
+}
+
+static process_t *spawn(const char *name, uint8_t priority) {
+    process_create_params_t params = {
+        .name = name,
+        .type = PROCESS_TYPE_USER,
+        .priority = priority,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)bench_entry,
+        .stack_address = (void *)0x400000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    process_t *process = NULL;
+
+    if (process_create(&params, &process) != STATUS_SUCCESS) {
+        boot_panic("bench: process_create failed");
+    }
+    return process;
+}
+
+static void spawn_many(uint32_t count) {
+    for (proc_count = 0; proc_count < count; proc_count++) {
+        procs[proc_count] = spawn("bench", PRIORITY_NORMAL);
+    }
+}
+
+static void destroy_all(void) {
+    while (proc_count) {
+        process_destroy(procs[--proc_count]->pid);
+    }
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void op_kmalloc(void) {
+    sink += (uintptr_t)kmalloc(64);
+}
+
+static void op_process_lifecycle(void) {
+    process_destroy(spawn("bench", PRIORITY_NORMAL)->pid);
+}
+
+static void setup_message(void) {
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = BENCH_MESSAGE_LEN;
+}
+
+static void op_ipc_send_receive(void) {
+    uint32_t sender;
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    ipc_receive(&sender, &reply, IPC_NO_WAIT);
+}
+
+static void setup_endpoint(void) {
+    setup_message();
+    if (ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &endpoint) != IPC_SUCCESS ||
+        ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &handed) != IPC_SUCCESS) {
+        boot_panic("bench: ipc_endpoint_create failed");
+    }
+}
+
+static void op_ipc_endpoint(void) {
+    uint32_t sender;
+    ipc_endpoint_send(endpoint, &message, CAP_NULL);
+    ipc_receive(&sender, &reply, IPC_NO_WAIT);
+}
+
+static void op_ipc_endpoint_transfer(void) {
+    uint32_t sender;
+    ipc_endpoint_send(endpoint, &message, handed);
+    ipc_receive(&sender, &reply, IPC_NO_WAIT);
+    ipc_endpoint_delete(reply.capability);
+}
+
+static void teardown_endpoint(void) {
+    ipc_endpoint_delete(endpoint);
+    ipc_endpoint_delete(handed);
+}
+
+static void setup_port(void) {
+    setup_message();
+    if (ipc_port_create("bench", &port_id) != IPC_SUCCESS) {
+        boot_panic("bench: ipc_port_create failed");
+    }
+}
+
+static void op_ipc_port(void) {
+    ipc_port_send(port_id, &message);
+    ipc_port_receive(port_id, &reply, IPC_NO_WAIT);
+}
+
+static void teardown_port(void) {
+    ipc_port_destroy(port_id);
+}
+
+static void setup_sched(void) {
+    spawn_many(SCHED_PROCESSES);
+}
+
+static void op_sched_next_ready(void) {
+    sink += (uintptr_t)process_get_next_ready();
+}
+
+static void setup_budget(void) {
+    cycle_budget_set(BENCH_BUDGET_PID, 1ULL << 40, 1ULL << 41);
+}
+
+static void op_cycle_budget_charge(void) {
+    cycle_budget_charge(BENCH_BUDGET_PID, 1000, cpu_rdtsc());
+}
+
+static void teardown_budget(void) {
+    cycle_budget_clear(BENCH_BUDGET_PID);
+}
+
+static void setup_resonant(void) {
+    resonant_scheduler_init(NULL);
+    spawn_many(RESONANT_PROCESSES);
+    for (uint32_t i = 0; i < proc_count; i++) {
+        resonant_register(procs[i]->pid, (resonant_class_t)(i % 3),
+                          (handedness_t)(i % 3));
+    }
+}
+
+static void op_resonant_schedule(void) {
+    scheduling_decision_t decision;
+    resonant_schedule_next(&decision);
+    sink += decision.selected_pid;
+}
+
+static void op_resonant_sync(void) {
+    resonant_sync();
+}
+
+static void teardown_resonant(void) {
+    for (uint32_t i = 0; i < proc_count; i++) {
+        resonant_unregister(procs[i]->pid);
+    }
+    destroy_all();
+}
+
+static const bench_case_t cases[] = {
+    { "kmalloc",             NULL,           op_kmalloc,             NULL,              0 },
+    { "process_lifecycle",   NULL,           op_process_lifecycle,   NULL,              0 },
+    { "ipc_send_receive",    setup_message,  op_ipc_send_receive,    NULL,              0 },
+    { "ipc_endpoint",        setup_endpoint, op_ipc_endpoint,        teardown_endpoint, 0 },
+    { "ipc_endpoint_transfer", setup_endpoint, op_ipc_endpoint_transfer, teardown_endpoint, 0 },
+    { "ipc_port",            setup_port,     op_ipc_port,            teardown_port,     0 },
+    { "sched_next_ready",    setup_sched,    op_sched_next_ready,    destroy_all,       0 },
+    { "cycle_budget_charge", setup_budget,   op_cycle_budget_charge, teardown_budget,   0 },
+    { "resonant_schedule",   setup_resonant, op_resonant_schedule,   teardown_resonant, 0 },
+    { "resonant_sync",       setup_resonant, op_resonant_sync,       teardown_resonant, 0 },
+};
+
+int main(int argc, char **argv) {
+    host_kernel_init(LOG_WARN);
+
+    if (process_init() != STATUS_SUCCESS || ipc_init() != IPC_SUCCESS) {
+        fprintf(stderr, "bench_kernel: kernel initialisation failed\n");
+        return 1;
+    }
+
+    return bench_main(argc, argv, "kernel", cases, sizeof(cases) / sizeof(cases[0]));
+}
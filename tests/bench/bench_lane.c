@@ -0,0 +1,279 @@
+/**
+ * QuantumOS Lane Host Benchmark
+ *
+ * Runs kernel/src/msi/lane.c natively against the host shims and times,
+ * with the bench.h framework:
+ *
+ *   spawn              lane_spawn() on a fresh LANE_STACK_MIN stack; the
+ *                      lanes are run to exit in teardown
+ *   spawn_recycled     the same again, every stack from the pool
+ *   spawn_exit         spawn, run to exit and recycle one lane
+ *   yield_pingpong     one yield, two lanes yielding to each other
+ *   yield_round_robin  one yield, 1024 lanes yielding in turn, so each
+ *                      switch touches a different stack
+ *   sleep_1us          one 1 us sleep on the vDSO clock
+ *   block_wake         one lane waking another that blocks again
+ *   swapcontext        one swapcontext() between two ucontexts, a
+ *                      reference for a switch that saves the full
+ *                      register file and signal mask
+ *
+ * The yield, sleep and block cases run lanes that live for the whole
+ * case: each op() wakes them for a burst and runs the carrier until the
+ * burst ends with every lane blocked, so the carrier's wake and the
+ * lanes' block are amortised over the burst. Lane statistics go to
+ * stderr at the end.
+ *
+ * Every spawn and spawn_recycled operation holds a stack until teardown:
+ * bench_op_calls() KiB must fit the 1 GB host heap.
+ *
+ * Build and run with: make bench-lane
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/msi_domain.h>
+#include <kernel/process.h>
+#include <kernel/vdso.h>
+#include <kernel/lane.h>
+#include <kernel/cpu.h>
+#include <msi.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+
+#define SPAWN_BATCH         4       /* Lanes per sample; keeps the spawn cases under 64 MB */
+#define PINGPONG_BURST      256     /* Yields per lane per op() */
+#define ROUND_LANES         1024
+#define ROUND_BURST         8
+#define SLEEP_BURST         16
+#define BLOCK_BURST         256
+#define MAX_BURST_LANES     ROUND_LANES
+
+static msi_domain_t *domain;
+static msi_lane_t *lanes[MAX_BURST_LANES];
+static uint32_t lane_count;
+static uint32_t burst;
+static msi_lane_t *blocked_lane;
+static volatile bool stopping;
+static volatile uint64_t sink;
+
+/* Publish the host monotonic clock through the vDSO page */
+static void calibrate_clock(void) {
+    uint64_t t0 = bench_now_ns(), c0 = cpu_rdtsc();
+    struct timespec pause = { 0, 50000000 };
+    nanosleep(&pause, NULL);
+    uint64_t t1 = bench_now_ns(), c1 = cpu_rdtsc();
+
+    /* us = cycles * mult >> 32 */
+    uint64_t mult = (uint64_t)(((unsigned __int128)(t1 - t0) << 32) / ((c1 - c0) * 1000));
+    vdso_update_clock(c1, t1 / 1000, mult, 32, (c1 - c0) * 1000000 / (t1 - t0));
+}
+
+/* ============================================================================
+ * Lane Bodies
+ * ============================================================================ */
+
+static void lane_idle(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    (void)arg;
+}
+
+static void lane_yielder(msi_lane_t *lane, void *arg) {
+    (void)arg;
+    while (!stopping) {
+        for (uint32_t i = 0; i < burst; i++) {
+            lane_yield();
+        }
+        lane_block();
+    }
+    sink += lane->id;
+}
+
+static void lane_sleeper(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    (void)arg;
+    while (!stopping) {
+        for (uint32_t i = 0; i < SLEEP_BURST; i++) {
+            lane_sleep_us(1);
+        }
+        lane_block();
+    }
+}
+
+static void lane_blocker(msi_lane_t *lane, void *arg) {
+    (void)arg;
+    blocked_lane = lane;
+    while (!stopping) {
+        lane_block();
+    }
+    blocked_lane = NULL;
+}
+
+static void lane_waker(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    (void)arg;
+    while (!stopping) {
+        for (uint32_t i = 0; i < BLOCK_BURST; i++) {
+            lane_wake(blocked_lane);
+            lane_yield();
+        }
+        lane_block();
+    }
+}
+
+static void spawn(lane_entry_t entry, uint32_t stack_size, msi_lane_t **lane) {
+    if (lane_spawn(domain, entry, NULL, stack_size, lane) != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_lane: spawn failed\n");
+        exit(1);
+    }
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void op_spawn(void) {
+    spawn(lane_idle, LANE_STACK_MIN, NULL);
+}
+
+static void teardown_spawn(void) {
+    lane_run(domain);
+}
+
+static void op_spawn_exit(void) {
+    spawn(lane_idle, LANE_STACK_MIN, NULL);
+    lane_run(domain);
+}
+
+/* Lanes that yield `each` times per wake */
+static void start_yielders(uint32_t count, uint32_t each) {
+    burst = each;
+    lane_count = count;
+    for (uint32_t i = 0; i < count; i++) {
+        spawn(lane_yielder, LANE_STACK_MIN, &lanes[i]);
+    }
+    bench_scale(count * each);
+}
+
+static void setup_pingpong(void) {
+    start_yielders(2, PINGPONG_BURST);
+}
+
+static void setup_round_robin(void) {
+    start_yielders(ROUND_LANES, ROUND_BURST);
+}
+
+static void op_burst(void) {
+    for (uint32_t i = 0; i < lane_count; i++) {
+        lane_wake(lanes[i]);
+    }
+    lane_run(domain);
+}
+
+/* Wakes every burst lane for the last time, so each sees `stopping` and exits */
+static void teardown_burst(void) {
+    stopping = true;
+    for (uint32_t i = 0; i < lane_count; i++) {
+        lane_wake(lanes[i]);
+    }
+    while (lane_run(domain) != 0) {
+        /* Sleepers finish their burst first */
+    }
+    stopping = false;
+    lane_count = 0;
+}
+
+static void setup_sleep(void) {
+    lane_count = 1;
+    spawn(lane_sleeper, 0, &lanes[0]);
+    bench_scale(SLEEP_BURST);
+}
+
+static void op_sleep(void) {
+    lane_wake(lanes[0]);
+    while (lane_run(domain) != LANE_NO_WAKE) {
+        /* Carrier idles in the kernel between timer wakes */
+    }
+}
+
+static void setup_block_wake(void) {
+    lane_count = 2;
+    spawn(lane_blocker, 0, &lanes[0]);
+    spawn(lane_waker, 0, &lanes[1]);
+    lane_run(domain);
+    bench_scale(BLOCK_BURST);
+}
+
+static void op_block_wake(void) {
+    lane_wake(lanes[1]);
+    lane_run(domain);
+}
+
+/* ============================================================================
+ * ucontext Reference
+ * ============================================================================ */
+
+static ucontext_t main_context, peer_context;
+static uint8_t peer_stack[16384];
+
+static void peer_entry(void) {
+    for (;;) {
+        swapcontext(&peer_context, &main_context);
+    }
+}
+
+static void setup_ucontext(void) {
+    getcontext(&peer_context);
+    peer_context.uc_stack.ss_sp = peer_stack;
+    peer_context.uc_stack.ss_size = sizeof(peer_stack);
+    peer_context.uc_link = NULL;
+    makecontext(&peer_context, peer_entry, 0);
+    bench_scale(2);
+}
+
+static void op_ucontext(void) {
+    swapcontext(&main_context, &peer_context);
+}
+
+static const bench_case_t cases[] = {
+    { "spawn",             NULL,              op_spawn,      teardown_spawn, SPAWN_BATCH },
+    { "spawn_recycled",    NULL,              op_spawn,      teardown_spawn, SPAWN_BATCH },
+    { "spawn_exit",        NULL,              op_spawn_exit, NULL,           0 },
+    { "yield_pingpong",    setup_pingpong,    op_burst,      teardown_burst, 1 },
+    { "yield_round_robin", setup_round_robin, op_burst,      teardown_burst, 1 },
+    { "sleep_1us",         setup_sleep,       op_sleep,      teardown_burst, 1 },
+    { "block_wake",        setup_block_wake,  op_block_wake, teardown_burst, 1 },
+    { "swapcontext",       setup_ucontext,    op_ucontext,   NULL,           0 },
+};
+
+int main(int argc, char **argv) {
+    lane_stats_t stats;
+    int status;
+
+    host_kernel_init(LOG_WARN);
+    if (process_init() != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_lane: kernel initialisation failed\n");
+        return 1;
+    }
+    calibrate_clock();
+    if (msi_domain_create(&domain) != MSI_SUCCESS) {
+        fprintf(stderr, "bench_lane: domain creation failed\n");
+        return 1;
+    }
+
+    status = bench_main(argc, argv, "lane", cases, sizeof(cases) / sizeof(cases[0]));
+
+    lane_get_stats(&stats);
+    fprintf(stderr, "Spawned %llu, exited %llu, switches %llu, carrier parks %llu, "
+            "stack pool %llu KiB\n", (unsigned long long)stats.spawned,
+            (unsigned long long)stats.exited, (unsigned long long)stats.switches,
+            (unsigned long long)stats.parks, (unsigned long long)(stats.stack_bytes / 1024));
+
+    msi_domain_destroy(domain);
+    return status;
+}
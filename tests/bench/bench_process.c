@@ -0,0 +1,130 @@
+/**
+ * QuantumOS Process Table Host Benchmark
+ *
+ * Links the real process.c and ipc.c against the host shims and times,
+ * with the bench.h framework and a given number of processes already
+ * live:
+ *
+ *   churn_<n>   process_create() followed by process_destroy() of the
+ *               same process, per pair. Each op() first destroys a
+ *               random background process and recreates it afterwards,
+ *               so the free slot is away from the bottom of the table
+ *               and slot allocation searches as it would in a
+ *               long-running system; that replacement is the second
+ *               pair counted.
+ *   lookup_<n>  process_get_by_pid() of a random live PID
+ *
+ * Live counts run from the old 256-entry table up to the full 64k slots,
+ * so a cost that grows with the table shows up as a rising column.
+ * Creation includes opening the process's IPC queue.
+ *
+ * Numbers are for the host CPU and compiler, not the kernel under QEMU.
+ *
+ * Build and run with: make bench-process
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/process.h>
+#include <kernel/ipc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NAME_LEN        24
+
+/* Background processes live during each case; the kernel and idle take two slots */
+static const uint32_t live_counts[] = { 256, 4096, 16384, MAX_PROCESSES - 3 };
+#define LIVE_COUNT      (sizeof(live_counts) / sizeof(live_counts[0]))
+
+enum { KIND_CHURN, KIND_LOOKUP, KINDS };
+
+static uint32_t live[MAX_PROCESSES];
+static uint32_t count;
+static uint64_t lookup_misses;
+
+static bench_case_t cases[LIVE_COUNT * KINDS];
+static char names[LIVE_COUNT * KINDS][NAME_LEN];
+
+static const process_create_params_t params = {
+    .name = "bench",
+    .type = PROCESS_TYPE_USER,
+    .priority = PRIORITY_NORMAL,
+    .parent_pid = KERNEL_PROCESS_ID,
+    .stack_address = (void *)0x500000,
+    .stack_size = PROCESS_STACK_SIZE,
+};
+
+static uint32_t create(void) {
+    process_t *process;
+
+    if (process_create(&params, &process) != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_process: process_create failed with %u live\n", count);
+        exit(1);
+    }
+    return process->pid;
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+/* Grow or shrink the background population to the running case's count */
+static void setup_population(void) {
+    uint32_t target = live_counts[(bench_current() - cases) / KINDS];
+
+    while (count < target) {
+        live[count++] = create();
+    }
+    while (count > target) {
+        process_destroy(live[--count]);
+    }
+}
+
+static void setup_churn(void) {
+    setup_population();
+    bench_scale(2);
+}
+
+static void op_churn(void) {
+    uint32_t victim = (uint32_t)(bench_rand() % count);
+
+    process_destroy(live[victim]);
+    process_destroy(create());
+    live[victim] = create();
+}
+
+static void op_lookup(void) {
+    lookup_misses += process_get_by_pid(live[bench_rand() % count]) == NULL;
+}
+
+int main(int argc, char **argv) {
+    uint32_t n = 0;
+    int status;
+
+    host_kernel_init(LOG_WARN);
+    if (process_init() != STATUS_SUCCESS || ipc_init() != IPC_SUCCESS) {
+        fprintf(stderr, "bench_process: kernel initialisation failed\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < LIVE_COUNT; i++) {
+        snprintf(names[n], NAME_LEN, "churn_%u", live_counts[i]);
+        cases[n] = (bench_case_t){ names[n], setup_churn, op_churn, NULL, 0 };
+        n++;
+        snprintf(names[n], NAME_LEN, "lookup_%u", live_counts[i]);
+        cases[n] = (bench_case_t){ names[n], setup_population, op_lookup, NULL, 0 };
+        n++;
+    }
+
+    status = bench_main(argc, argv, "process", cases, n);
+    if (status == 0 && lookup_misses) {
+        fprintf(stderr, "bench_process: %llu lookups missed a live process\n",
+                (unsigned long long)lookup_misses);
+        return 1;
+    }
+    return status;
+}
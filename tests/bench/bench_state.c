@@ -0,0 +1,164 @@
+/**
+ * QuantumOS Transactional State Host Benchmark
+ *
+ * Runs kernel/src/msi/state.c natively against the host shims with the
+ * bench.h framework. A 32 MiB region is filled and committed once; then,
+ * for dirty sets from one page to the whole region:
+ *
+ *   write_<n>    copy-on-write of one page, per page, in a transaction
+ *                that dirties n random pages and is dropped with
+ *                state_abort()
+ *   commit_<n>   one transaction: n random pages written and
+ *                state_commit(), which also frees what the previous
+ *                transaction superseded
+ *
+ * and, at the end:
+ *
+ *   snapshot     state_snapshot_acquire() + release, the reader's fixed
+ *                cost
+ *   copy_region  memcpy() of the whole region: what a snapshot costs
+ *                when a commit copies everything
+ *
+ * Region statistics go to stderr at the end.
+ *
+ * Build and run with: make bench-state
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/memory.h>
+#include <kernel/state.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REGION_PAGES    8192
+#define REGION_BYTES    ((size_t)REGION_PAGES * PAGE_SIZE)
+#define NAME_LEN        24
+
+static const uint32_t dirty_sizes[] = { 1, 4, 16, 64, 256, 1024, 4096, REGION_PAGES };
+#define DIRTY_COUNT     (sizeof(dirty_sizes) / sizeof(dirty_sizes[0]))
+
+enum { KIND_WRITE, KIND_COMMIT, KINDS };
+
+static state_region_t *region;
+static uint32_t order[REGION_PAGES];
+static uint32_t dirty;
+static uint64_t word;
+static uint8_t *copy_src;
+static uint8_t *copy_dst;
+static uint32_t copy_round;
+
+static bench_case_t cases[DIRTY_COUNT * KINDS + 2];
+static char names[DIRTY_COUNT * KINDS][NAME_LEN];
+
+/* The first `count` entries of `order` become distinct random pages */
+static void pick_pages(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t j = i + (uint32_t)(bench_rand() % (REGION_PAGES - i));
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+}
+
+static void write_pages(void) {
+    pick_pages(dirty);
+    for (uint32_t i = 0; i < dirty; i++) {
+        word++;
+        state_write(region, (uint64_t)order[i] * PAGE_SIZE + 64, &word, sizeof(word));
+    }
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+static void setup_write(void) {
+    dirty = dirty_sizes[(bench_current() - cases) / KINDS];
+    bench_scale(dirty);
+}
+
+static void op_write(void) {
+    write_pages();
+    state_abort(region);
+}
+
+static void setup_commit(void) {
+    dirty = dirty_sizes[(bench_current() - cases) / KINDS];
+}
+
+static void op_commit(void) {
+    write_pages();
+    state_commit(region, NULL);
+}
+
+static void op_snapshot(void) {
+    state_snapshot_release(state_snapshot_acquire(region));
+}
+
+static void setup_copy(void) {
+    copy_src = malloc(REGION_BYTES);
+    copy_dst = malloc(REGION_BYTES);
+    if (!copy_src || !copy_dst) {
+        fprintf(stderr, "bench_state: out of memory\n");
+        exit(1);
+    }
+    memset(copy_src, 1, REGION_BYTES);
+    memset(copy_dst, 0, REGION_BYTES);
+}
+
+static void op_copy(void) {
+    memcpy(copy_dst, copy_src, REGION_BYTES);
+    copy_src[copy_round % REGION_BYTES] = copy_dst[(copy_round + 1) % REGION_BYTES];
+    copy_round++;
+}
+
+static void teardown_copy(void) {
+    free(copy_src);
+    free(copy_dst);
+}
+
+int main(int argc, char **argv) {
+    state_stats_t stats;
+    uint32_t count = 0;
+    int status;
+
+    host_kernel_init(LOG_WARN);
+    if (state_region_create(REGION_BYTES, STATE_READ | STATE_WRITE, &region) != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_state: region creation failed\n");
+        return 1;
+    }
+    for (uint32_t page = 0; page < REGION_PAGES; page++) {
+        order[page] = page;
+        word = page;
+        state_write(region, (uint64_t)page * PAGE_SIZE, &word, sizeof(word));
+    }
+    state_commit(region, NULL);
+
+    for (uint32_t s = 0; s < DIRTY_COUNT; s++) {
+        snprintf(names[count], NAME_LEN, "write_%u", dirty_sizes[s]);
+        cases[count] = (bench_case_t){ names[count], setup_write, op_write, NULL, 1 };
+        count++;
+        snprintf(names[count], NAME_LEN, "commit_%u", dirty_sizes[s]);
+        cases[count] = (bench_case_t){ names[count], setup_commit, op_commit, NULL, 1 };
+        count++;
+    }
+    cases[count++] = (bench_case_t){ "snapshot", NULL, op_snapshot, NULL, 0 };
+    cases[count++] = (bench_case_t){ "copy_region", setup_copy, op_copy, teardown_copy, 1 };
+
+    status = bench_main(argc, argv, "state", cases, count);
+
+    state_get_stats(region, &stats);
+    fprintf(stderr, "State region %u pages (%zu MiB): commits %llu, pages copied %llu, "
+            "tables copied %llu, frames reclaimed %llu, pool %llu MiB\n", REGION_PAGES,
+            REGION_BYTES >> 20, (unsigned long long)stats.commits,
+            (unsigned long long)stats.cow_pages, (unsigned long long)stats.cow_tables,
+            (unsigned long long)stats.reclaimed,
+            (unsigned long long)(stats.frames * PAGE_SIZE >> 20));
+    return status;
+}
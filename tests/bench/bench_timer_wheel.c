@@ -0,0 +1,101 @@
+/**
+ * QuantumOS Timer Wheel Host Benchmark
+ *
+ * Builds kernel/src/timer_wheel.c natively and measures add, cancel and
+ * expiry with 10^6 timers spread from 1 us to one hour. Expiry is also
+ * checked: no timer may fire early, late (after the first tick at or
+ * past its expiry) or be lost.
+ *
+ * Build and run with: make bench-timer
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/timer.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_TIMERS      1000000
+#define MAX_DELAY_US    3600000000ULL   /* One hour */
+#define STEP_US         1000            /* Simulated 1 kHz tick */
+
+static ktimer_t timers[NUM_TIMERS];
+static uint64_t fired;
+static uint64_t early;
+static uint64_t late;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+int main(void) {
+    static timer_wheel_t wheel;
+    uint64_t start_us = 12345;
+
+    timer_wheel_init(&wheel, start_us);
+
+    /* Add */
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < NUM_TIMERS; i++) {
+        timers[i].expires = start_us + 1 + rng_next() % MAX_DELAY_US;
+        timers[i].data = i;
+        timer_wheel_add(&wheel, &timers[i]);
+    }
+    uint64_t add_ns = now_ns() - t0;
+
+    /* Cancel every other timer */
+    t0 = now_ns();
+    uint64_t cancelled = 0;
+    for (uint32_t i = 0; i < NUM_TIMERS; i += 2) {
+        cancelled += timer_wheel_cancel(&timers[i]);
+    }
+    uint64_t cancel_ns = now_ns() - t0;
+
+    /* Expire the rest at a 1 kHz simulated tick */
+    uint64_t steps = 0;
+    t0 = now_ns();
+    for (uint64_t now = start_us; now <= start_us + MAX_DELAY_US + STEP_US; now += STEP_US) {
+        ktimer_t *t = timer_wheel_advance(&wheel, now);
+        while (t) {
+            if (t->expires > now) {
+                early++;
+            } else if (now - t->expires >= STEP_US) {
+                late++;
+            }
+            fired++;
+            t = t->next;
+        }
+        steps++;
+    }
+    uint64_t expire_ns = now_ns() - t0;
+
+    printf("{\"bench\":\"timer_wheel\",\"timers\":%d,"
+           "\"add_ns_per_op\":%.1f,\"cancel_ns_per_op\":%.1f,"
+           "\"expire_ns_per_step\":%.1f,\"advance_steps\":%llu,"
+           "\"fired\":%llu,\"cancelled\":%llu,\"early\":%llu,\"late\":%llu,\"lost\":%llu}\n",
+           NUM_TIMERS,
+           (double)add_ns / NUM_TIMERS,
+           (double)cancel_ns / cancelled,
+           (double)expire_ns / steps,
+           (unsigned long long)steps,
+           (unsigned long long)fired,
+           (unsigned long long)cancelled,
+           (unsigned long long)early,
+           (unsigned long long)late,
+           (unsigned long long)(NUM_TIMERS - cancelled - fired));
+
+    return (early == 0 && late == 0 && fired + cancelled == NUM_TIMERS) ? 0 : 1;
+}
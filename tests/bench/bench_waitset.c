@@ -0,0 +1,203 @@
+/**
+ * QuantumOS Wait Set Host Benchmark
+ *
+ * Links the real ipc.c, waitset.c and process.c against the host shims.
+ * The kernel process holds 1000 channels to a peer process. Every round
+ * the peer sends one message on each of a few random channels, then the
+ * kernel collects them, either by
+ *
+ *   poll     ipc_channel_receive() on every channel in turn, or
+ *   level    ipc_waitset_collect() on a set watching all channels
+ *            (level-triggered) and receiving from what it reports, or
+ *   edge     the same with WAITSET_EDGE registrations.
+ *
+ * Cases, with the bench.h framework:
+ *
+ *   <mode>_<n>       one round with n active channels, sends included
+ *   sendrecv_<mode>  one message sent on a random channel and received
+ *                    from it directly, so the difference from
+ *                    sendrecv_poll is what watching the channel adds to
+ *                    the send
+ *
+ * Numbers are for the host CPU and compiler, not the kernel under QEMU.
+ *
+ * Build and run with: make bench-waitset
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "bench.h"
+#include "../host/host_shim.h"
+
+#include <kernel/process.h>
+#include <kernel/ipc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHANNELS        1000
+#define EVENT_BATCH     64
+#define MESSAGE_LEN     64
+#define NAME_LEN        24
+
+enum { MODE_POLL, MODE_LEVEL, MODE_EDGE, MODE_COUNT };
+
+static const char *const mode_names[MODE_COUNT] = { "poll", "level", "edge" };
+static const uint32_t active_counts[] = { 1, 10, 100 };
+#define ACTIVE_SIZES    (sizeof(active_counts) / sizeof(active_counts[0]))
+#define ROUND_CASES     (ACTIVE_SIZES * MODE_COUNT)
+
+static uint32_t channel_ids[CHANNELS];
+static uint32_t order[CHANNELS];
+static process_t *kernel_process;
+static process_t *peer;
+static ipc_message_t message;
+static ipc_message_t received;
+static waitset_event_t events[EVENT_BATCH];
+static uint32_t mode;
+static uint32_t active;
+static uint32_t ws;
+
+static bench_case_t cases[ROUND_CASES + MODE_COUNT];
+static char names[ROUND_CASES + MODE_COUNT][NAME_LEN];
+
+/* The first `count` entries of `order` become distinct random channels */
+static void pick_channels(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t j = i + (uint32_t)(bench_rand() % (CHANNELS - i));
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+}
+
+static uint32_t collect_poll(void) {
+    uint32_t got = 0;
+
+    for (uint32_t i = 0; i < CHANNELS; i++) {
+        if (ipc_channel_receive(channel_ids[i], &received, IPC_NO_WAIT) == IPC_SUCCESS) {
+            got++;
+        }
+    }
+    return got;
+}
+
+static uint32_t collect_waitset(void) {
+    uint32_t got = 0, count;
+
+    while (ipc_waitset_collect(ws, events, EVENT_BATCH, &count) == IPC_SUCCESS) {
+        for (uint32_t i = 0; i < count; i++) {
+            while (ipc_channel_receive(channel_ids[events[i].cookie], &received,
+                                       IPC_NO_WAIT) == IPC_SUCCESS) {
+                got++;
+            }
+        }
+    }
+    return got;
+}
+
+/* ============================================================================
+ * Cases
+ * ============================================================================ */
+
+/* Watch every channel in the running case's mode */
+static void watch(void) {
+    if (mode == MODE_POLL) {
+        return;
+    }
+    ipc_waitset_create(&ws);
+    for (uint32_t i = 0; i < CHANNELS; i++) {
+        ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_ids[i],
+                        mode == MODE_EDGE ? WAITSET_EDGE : WAITSET_LEVEL, i);
+    }
+}
+
+static void unwatch(void) {
+    if (ws) {
+        ipc_waitset_destroy(ws);
+        ws = 0;
+    }
+}
+
+static void setup_round(void) {
+    uint32_t index = (uint32_t)(bench_current() - cases);
+
+    mode = index % MODE_COUNT;
+    active = active_counts[index / MODE_COUNT];
+    watch();
+}
+
+static void op_round(void) {
+    uint32_t got;
+
+    pick_channels(active);
+    process_switch_to(peer);
+    for (uint32_t i = 0; i < active; i++) {
+        ipc_channel_send(channel_ids[order[i]], &message);
+    }
+    process_switch_to(kernel_process);
+
+    got = mode == MODE_POLL ? collect_poll() : collect_waitset();
+    if (got != active) {
+        fprintf(stderr, "bench_waitset: %s collected %u of %u\n", mode_names[mode], got, active);
+        exit(1);
+    }
+}
+
+static void setup_sendrecv(void) {
+    mode = (uint32_t)(bench_current() - cases) - ROUND_CASES;
+    watch();
+}
+
+static void op_sendrecv(void) {
+    uint32_t channel = channel_ids[bench_rand() % CHANNELS];
+
+    process_switch_to(peer);
+    ipc_channel_send(channel, &message);
+    process_switch_to(kernel_process);
+    ipc_channel_receive(channel, &received, IPC_NO_WAIT);
+}
+
+int main(int argc, char **argv) {
+    process_create_params_t params = {
+        .name = "bench_peer",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .stack_size = PROCESS_STACK_SIZE,
+    };
+    uint32_t count = 0;
+
+    host_kernel_init(LOG_WARN);
+    if (process_init() != STATUS_SUCCESS || ipc_init() != IPC_SUCCESS ||
+        process_create(&params, &peer) != STATUS_SUCCESS) {
+        fprintf(stderr, "bench_waitset: kernel initialisation failed\n");
+        return 1;
+    }
+    kernel_process = process_get_current();
+
+    for (uint32_t i = 0; i < CHANNELS; i++) {
+        if (ipc_channel_create(peer->pid, IPC_PID_KERNEL, &channel_ids[i]) != IPC_SUCCESS) {
+            fprintf(stderr, "bench_waitset: channel %u not created\n", i);
+            return 1;
+        }
+        order[i] = i;
+    }
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = MESSAGE_LEN;
+
+    for (uint32_t s = 0; s < ACTIVE_SIZES; s++) {
+        for (uint32_t m = 0; m < MODE_COUNT; m++) {
+            snprintf(names[count], NAME_LEN, "%s_%u", mode_names[m], active_counts[s]);
+            cases[count] = (bench_case_t){ names[count], setup_round, op_round, unwatch, 1 };
+            count++;
+        }
+    }
+    for (uint32_t m = 0; m < MODE_COUNT; m++) {
+        snprintf(names[count], NAME_LEN, "sendrecv_%s", mode_names[m]);
+        cases[count] = (bench_case_t){ names[count], setup_sendrecv, op_sendrecv, unwatch, 0 };
+        count++;
+    }
+
+    return bench_main(argc, argv, "waitset", cases, count);
+}
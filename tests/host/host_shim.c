@@ -0,0 +1,90 @@
+/**
+ * QuantumOS Host Shim Implementation
+ *
+ * See host_shim.h.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "host_shim.h"
+
+#include <kernel/boot.h>
+#include <kernel/memory.h>
+#include <kernel/trace.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define HOST_LOW_MEMORY_SIZE    (1 << 20)   /* PMM bitmap for up to 32 GB */
+
+/* Kernel heap (see KERNEL_HEAP_START in kernel/memory.h) */
+uint8_t host_kernel_heap[HOST_KERNEL_HEAP_SIZE] ALIGNED(PAGE_SIZE);
+
+/* The linker script puts the PMM bitmap at __end, just past the image */
+static uint8_t host_low_memory[HOST_LOW_MEMORY_SIZE] ALIGNED(PAGE_SIZE);
+extern uint8_t __end __attribute__((alias("host_low_memory")));
+
+volatile uint32_t trace_key;
+
+static log_level_t host_log_level = LOG_DEFAULT_LEVEL;
+
+static const char *const level_names[] = { "EMERG", "ERR", "WARN", "INFO", "DEBUG" };
+
+/* ============================================================================
+ * Kernel Services
+ * ============================================================================ */
+
+void log_set_level(log_level_t level) {
+    host_log_level = level;
+}
+
+bool log_enabled(log_level_t level) {
+    return level <= host_log_level;
+}
+
+void klog(log_level_t level, const char *message) {
+    if (log_enabled(level)) {
+        fprintf(stderr, "[%s] %s\n", level_names[level], message);
+    }
+}
+
+void klog_hex(log_level_t level, const char *message, uint64_t value) {
+    if (log_enabled(level)) {
+        fprintf(stderr, "[%s] %s0x%llx\n", level_names[level], message, (unsigned long long)value);
+    }
+}
+
+void boot_log(const char *message) {
+    klog(LOG_INFO, message);
+}
+
+void boot_panic(const char *message) {
+    fprintf(stderr, "PANIC: %s\n", message);
+    abort();
+}
+
+void early_console_write(const char *str) {
+    klog(LOG_INFO, str);
+}
+
+void early_console_write_hex(uint64_t value) {
+    klog_hex(LOG_INFO, "", value);
+}
+
+void trace_record(trace_event_t event, uint64_t arg0, uint64_t arg1) {
+    (void)event;
+    (void)arg0;
+    (void)arg1;
+}
+
+/* ============================================================================
+ * Setup
+ * ============================================================================ */
+
+void host_kernel_init(log_level_t level) {
+    log_set_level(level);
+
+    if (kheap_init() != MEM_SUCCESS) {
+        boot_panic("host: kernel heap initialisation failed");
+    }
+}
@@ -0,0 +1,35 @@
+/**
+ * QuantumOS Host Shim
+ *
+ * Lets kernel sources build as an ordinary Linux program for unit tests
+ * and benchmarks. Everything is compiled with -DQUANTUM_HOST, which
+ * swaps the privileged inlines in kernel/cpu.h and kernel/io.h for
+ * harmless stand-ins and points the kernel heap at a host array.
+ *
+ * host_shim.c supplies what the linked sources need from the rest of
+ * the kernel:
+ *
+ *   boot_log, klog, early_console_*   stderr, filtered by log level
+ *   boot_panic                        message on stderr, then abort()
+ *   __end                             page-aligned scratch for the PMM bitmap
+ *   trace_key / trace_record          tracing compiled in but never enabled
+ *
+ * memset, memcpy and strlen come from the C library, whose signatures
+ * match the kernel's.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <kernel/log.h>
+#include <kernel/types.h>
+
+/**
+ * Bring up the kernel services the linked sources expect: the heap,
+ * and log output at `level`
+ */
+void host_kernel_init(log_level_t level);
+
+#endif /* HOST_SHIM_H */
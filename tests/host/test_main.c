@@ -0,0 +1,22 @@
+/**
+ * QuantumOS Host Unit Test Runner
+ *
+ * Entry point for one tests/unit suite built natively. The Makefile
+ * compiles this file once per suite with TEST_SUITE set to the suite's
+ * run_<name>_tests() function; the exit status is the failure count.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include "host_shim.h"
+
+#ifndef TEST_SUITE
+#error "TEST_SUITE must name the suite's run function"
+#endif
+
+int TEST_SUITE(void);
+
+int main(void) {
+    host_kernel_init(LOG_INFO);
+    return TEST_SUITE() ? 1 : 0;
+}
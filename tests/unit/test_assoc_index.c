@@ -0,0 +1,503 @@
+/**
+ * QuantumOS Associative Memory Index Unit Tests
+ *
+ * Unit tests for the HNSW index behind msi_assoc_*: the distance kernels
+ * against a plain reference, exact lookup, forgetting and reviving,
+ * promotion from the flat tier to the graph, recall against the linear
+ * scan, quantised scans with re-ranking, and the MSI result codes.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/assoc_index.h>
+#include <kernel/memory.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define TEST_DIMENSIONS     32
+#define TEST_CLUSTERS       16
+#define TEST_ENTRIES        2000
+#define TEST_QUERIES        50
+#define TEST_K              10
+
+static uint8_t vectors[TEST_ENTRIES][TEST_DIMENSIONS];
+static uint8_t centers[TEST_CLUSTERS][TEST_DIMENSIONS];
+static assoc_match_t approx[TEST_K];
+static assoc_match_t exact[TEST_K];
+
+static uint64_t rng_state = 0x2545F4914F6CDD1DULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Points scattered around a few centres, like real embeddings */
+static void make_vector(uint8_t *out, uint32_t dims) {
+    const uint8_t *center = centers[rng_next() % TEST_CLUSTERS];
+    for (uint32_t i = 0; i < dims; i++) {
+        int32_t value = (int32_t)center[i] + (int32_t)(rng_next() % 41) - 20;
+        out[i] = (uint8_t)MIN(MAX(value, 0), 255);
+    }
+}
+
+static uint32_t reference_distance(assoc_metric_t metric, const uint8_t *a,
+                                   const uint8_t *b, uint32_t n) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        int32_t d = (int32_t)a[i] - b[i];
+        uint8_t x = a[i] ^ b[i];
+        switch (metric) {
+        case ASSOC_METRIC_L2:
+            sum += (uint32_t)(d * d);
+            break;
+        case ASSOC_METRIC_DOT:
+            sum += 255U * 255U - (uint32_t)a[i] * b[i];
+            break;
+        default:
+            while (x) {
+                sum += x & 1;
+                x >>= 1;
+            }
+            break;
+        }
+    }
+    return sum;
+}
+
+static assoc_index_t *create_configured(const assoc_config_t *config) {
+    assoc_index_t *index = NULL;
+    size_t size = assoc_index_arena_size(config);
+    uint8_t *arena = kmalloc(size + ASSOC_VECTOR_ALIGN);
+
+    if (!size || !arena) {
+        return NULL;
+    }
+    arena = (uint8_t *)ALIGN_UP((uintptr_t)arena, ASSOC_VECTOR_ALIGN);
+    if (assoc_index_create(arena, size, config, &index) != STATUS_SUCCESS) {
+        return NULL;
+    }
+    return index;
+}
+
+static assoc_index_t *create_index(assoc_metric_t metric, uint32_t capacity,
+                                   uint32_t payload_bytes, uint32_t flat_threshold) {
+    assoc_config_t config = {
+        .dimensions = TEST_DIMENSIONS,
+        .capacity = capacity,
+        .payload_bytes = payload_bytes,
+        .flat_threshold = flat_threshold,
+        .metric = metric,
+    };
+    return create_configured(&config);
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================ */
+
+/**
+ * Test the dispatched distance kernels on every length up to 200
+ */
+static void test_distance_kernels(void) {
+    static uint8_t a[200], b[200];
+    bool ok[ASSOC_METRIC_COUNT] = { true, true, true };
+
+    boot_log("Testing distance kernels...");
+
+    for (uint32_t i = 0; i < sizeof(a); i++) {
+        a[i] = (uint8_t)rng_next();
+        b[i] = (uint8_t)rng_next();
+    }
+    for (uint32_t n = 0; n <= sizeof(a); n++) {
+        for (uint32_t m = 0; m < ASSOC_METRIC_COUNT; m++) {
+            if (assoc_distance(m, a, b, n) != reference_distance(m, a, b, n)) {
+                ok[m] = false;
+            }
+        }
+    }
+    TEST_ASSERT(ok[ASSOC_METRIC_L2], "L2 kernel matches reference");
+    TEST_ASSERT(ok[ASSOC_METRIC_DOT], "Dot kernel matches reference");
+    TEST_ASSERT(ok[ASSOC_METRIC_HAMMING], "Hamming kernel matches reference");
+    TEST_ASSERT_EQUAL(0U, assoc_distance(ASSOC_METRIC_L2, a, a, sizeof(a)), "Self distance zero");
+}
+
+/**
+ * Test configuration checks and a full index
+ */
+static void test_config_and_capacity(void) {
+    assoc_config_t config = { .dimensions = 0, .capacity = 16 };
+    assoc_index_t *index;
+    uint8_t vector[TEST_DIMENSIONS];
+
+    boot_log("Testing configuration and capacity...");
+
+    TEST_ASSERT_EQUAL(0U, (uint32_t)assoc_index_arena_size(&config), "Zero dimensions rejected");
+    config.dimensions = ASSOC_MAX_DIMENSIONS + 1;
+    TEST_ASSERT_EQUAL(0U, (uint32_t)assoc_index_arena_size(&config), "Oversized vectors rejected");
+    config.dimensions = TEST_DIMENSIONS;
+    config.m = 1;
+    TEST_ASSERT_EQUAL(0U, (uint32_t)assoc_index_arena_size(&config), "M of 1 rejected");
+
+    index = create_index(ASSOC_METRIC_L2, 4, 0, 0);
+    TEST_ASSERT(index != NULL, "Small index created");
+    if (!index) {
+        return;
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        memset(vector, (int)i, sizeof(vector));
+        assoc_index_insert(index, vector, NULL, 0, NULL);
+    }
+    memset(vector, 0x7F, sizeof(vector));
+    TEST_ASSERT_EQUAL(STATUS_NO_MEMORY, assoc_index_insert(index, vector, NULL, 0, NULL),
+                      "Insert into full index fails");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, assoc_index_lookup(index, vector, &(uint32_t){0}),
+                      "Failed insert left no entry");
+}
+
+/**
+ * Test exact lookup, duplicates, forgetting and reviving
+ */
+static void test_lookup_and_forget(void) {
+    assoc_index_t *index = create_index(ASSOC_METRIC_L2, 64, 1024, 1);
+    uint8_t vector[TEST_DIMENSIONS];
+    const char payload[] = "payload";
+    static assoc_match_t matches[32];
+    uint32_t id, found, size;
+    bool present = false;
+
+    boot_log("Testing lookup and forget...");
+
+    TEST_ASSERT(index != NULL, "Index created");
+    if (!index) {
+        return;
+    }
+    for (uint32_t i = 0; i < 32; i++) {
+        make_vector(vectors[i], TEST_DIMENSIONS);
+        vectors[i][0] = (uint8_t)i;     /* Keep them distinct */
+        assoc_index_insert(index, vectors[i], payload, sizeof(payload), NULL);
+    }
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, assoc_index_lookup(index, vectors[7], &id), "Lookup hit");
+    TEST_ASSERT(assoc_index_payload(index, id, &size) != NULL && size == sizeof(payload),
+                "Payload stored");
+    TEST_ASSERT_EQUAL(STATUS_BUSY, assoc_index_insert(index, vectors[7], NULL, 0, NULL),
+                      "Duplicate vector rejected");
+
+    memset(vector, 0xAA, sizeof(vector));
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, assoc_index_lookup(index, vector, &id), "Lookup miss");
+
+    found = assoc_index_search(index, vectors[7], 1, 0, approx);
+    TEST_ASSERT(found == 1 && approx[0].id == id && approx[0].distance == 0,
+                "Nearest neighbour of a stored vector is itself");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, assoc_index_remove(index, id), "Forget");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, assoc_index_remove(index, id), "Forget twice fails");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, assoc_index_lookup(index, vectors[7], &found),
+                      "Forgotten entry not found");
+    found = assoc_index_search(index, vectors[7], 31, 64, matches);
+    for (uint32_t i = 0; i < found; i++) {
+        present |= matches[i].id == id;
+    }
+    TEST_ASSERT(found == 31 && !present, "Search skips forgotten entry");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, assoc_index_insert(index, vectors[7], NULL, 0, &found),
+                      "Put after forget");
+    TEST_ASSERT_EQUAL(id, found, "Entry revived in place");
+    assoc_index_payload(index, id, &size);
+    TEST_ASSERT_EQUAL(0U, size, "Revived entry has the new payload");
+
+    assoc_stats_t stats;
+    assoc_index_get_stats(index, &stats);
+    TEST_ASSERT(stats.count == 32 && stats.deleted == 0, "Statistics track live entries");
+}
+
+/**
+ * Test that a store scans until the threshold and then builds its graph
+ */
+static void test_promotion(void) {
+    assoc_index_t *index = create_index(ASSOC_METRIC_L2, 256, 0, 100);
+    uint8_t query[TEST_DIMENSIONS];
+    assoc_stats_t stats;
+    bool same = true;
+
+    boot_log("Testing promotion from flat scan to graph...");
+
+    TEST_ASSERT(index != NULL, "Index created");
+    if (!index) {
+        return;
+    }
+    for (uint32_t i = 0; i < 99; i++) {
+        make_vector(vectors[i], TEST_DIMENSIONS);
+        vectors[i][1] = (uint8_t)i;
+        assoc_index_insert(index, vectors[i], NULL, 0, NULL);
+    }
+    assoc_index_get_stats(index, &stats);
+    TEST_ASSERT(stats.count == 99 && stats.linked == 0, "Nothing linked below the threshold");
+
+    for (uint32_t q = 0; q < 10; q++) {
+        make_vector(query, TEST_DIMENSIONS);
+        uint32_t n = assoc_index_search(index, query, TEST_K, 0, approx);
+        assoc_index_search_exact(index, query, TEST_K, exact);
+        for (uint32_t i = 0; i < n; i++) {
+            same &= approx[i].distance == exact[i].distance;
+        }
+        same &= n == TEST_K;
+    }
+    TEST_ASSERT(same, "Flat queries are exact");
+
+    make_vector(vectors[99], TEST_DIMENSIONS);
+    vectors[99][1] = 99;
+    assoc_index_insert(index, vectors[99], NULL, 0, NULL);
+    assoc_index_get_stats(index, &stats);
+    TEST_ASSERT_EQUAL(100U, stats.linked, "Threshold insert links the backlog");
+
+    make_vector(vectors[100], TEST_DIMENSIONS);
+    vectors[100][1] = 100;
+    assoc_index_insert(index, vectors[100], NULL, 0, NULL);
+    assoc_index_get_stats(index, &stats);
+    TEST_ASSERT_EQUAL(101U, stats.linked, "Later inserts link directly");
+
+    uint32_t n = assoc_index_search(index, vectors[100], 1, 0, approx);
+    TEST_ASSERT(n == 1 && approx[0].distance == 0, "Graph finds the newest entry");
+}
+
+/**
+ * Test recall@10 against the linear scan
+ */
+static void test_recall(void) {
+    assoc_index_t *index = create_index(ASSOC_METRIC_L2, TEST_ENTRIES, 0, 1);
+    uint8_t query[TEST_DIMENSIONS];
+    uint32_t hits = 0, inserted = 0;
+
+    boot_log("Testing recall against exact search...");
+
+    TEST_ASSERT(index != NULL, "Index created");
+    if (!index) {
+        return;
+    }
+    for (uint32_t c = 0; c < TEST_CLUSTERS; c++) {
+        for (uint32_t i = 0; i < TEST_DIMENSIONS; i++) {
+            centers[c][i] = (uint8_t)rng_next();
+        }
+    }
+    for (uint32_t i = 0; i < TEST_ENTRIES; i++) {
+        make_vector(vectors[i], TEST_DIMENSIONS);
+        inserted += assoc_index_insert(index, vectors[i], NULL, 0, NULL) == STATUS_SUCCESS;
+    }
+    TEST_ASSERT(inserted > TEST_ENTRIES - 10, "Entries inserted");
+
+    /* Forget a tenth so the search has tombstones to route through */
+    for (uint32_t i = 0; i < TEST_ENTRIES; i += 10) {
+        uint32_t id;
+        if (assoc_index_lookup(index, vectors[i], &id) == STATUS_SUCCESS) {
+            assoc_index_remove(index, id);
+        }
+    }
+
+    for (uint32_t q = 0; q < TEST_QUERIES; q++) {
+        make_vector(query, TEST_DIMENSIONS);
+        uint32_t n_exact = assoc_index_search_exact(index, query, TEST_K, exact);
+        uint32_t n_approx = assoc_index_search(index, query, TEST_K, 0, approx);
+        for (uint32_t i = 0; i < n_approx; i++) {
+            for (uint32_t j = 0; j < n_exact; j++) {
+                if (approx[i].id == exact[j].id) {
+                    hits++;
+                    break;
+                }
+            }
+        }
+    }
+    TEST_ASSERT(hits * 100 >= TEST_QUERIES * TEST_K * 90, "Recall@10 at least 90%");
+}
+
+/**
+ * Test quantised flat scans: exact once every entry is re-ranked, close
+ * to exact at the default width. Reuses the vectors from test_recall().
+ */
+static void test_quantized(void) {
+    static const assoc_quant_t quants[] = { ASSOC_QUANT_4BIT, ASSOC_QUANT_BINARY };
+    static const assoc_metric_t metrics[] = { ASSOC_METRIC_L2, ASSOC_METRIC_DOT };
+    static const uint32_t code_bytes[] = { 16, 8 };    /* 32 dimensions, 8-byte stride */
+    assoc_config_t config = {
+        .dimensions = TEST_DIMENSIONS,
+        .capacity = TEST_ENTRIES / 2,
+        .flat_threshold = 0xFFFFFFFFU,
+        .metric = ASSOC_METRIC_HAMMING,
+        .quantization = ASSOC_QUANT_BINARY,
+    };
+    uint8_t query[TEST_DIMENSIONS];
+    bool created = true, strides = true, full_exact = true;
+    uint32_t hits = 0, total = 0;
+
+    boot_log("Testing quantised scans...");
+
+    TEST_ASSERT_EQUAL(0U, (uint32_t)assoc_index_arena_size(&config),
+                      "Quantised Hamming store rejected");
+
+    for (uint32_t q = 0; q < 2; q++) {
+        for (uint32_t m = 0; m < 2; m++) {
+            assoc_index_t *wide, *narrow;
+            assoc_stats_t stats;
+
+            config.metric = metrics[m];
+            config.quantization = quants[q];
+            config.rerank = TEST_ENTRIES / 2 / TEST_K;
+            wide = create_configured(&config);
+            config.rerank = 0;
+            narrow = create_configured(&config);
+            if (!wide || !narrow) {
+                created = false;
+                continue;
+            }
+            for (uint32_t i = 0; i < config.capacity; i++) {
+                assoc_index_insert(wide, vectors[i], NULL, 0, NULL);
+                assoc_index_insert(narrow, vectors[i], NULL, 0, NULL);
+            }
+            assoc_index_get_stats(narrow, &stats);
+            strides &= stats.code_bytes == code_bytes[q] && stats.vector_bytes == 64;
+
+            for (uint32_t t = 0; t < TEST_QUERIES; t++) {
+                make_vector(query, TEST_DIMENSIONS);
+                uint32_t n_exact = assoc_index_search_exact(narrow, query, TEST_K, exact);
+                uint32_t n = assoc_index_search(wide, query, TEST_K, 0, approx);
+                full_exact &= n == n_exact;
+                for (uint32_t i = 0; i < n && i < n_exact; i++) {
+                    full_exact &= approx[i].distance == exact[i].distance;
+                }
+
+                n = assoc_index_search(narrow, query, TEST_K, 0, approx);
+                for (uint32_t i = 0; i < n; i++) {
+                    for (uint32_t j = 0; j < n_exact; j++) {
+                        if (approx[i].id == exact[j].id) {
+                            hits++;
+                            break;
+                        }
+                    }
+                }
+                total += n_exact;
+            }
+        }
+    }
+    TEST_ASSERT(created, "Quantised indexes created");
+    TEST_ASSERT(strides, "Code stride matches the quantisation");
+    TEST_ASSERT(full_exact, "Re-ranking every entry gives the exact result");
+    TEST_ASSERT(total && hits * 100 >= total * 90, "Default re-rank recall@10 at least 90%");
+}
+
+/**
+ * Test the MSI entry points and their result codes
+ */
+static void test_msi_binding(void) {
+    uint8_t a[TEST_DIMENSIONS], b[TEST_DIMENSIONS];
+    uint32_t value = 42;
+    msi_assoc_entry_t entry = { a, sizeof(a), &value, sizeof(value) };
+    msi_assoc_entry_t results[3];
+
+    boot_log("Testing MSI assoc binding...");
+
+    memset(a, 10, sizeof(a));
+    memset(b, 200, sizeof(b));
+
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_assoc_get(a, &results[0]), "Get before put");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_put(&entry), "Put creates the store");
+    TEST_ASSERT(msi_assoc_index() != NULL, "Store exists");
+    TEST_ASSERT_EQUAL(MSI_ERROR_ASSOC_COLLISION, msi_assoc_put(&entry), "Duplicate put collides");
+
+    entry.vector = b;
+    entry.payload = NULL;
+    entry.payload_size = 0;
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_put(&entry), "Second put");
+    entry.dimensions = TEST_DIMENSIONS / 2;
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_assoc_put(&entry), "Dimension mismatch rejected");
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_get(a, &results[0]), "Get");
+    TEST_ASSERT(results[0].payload_size == sizeof(value) &&
+                *(const uint32_t *)results[0].payload == 42, "Get returns the payload");
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_query(b, results, 3), "Query");
+    TEST_ASSERT(results[0].vector != NULL && results[0].vector[0] == 200 &&
+                results[1].vector != NULL && results[1].vector[0] == 10 &&
+                results[2].vector == NULL, "Query ordered by distance, rest zeroed");
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_forget(a), "Forget");
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_assoc_forget(a), "Forget twice");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_assoc_query(a, results, 3), "Query after forget");
+    TEST_ASSERT(results[0].vector[0] == 200 && results[1].vector == NULL,
+                "Forgotten entry not returned");
+    TEST_ASSERT_EQUAL(STATUS_BUSY, msi_assoc_configure(&(assoc_config_t){ .dimensions = 8 }),
+                      "Configure after first put rejected");
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+/**
+ * Run all associative memory index tests
+ *
+ * @return Number of failed assertions
+ */
+int run_assoc_index_tests(void) {
+    boot_log("=== Starting Associative Memory Index Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    /* Run tests */
+    test_distance_kernels();
+    test_config_and_capacity();
+    test_lookup_and_forget();
+    test_promotion();
+    test_recall();
+    test_quantized();
+    test_msi_binding();
+
+    /* Print results */
+    boot_log("=== Associative Memory Index Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Associative Memory Index Tests Complete ===");
+    return test_failed;
+}
@@ -0,0 +1,380 @@
+/**
+ * QuantumOS Capability Unit Tests
+ *
+ * Unit tests for CSpaces: slot allocation across radix nodes, lookup,
+ * delete and slot reuse, the cached rights bitmap with repeated grants,
+ * sealing, the registry and process attachment, the
+ * msi_domain_grant/seal binding and the rights MSI entry points check.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/capability.h>
+#include <kernel/msi_domain.h>
+#include <kernel/process.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+static int dummy_object;
+
+static void dummy_process_entry(void) {
+}
+
+static process_t *create_process(const char *name) {
+    process_create_params_t params = {
+        .name = name,
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)dummy_process_entry,
+        .stack_address = (void *)0x500000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    process_t *process = NULL;
+
+    return process_create(&params, &process) == STATUS_SUCCESS ? process : NULL;
+}
+
+/* ============================================================================
+ * Tests
+ * ============================================================================ */
+
+static void test_insert_lookup(void) {
+    cspace_t cs;
+    cap_t cap = { .object = &dummy_object, .type = CAP_TYPE_OBJECT, .rights = 3, .badge = 77 };
+    cap_t out;
+    uint32_t cptr = CAP_NULL, last = CAP_NULL;
+    bool all = true;
+
+    boot_log("Testing insert and lookup...");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_init(&cs), "Space initialised");
+    TEST_ASSERT(cs.id != 0 && cspace_get(cs.id) == &cs, "Space registered");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_insert(&cs, &cap, &cptr), "Object inserted");
+    TEST_ASSERT(cptr != CAP_NULL, "Null cptr never handed out");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_lookup(&cs, cptr, &out), "Object found");
+    TEST_ASSERT(out.object == &dummy_object && out.type == CAP_TYPE_OBJECT &&
+                out.rights == 3 && out.badge == 77, "Lookup returns the capability");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_lookup(&cs, CAP_NULL, &out), "Null cptr not found");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_lookup(&cs, cptr + 1, &out), "Unused slot not found");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_lookup(&cs, CSPACE_SLOTS, &out),
+                      "Out-of-range cptr not found");
+
+    /* Enough slots to need several leaves and a second interior node */
+    for (uint32_t i = 0; i < 5000; i++) {
+        cap.badge = i;
+        if (cspace_insert(&cs, &cap, &last) != STATUS_SUCCESS) {
+            all = false;
+        }
+    }
+    TEST_ASSERT(all, "Five thousand inserts");
+    TEST_ASSERT_EQUAL(5001U, cs.count, "Count tracks inserts");
+    TEST_ASSERT(cspace_lookup(&cs, last, &out) == STATUS_SUCCESS && out.badge == 4999,
+                "Deep slot found");
+
+    cap.type = CAP_TYPE_NULL;
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, cspace_insert(&cs, &cap, NULL), "Null type rejected");
+    cspace_destroy(&cs);
+    TEST_ASSERT(cspace_get(cs.id) == NULL, "Destroyed space unregistered");
+}
+
+static void test_delete_reuse(void) {
+    cspace_t cs;
+    cap_t cap = { .object = &dummy_object, .type = CAP_TYPE_OBJECT, .rights = 1, .badge = 0 };
+    cap_t out;
+    uint32_t a, b, c;
+
+    boot_log("Testing delete and slot reuse...");
+    cspace_init(&cs);
+    cspace_insert(&cs, &cap, &a);
+    cspace_insert(&cs, &cap, &b);
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_delete(&cs, a), "Delete");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_lookup(&cs, a, &out), "Deleted slot not found");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_delete(&cs, a), "Double delete refused");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_delete(&cs, 4000), "Unused slot delete refused");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_lookup(&cs, b, &out), "Neighbour untouched");
+    cspace_insert(&cs, &cap, &c);
+    TEST_ASSERT_EQUAL(a, c, "Freed slot reused first");
+    TEST_ASSERT_EQUAL(2U, cs.count, "Count after reuse");
+    cspace_destroy(&cs);
+}
+
+static void test_rights_cache(void) {
+    cspace_t cs;
+    uint32_t first, second, service;
+
+    boot_log("Testing the rights bitmap...");
+    cspace_init(&cs);
+    TEST_ASSERT(!cspace_has_right(&cs, CAP_RIGHT_IPC_SEND), "Empty space holds nothing");
+
+    cspace_grant(&cs, CAP_RIGHT_IPC_SEND, &first);
+    cspace_grant(&cs, CAP_RIGHT_IPC_SEND, &second);
+    TEST_ASSERT(cspace_has_right(&cs, CAP_RIGHT_IPC_SEND), "Granted right held");
+    TEST_ASSERT(!cspace_has_right(&cs, CAP_RIGHT_IPC_RECEIVE), "Other right not held");
+
+    cspace_delete(&cs, first);
+    TEST_ASSERT(cspace_has_right(&cs, CAP_RIGHT_IPC_SEND), "Second grant keeps the right");
+    cspace_delete(&cs, second);
+    TEST_ASSERT(!cspace_has_right(&cs, CAP_RIGHT_IPC_SEND), "Last delete drops the right");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_grant(&cs, CAP_RIGHT_MAX - 1, &service),
+                      "Highest service right granted");
+    TEST_ASSERT(cspace_has_right(&cs, CAP_RIGHT_MAX - 1), "Highest service right held");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, cspace_grant(&cs, CAP_RIGHT_MAX, NULL),
+                      "Right past the bitmap rejected");
+    TEST_ASSERT(!cspace_has_right(&cs, CAP_RIGHT_MAX), "Right past the bitmap never held");
+
+    /* More grants of one right than a 16-bit count holds */
+    for (uint32_t i = 0; i <= 0x10000; i++) {
+        cspace_grant(&cs, CAP_RIGHT_IPC_PORT, &first);
+    }
+    cspace_delete(&cs, first);
+    TEST_ASSERT(cspace_has_right(&cs, CAP_RIGHT_IPC_PORT), "65536 remaining grants keep the right");
+    cspace_destroy(&cs);
+}
+
+static void test_seal(void) {
+    cspace_t cs;
+    cap_t cap = { .object = &dummy_object, .type = CAP_TYPE_OBJECT, .rights = 1, .badge = 5 };
+    cap_t out;
+    uint32_t right_cptr, object_cptr;
+
+    boot_log("Testing sealed spaces...");
+    cspace_init(&cs);
+    cspace_grant(&cs, CAP_RIGHT_MSI_STATE, &right_cptr);
+    cspace_insert(&cs, &cap, &object_cptr);
+    cspace_seal(&cs);
+    cspace_seal(&cs);
+
+    TEST_ASSERT_EQUAL(STATUS_PERMISSION_DENIED, cspace_grant(&cs, CAP_RIGHT_MSI_LANE, NULL),
+                      "Grant into sealed space refused");
+    TEST_ASSERT_EQUAL(STATUS_PERMISSION_DENIED, cspace_delete(&cs, right_cptr),
+                      "Delete from sealed space refused");
+    TEST_ASSERT(cspace_has_right(&cs, CAP_RIGHT_MSI_STATE), "Sealed right still held");
+    TEST_ASSERT(cspace_lookup(&cs, object_cptr, &out) == STATUS_SUCCESS && out.badge == 5,
+                "Sealed lookup");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_lookup(&cs, object_cptr + 1, &out),
+                      "Sealed lookup of an empty slot");
+    cspace_destroy(&cs);
+}
+
+static void test_process_binding(void) {
+    cspace_t cs;
+    process_t *process = create_process("cap_test");
+    uint32_t id;
+
+    boot_log("Testing process attachment...");
+    TEST_ASSERT(process != NULL, "Process created");
+    if (!process) {
+        return;
+    }
+    TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_IPC_SEND), "Unattached user process refused");
+    TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_MSI_STATE),
+                "Unattached user process holds no right");
+    TEST_ASSERT(cap_process_has(process_get_by_pid(KERNEL_PROCESS_ID), CAP_RIGHT_IPC_SEND),
+                "Unattached kernel process unrestricted");
+    TEST_ASSERT(cap_process_has(NULL, CAP_RIGHT_IPC_SEND), "Kernel context unrestricted");
+
+    cspace_init(&cs);
+    cspace_grant(&cs, CAP_RIGHT_IPC_RECEIVE, NULL);
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cspace_attach(&cs, process->pid), "Attach");
+    TEST_ASSERT_EQUAL(cs.id, process->capability_root, "Space id stored in the process");
+    TEST_ASSERT(cap_process_has(process, CAP_RIGHT_IPC_RECEIVE), "Attached right allowed");
+    TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_IPC_SEND), "Missing right denied");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cspace_attach(&cs, MAX_PROCESSES + 1),
+                      "Attach to unknown pid");
+
+    id = cs.id;
+    cspace_destroy(&cs);
+    TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_IPC_RECEIVE),
+                "Destroyed space denies everything");
+
+    /* The slot comes back with a new generation, not the old id */
+    cspace_init(&cs);
+    TEST_ASSERT(cs.id != id && cspace_get(id) == NULL, "Stale id stays dead");
+    cspace_destroy(&cs);
+
+    process_destroy(process->pid);
+}
+
+static void test_msi_binding(void) {
+    msi_domain_t *domain = NULL;
+    process_t *process = create_process("cap_domain");
+
+    boot_log("Testing msi_domain_grant and msi_domain_seal...");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_create(&domain), "msi_domain_create");
+    TEST_ASSERT(!msi_domain_has(domain, CAP_RIGHT_MSI_EVENT), "New domain holds nothing");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_grant(domain, CAP_RIGHT_MSI_EVENT), "msi_domain_grant");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_grant(domain, CAP_RIGHT_MSI_EVENT), "Repeat grant");
+    TEST_ASSERT_EQUAL(1U, domain->caps.count, "Repeat grant takes no slot");
+    TEST_ASSERT(msi_domain_has(domain, CAP_RIGHT_MSI_EVENT), "Granted right held");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_domain_grant(domain, CAP_RIGHT_MAX),
+                      "Unknown right rejected");
+
+    if (process) {
+        TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_attach(domain, process->pid), "msi_domain_attach");
+        TEST_ASSERT(cap_process_has(process, CAP_RIGHT_MSI_EVENT), "Process holds the domain's right");
+        TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_MSI_LANE), "Process limited to the domain");
+    }
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_seal(domain), "msi_domain_seal");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_domain_grant(domain, CAP_RIGHT_MSI_LANE),
+                      "Grant after seal refused");
+    TEST_ASSERT(msi_domain_has(domain, CAP_RIGHT_MSI_EVENT), "Sealed domain keeps its right");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_domain_grant(NULL, CAP_RIGHT_MSI_EVENT),
+                      "Grant to NULL rejected");
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_destroy(domain), "msi_domain_destroy");
+    if (process) {
+        TEST_ASSERT(!cap_process_has(process, CAP_RIGHT_MSI_EVENT),
+                    "Destroyed domain's process loses its rights");
+        process_destroy(process->pid);
+    }
+}
+
+/* An attached process is refused the MSI calls its domain holds no right for */
+static void test_msi_rights(void) {
+    msi_domain_t *domain = NULL;
+    process_t *kernel_process = process_get_current();
+    process_t *process = create_process("cap_msi");
+    uint8_t vector[4] = { 1, 2, 3, 4 };
+    msi_assoc_entry_t entry = { .vector = vector, .dimensions = sizeof(vector) };
+    msi_lane_t *lane = NULL;
+    void *addr = NULL;
+    uint8_t byte = 0;
+
+    boot_log("Testing MSI entry point rights...");
+    TEST_ASSERT(process != NULL, "Process created");
+    if (!process || msi_domain_create(&domain) != MSI_SUCCESS) {
+        return;
+    }
+    msi_domain_grant(domain, CAP_RIGHT_MSI_EVENT);
+    msi_domain_attach(domain, process->pid);
+    process_switch_to(process);
+
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_map(&addr, 64, MSI_STATE_READ),
+                      "msi_state_map refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_read(addr, &byte, 1),
+                      "msi_state_read refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_write(addr, &byte, 1),
+                      "msi_state_write refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_commit(addr, 1),
+                      "msi_state_commit refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_assoc_put(&entry), "msi_assoc_put refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_assoc_get(vector, &entry),
+                      "msi_assoc_get refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_assoc_query(vector, &entry, 1),
+                      "msi_assoc_query refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_assoc_forget(vector),
+                      "msi_assoc_forget refused");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_lane_spawn(domain, &lane),
+                      "msi_lane_spawn refused");
+
+    /* With the right the call goes through to its own checks */
+    process_switch_to(kernel_process);
+    msi_domain_grant(domain, CAP_RIGHT_MSI_STATE);
+    process_switch_to(process);
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_state_read(NULL, &byte, 1),
+                      "msi_state_read allowed once granted");
+
+    process_switch_to(kernel_process);
+    msi_domain_destroy(domain);
+    process_destroy(process->pid);
+}
+
+/* A user process outside any space is refused; the kernel process is not */
+static void test_unattached_default(void) {
+    process_t *kernel_process = process_get_current();
+    process_t *process = create_process("cap_unattached");
+    uint8_t vector[4] = { 5, 6, 7, 8 };
+    msi_assoc_entry_t entry = { .vector = vector, .dimensions = sizeof(vector) };
+    void *addr = NULL;
+
+    boot_log("Testing the default for unattached processes...");
+    TEST_ASSERT(process != NULL && process->capability_root == 0, "Unattached process created");
+    if (!process) {
+        return;
+    }
+
+    process_switch_to(process);
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_map(&addr, 64, MSI_STATE_READ),
+                      "Unattached process refused msi_state_map");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_assoc_get(vector, &entry),
+                      "Unattached process refused msi_assoc_get");
+
+    process_switch_to(kernel_process);
+    TEST_ASSERT(msi_assoc_get(vector, &entry) != MSI_ERROR_PERMISSION_DENIED,
+                "Unattached kernel process allowed msi_assoc_get");
+
+    process_destroy(process->pid);
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_capability_tests(void) {
+    boot_log("=== Starting Capability Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    process_init();
+
+    /* Run tests */
+    test_insert_lookup();
+    test_delete_reuse();
+    test_rights_cache();
+    test_seal();
+    test_process_binding();
+    test_msi_binding();
+    test_msi_rights();
+    test_unattached_default();
+
+    /* Print results */
+    boot_log("=== Capability Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Capability Tests Complete ===");
+    return test_failed;
+}
@@ -0,0 +1,187 @@
+/**
+ * QuantumOS Cycle Budget Unit Tests
+ *
+ * Unit tests for per-process cycle budgets. The main case is a CPU hog
+ * at high priority: once its budget is exhausted the scheduler must pick
+ * lower-priority work until the period is replenished.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/cycle_budget.h>
+#include <kernel/resonance/consciousness_process.h>
+#include <kernel/process.h>
+#include <kernel/cpu.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define TEST_BUDGET     100000ULL
+#define TEST_PERIOD     1000000ULL
+#define TEST_STACK_SIZE 8192
+
+/* Dummy test function for process entry point */
+static void dummy_process_entry(void) {
+    while (1) {
+        __asm__ volatile("hlt");
+    }
+}
+
+static process_t *create_test_process(const char *name, uint8_t priority,
+                                      uint64_t stack) {
+    process_create_params_t params = {
+        .name = name,
+        .type = PROCESS_TYPE_USER,
+        .priority = priority,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void*)dummy_process_entry,
+        .stack_address = (void*)stack,
+        .stack_size = TEST_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+
+    process_t *process = NULL;
+    if (process_create(&params, &process) != STATUS_SUCCESS) {
+        return NULL;
+    }
+    return process;
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================ */
+
+/**
+ * Test budget accounting without the scheduler
+ */
+static void test_budget_accounting(void) {
+    boot_log("Testing cycle budget accounting...");
+
+    uint64_t now = 0;
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cycle_budget_set(200, TEST_BUDGET, TEST_PERIOD),
+                      "Budget set");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, cycle_budget_set(200, TEST_PERIOD + 1, TEST_PERIOD),
+                      "Budget larger than period rejected");
+
+    cycle_budget_t b;
+    cycle_budget_get(200, &b);
+    now = b.period_start;
+
+    cycle_budget_charge(200, TEST_BUDGET / 2, now);
+    TEST_ASSERT(!cycle_budget_is_throttled(200, now), "Not throttled under budget");
+    TEST_ASSERT_EQUAL(TEST_BUDGET / 2, cycle_budget_remaining(200, now), "Remaining cycles");
+
+    cycle_budget_charge(200, TEST_BUDGET, now);
+    TEST_ASSERT(cycle_budget_is_throttled(200, now), "Throttled after overrun");
+    cycle_budget_get(200, &b);
+    TEST_ASSERT_EQUAL(1, b.overrun_count, "Overrun counted once");
+    TEST_ASSERT_EQUAL(TEST_BUDGET / 2, b.overrun_cycles, "Overrun cycles recorded");
+
+    /* Next period: overrun debt is carried but below budget, so runnable */
+    now += TEST_PERIOD;
+    TEST_ASSERT(!cycle_budget_is_throttled(200, now), "Replenished after period");
+    TEST_ASSERT_EQUAL(TEST_BUDGET / 2, cycle_budget_remaining(200, now), "Overrun debt carried");
+
+    cycle_budget_clear(200);
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cycle_budget_get(200, &b), "Budget cleared");
+}
+
+/**
+ * Test that a throttled CPU hog yields to lower-priority work
+ */
+static void test_cpu_hog_throttled(void) {
+    boot_log("Testing CPU hog throttling...");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_init(), "Process system initialization");
+
+    process_t *hog = create_test_process("test_hog", PRIORITY_HIGH, 0xC00000);
+    process_t *worker = create_test_process("test_worker", PRIORITY_NORMAL, 0xD00000);
+    TEST_ASSERT(hog != NULL && worker != NULL, "Hog and worker creation");
+    if (!hog || !worker) {
+        return;
+    }
+
+    TEST_ASSERT_EQUAL(hog, process_get_next_ready(), "Hog scheduled first");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, consciousness_allocate_cycles(hog->pid, TEST_BUDGET),
+                      "Consciousness cycle allocation");
+    consciousness_consume_cycles(hog->pid, TEST_BUDGET * 2);
+
+    TEST_ASSERT(cycle_budget_is_throttled(hog->pid, cpu_rdtsc()), "Hog throttled");
+    TEST_ASSERT_EQUAL(worker, process_get_next_ready(), "Worker runs while hog throttled");
+
+    cycle_budget_stats_t stats;
+    cycle_budget_get_stats(&stats);
+    TEST_ASSERT(stats.total_overruns > 0, "Overrun reported in statistics");
+
+    /* Destroying the process releases its budget */
+    uint32_t hog_pid = hog->pid;
+    process_destroy(hog_pid);
+    process_destroy(worker->pid);
+    cycle_budget_t b;
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cycle_budget_get(hog_pid, &b), "Budget released on destroy");
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+/**
+ * Run all cycle budget tests
+ *
+ * @return Number of failed assertions
+ */
+int run_cycle_budget_tests(void) {
+    boot_log("=== Starting Cycle Budget Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    /* Run tests */
+    test_budget_accounting();
+    test_cpu_hog_throttled();
+
+    /* Print results */
+    boot_log("=== Cycle Budget Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Cycle Budget Tests Complete ===");
+    return test_failed;
+}
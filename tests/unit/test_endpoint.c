@@ -0,0 +1,344 @@
+/**
+ * QuantumOS IPC Endpoint Unit Tests
+ *
+ * Unit tests for capability-addressed IPC: sending through process and
+ * port endpoints, rights, grants to other processes, capability
+ * transfer inside messages, deletion and stale endpoints after a queue
+ * closes, and table reuse across processes. IPC runs as the kernel process, so every send here comes from
+ * pid 0.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/capability.h>
+#include <kernel/process.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <kernel/memory.h>
+#include <kernel/ipc.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+static ipc_message_t message;
+static ipc_message_t received;
+
+static void dummy_process_entry(void) {
+}
+
+static void drain(void) {
+    uint32_t sender = IPC_PID_ANY;
+
+    while (ipc_receive(&sender, &received, IPC_NO_WAIT) == IPC_SUCCESS) {
+        sender = IPC_PID_ANY;
+    }
+}
+
+static void set_payload(uint8_t value) {
+    memset(&message, 0, sizeof(message));
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = 16;
+    for (uint32_t i = 0; i < message.length; i++) {
+        message.data[i] = (uint8_t)(value + i);
+    }
+}
+
+static bool payload_is(const ipc_message_t *msg, uint8_t value) {
+    if (msg->length != 16) {
+        return false;
+    }
+    for (uint32_t i = 0; i < msg->length; i++) {
+        if (msg->data[i] != (uint8_t)(value + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Tests
+ * ============================================================================ */
+
+static void test_self_endpoint(void) {
+    uint32_t all, send_only, sender = IPC_PID_ANY;
+
+    boot_log("Testing endpoints to the caller's queue...");
+    drain();
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &all),
+                      "Endpoint created");
+    TEST_ASSERT(all != CAP_NULL, "Endpoint has a slot");
+
+    set_payload(10);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_send(all, &message, CAP_NULL), "Send through endpoint");
+    TEST_ASSERT_EQUAL(1U, ipc_get_queue_depth(), "Message queued");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_receive(&sender, &received, IPC_NO_WAIT), "Receive");
+    TEST_ASSERT(payload_is(&received, 10), "Payload intact");
+    TEST_ASSERT_EQUAL((uint32_t)IPC_PID_KERNEL, received.receiver_id, "Receiver filled in");
+    TEST_ASSERT_EQUAL((uint32_t)CAP_NULL, received.capability, "No capability transferred");
+
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_GRANT, &send_only);
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED, ipc_endpoint_send(send_only, &message, CAP_NULL),
+                      "Send without IPC_ENDPOINT_SEND denied");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_endpoint_send(all + 1000, &message, CAP_NULL),
+                      "Unknown slot not found");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG, ipc_endpoint_create(IPC_ENDPOINT_SELF, 0x80, &send_only),
+                      "Unknown rights rejected");
+
+    message.length = IPC_MAX_MESSAGE_SIZE + 1;
+    TEST_ASSERT_EQUAL(IPC_ERROR_MESSAGE_TOO_LARGE, ipc_endpoint_send(all, &message, CAP_NULL),
+                      "Oversized message rejected");
+
+    set_payload(11);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_delete(all), "Delete");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_endpoint_send(all, &message, CAP_NULL),
+                      "Deleted endpoint not found");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_endpoint_delete(all), "Double delete refused");
+    ipc_endpoint_delete(send_only);
+}
+
+static void test_port_endpoint(void) {
+    uint32_t port_id, endpoint, old_port;
+
+    boot_log("Testing port endpoints and staleness...");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_port_create("endpoint-test", &port_id), "Port created");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_create(port_id, IPC_ENDPOINT_SEND, &endpoint),
+                      "Port endpoint created");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_PORT, ipc_endpoint_create(port_id + 1000, IPC_ENDPOINT_SEND,
+                                                                  &old_port),
+                      "Endpoint to unknown port rejected");
+
+    set_payload(20);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_send(endpoint, &message, CAP_NULL), "Send to port");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_port_receive(port_id, &received, IPC_NO_WAIT),
+                      "Port receives it");
+    TEST_ASSERT(payload_is(&received, 20), "Port payload intact");
+
+    /* A new port in the same slot is a different queue incarnation */
+    old_port = port_id;
+    ipc_port_destroy(port_id);
+    TEST_ASSERT_EQUAL(IPC_ERROR_PORT_CLOSED, ipc_endpoint_send(endpoint, &message, CAP_NULL),
+                      "Endpoint to destroyed port is stale");
+    ipc_port_create("endpoint-test", &port_id);
+    TEST_ASSERT(port_id != old_port, "Port recreated");
+    TEST_ASSERT_EQUAL(IPC_ERROR_PORT_CLOSED, ipc_endpoint_send(endpoint, &message, CAP_NULL),
+                      "Stale endpoint does not reach the new port");
+    ipc_endpoint_delete(endpoint);
+    ipc_port_destroy(port_id);
+}
+
+static void test_transfer(void) {
+    uint32_t carrier, narrow, port_id, port_endpoint, sender = IPC_PID_ANY;
+
+    boot_log("Testing capability transfer in messages...");
+    drain();
+    ipc_port_create("transfer-test", &port_id);
+    ipc_endpoint_create(port_id, IPC_ENDPOINT_ALL, &port_endpoint);
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &carrier);
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_SEND, &narrow);
+
+    set_payload(30);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_send(carrier, &message, port_endpoint),
+                      "Send with a capability");
+    ipc_receive(&sender, &received, IPC_NO_WAIT);
+    TEST_ASSERT(received.capability != CAP_NULL && received.capability != port_endpoint,
+                "Receiver gets a new slot");
+
+    set_payload(31);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_send(received.capability, &message, CAP_NULL),
+                      "Transferred capability usable");
+    TEST_ASSERT(ipc_port_receive(port_id, &received, IPC_NO_WAIT) == IPC_SUCCESS &&
+                payload_is(&received, 31), "Transferred capability reaches the port");
+
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED, ipc_endpoint_send(narrow, &message, port_endpoint),
+                      "Transfer through endpoint without grant denied");
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED, ipc_endpoint_send(carrier, &message, narrow),
+                      "Transfer of capability without grant denied");
+    TEST_ASSERT_EQUAL(0U, ipc_get_queue_depth(), "Denied transfers send nothing");
+
+    /* A user-supplied slot number is never passed through */
+    set_payload(32);
+    message.capability = port_endpoint;
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    ipc_receive(&sender, &received, IPC_NO_WAIT);
+    TEST_ASSERT_EQUAL((uint32_t)CAP_NULL, received.capability, "PID send clears the capability field");
+
+    ipc_endpoint_delete(carrier);
+    ipc_endpoint_delete(narrow);
+    ipc_endpoint_delete(port_endpoint);
+    ipc_port_destroy(port_id);
+}
+
+static void test_grant(void) {
+    process_create_params_t params = {
+        .name = "endpoint_peer",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)dummy_process_entry,
+        .stack_address = (void *)0x500000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    process_t *peer = NULL;
+    uint32_t endpoint, narrow, copy;
+
+    boot_log("Testing grants to other processes...");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_create(&params, &peer), "Peer created");
+    if (!peer) {
+        return;
+    }
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &endpoint);
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_SEND, &narrow);
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_grant(endpoint, peer->pid, IPC_ENDPOINT_SEND, &copy),
+                      "Grant to peer");
+    TEST_ASSERT(copy != CAP_NULL, "Peer slot returned");
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED,
+                      ipc_endpoint_grant(narrow, peer->pid, IPC_ENDPOINT_SEND, NULL),
+                      "Grant without IPC_ENDPOINT_GRANT denied");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_RECEIVER,
+                      ipc_endpoint_grant(endpoint, MAX_PROCESSES + 1, IPC_ENDPOINT_SEND, NULL),
+                      "Grant to unknown process rejected");
+
+    /* The peer's table is its own: the kernel's slot numbers are unaffected */
+    set_payload(40);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_send(endpoint, &message, CAP_NULL),
+                      "Granter keeps its capability");
+    drain();
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_destroy(peer->pid), "Peer destroyed with its table");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_RECEIVER,
+                      ipc_endpoint_grant(endpoint, peer->pid, IPC_ENDPOINT_SEND, NULL),
+                      "Grant to exited process rejected");
+    ipc_endpoint_delete(endpoint);
+    ipc_endpoint_delete(narrow);
+}
+
+static void test_full_queue(void) {
+    uint32_t endpoint, extra, next, sender = IPC_PID_ANY;
+
+    boot_log("Testing a failed transfer...");
+    drain();
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &endpoint);
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &extra);
+    set_payload(50);
+    for (uint32_t i = 0; i < IPC_MAX_QUEUE_SIZE; i++) {
+        ipc_endpoint_send(endpoint, &message, CAP_NULL);
+    }
+    TEST_ASSERT_EQUAL(IPC_ERROR_BUFFER_FULL, ipc_endpoint_send(endpoint, &message, extra),
+                      "Send to full queue fails");
+
+    /* The copy made for the failed send was removed again, so its slot is next */
+    drain();
+    ipc_endpoint_send(endpoint, &message, extra);
+    ipc_receive(&sender, &received, IPC_NO_WAIT);
+    ipc_endpoint_delete(received.capability);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_SEND, &next),
+                      "Create after rollback");
+    TEST_ASSERT_EQUAL(received.capability, next, "Rolled-back slot reused");
+
+    ipc_endpoint_delete(endpoint);
+    ipc_endpoint_delete(extra);
+    ipc_endpoint_delete(next);
+}
+
+/*
+ * Processes coming and going in one PCB slot reuse its endpoint table and
+ * the radix nodes, so the heap stops growing after the first round.
+ */
+static void test_churn(void) {
+    process_create_params_t params = {
+        .name = "endpoint_churn",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)dummy_process_entry,
+        .stack_address = (void *)0x500000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    uintptr_t before = 0, after = 0;
+    uint32_t endpoint;
+
+    boot_log("Testing endpoint table reuse...");
+    ipc_endpoint_create(IPC_ENDPOINT_SELF, IPC_ENDPOINT_ALL, &endpoint);
+    for (uint32_t round = 0; round < 9; round++) {
+        process_t *peer = NULL;
+
+        if (round == 1) {
+            before = (uintptr_t)kmalloc(8);
+        }
+        if (process_create(&params, &peer) != STATUS_SUCCESS) {
+            break;
+        }
+        ipc_endpoint_grant(endpoint, peer->pid, IPC_ENDPOINT_SEND, NULL);
+        process_destroy(peer->pid);
+    }
+    after = (uintptr_t)kmalloc(8);
+    TEST_ASSERT(before && after - before < 256, "Process churn reuses endpoint storage");
+    ipc_endpoint_delete(endpoint);
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_endpoint_tests(void) {
+    boot_log("=== Starting Endpoint Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    process_init();
+    ipc_init();
+
+    /* Run tests */
+    test_self_endpoint();
+    test_port_endpoint();
+    test_transfer();
+    test_grant();
+    test_full_queue();
+    test_churn();
+
+    /* Print results */
+    boot_log("=== Endpoint Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Endpoint Tests Complete ===");
+    return test_failed;
+}
@@ -0,0 +1,485 @@
+/**
+ * QuantumOS Entropy Pool Unit Tests
+ *
+ * Unit tests for the entropy pool: ChaCha20 known answers, buffered and
+ * bulk draws, pool credit and reseeding, interrupt batching, and the
+ * ENTROPY_GET / ENTROPY_REFRESH service. Requests come from a client
+ * process, reached with process_switch_to(); the kernel process serves
+ * them.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/entropy.h>
+#include <kernel/process.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <kernel/ipc.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define BULK_BYTES      65536
+#define REGION_BYTES    4096
+#define GUARD           0xA5
+
+static uint8_t bulk[BULK_BYTES + 1];
+static uint8_t small[64 + 1];
+static ipc_message_t request;
+static ipc_message_t reply;
+static process_t *kernel_process;
+static process_t *client;
+static process_t *intruder;             /* A second client */
+static uint32_t port_id;
+
+static void dummy_process_entry(void) {
+}
+
+static uint32_t bit_count(const uint8_t *buf, size_t len) {
+    uint32_t bits = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        for (uint8_t b = buf[i]; b; b &= (uint8_t)(b - 1)) {
+            bits++;
+        }
+    }
+    return bits;
+}
+
+static bool same(const void *a, const void *b, size_t len) {
+    const uint8_t *x = a, *y = b;
+
+    for (size_t i = 0; i < len; i++) {
+        if (x[i] != y[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool all_equal(const uint8_t *buf, size_t len, uint8_t value) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * Send a request as `caller`, serve it as the kernel and return the
+ * response as the caller sees it. Inline bytes are left in reply.data.
+ */
+static ipc_result_t call_service_as(process_t *caller, uint32_t type, uint32_t region_id,
+                                    uint64_t offset, uint64_t length, entropy_response_t *resp) {
+    entropy_request_t req = {
+        .type = type,
+        .region_id = region_id,
+        .offset = offset,
+        .length = length,
+    };
+    uint32_t sender = IPC_PID_ANY;
+    ipc_result_t result;
+
+    memset(&request, 0, sizeof(request));
+    request.message_type = IPC_MSG_NORMAL;
+    request.length = sizeof(req);
+    memcpy(request.data, &req, sizeof(req));
+
+    process_switch_to(caller);
+    result = ipc_port_send(port_id, &request);
+    process_switch_to(kernel_process);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+
+    if (entropy_service_poll(port_id, 8) != 1) {
+        return IPC_ERROR_NO_MESSAGE;
+    }
+
+    process_switch_to(caller);
+    memset(&reply, 0, sizeof(reply));
+    result = ipc_receive(&sender, &reply, IPC_NO_WAIT);
+    process_switch_to(kernel_process);
+    if (result != IPC_SUCCESS) {
+        return result;
+    }
+
+    memcpy(resp, reply.data, sizeof(*resp));
+    return (ipc_result_t)resp->status;
+}
+
+static ipc_result_t call_service(uint32_t type, uint32_t region_id, uint64_t offset,
+                                 uint64_t length, entropy_response_t *resp) {
+    return call_service_as(client, type, region_id, offset, length, resp);
+}
+
+/* ============================================================================
+ * ChaCha20 Tests
+ * ============================================================================ */
+
+static void test_chacha20_vectors(void) {
+    boot_log("Testing ChaCha20 known answers...");
+
+    /* All-zero key and nonce, blocks 0 and 1 (RFC 7539 A.1 #1 and #2) */
+    static const uint8_t block0[16] = {
+        0x76, 0xb8, 0xe0, 0xad, 0xa0, 0xf1, 0x3d, 0x90,
+        0x40, 0x5d, 0x6a, 0xe5, 0x53, 0x86, 0xbd, 0x28,
+    };
+    static const uint8_t block1[16] = {
+        0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a,
+        0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d,
+    };
+    uint32_t key[8] = { 0 };
+    uint32_t out[16];
+
+    entropy_chacha20_block(key, 0, 0, out);
+    TEST_ASSERT(same(out, block0, sizeof(block0)), "Zero key, block 0 matches");
+
+    entropy_chacha20_block(key, 1, 0, out);
+    TEST_ASSERT(same(out, block1, sizeof(block1)), "Zero key, block 1 matches");
+}
+
+/* ============================================================================
+ * Generator Tests
+ * ============================================================================ */
+
+static void test_init(void) {
+    entropy_stats_t stats;
+
+    boot_log("Testing entropy initialisation...");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, entropy_init(), "Entropy pool initialised");
+
+    entropy_get_stats(&stats);
+    TEST_ASSERT(stats.reseeds >= 1, "Generator seeded at init");
+    TEST_ASSERT(stats.samples[ENTROPY_SOURCE_JITTER] >= 1, "Jitter gathered at init");
+    TEST_ASSERT(stats.credited[ENTROPY_SOURCE_RDSEED] > 0 || !stats.has_rdseed,
+                "RDSEED credited when present");
+    TEST_ASSERT(stats.credited[ENTROPY_SOURCE_RDRAND] > 0 || !stats.has_rdrand,
+                "RDRAND credited when present");
+    TEST_ASSERT_EQUAL(0, stats.pool_bits, "Pool credit consumed by the seed");
+}
+
+static void test_small_draws(void) {
+    entropy_stats_t before, after;
+    uint8_t first[32], second[32];
+
+    boot_log("Testing buffered draws...");
+
+    entropy_get_stats(&before);
+
+    memset(small, GUARD, sizeof(small));
+    entropy_get(small, 16);
+    TEST_ASSERT(all_equal(&small[16], sizeof(small) - 16, GUARD),
+                "Small draw writes only the bytes asked for");
+    TEST_ASSERT(!all_equal(small, 16, 0), "Small draw is not all zero");
+
+    entropy_get(first, sizeof(first));
+    entropy_get(second, sizeof(second));
+    TEST_ASSERT(!same(first, second, sizeof(first)), "Consecutive draws differ");
+
+    TEST_ASSERT(entropy_get_u64() != entropy_get_u64(), "Consecutive u64 draws differ");
+
+    /* Enough small draws to refill the buffer several times */
+    for (uint32_t i = 0; i < 100; i++) {
+        entropy_get(small, 24);
+    }
+    TEST_ASSERT(!same(small, first, 24), "Draws across refills differ");
+
+    entropy_get(NULL, 16);
+    entropy_get(small, 0);
+
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.bytes_out + 16 + 64 + 16 + 2400, after.bytes_out,
+                      "Bytes out counted");
+}
+
+static void test_bulk_draws(void) {
+    uint32_t ones;
+
+    boot_log("Testing bulk draws...");
+
+    memset(bulk, GUARD, sizeof(bulk));
+    entropy_get(bulk, BULK_BYTES);
+    TEST_ASSERT_EQUAL(GUARD, bulk[BULK_BYTES], "Bulk draw stays in bounds");
+
+    /* 524288 bits; a fair source lands within six standard deviations (2144) of half */
+    ones = bit_count(bulk, BULK_BYTES);
+    TEST_ASSERT(ones > 260000 && ones < 264288, "Bulk output balanced between 0 and 1");
+
+    TEST_ASSERT(!same(bulk, &bulk[BULK_BYTES / 2], 4096),
+                "Bulk output does not repeat");
+
+    /* Smallest direct draw against the largest buffered one */
+    memset(bulk, GUARD, 1024);
+    entropy_get(bulk, ENTROPY_DIRECT_MIN);
+    TEST_ASSERT(all_equal(&bulk[ENTROPY_DIRECT_MIN], 1024 - ENTROPY_DIRECT_MIN, GUARD),
+                "Direct draw writes only the bytes asked for");
+    entropy_get(&bulk[512], ENTROPY_DIRECT_MIN - 1);
+    TEST_ASSERT(!same(bulk, &bulk[512], ENTROPY_DIRECT_MIN - 1),
+                "Direct and buffered draws differ");
+}
+
+static void test_pool_credit(void) {
+    entropy_stats_t before, after;
+    uint8_t input[64];
+
+    boot_log("Testing pool credit and reseeding...");
+
+    memset(input, 0x3C, sizeof(input));
+    entropy_get_stats(&before);
+
+    entropy_add(input, 4, 100);
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.pool_bits + 32, after.pool_bits, "Credit capped at 8 bits per byte");
+    TEST_ASSERT_EQUAL(before.samples[ENTROPY_SOURCE_EXTERNAL] + 1,
+                      after.samples[ENTROPY_SOURCE_EXTERNAL], "External sample counted");
+
+    entropy_add(NULL, 16, 8);
+    entropy_add(input, 0, 8);
+    entropy_get_stats(&before);
+    TEST_ASSERT_EQUAL(after.pool_bits, before.pool_bits, "Empty input ignored");
+
+    /* A full reseed's worth of credit is spent on the next draw */
+    entropy_add(input, sizeof(input), ENTROPY_RESEED_BITS);
+    entropy_get_stats(&after);
+    TEST_ASSERT(after.pool_bits >= ENTROPY_RESEED_BITS, "Reseed threshold reached");
+    TEST_ASSERT_EQUAL(before.reseeds, after.reseeds, "No reseed before a draw");
+
+    entropy_get_u64();
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.reseeds + 1, after.reseeds, "Draw reseeds from a full pool");
+    TEST_ASSERT_EQUAL(0, after.pool_bits, "Reseed spends the credit");
+    TEST_ASSERT_EQUAL(ENTROPY_RESEED_BITS, after.seed_bits, "Seed quality recorded");
+
+    entropy_reseed();
+    entropy_get_stats(&before);
+    TEST_ASSERT_EQUAL(after.reseeds + 1, before.reseeds, "Forced reseed counted");
+}
+
+static void test_interrupts(void) {
+    entropy_stats_t before, after;
+
+    boot_log("Testing interrupt batching...");
+
+    entropy_get_stats(&before);
+    for (uint32_t i = 0; i < ENTROPY_IRQ_BATCH - 1; i++) {
+        entropy_add_interrupt(32 + (i & 7), 1000 + i * 37);
+    }
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.samples[ENTROPY_SOURCE_INTERRUPT],
+                      after.samples[ENTROPY_SOURCE_INTERRUPT], "Interrupts held back until a batch");
+
+    entropy_add_interrupt(33, 5000);
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.samples[ENTROPY_SOURCE_INTERRUPT] + 1,
+                      after.samples[ENTROPY_SOURCE_INTERRUPT], "Full batch folded into the pool");
+    TEST_ASSERT_EQUAL(before.credited[ENTROPY_SOURCE_INTERRUPT] + 1,
+                      after.credited[ENTROPY_SOURCE_INTERRUPT], "Batch credited one bit");
+}
+
+/* ============================================================================
+ * Region Backing Tests
+ * ============================================================================ */
+
+static void test_region_reuse(void) {
+    ipc_shared_region_t first, second;
+
+    boot_log("Testing shared region reuse...");
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_share_create(REGION_BYTES, &first), "Region created");
+    TEST_ASSERT(all_equal(first.virtual_addr, REGION_BYTES, 0), "New region is zeroed");
+    memset(first.virtual_addr, GUARD, REGION_BYTES);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_share_destroy(first.region_id), "Region destroyed");
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_share_create(REGION_BYTES - 100, &second),
+                      "Region of the same class created");
+    TEST_ASSERT(second.virtual_addr == first.virtual_addr, "Destroyed buffer reused");
+    TEST_ASSERT(all_equal(second.virtual_addr, REGION_BYTES - 100, 0),
+                "Reused buffer is zeroed");
+    ipc_share_destroy(second.region_id);
+}
+
+/* ============================================================================
+ * Service Tests
+ * ============================================================================ */
+
+static void test_service(void) {
+    entropy_response_t resp;
+    ipc_shared_region_t region, unshared;
+    ipc_region_grant_t grant;
+    entropy_stats_t before, after;
+    uint8_t *bytes;
+
+    boot_log("Testing entropy service...");
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, entropy_service_start(&port_id), "Service port created");
+    TEST_ASSERT_EQUAL(0, entropy_service_poll(port_id, 8), "Nothing to serve on an idle port");
+
+    /* Inline */
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, call_service(ENTROPY_GET, 0, 0, 32, &resp),
+                      "Inline request served");
+    TEST_ASSERT_EQUAL(32, resp.length, "Inline length reported");
+    TEST_ASSERT_EQUAL(sizeof(resp) + 32, reply.length, "Inline bytes follow the response");
+    TEST_ASSERT(!all_equal(reply.data + sizeof(resp), 32, 0), "Inline bytes filled");
+
+    TEST_ASSERT_EQUAL(IPC_ERROR_MESSAGE_TOO_LARGE,
+                      call_service(ENTROPY_GET, 0, 0, ENTROPY_INLINE_MAX + 1, &resp),
+                      "Oversized inline request refused");
+    TEST_ASSERT_EQUAL(0, resp.length, "Nothing reported for a refused request");
+
+    /* Region, created by the client and granted to the server */
+    process_switch_to(client);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_share_create(REGION_BYTES, &region), "Client region created");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_share_create(REGION_BYTES, &unshared),
+                      "Ungranted region created");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS,
+                      ipc_share_grant(region.region_id, IPC_PID_KERNEL, IPC_SHARE_WRITE, &grant),
+                      "Region granted to the server");
+    ipc_share_map(region.region_id, (void **)&bytes);
+    memset(bytes, GUARD, REGION_BYTES);
+    process_switch_to(kernel_process);
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, call_service(ENTROPY_GET, region.region_id, 1024, 2048, &resp),
+                      "Region request served");
+    TEST_ASSERT_EQUAL(2048, resp.length, "Region length reported");
+    TEST_ASSERT_EQUAL(sizeof(resp), reply.length, "No inline bytes for a region request");
+    TEST_ASSERT(all_equal(bytes, 1024, GUARD) && all_equal(&bytes[3072], 1024, GUARD),
+                "Only the requested range written");
+    TEST_ASSERT(!all_equal(&bytes[1024], 2048, GUARD), "Requested range filled");
+
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG,
+                      call_service(ENTROPY_GET, region.region_id, 3072, 2048, &resp),
+                      "Range past the region refused");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG,
+                      call_service(ENTROPY_GET, region.region_id, ~0ULL, 2, &resp),
+                      "Overflowing offset refused");
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED,
+                      call_service(ENTROPY_GET, unshared.region_id, 0, 64, &resp),
+                      "Ungranted region refused");
+
+    /* A second client naming the first client's region */
+    TEST_ASSERT(intruder != NULL, "Second client created");
+    if (intruder) {
+        memset(bytes, GUARD, REGION_BYTES);
+        TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED,
+                          call_service_as(intruder, ENTROPY_GET, region.region_id, 0, 64, &resp),
+                          "Another client's region refused");
+        TEST_ASSERT(all_equal(bytes, REGION_BYTES, GUARD), "Another client's region untouched");
+    }
+
+    process_switch_to(client);
+    ipc_share_revoke(region.region_id, IPC_PID_KERNEL);
+    ipc_share_grant(region.region_id, IPC_PID_KERNEL, IPC_SHARE_READ, &grant);
+    process_switch_to(kernel_process);
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED,
+                      call_service(ENTROPY_GET, region.region_id, 0, 64, &resp),
+                      "Read-only grant refused");
+
+    /* Refresh and unknown requests */
+    entropy_get_stats(&before);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, call_service(ENTROPY_REFRESH, 0, 0, 0, &resp),
+                      "Refresh served");
+    entropy_get_stats(&after);
+    TEST_ASSERT_EQUAL(before.reseeds + 1, after.reseeds, "Refresh reseeds the generator");
+    TEST_ASSERT_EQUAL(after.seed_bits, resp.entropy_quality, "Seed quality reported");
+
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_SUPPORTED, call_service(42, 0, 0, 16, &resp),
+                      "Unknown request refused");
+
+    process_switch_to(client);
+    ipc_share_revoke(region.region_id, IPC_PID_KERNEL);
+    ipc_share_destroy(region.region_id);
+    ipc_share_destroy(unshared.region_id);
+    process_switch_to(kernel_process);
+    ipc_port_destroy(port_id);
+}
+
+/* ============================================================================
+ * Main Test Runner
+ * ============================================================================ */
+
+int run_entropy_tests(void) {
+    process_create_params_t params = {
+        .name = "entropy_client",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)dummy_process_entry,
+        .stack_address = (void *)0x500000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+
+    boot_log("=== Starting Entropy Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    process_init();
+    ipc_init();
+    kernel_process = process_get_current();
+
+    /* Run tests */
+    test_chacha20_vectors();
+    test_init();
+    test_small_draws();
+    test_bulk_draws();
+    test_pool_credit();
+    test_interrupts();
+    test_region_reuse();
+    if (kernel_process && process_create(&params, &client) == STATUS_SUCCESS) {
+        if (process_create(&params, &intruder) != STATUS_SUCCESS) {
+            intruder = NULL;
+        }
+        test_service();
+        process_destroy(client->pid);
+        if (intruder) {
+            process_destroy(intruder->pid);
+        }
+    } else {
+        TEST_ASSERT(false, "Client process created");
+    }
+
+    /* Print results */
+    boot_log("=== Entropy Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    return test_failed;
+}
@@ -0,0 +1,408 @@
+/**
+ * QuantumOS Lane Unit Tests
+ *
+ * Unit tests for lanes: run order, yield interleaving, block and wake,
+ * sleep against a hand-set vDSO clock, kill, stack reuse, stack
+ * overflow detection and the msi_lane_* and msi_domain_* bindings.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/msi_domain.h>
+#include <kernel/vdso.h>
+#include <kernel/lane.h>
+#include <kernel/memory.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define TRACE_MAX       64
+
+static uint32_t trace[TRACE_MAX];
+static uint32_t trace_len;
+static msi_lane_t *parked_lane;
+
+static void record(uint32_t value) {
+    if (trace_len < TRACE_MAX) {
+        trace[trace_len++] = value;
+    }
+}
+
+static bool trace_is(const uint32_t *expected, uint32_t count) {
+    if (trace_len != count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (trace[i] != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Freeze the vDSO clock at `us` */
+static void set_clock(uint64_t us) {
+    vdso_update_clock(0, us, 0, 0, 0);
+}
+
+static msi_domain_t *new_domain(void) {
+    msi_domain_t *domain = NULL;
+    trace_len = 0;
+    msi_domain_create(&domain);
+    return domain;
+}
+
+/* ============================================================================
+ * Lane Bodies
+ * ============================================================================ */
+
+static void lane_record(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    record((uint32_t)(uintptr_t)arg);
+}
+
+static void lane_yield_three(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    for (uint32_t i = 0; i < 3; i++) {
+        record((uint32_t)(uintptr_t)arg * 10 + i);
+        lane_yield();
+    }
+}
+
+static void lane_block_once(msi_lane_t *lane, void *arg) {
+    (void)arg;
+    parked_lane = lane;
+    record(1);
+    lane_block();
+    record(2);
+}
+
+static void lane_sleep_100(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    (void)arg;
+    record(1);
+    lane_sleep_us(100);
+    record(2);
+}
+
+static void lane_sleep_1(msi_lane_t *lane, void *arg) {
+    (void)lane;
+    (void)arg;
+    record(1);
+    lane_sleep_us(1);
+    record(2);
+}
+
+static void lane_check_current(msi_lane_t *lane, void *arg) {
+    (void)arg;
+    record(lane_current() == lane);
+    record(msi_lane_yield(lane) == MSI_SUCCESS);
+    record(msi_lane_sleep(lane, 0) == MSI_SUCCESS);
+}
+
+static void lane_overflow(msi_lane_t *lane, void *arg) {
+    (void)arg;
+    /* Stand-in for a lane that ran past its stack */
+    lane->stack[0] ^= 0xFF;
+    lane_yield();
+    record(99);
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================ */
+
+/**
+ * Lanes run in spawn order and a finished domain reports no lanes
+ */
+static void test_spawn_run(void) {
+    msi_domain_t *domain = new_domain();
+    static const uint32_t expected[] = { 1, 2, 3 };
+    lane_stats_t before, after;
+    msi_lane_t *lane = NULL;
+
+    TEST_ASSERT(domain != NULL, "Domain created");
+    lane_get_stats(&before);
+    for (uint32_t i = 1; i <= 3; i++) {
+        lane_spawn(domain, lane_record, (void *)(uintptr_t)i, LANE_STACK_MIN, &lane);
+    }
+    TEST_ASSERT(lane != NULL && lane->state == LANE_STATE_READY, "Spawned lane is ready");
+    TEST_ASSERT_EQUAL(3U, domain->lanes.live, "Three live lanes");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG,
+                      lane_spawn(domain, lane_record, NULL, LANE_STACK_MAX * 2, NULL),
+                      "Oversized stack rejected");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, lane_spawn(domain, NULL, NULL, 0, NULL),
+                      "Missing entry rejected");
+    TEST_ASSERT(lane_current() == NULL, "No current lane outside lane_run");
+
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "lane_run returns 0 once all lanes exit");
+    TEST_ASSERT(trace_is(expected, 3), "Lanes ran in spawn order");
+    TEST_ASSERT_EQUAL(0U, domain->lanes.live, "No live lanes left");
+    lane_get_stats(&after);
+    TEST_ASSERT_EQUAL(3ULL, after.exited - before.exited, "Three lanes exited");
+
+    msi_domain_destroy(domain);
+}
+
+/**
+ * Yield interleaves lanes round-robin
+ */
+static void test_yield(void) {
+    msi_domain_t *domain = new_domain();
+    static const uint32_t expected[] = { 10, 20, 11, 21, 12, 22 };
+
+    lane_spawn(domain, lane_yield_three, (void *)1, 0, NULL);
+    lane_spawn(domain, lane_yield_three, (void *)2, 0, NULL);
+    lane_run(domain);
+    TEST_ASSERT(trace_is(expected, 6), "Two yielding lanes alternate");
+
+    msi_domain_destroy(domain);
+}
+
+/**
+ * A blocked lane parks the carrier until it is woken
+ */
+static void test_block_wake(void) {
+    msi_domain_t *domain = new_domain();
+    static const uint32_t expected[] = { 1, 2 };
+    lane_stats_t before, after;
+
+    lane_get_stats(&before);
+    lane_spawn(domain, lane_block_once, NULL, 0, NULL);
+    TEST_ASSERT_EQUAL(LANE_NO_WAKE, lane_run(domain), "Blocked lane leaves no wake time");
+    TEST_ASSERT_EQUAL(LANE_STATE_BLOCKED, parked_lane->state, "Lane is blocked");
+    TEST_ASSERT(domain->lanes.cpus[0].parked, "Carrier parked");
+    lane_get_stats(&after);
+    TEST_ASSERT_EQUAL(1ULL, after.parks - before.parks, "Park counted");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, lane_wake(parked_lane), "Wake succeeds");
+    TEST_ASSERT(!domain->lanes.cpus[0].parked, "Wake unparks the carrier");
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "Woken lane runs to exit");
+    TEST_ASSERT(trace_is(expected, 2), "Lane resumed after lane_block");
+
+    msi_domain_destroy(domain);
+}
+
+/**
+ * Sleep expires on the vDSO clock, or early on lane_wake(), or before
+ * the lane has even switched away
+ */
+static void test_sleep(void) {
+    msi_domain_t *domain;
+    static const uint32_t expected[] = { 1, 2 };
+    msi_lane_t *lane;
+    uint64_t wake;
+
+    set_clock(1000);
+    domain = new_domain();
+    lane_spawn(domain, lane_sleep_100, NULL, 0, &lane);
+    wake = lane_run(domain);
+    TEST_ASSERT(wake > 1000 && wake <= 1100, "Wake time no later than the sleep's end");
+    TEST_ASSERT_EQUAL(LANE_STATE_SLEEPING, lane->state, "Lane is sleeping");
+
+    set_clock(1050);
+    lane_run(domain);
+    TEST_ASSERT_EQUAL(1U, trace_len, "Not resumed at +50 us");
+    for (uint32_t i = 0; i < 8 && wake != 0; i++) {
+        set_clock(wake);
+        wake = lane_run(domain);
+        if (trace_len == 1) {
+            TEST_ASSERT(wake != 0 && wake <= 1100, "Still asleep before +100 us");
+        }
+    }
+    TEST_ASSERT_EQUAL(0ULL, wake, "Sleeper resumes once due");
+    TEST_ASSERT(trace_is(expected, 2), "Lane finished after its sleep");
+    msi_domain_destroy(domain);
+
+    domain = new_domain();
+    lane_spawn(domain, lane_sleep_100, NULL, 0, &lane);
+    lane_run(domain);
+    lane_wake(lane);
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "Wake cuts a sleep short");
+    TEST_ASSERT_EQUAL(0ULL, domain->lanes.cpus[0].sleepers.pending_count,
+                      "Sleep timer cancelled");
+    msi_domain_destroy(domain);
+
+    /* One microsecond per TSC cycle: the sleep is over before the switch */
+    vdso_update_clock(0, 1000, 1, 0, 0);
+    domain = new_domain();
+    lane_spawn(domain, lane_sleep_1, NULL, 0, &lane);
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "Lane whose sleep already expired runs on");
+    TEST_ASSERT(trace_is(expected, 2), "Expired sleeper resumed in place");
+    msi_domain_destroy(domain);
+    set_clock(1000);
+}
+
+/**
+ * Kill removes lanes in any waiting state; stacks are reused
+ */
+static void test_kill_and_reuse(void) {
+    msi_domain_t *domain = new_domain();
+    msi_lane_t *ready, *blocked, *again;
+    lane_stats_t before, after;
+
+    set_clock(5000);
+    lane_spawn(domain, lane_block_once, NULL, LANE_STACK_MIN, &blocked);
+    lane_run(domain);
+    lane_spawn(domain, lane_record, (void *)7, LANE_STACK_MIN, &ready);
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, lane_kill(ready), "Kill a ready lane");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, lane_kill(blocked), "Kill a blocked lane");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, lane_kill(blocked), "Second kill fails");
+    TEST_ASSERT_EQUAL(0U, domain->lanes.live, "No live lanes after kills");
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "Killed lanes never run");
+    TEST_ASSERT_EQUAL(1U, trace_len, "Only the blocker's first step ran");
+
+    lane_get_stats(&before);
+    lane_spawn(domain, lane_record, NULL, LANE_STACK_MIN, &again);
+    lane_get_stats(&after);
+    TEST_ASSERT(again == ready || again == blocked, "Freed stack block reused");
+    TEST_ASSERT_EQUAL(before.stack_bytes, after.stack_bytes, "No new stack allocated");
+    lane_run(domain);
+
+    msi_domain_destroy(domain);
+}
+
+/**
+ * A lane whose stack canary is gone is killed on its next switch
+ */
+static void test_overflow(void) {
+    msi_domain_t *domain = new_domain();
+    lane_stats_t before, after;
+
+    lane_get_stats(&before);
+    lane_spawn(domain, lane_overflow, NULL, 0, NULL);
+    lane_spawn(domain, lane_record, (void *)5, 0, NULL);
+    TEST_ASSERT_EQUAL(0ULL, lane_run(domain), "Domain drains");
+    lane_get_stats(&after);
+    TEST_ASSERT_EQUAL(1ULL, after.overflows - before.overflows, "Overflow counted");
+    TEST_ASSERT(trace_len == 1 && trace[0] == 5, "Overflowed lane did not resume");
+
+    msi_domain_destroy(domain);
+}
+
+/**
+ * msi_domain_* and msi_lane_* bindings
+ */
+static void test_msi_binding(void) {
+    msi_domain_t *domain = new_domain();
+    msi_lane_t *lane = NULL;
+
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_lane_spawn(domain, &lane),
+                      "Spawn without a domain entry fails");
+    lane_domain_set_entry(domain, lane_check_current, NULL, 0);
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_lane_spawn(domain, &lane), "msi_lane_spawn");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_lane_yield(lane),
+                      "Yield on behalf of another lane rejected");
+    lane_run(domain);
+    TEST_ASSERT(trace_len == 3 && trace[0] && trace[1] && trace[2],
+                "lane_current, msi_lane_yield and msi_lane_sleep inside a lane");
+
+    msi_lane_spawn(domain, &lane);
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_lane_kill(lane), "msi_lane_kill");
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_lane_kill(lane), "Killed lane is gone");
+
+    msi_lane_spawn(domain, &lane);
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_domain_destroy(domain), "Destroy ends pending lanes");
+    TEST_ASSERT(!msi_domain_valid(domain), "Destroyed domain is invalid");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_lane_spawn(domain, &lane),
+                      "Spawn into a destroyed domain fails");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_domain_create(NULL), "Create needs an out pointer");
+}
+
+/**
+ * Domains created and destroyed in turn reuse one allocation, so the heap
+ * stops growing after the first round
+ */
+static void test_domain_churn(void) {
+    uintptr_t before = 0, after = 0;
+    uint32_t last_id = 0;
+    bool fresh_ids = true;
+
+    for (uint32_t round = 0; round < 64; round++) {
+        msi_domain_t *domain = NULL;
+
+        if (round == 1) {
+            before = (uintptr_t)kmalloc(8);
+        }
+        if (msi_domain_create(&domain) != MSI_SUCCESS) {
+            break;
+        }
+        fresh_ids = fresh_ids && domain->id > last_id && domain->lanes.live == 0 &&
+                    !cspace_has_right(&domain->caps, CAP_RIGHT_IPC_SEND);
+        last_id = domain->id;
+        msi_domain_grant(domain, CAP_RIGHT_IPC_SEND);
+        lane_spawn(domain, lane_record, NULL, LANE_STACK_MIN, NULL);
+        lane_run(domain);
+        msi_domain_destroy(domain);
+    }
+    after = (uintptr_t)kmalloc(8);
+    TEST_ASSERT(before && after - before < 256, "Domain churn reuses domain storage");
+    TEST_ASSERT(fresh_ids, "Recycled domain comes back empty with a new id");
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_lane_tests(void) {
+    boot_log("=== Starting Lane Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    /* Run tests */
+    test_spawn_run();
+    test_yield();
+    test_block_wake();
+    test_sleep();
+    test_kill_and_reuse();
+    test_overflow();
+    test_msi_binding();
+    test_domain_churn();
+
+    /* Print results */
+    boot_log("=== Lane Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Lane Tests Complete ===");
+    return test_failed;
+}
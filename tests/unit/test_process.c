@@ -9,6 +9,8 @@
  */
 
 #include <kernel/process.h>
+#include <kernel/cycle_budget.h>
+#include <kernel/vdso.h>
 #include <kernel/types.h>
 #include <kernel/boot.h>
 
@@ -25,10 +27,12 @@ static int test_failed = 0;
         test_count++; \
         if (condition) { \
             test_passed++; \
-            boot_log("[PASS] %s", message); \
+            boot_log("[PASS]"); \
+            boot_log(message); \
         } else { \
             test_failed++; \
-            boot_log("[FAIL] %s", message); \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
         } \
     } while(0)
 
@@ -41,6 +45,15 @@ static int test_failed = 0;
 #define TEST_ASSERT_NULL(ptr, message) \
     TEST_ASSERT((ptr) == NULL, message)
 
+/* String comparison (no libc in the kernel) */
+static int str_equal(const char *a, const char *b) {
+    while (*a && *a == *b) {
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
 /* Dummy test function for process entry point */
 static void dummy_process_entry(void) {
     while (1) {
@@ -96,7 +109,7 @@ static void test_process_create(void) {
     TEST_ASSERT_EQUAL(KERNEL_PROCESS_ID, process->parent_pid, "Process parent");
     
     /* Verify process name */
-    TEST_ASSERT_EQUAL(0, strcmp(process->name, "test_process"), "Process name");
+    TEST_ASSERT(str_equal(process->name, "test_process"), "Process name");
     
     /* Verify process is valid */
     TEST_ASSERT(process_is_valid(process->pid), "Process is valid");
@@ -225,13 +238,160 @@ static void test_process_relationships(void) {
     /* Test parent-child relationship */
     TEST_ASSERT_EQUAL(parent->pid, process_get_parent(child->pid), "Child parent relationship");
     TEST_ASSERT_EQUAL(1, parent->child_count, "Parent child count");
-    TEST_ASSERT_EQUAL(child->pid, parent->children[0], "Parent child list");
+    TEST_ASSERT(parent->first_child == child && child->parent == parent, "Parent child list");
+    TEST_ASSERT_EQUAL(PROCESS_ERROR_ALREADY_EXISTS, process_add_child(parent->pid, child->pid),
+                      "Child cannot be added twice");
+    TEST_ASSERT_EQUAL(PROCESS_ERROR_NOT_FOUND, process_remove_child(child->pid, parent->pid),
+                      "Remove of a non-child");
     
     /* Clean up */
     process_destroy(child->pid);
+    TEST_ASSERT_EQUAL(0, parent->child_count, "Destroyed child leaves the list");
+    TEST_ASSERT_NULL(parent->first_child, "Child list empty");
     process_destroy(parent->pid);
 }
 
+/**
+ * Test that children of a destroyed process pass to the kernel
+ */
+static void test_process_orphans(void) {
+    boot_log("Testing orphaned children...");
+    
+    process_create_params_t params = {
+        .name = "test_orphan",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void*)dummy_process_entry,
+        .stack_address = (void*)0x900000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    
+    process_t *parent = NULL;
+    process_t *children[3] = { NULL, NULL, NULL };
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_create(&params, &parent), "Parent creation");
+    
+    params.parent_pid = parent->pid;
+    for (uint32_t i = 0; i < 3; i++) {
+        process_create(&params, &children[i]);
+    }
+    TEST_ASSERT_EQUAL(3, parent->child_count, "Three children");
+    
+    /* Unlink from the middle of the list */
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_remove_child(parent->pid, children[1]->pid),
+                      "Remove middle child");
+    TEST_ASSERT(parent->first_child == children[2] && children[2]->next_sibling == children[0] &&
+                children[0]->prev_sibling == children[2], "Siblings relinked");
+    
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_destroy(parent->pid), "Destroy parent");
+    TEST_ASSERT(children[0]->parent == NULL && children[2]->parent == NULL, "Children unlinked");
+    TEST_ASSERT_EQUAL(KERNEL_PROCESS_ID, process_get_parent(children[0]->pid),
+                      "Orphan passes to the kernel");
+    TEST_ASSERT_EQUAL(KERNEL_PROCESS_ID, process_get_parent(children[2]->pid),
+                      "Second orphan passes to the kernel");
+    
+    for (uint32_t i = 0; i < 3; i++) {
+        process_destroy(children[i]->pid);
+    }
+}
+
+/**
+ * Test PID reuse: a slot comes back with the next generation
+ */
+static void test_process_pid_generation(void) {
+    boot_log("Testing PID generations...");
+    
+    process_create_params_t params = {
+        .name = "test_generation",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void*)dummy_process_entry,
+        .stack_address = (void*)0x600000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    
+    process_t *process = NULL;
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_create(&params, &process), "First process");
+    uint32_t old_pid = process->pid;
+    process_destroy(old_pid);
+    
+    /* The lowest free slot is the one just released */
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, process_create(&params, &process), "Second process");
+    TEST_ASSERT_EQUAL(PROCESS_PID_INDEX(old_pid), PROCESS_PID_INDEX(process->pid), "Slot reused");
+    TEST_ASSERT_EQUAL(PROCESS_PID_GENERATION(old_pid) + 1, PROCESS_PID_GENERATION(process->pid),
+                      "Generation advanced");
+    TEST_ASSERT(!process_is_valid(old_pid), "Stale PID is invalid");
+    TEST_ASSERT_NULL(process_get_by_pid(old_pid), "Stale PID finds nothing");
+    TEST_ASSERT_EQUAL(PROCESS_ERROR_INVALID_PID, process_destroy(old_pid),
+                      "Stale PID cannot destroy the new process");
+    TEST_ASSERT(process_is_valid(process->pid), "New process survives");
+    
+    process_destroy(process->pid);
+}
+
+/**
+ * Test the table growing past its first chunks
+ */
+#define GROWTH_PROCESSES 300
+
+static void test_process_growth(void) {
+    boot_log("Testing process table growth...");
+    
+    process_create_params_t params = {
+        .name = "test_growth",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void*)dummy_process_entry,
+        .stack_address = (void*)0x600000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+    static uint32_t pids[GROWTH_PROCESSES];
+    process_stats_t stats;
+    uint32_t created = 0;
+    
+    for (uint32_t i = 0; i < GROWTH_PROCESSES; i++) {
+        process_t *process = NULL;
+        if (process_create(&params, &process) != STATUS_SUCCESS) {
+            break;
+        }
+        pids[created++] = process->pid;
+    }
+    TEST_ASSERT_EQUAL(GROWTH_PROCESSES, created, "Created more processes than the old table held");
+    
+    process_get_stats(&stats);
+    TEST_ASSERT(stats.pcb_capacity >= GROWTH_PROCESSES + 2, "PCB capacity grew");
+    TEST_ASSERT(stats.pcb_capacity < MAX_PROCESSES, "Only used chunks are backed");
+    TEST_ASSERT(process_is_valid(pids[created - 1]), "Last process valid");
+    
+    /* Per-slot tables follow the PCB table past the old 256 entries */
+    uint32_t high = pids[created - 1];
+    cycle_budget_t budget;
+    TEST_ASSERT(PROCESS_PID_INDEX(high) >= 256, "Last process above slot 256");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, cycle_budget_set(high, 1000, CYCLE_BUDGET_MIN_PERIOD),
+                      "Budget set above slot 256");
+    TEST_ASSERT(cycle_budget_get(high, &budget) == STATUS_SUCCESS && budget.pid == high &&
+                budget.budget == 1000, "Budget read back above slot 256");
+    
+    vdso_update_ipc(high, 3, 16, 0, true);
+    const vdso_proc_t *page = vdso_proc_page(high);
+    TEST_ASSERT(page != NULL, "Status page above slot 256");
+    TEST_ASSERT(page && ((uintptr_t)page & (VDSO_PAGE_SIZE - 1)) == 0, "Status page aligned");
+    TEST_ASSERT(page && vdso_ipc_queue_depth(page) == 3, "Status page read back");
+    
+    for (uint32_t i = 0; i < created; i++) {
+        process_destroy(pids[i]);
+    }
+    TEST_ASSERT(!process_is_valid(pids[0]) && !process_is_valid(pids[created - 1]),
+                "All destroyed");
+    TEST_ASSERT_EQUAL(STATUS_NOT_FOUND, cycle_budget_get(high, &budget),
+                      "Budget cleared with its process");
+}
+
 /**
  * Test process statistics
  */
@@ -321,8 +481,10 @@ static void test_quantum_processes(void) {
 
 /**
  * Run all process management tests
+ *
+ * @return Number of failed assertions
  */
-void run_process_tests(void) {
+int run_process_tests(void) {
     boot_log("=== Starting Process Management Tests ===");
     
     /* Reset test counters */
@@ -336,14 +498,20 @@ void run_process_tests(void) {
     test_process_destroy();
     test_process_states();
     test_process_relationships();
+    test_process_orphans();
+    test_process_pid_generation();
+    test_process_growth();
     test_process_statistics();
     test_quantum_processes();
     
     /* Print results */
     boot_log("=== Process Management Test Results ===");
-    boot_log("Total tests: %d", test_count);
-    boot_log("Passed: %d", test_passed);
-    boot_log("Failed: %d", test_failed);
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
     
     if (test_failed == 0) {
         boot_log("All tests PASSED! ✓");
@@ -352,4 +520,5 @@ void run_process_tests(void) {
     }
     
     boot_log("=== Process Management Tests Complete ===");
+    return test_failed;
 }
@@ -0,0 +1,294 @@
+/**
+ * QuantumOS Deferred Interrupt Work Unit Tests
+ *
+ * Unit tests for softirqs and tasklets: registration, run order, the
+ * hard-IRQ nesting that defers them to the outermost irq_exit(), the
+ * restart limit, and tasklet queueing rules. Each test starts from a
+ * fresh softirq_init().
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/softirq.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define TEST_SOFTIRQ_A      4       /* Numbers not claimed by softirq_init() */
+#define TEST_SOFTIRQ_B      5
+#define TEST_LOG_MAX        32
+
+/* Order in which handlers and tasklets ran */
+static uint32_t run_log[TEST_LOG_MAX];
+static uint32_t run_count;
+static uint32_t reraise_left;
+
+static void log_run(uint32_t id) {
+    if (run_count < TEST_LOG_MAX) {
+        run_log[run_count] = id;
+    }
+    run_count++;
+}
+
+static void reset(void) {
+    softirq_init();
+    run_count = 0;
+    reraise_left = 0;
+}
+
+static void handler_a(void) {
+    log_run(TEST_SOFTIRQ_A);
+}
+
+static void handler_b(void) {
+    log_run(TEST_SOFTIRQ_B);
+}
+
+/* Raises itself again while reraise_left lasts */
+static void handler_reraise(void) {
+    log_run(TEST_SOFTIRQ_A);
+    if (reraise_left) {
+        reraise_left--;
+        softirq_raise(TEST_SOFTIRQ_A);
+    }
+}
+
+static void tasklet_fn(uint64_t data) {
+    log_run((uint32_t)data);
+}
+
+static tasklet_t self_tasklet;
+
+/* Reschedules itself once; SCHED is clear by the time it runs */
+static void tasklet_self_fn(uint64_t data) {
+    log_run((uint32_t)data);
+    TEST_ASSERT((self_tasklet.state & TASKLET_STATE_RUN) != 0, "Tasklet marked running");
+    if (reraise_left) {
+        reraise_left--;
+        tasklet_schedule(&self_tasklet);
+    }
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================ */
+
+/**
+ * Test handler registration
+ */
+static void test_register(void) {
+    softirq_stats_t stats;
+
+    reset();
+
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, softirq_register(SOFTIRQ_COUNT, handler_a),
+                      "Softirq number out of range rejected");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, softirq_register(TEST_SOFTIRQ_A, NULL),
+                      "NULL handler rejected");
+    TEST_ASSERT_EQUAL(STATUS_BUSY, softirq_register(SOFTIRQ_TASKLET, handler_a),
+                      "Tasklet softirq already claimed");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, softirq_register(TEST_SOFTIRQ_A, handler_a),
+                      "Free softirq number registered");
+    TEST_ASSERT_EQUAL(STATUS_BUSY, softirq_register(TEST_SOFTIRQ_A, handler_b),
+                      "Second handler for the same number rejected");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, softirq_get_stats(NULL), "NULL stats rejected");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, softirq_get_stats(&stats), "Stats read");
+}
+
+/**
+ * Test that raised softirqs run once each, lowest number first
+ */
+static void test_raise_and_run(void) {
+    softirq_stats_t stats;
+
+    reset();
+    softirq_register(TEST_SOFTIRQ_A, handler_a);
+    softirq_register(TEST_SOFTIRQ_B, handler_b);
+
+    TEST_ASSERT(!softirq_pending(), "Nothing pending after init");
+
+    softirq_raise(TEST_SOFTIRQ_B);
+    softirq_raise(TEST_SOFTIRQ_A);
+    softirq_raise(TEST_SOFTIRQ_A);
+    softirq_raise(SOFTIRQ_COUNT);
+    TEST_ASSERT(softirq_pending(), "Raised softirqs pending");
+
+    softirq_run_pending();
+    TEST_ASSERT_EQUAL(2, run_count, "Each raised softirq ran once");
+    TEST_ASSERT(run_log[0] == TEST_SOFTIRQ_A && run_log[1] == TEST_SOFTIRQ_B,
+                "Lower softirq number ran first");
+    TEST_ASSERT(!softirq_pending(), "Nothing pending after the run");
+
+    softirq_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.softirq_runs[TEST_SOFTIRQ_A], "Run counted for A");
+    TEST_ASSERT_EQUAL(1, stats.softirq_runs[TEST_SOFTIRQ_B], "Run counted for B");
+
+    softirq_run_pending();
+    TEST_ASSERT_EQUAL(2, run_count, "Nothing runs twice");
+}
+
+/**
+ * Test that softirqs wait for the outermost irq_exit()
+ */
+static void test_irq_nesting(void) {
+    reset();
+    softirq_register(TEST_SOFTIRQ_A, handler_a);
+
+    TEST_ASSERT(!in_interrupt(), "Process context outside irq_enter()");
+
+    irq_enter();
+    TEST_ASSERT(in_interrupt(), "Hard-IRQ context after irq_enter()");
+    softirq_raise(TEST_SOFTIRQ_A);
+
+    softirq_run_pending();
+    TEST_ASSERT_EQUAL(0, run_count, "softirq_run_pending() does nothing in hard-IRQ context");
+
+    irq_enter();
+    irq_exit();
+    TEST_ASSERT_EQUAL(0, run_count, "Nested irq_exit() leaves softirqs pending");
+    TEST_ASSERT(in_interrupt(), "Still in hard-IRQ context after nested exit");
+
+    irq_exit();
+    TEST_ASSERT_EQUAL(1, run_count, "Outermost irq_exit() runs pending softirqs");
+    TEST_ASSERT(!in_interrupt(), "Process context after outermost exit");
+    TEST_ASSERT(!softirq_pending(), "Nothing pending after irq_exit()");
+}
+
+/**
+ * Test that a softirq raising itself is cut off after the restart limit
+ */
+static void test_restart_limit(void) {
+    softirq_stats_t stats;
+
+    reset();
+    softirq_register(TEST_SOFTIRQ_A, handler_reraise);
+
+    reraise_left = SOFTIRQ_MAX_RESTART + 2;
+    softirq_raise(TEST_SOFTIRQ_A);
+    irq_enter();
+    irq_exit();
+
+    TEST_ASSERT_EQUAL(SOFTIRQ_MAX_RESTART, run_count, "One exit runs at most the restart limit");
+    TEST_ASSERT(softirq_pending(), "Remaining work left pending");
+    softirq_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.restart_limit_hits, "Restart limit hit counted");
+
+    softirq_run_pending();
+    TEST_ASSERT_EQUAL(SOFTIRQ_MAX_RESTART + 3, run_count, "Leftover work runs from process context");
+    TEST_ASSERT(!softirq_pending(), "Nothing pending once the handler stops");
+    softirq_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.restart_limit_hits, "Finished pass does not count a hit");
+}
+
+/**
+ * Test tasklet queueing: no double queueing, HI first, FIFO within a list
+ */
+static void test_tasklets(void) {
+    tasklet_t first = TASKLET_INIT(tasklet_fn, 1);
+    tasklet_t second;
+    tasklet_t hi;
+    softirq_stats_t stats;
+
+    reset();
+    tasklet_init(&second, tasklet_fn, 2);
+    tasklet_init(&hi, tasklet_fn, 3);
+
+    tasklet_schedule(&first);
+    tasklet_schedule(&second);
+    tasklet_schedule(&first);
+    tasklet_hi_schedule(&hi);
+    TEST_ASSERT((first.state & TASKLET_STATE_SCHED) != 0, "Scheduled tasklet marked queued");
+    TEST_ASSERT(softirq_pending(), "Scheduling raises the tasklet softirqs");
+
+    softirq_run_pending();
+    TEST_ASSERT_EQUAL(3, run_count, "Tasklet queued twice runs once");
+    TEST_ASSERT(run_log[0] == 3 && run_log[1] == 1 && run_log[2] == 2,
+                "HI tasklet first, then normal tasklets in order");
+    TEST_ASSERT_EQUAL(0, first.state, "Tasklet state clear after running");
+    TEST_ASSERT_EQUAL(0, hi.state, "HI tasklet state clear after running");
+
+    softirq_get_stats(&stats);
+    TEST_ASSERT_EQUAL(3, stats.tasklet_runs, "Tasklet runs counted");
+    TEST_ASSERT_EQUAL(1, stats.softirq_runs[SOFTIRQ_HI], "HI softirq ran once");
+    TEST_ASSERT_EQUAL(1, stats.softirq_runs[SOFTIRQ_TASKLET], "Tasklet softirq ran once");
+}
+
+/**
+ * Test that a tasklet may reschedule itself from its callback
+ */
+static void test_tasklet_reschedule(void) {
+    reset();
+    tasklet_init(&self_tasklet, tasklet_self_fn, 7);
+
+    reraise_left = 1;
+    tasklet_schedule(&self_tasklet);
+    irq_enter();
+    irq_exit();
+
+    TEST_ASSERT_EQUAL(2, run_count, "Rescheduled tasklet ran again in the same exit");
+    TEST_ASSERT_EQUAL(0, self_tasklet.state, "Tasklet idle afterwards");
+    TEST_ASSERT(!softirq_pending(), "Nothing pending afterwards");
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_softirq_tests(void) {
+    boot_log("=== Starting Softirq Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    /* Run tests */
+    test_register();
+    test_raise_and_run();
+    test_irq_nesting();
+    test_restart_limit();
+    test_tasklets();
+    test_tasklet_reschedule();
+
+    /* Print results */
+    boot_log("=== Softirq Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== Softirq Tests Complete ===");
+    return test_failed;
+}
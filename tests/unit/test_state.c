@@ -0,0 +1,306 @@
+/**
+ * QuantumOS Transactional State Unit Tests
+ *
+ * Unit tests for state regions: commit visibility, snapshot isolation,
+ * sharing of untouched pages, dirty bits, abort, reclamation behind
+ * pinned snapshots and the msi_state_* bindings.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/memory.h>
+#include <kernel/state.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <msi.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define TEST_PAGES      1100    /* Spans three page tables */
+
+static uint8_t buffer[3 * PAGE_SIZE];
+
+static uint32_t read_word(state_region_t *region, uint64_t offset) {
+    uint32_t value = 0xFFFFFFFFU;
+    state_read(region, offset, &value, sizeof(value));
+    return value;
+}
+
+static status_t write_word(state_region_t *region, uint64_t offset, uint32_t value) {
+    return state_write(region, offset, &value, sizeof(value));
+}
+
+static state_region_t *new_region(void) {
+    state_region_t *region = NULL;
+    state_region_create((uint64_t)TEST_PAGES * PAGE_SIZE, STATE_READ | STATE_WRITE, &region);
+    return region;
+}
+
+/* ============================================================================
+ * Test Cases
+ * ============================================================================ */
+
+/**
+ * Writes stay invisible until committed
+ */
+static void test_commit_visibility(void) {
+    state_region_t *region = new_region();
+    uint64_t seq = 99;
+    bool zero = true;
+
+    TEST_ASSERT(region != NULL, "Region created");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, state_read(region, 0, buffer, sizeof(buffer)),
+                      "Read a fresh region");
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        zero = zero && buffer[i] == 0;
+    }
+    TEST_ASSERT(zero, "Fresh region reads as zero");
+
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, write_word(region, 100, 0xAABBCCDD), "Write");
+    TEST_ASSERT_EQUAL(0U, read_word(region, 100), "Pending write not visible");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, state_commit(region, &seq), "Commit");
+    TEST_ASSERT_EQUAL(1ULL, seq, "First commit is version 1");
+    TEST_ASSERT_EQUAL(0xAABBCCDDU, read_word(region, 100), "Committed write visible");
+
+    state_commit(region, &seq);
+    TEST_ASSERT_EQUAL(1ULL, seq, "Empty commit keeps the version");
+
+    /* A write straddling a page boundary */
+    for (uint32_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 7);
+    }
+    state_write(region, PAGE_SIZE - 10, buffer, 20);
+    state_commit(region, NULL);
+    state_read(region, PAGE_SIZE - 10, buffer + 100, 20);
+    zero = true;
+    for (uint32_t i = 0; i < 20; i++) {
+        zero = zero && buffer[i] == buffer[100 + i];
+    }
+    TEST_ASSERT(zero, "Write across a page boundary");
+
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG,
+                      state_write(region, (uint64_t)TEST_PAGES * PAGE_SIZE - 2, buffer, 4),
+                      "Write past the end rejected");
+    TEST_ASSERT_EQUAL(STATUS_INVALID_ARG, state_region_create(STATE_MAX_SIZE + 1, STATE_WRITE, &region),
+                      "Oversized region rejected");
+}
+
+/**
+ * A pinned snapshot keeps its contents across later commits
+ */
+static void test_snapshot_isolation(void) {
+    state_region_t *region = new_region();
+    const state_version_t *before, *after;
+    uint32_t value;
+
+    write_word(region, 0, 1);
+    write_word(region, 600 * PAGE_SIZE, 1);
+    state_commit(region, NULL);
+
+    before = state_snapshot_acquire(region);
+    write_word(region, 0, 2);
+    write_word(region, 600 * PAGE_SIZE, 2);
+    state_commit(region, NULL);
+    after = state_snapshot_acquire(region);
+
+    state_snapshot_read(region, before, 0, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(1U, value, "Old snapshot keeps page 0");
+    state_snapshot_read(region, before, 600 * PAGE_SIZE, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(1U, value, "Old snapshot keeps page 600");
+    state_snapshot_read(region, after, 600 * PAGE_SIZE, &value, sizeof(value));
+    TEST_ASSERT_EQUAL(2U, value, "New snapshot sees the commit");
+    TEST_ASSERT_EQUAL(before->seq + 1, after->seq, "Versions are consecutive");
+
+    state_snapshot_release(before);
+    state_snapshot_release(after);
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, state_region_destroy(region), "Destroy unpinned region");
+}
+
+/**
+ * Only written pages are copied, and dirty bits record them
+ */
+static void test_sharing_and_dirty_bits(void) {
+    state_region_t *region = new_region();
+    const state_version_t *snapshot;
+    state_stats_t stats;
+
+    for (uint32_t page = 0; page < TEST_PAGES; page++) {
+        write_word(region, (uint64_t)page * PAGE_SIZE + 16, page);
+    }
+    state_commit(region, NULL);
+    state_get_stats(region, &stats);
+    TEST_ASSERT_EQUAL((uint64_t)TEST_PAGES, stats.cow_pages, "Every page filled once");
+
+    write_word(region, 5 * PAGE_SIZE, 0x55);
+    write_word(region, 5 * PAGE_SIZE + 8, 0x56);
+    write_word(region, 1000 * PAGE_SIZE, 0x57);
+    state_get_stats(region, &stats);
+    TEST_ASSERT_EQUAL((uint64_t)TEST_PAGES + 2, stats.cow_pages, "Two more pages copied");
+    TEST_ASSERT_EQUAL(2U, stats.pending, "Two pages pending");
+    state_commit(region, NULL);
+
+    snapshot = state_snapshot_acquire(region);
+    TEST_ASSERT_EQUAL(2U, snapshot->changed, "Commit changed two pages");
+    TEST_ASSERT(state_snapshot_changed(snapshot, 5 * PAGE_SIZE), "Page 5 dirty");
+    TEST_ASSERT(state_snapshot_changed(snapshot, 1000 * PAGE_SIZE), "Page 1000 dirty");
+    TEST_ASSERT(!state_snapshot_changed(snapshot, 6 * PAGE_SIZE), "Page 6 clean");
+    TEST_ASSERT(!state_snapshot_changed(snapshot, 600 * PAGE_SIZE), "Page 600 clean");
+    state_snapshot_release(snapshot);
+
+    TEST_ASSERT_EQUAL(999U, read_word(region, 999 * PAGE_SIZE + 16), "Untouched page intact");
+    TEST_ASSERT_EQUAL(5U, read_word(region, 5 * PAGE_SIZE + 16), "Copied page kept old bytes");
+    TEST_ASSERT_EQUAL(0x56U, read_word(region, 5 * PAGE_SIZE + 8), "Second write to same page");
+}
+
+/**
+ * Abort drops pending writes and their frames
+ */
+static void test_abort(void) {
+    state_region_t *region = new_region();
+    state_stats_t stats;
+    uint64_t frames;
+
+    write_word(region, 0, 7);
+    state_commit(region, NULL);
+    state_get_stats(region, &stats);
+    frames = stats.frames;
+
+    for (uint32_t page = 0; page < 40; page++) {
+        write_word(region, (uint64_t)page * PAGE_SIZE, 8);
+    }
+    state_abort(region);
+    state_get_stats(region, &stats);
+    TEST_ASSERT_EQUAL(0U, stats.pending, "Nothing pending after abort");
+    TEST_ASSERT_EQUAL(7U, read_word(region, 0), "Committed data survives abort");
+
+    /* The aborted frames are reused, not allocated again */
+    for (uint32_t page = 0; page < 40; page++) {
+        write_word(region, (uint64_t)page * PAGE_SIZE, 9);
+    }
+    state_commit(region, NULL);
+    state_get_stats(region, &stats);
+    TEST_ASSERT(stats.frames <= frames + 64, "Aborted frames reused");
+    TEST_ASSERT_EQUAL(9U, read_word(region, 39 * PAGE_SIZE), "Commit after abort");
+}
+
+/**
+ * Superseded frames wait for the oldest pinned version
+ */
+static void test_reclaim(void) {
+    state_region_t *region = new_region();
+    const state_version_t *pinned;
+    state_stats_t stats;
+
+    write_word(region, 0, 1);
+    state_commit(region, NULL);
+    pinned = state_snapshot_acquire(region);
+
+    for (uint32_t round = 2; round < 6; round++) {
+        write_word(region, 0, round);
+        state_commit(region, NULL);
+    }
+    state_get_stats(region, &stats);
+    TEST_ASSERT_EQUAL(4U, stats.retired, "Pinned version holds back reclamation");
+    TEST_ASSERT_EQUAL(STATUS_BUSY, state_region_destroy(region), "Destroy refused while pinned");
+
+    state_snapshot_release(pinned);
+    state_commit(region, NULL);
+    state_get_stats(region, &stats);
+    TEST_ASSERT_EQUAL(0U, stats.retired, "Released versions reclaimed");
+    TEST_ASSERT(stats.reclaimed >= 4 * 3, "Pages, tables and roots reclaimed");
+    TEST_ASSERT_EQUAL(5U, read_word(region, 0), "Latest version intact");
+    TEST_ASSERT_EQUAL(STATUS_SUCCESS, state_region_destroy(region), "Destroy after release");
+}
+
+/**
+ * msi_state_* bindings
+ */
+static void test_msi_binding(void) {
+    void *addr = NULL, *readonly = NULL;
+    uint32_t value = 0x1234, out = 0;
+
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_state_map(&addr, 8 * PAGE_SIZE, MSI_STATE_READ | MSI_STATE_WRITE),
+                      "msi_state_map");
+    TEST_ASSERT(msi_state_region(addr, NULL) != NULL, "Address resolves to its region");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_state_write((uint8_t *)addr + 64, &value, sizeof(value)),
+                      "msi_state_write");
+    msi_state_read((uint8_t *)addr + 64, &out, sizeof(out));
+    TEST_ASSERT_EQUAL(0U, out, "Uncommitted write not read back");
+    TEST_ASSERT_EQUAL(MSI_SUCCESS, msi_state_commit(addr, 8 * PAGE_SIZE), "msi_state_commit");
+    msi_state_read((uint8_t *)addr + 64, &out, sizeof(out));
+    TEST_ASSERT_EQUAL(value, out, "Committed write read back");
+
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_state_commit(addr, 9 * PAGE_SIZE),
+                      "Commit range past the region rejected");
+    TEST_ASSERT_EQUAL(MSI_ERROR_NOT_FOUND, msi_state_read((uint8_t *)addr + 8 * PAGE_SIZE, &out, 1),
+                      "Address past the region unknown");
+    TEST_ASSERT_EQUAL(MSI_ERROR_INVALID_ARG, msi_state_map(&readonly, PAGE_SIZE, MSI_STATE_EXECUTE),
+                      "Executable state rejected");
+
+    msi_state_map(&readonly, PAGE_SIZE, MSI_STATE_READ);
+    TEST_ASSERT(readonly != addr, "Regions get distinct addresses");
+    TEST_ASSERT_EQUAL(MSI_ERROR_PERMISSION_DENIED, msi_state_write(readonly, &value, sizeof(value)),
+                      "Write to read-only state denied");
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_state_tests(void) {
+    boot_log("=== Starting State Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    /* Run tests */
+    test_commit_visibility();
+    test_snapshot_isolation();
+    test_sharing_and_dirty_bits();
+    test_abort();
+    test_reclaim();
+    test_msi_binding();
+
+    /* Print results */
+    boot_log("=== State Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    boot_log("=== State Tests Complete ===");
+    return test_failed;
+}
@@ -0,0 +1,382 @@
+/**
+ * QuantumOS Wait Set Unit Tests
+ *
+ * Unit tests for IPC wait sets: level- and edge-triggered readiness on
+ * the caller's queue, ports and channels, batch retrieval, sources
+ * drained before collection, removal, hangup on destroy and ownership
+ * checks, and the sender pid and channel ids they depend on. Channel traffic comes from a peer process, reached with
+ * process_switch_to(); everything else runs as the kernel process.
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/process.h>
+#include <kernel/types.h>
+#include <kernel/boot.h>
+#include <kernel/ipc.h>
+
+/* ============================================================================
+ * Test Helper Functions
+ * ============================================================================ */
+
+static int test_count = 0;
+static int test_passed = 0;
+static int test_failed = 0;
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        test_count++; \
+        if (condition) { \
+            test_passed++; \
+            boot_log("[PASS]"); \
+            boot_log(message); \
+        } else { \
+            test_failed++; \
+            boot_log("[FAIL]"); \
+            boot_log(message); \
+        } \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual, message) \
+    TEST_ASSERT((expected) == (actual), message)
+
+#define CHANNEL_COUNT   100
+#define CHANNEL_LIMIT   1024            /* MAX_CHANNELS in ipc.c */
+
+static ipc_message_t message;
+static ipc_message_t received;
+static waitset_event_t events[16];
+static uint32_t channel_ids[CHANNEL_COUNT];
+static process_t *kernel_process;
+static process_t *peer;
+
+static void dummy_process_entry(void) {
+}
+
+static void drain(void) {
+    uint32_t sender = IPC_PID_ANY;
+
+    while (ipc_receive(&sender, &received, IPC_NO_WAIT) == IPC_SUCCESS) {
+        sender = IPC_PID_ANY;
+    }
+}
+
+static void set_payload(uint8_t value) {
+    memset(&message, 0, sizeof(message));
+    message.message_type = IPC_MSG_NORMAL;
+    message.length = 16;
+    message.data[0] = value;
+}
+
+/* Events collected, 0 when nothing was ready */
+static uint32_t collect(uint32_t waitset_id, uint32_t max) {
+    uint32_t count = 0;
+
+    ipc_waitset_collect(waitset_id, events, max, &count);
+    return count;
+}
+
+static void send_as_peer(uint32_t channel_id, uint8_t value) {
+    process_switch_to(peer);
+    set_payload(value);
+    ipc_channel_send(channel_id, &message);
+    process_switch_to(kernel_process);
+}
+
+/* ============================================================================
+ * Tests
+ * ============================================================================ */
+
+static void test_level_queue(void) {
+    uint32_t ws, count = 0, sender = IPC_PID_ANY;
+
+    boot_log("Testing level-triggered own queue...");
+    drain();
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_waitset_create(&ws), "Wait set created");
+    TEST_ASSERT(ws != 0, "Wait set id is not 0");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_waitset_add(ws, IPC_WAIT_QUEUE, 0, WAITSET_LEVEL, 7),
+                      "Own queue added");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NO_MESSAGE, ipc_waitset_collect(ws, events, 16, &count),
+                      "Nothing ready");
+    TEST_ASSERT_EQUAL(0U, count, "No events");
+
+    set_payload(1);
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Queue ready once for two messages");
+    TEST_ASSERT_EQUAL(7ULL, events[0].cookie, "Cookie returned");
+    TEST_ASSERT_EQUAL((uint32_t)WAITSET_READABLE, events[0].events, "Readable");
+    TEST_ASSERT_EQUAL(2U, events[0].pending, "Pending count reported");
+
+    ipc_receive(&sender, &received, IPC_NO_WAIT);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Level: still ready while non-empty");
+    TEST_ASSERT_EQUAL(1U, events[0].pending, "One left");
+
+    drain();
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Level: drained queue not reported");
+
+    /* Messages queued before registration are not missed */
+    ipc_waitset_remove(ws, IPC_WAIT_QUEUE, 0);
+    ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT);
+    ipc_waitset_add(ws, IPC_WAIT_QUEUE, 0, WAITSET_LEVEL, 8);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Pending at registration is ready");
+    TEST_ASSERT_EQUAL(8ULL, events[0].cookie, "New cookie");
+    drain();
+
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_waitset_destroy(ws), "Wait set destroyed");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_waitset_collect(ws, events, 16, &count),
+                      "Destroyed wait set not found");
+}
+
+static void test_edge_port(void) {
+    uint32_t ws, port_id;
+
+    boot_log("Testing edge-triggered port...");
+    ipc_waitset_create(&ws);
+    ipc_port_create("waitset-test", &port_id);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_waitset_add(ws, IPC_WAIT_PORT, port_id, WAITSET_EDGE, 3),
+                      "Port added edge-triggered");
+
+    set_payload(2);
+    ipc_port_send(port_id, &message);
+    ipc_port_send(port_id, &message);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Edge: one event for the batch");
+    TEST_ASSERT_EQUAL(2U, events[0].pending, "Both messages pending");
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Edge: not reported again while unchanged");
+
+    ipc_port_send(port_id, &message);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Edge: new message reported");
+    TEST_ASSERT_EQUAL(3U, events[0].pending, "Three pending");
+
+    /* Destroying the port hangs up and drops the registration */
+    ipc_port_send(port_id, &message);
+    ipc_port_destroy(port_id);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Hangup reported");
+    TEST_ASSERT(events[0].events & WAITSET_HANGUP, "Hangup flag");
+    TEST_ASSERT_EQUAL(0U, events[0].pending, "Closed port has nothing pending");
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Hangup reported once");
+
+    ipc_waitset_destroy(ws);
+}
+
+static void test_channels(void) {
+    uint32_t ws, total = 0;
+    bool seen[CHANNEL_COUNT] = { false };
+
+    boot_log("Testing many channels, few active...");
+    ipc_waitset_create(&ws);
+    for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+        ipc_channel_create(peer->pid, IPC_PID_KERNEL, &channel_ids[i]);
+        ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_ids[i], WAITSET_LEVEL, i);
+    }
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Idle channels not ready");
+
+    send_as_peer(channel_ids[42], 42);
+    send_as_peer(channel_ids[7], 7);
+    send_as_peer(channel_ids[99], 99);
+    send_as_peer(channel_ids[42], 43);
+
+    TEST_ASSERT_EQUAL(2U, collect(ws, 2), "Batch limited to max");
+    TEST_ASSERT_EQUAL(42ULL, events[0].cookie, "First ready first");
+    TEST_ASSERT_EQUAL(2U, events[0].pending, "Two on channel 42");
+    TEST_ASSERT_EQUAL(7ULL, events[1].cookie, "Second ready second");
+    TEST_ASSERT_EQUAL(3U, collect(ws, 16), "Remaining and level re-reports in one batch");
+    TEST_ASSERT_EQUAL(99ULL, events[0].cookie, "Unreported source before re-reports");
+
+    /* Receive everything the wait set reports until nothing is ready */
+    for (uint32_t round = 0; round < 4; round++) {
+        uint32_t count = collect(ws, 16);
+
+        for (uint32_t i = 0; i < count; i++) {
+            seen[events[i].cookie] = true;
+            while (ipc_channel_receive(channel_ids[events[i].cookie], &received,
+                                       IPC_NO_WAIT) == IPC_SUCCESS) {
+                total++;
+            }
+        }
+    }
+    TEST_ASSERT_EQUAL(4U, total, "All messages received through the wait set");
+    TEST_ASSERT(seen[7] && seen[42] && seen[99] && !seen[0], "Only active channels reported");
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Nothing left");
+
+    /* Signalled, then drained before the wait: not reported */
+    send_as_peer(channel_ids[5], 5);
+    ipc_channel_receive(channel_ids[5], &received, IPC_NO_WAIT);
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Drained source dropped silently");
+
+    TEST_ASSERT_EQUAL(IPC_ERROR_ALREADY_EXISTS,
+                      ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_ids[1], WAITSET_LEVEL, 1),
+                      "Duplicate registration refused");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_waitset_remove(ws, IPC_WAIT_CHANNEL, channel_ids[1]),
+                      "Channel removed");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_waitset_remove(ws, IPC_WAIT_CHANNEL, channel_ids[1]),
+                      "Second remove not found");
+    send_as_peer(channel_ids[1], 1);
+    TEST_ASSERT_EQUAL(0U, collect(ws, 16), "Removed channel not reported");
+    ipc_channel_receive(channel_ids[1], &received, IPC_NO_WAIT);
+
+    /* The peer's side is its own: the kernel cannot watch it */
+    process_switch_to(peer);
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND,
+                      ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_ids[2], WAITSET_LEVEL, 2),
+                      "Another process's wait set not found");
+    process_switch_to(kernel_process);
+
+    ipc_channel_destroy(channel_ids[3]);
+    TEST_ASSERT_EQUAL(1U, collect(ws, 16), "Destroyed channel hangs up");
+    TEST_ASSERT_EQUAL(3ULL, events[0].cookie, "Hangup for the right channel");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_channel_send(channel_ids[3], &message),
+                      "Destroyed channel id not found");
+
+    ipc_waitset_destroy(ws);
+    for (uint32_t i = 0; i < CHANNEL_COUNT; i++) {
+        ipc_channel_destroy(channel_ids[i]);
+    }
+}
+
+/*
+ * The two IPC changes wait sets rely on: messages carry the running
+ * process as sender, and channel ids name their table slot, so lookup
+ * is O(1) and a destroyed channel's id stays dead after the slot is
+ * reused.
+ */
+static void test_caller_pid(void) {
+    uint32_t sender = IPC_PID_ANY;
+
+    boot_log("Testing the sender of a message...");
+    process_switch_to(peer);
+    set_payload(1);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_send(IPC_PID_KERNEL, &message, IPC_NO_WAIT), "Peer sends");
+    process_switch_to(kernel_process);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_receive(&sender, &received, IPC_NO_WAIT), "Kernel receives");
+    TEST_ASSERT_EQUAL(peer->pid, sender, "Sender is the running process");
+    TEST_ASSERT_EQUAL(peer->pid, received.sender_id, "Message names the running process");
+}
+
+static void test_channel_ids(void) {
+    static uint32_t ids[CHANNEL_LIMIT + 1];
+    uint32_t first, second, live = 0;
+
+    boot_log("Testing channel ids...");
+    ipc_channel_create(peer->pid, IPC_PID_KERNEL, &first);
+    ipc_channel_destroy(first);
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_channel_create(peer->pid, IPC_PID_KERNEL, &second),
+                      "Channel created in the freed slot");
+    TEST_ASSERT(second != first, "Reused slot gets a new id");
+    set_payload(2);
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_channel_send(first, &message),
+                      "Old id does not reach the new channel");
+    TEST_ASSERT_EQUAL(IPC_SUCCESS, ipc_channel_send(second, &message), "New id does");
+    ipc_channel_destroy(second);
+
+    while (live <= CHANNEL_LIMIT &&
+           ipc_channel_create(peer->pid, IPC_PID_KERNEL, &ids[live]) == IPC_SUCCESS) {
+        live++;
+    }
+    TEST_ASSERT_EQUAL(CHANNEL_LIMIT, live, "Table holds 1024 channels");
+    while (live) {
+        ipc_channel_destroy(ids[--live]);
+    }
+}
+
+static void test_invalid(void) {
+    uint32_t ws, port_id, channel_id, other;
+
+    boot_log("Testing invalid registrations...");
+    ipc_waitset_create(&ws);
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG, ipc_waitset_add(ws, 9, 0, WAITSET_LEVEL, 0),
+                      "Unknown source kind rejected");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG, ipc_waitset_add(ws, IPC_WAIT_QUEUE, 0, 0x80, 0),
+                      "Unknown flags rejected");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_PORT, ipc_waitset_add(ws, IPC_WAIT_PORT, 12345, 0, 0),
+                      "Unknown port rejected");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_waitset_add(ws + 1, IPC_WAIT_QUEUE, 0, 0, 0),
+                      "Unknown wait set not found");
+    TEST_ASSERT_EQUAL(IPC_ERROR_INVALID_ARG, ipc_waitset_collect(ws, events, 0, &other),
+                      "Empty buffer rejected");
+
+    /* A port the caller does not own */
+    process_switch_to(peer);
+    ipc_port_create("waitset-peer", &port_id);
+    process_switch_to(kernel_process);
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED, ipc_waitset_add(ws, IPC_WAIT_PORT, port_id, 0, 0),
+                      "Foreign port refused");
+
+    /* A channel the caller is not on */
+    ipc_channel_create(peer->pid, peer->pid, &channel_id);
+    TEST_ASSERT_EQUAL(IPC_ERROR_PERMISSION_DENIED,
+                      ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_id, 0, 0),
+                      "Foreign channel refused");
+
+    /* Slot reuse does not revive an old id */
+    ipc_channel_destroy(channel_id);
+    ipc_channel_create(IPC_PID_KERNEL, peer->pid, &other);
+    TEST_ASSERT(other != channel_id, "New channel gets a new id");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_waitset_add(ws, IPC_WAIT_CHANNEL, channel_id, 0, 0),
+                      "Stale channel id not found");
+    ipc_channel_destroy(other);
+
+    ipc_waitset_destroy(ws);
+    ipc_waitset_create(&other);
+    TEST_ASSERT(other != ws, "Reused wait set slot gets a new id");
+    TEST_ASSERT_EQUAL(IPC_ERROR_NOT_FOUND, ipc_waitset_destroy(ws), "Stale wait set id not found");
+    ipc_waitset_destroy(other);
+}
+
+/* ============================================================================
+ * Test Runner
+ * ============================================================================ */
+
+int run_waitset_tests(void) {
+    process_create_params_t params = {
+        .name = "waitset_peer",
+        .type = PROCESS_TYPE_USER,
+        .priority = PRIORITY_NORMAL,
+        .parent_pid = KERNEL_PROCESS_ID,
+        .entry_point = (void *)dummy_process_entry,
+        .stack_address = (void *)0x500000,
+        .stack_size = PROCESS_STACK_SIZE,
+        .is_quantum_aware = false
+    };
+
+    boot_log("=== Starting Wait Set Tests ===");
+
+    /* Reset test counters */
+    test_count = 0;
+    test_passed = 0;
+    test_failed = 0;
+
+    process_init();
+    ipc_init();
+    kernel_process = process_get_current();
+
+    /* Run tests */
+    test_level_queue();
+    test_edge_port();
+    if (kernel_process && process_create(&params, &peer) == STATUS_SUCCESS) {
+        test_channels();
+        test_caller_pid();
+        test_channel_ids();
+        test_invalid();
+        process_destroy(peer->pid);
+    } else {
+        TEST_ASSERT(false, "Peer process created");
+    }
+
+    /* Print results */
+    boot_log("=== Wait Set Test Results ===");
+    boot_log("Total tests: ");
+    early_console_write_hex(test_count);
+    boot_log("Passed: ");
+    early_console_write_hex(test_passed);
+    boot_log("Failed: ");
+    early_console_write_hex(test_failed);
+
+    if (test_failed == 0) {
+        boot_log("All tests PASSED! ✓");
+    } else {
+        boot_log("Some tests FAILED! ✗");
+    }
+
+    return test_failed;
+}
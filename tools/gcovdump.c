@@ -0,0 +1,178 @@
+/**
+ * QuantumOS Profile Counter Extractor
+ *
+ * Reads a serial console capture containing a gcov dump (see
+ * kernel/gcov.h) and writes every unit back out as a .gcda file that
+ * -fprofile-use can read. Files go to the path the kernel reports,
+ * which is inside the profile directory the instrumented kernel was
+ * compiled with, or under -d <dir> keeping only the file name.
+ * Existing files are replaced, not merged.
+ *
+ * Build with: make pgo (builds and runs it)
+ * Usage:      build/host/tools/gcovdump [-d dir] < serial.log
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/gcov.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LEN    4096
+
+typedef struct {
+    char path[LINE_MAX_LEN];
+    unsigned char *data;
+    size_t len;
+    size_t cap;
+} unit_t;
+
+static const char *out_dir;
+static unsigned long units_written;
+static unsigned long long bytes_written;
+
+static void strip_newline(char *line) {
+    size_t len = strlen(line);
+    while (len && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+        line[--len] = '\0';
+    }
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+static int append_hex(unit_t *unit, const char *hex) {
+    size_t n = strlen(hex);
+
+    if (n % 2) {
+        return -1;
+    }
+    if (unit->len + n / 2 > unit->cap) {
+        size_t cap = unit->cap ? unit->cap * 2 : 4096;
+        while (cap < unit->len + n / 2) {
+            cap *= 2;
+        }
+        unsigned char *data = realloc(unit->data, cap);
+        if (!data) {
+            return -1;
+        }
+        unit->data = data;
+        unit->cap = cap;
+    }
+    for (size_t i = 0; i < n; i += 2) {
+        int hi = hex_value(hex[i]), lo = hex_value(hex[i + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        unit->data[unit->len++] = (unsigned char)(hi << 4 | lo);
+    }
+    return 0;
+}
+
+static int write_unit(unit_t *unit) {
+    char path[2 * LINE_MAX_LEN];
+    FILE *f;
+
+    if (!unit->path[0]) {
+        return 0;
+    }
+    if (out_dir) {
+        const char *base = strrchr(unit->path, '/');
+        snprintf(path, sizeof(path), "%s/%s", out_dir, base ? base + 1 : unit->path);
+    } else {
+        snprintf(path, sizeof(path), "%s", unit->path);
+    }
+
+    f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    if (fwrite(unit->data, 1, unit->len, f) != unit->len) {
+        perror(path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    units_written++;
+    bytes_written += unit->len;
+    unit->path[0] = '\0';
+    unit->len = 0;
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "usage: %s [-d dir] < serial.log\n", prog);
+}
+
+int main(int argc, char **argv) {
+    char line[LINE_MAX_LEN];
+    unit_t unit = { .path = "" };
+    unsigned long expected_units = 0;
+    unsigned long long expected_bytes = 0;
+    int in_dump = 0, done = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+            out_dir = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    while (fgets(line, sizeof(line), stdin)) {
+        unsigned int version;
+
+        strip_newline(line);
+        if (sscanf(line, "#GCOV-BEGIN %u %lu", &version, &expected_units) == 2) {
+            if (version != GCOV_DUMP_VERSION) {
+                fprintf(stderr, "%s: dump version %u, expected %u\n", argv[0], version,
+                        GCOV_DUMP_VERSION);
+                return 1;
+            }
+            in_dump = 1;
+        } else if (!in_dump) {
+            continue;
+        } else if (strncmp(line, "#GCDA ", 6) == 0) {
+            if (write_unit(&unit) != 0) {
+                return 1;
+            }
+            snprintf(unit.path, sizeof(unit.path), "%s", line + 6);
+        } else if (strncmp(line, "#D ", 3) == 0) {
+            if (!unit.path[0] || append_hex(&unit, line + 3) != 0) {
+                fprintf(stderr, "%s: malformed data line\n", argv[0]);
+                return 1;
+            }
+        } else if (sscanf(line, "#GCOV-END %lu %llu", &expected_units, &expected_bytes) == 2) {
+            if (write_unit(&unit) != 0) {
+                return 1;
+            }
+            done = 1;
+            break;
+        }
+    }
+
+    free(unit.data);
+    if (!done) {
+        fprintf(stderr, "%s: no complete gcov dump in input\n", argv[0]);
+        return 1;
+    }
+    if (units_written != expected_units || bytes_written != expected_bytes) {
+        fprintf(stderr, "%s: wrote %lu units, %llu bytes; dump reported %lu, %llu\n", argv[0],
+                units_written, bytes_written, expected_units, expected_bytes);
+        return 1;
+    }
+    printf("%lu profiles, %llu bytes\n", units_written, bytes_written);
+    return 0;
+}
@@ -0,0 +1,118 @@
+/**
+ * QuantumOS In-kernel Benchmark Comparison
+ *
+ * Reads two result files from `make bench-qemu` (JSON lines, see
+ * kernel/kbench.h) and prints, for every case present in both, the
+ * median and mean cycles of each run and the change in percent.
+ * Negative deltas are improvements.
+ *
+ * Build with: make pgo (builds and runs it)
+ * Usage:      build/host/tools/kbenchdiff base.jsonl new.jsonl
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LEN    1024
+#define MAX_CASES       64
+#define NAME_MAX_LEN    64
+
+typedef struct {
+    char name[NAME_MAX_LEN];
+    unsigned long long p50;
+    unsigned long long mean;
+} result_t;
+
+typedef struct {
+    result_t cases[MAX_CASES];
+    int count;
+} run_t;
+
+/* Value of "key":"..." in a line, or 0 if absent */
+static int get_str(const char *line, const char *key, char *out, size_t size) {
+    char pattern[NAME_MAX_LEN + 8];
+    const char *start, *end;
+
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    start = strstr(line, pattern);
+    if (!start) {
+        return 0;
+    }
+    start += strlen(pattern);
+    end = strchr(start, '"');
+    if (!end || (size_t)(end - start) >= size) {
+        return 0;
+    }
+    memcpy(out, start, end - start);
+    out[end - start] = '\0';
+    return 1;
+}
+
+/* Value of "key":<number> in a line, or 0 if absent */
+static int get_num(const char *line, const char *key, unsigned long long *out) {
+    char pattern[NAME_MAX_LEN + 8];
+    const char *start;
+
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    start = strstr(line, pattern);
+    if (!start) {
+        return 0;
+    }
+    *out = strtoull(start + strlen(pattern), NULL, 10);
+    return 1;
+}
+
+static int load(const char *path, run_t *run) {
+    char line[LINE_MAX_LEN];
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    run->count = 0;
+    while (fgets(line, sizeof(line), f) && run->count < MAX_CASES) {
+        result_t *r = &run->cases[run->count];
+        if (get_str(line, "bench", r->name, sizeof(r->name)) &&
+            get_num(line, "p50", &r->p50) && get_num(line, "mean", &r->mean)) {
+            run->count++;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static double delta(unsigned long long base, unsigned long long now) {
+    return base ? 100.0 * ((double)now - (double)base) / (double)base : 0.0;
+}
+
+int main(int argc, char **argv) {
+    static run_t base, now;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s base.jsonl new.jsonl\n", argv[0]);
+        return 2;
+    }
+    if (load(argv[1], &base) != 0 || load(argv[2], &now) != 0) {
+        return 1;
+    }
+
+    printf("%-20s %10s %10s %8s %10s %10s %8s  (cycles)\n",
+           "bench", "base p50", "p50", "delta", "base mean", "mean", "delta");
+    for (int i = 0; i < now.count; i++) {
+        const result_t *n = &now.cases[i];
+        for (int j = 0; j < base.count; j++) {
+            const result_t *b = &base.cases[j];
+            if (strcmp(b->name, n->name) == 0) {
+                printf("%-20s %10llu %10llu %+7.1f%% %10llu %10llu %+7.1f%%\n", n->name,
+                       b->p50, n->p50, delta(b->p50, n->p50),
+                       b->mean, n->mean, delta(b->mean, n->mean));
+                break;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+/**
+ * QuantumOS Profile Symboliser
+ *
+ * Reads a serial console capture containing profiler dumps (see
+ * kernel/profile.h), resolves every address against the function
+ * symbols of kernel.elf and prints either
+ *
+ *   flat    self and total sample counts per function (default)
+ *   folded  one "outer;...;inner count" line per distinct stack, the
+ *           input format of flamegraph.pl and speedscope
+ *
+ * Return addresses are looked up at address - 1 so a call that ends a
+ * function is attributed to that function. User-mode samples are
+ * reported as [user].
+ *
+ * Build with: make profile-decode
+ * Usage:      build/host/tools/profsym [-f] build/x86_64/kernel.elf < serial.log
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/profile.h>
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LEN    1024
+#define UNKNOWN_SYMBOL  "[unknown]"
+#define USER_SYMBOL     "[user]"
+
+typedef struct {
+    uint64_t addr;
+    uint64_t size;
+    const char *name;
+    uint64_t self;
+    uint64_t total;
+    uint64_t last_sample;           /* Sample that last counted towards total */
+} symbol_t;
+
+typedef struct {
+    char *stack;
+    uint64_t count;
+} folded_t;
+
+static symbol_t *symbols;
+static size_t symbol_count;
+static char *elf_image;
+
+static int compare_addr(const void *a, const void *b) {
+    const symbol_t *sa = a, *sb = b;
+    return sa->addr < sb->addr ? -1 : sa->addr > sb->addr;
+}
+
+static int compare_self(const void *a, const void *b) {
+    const symbol_t *sa = *(symbol_t *const *)a, *sb = *(symbol_t *const *)b;
+    if (sa->self != sb->self) {
+        return sa->self > sb->self ? -1 : 1;
+    }
+    return sa->total > sb->total ? -1 : sa->total < sb->total;
+}
+
+static int compare_stack(const void *a, const void *b) {
+    return strcmp(((const folded_t *)a)->stack, ((const folded_t *)b)->stack);
+}
+
+/**
+ * Load the function symbols of an ELF64 image
+ */
+static int load_symbols(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    elf_image = malloc(size);
+    if (!elf_image || fread(elf_image, 1, size, f) != (size_t)size) {
+        fprintf(stderr, "profsym: cannot read %s\n", path);
+        fclose(f);
+        return -1;
+    }
+    fclose(f);
+
+    const Elf64_Ehdr *ehdr = (const Elf64_Ehdr *)elf_image;
+    if (size < (long)sizeof(*ehdr) || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != ELFCLASS64) {
+        fprintf(stderr, "profsym: %s is not an ELF64 file\n", path);
+        return -1;
+    }
+
+    const Elf64_Shdr *shdrs = (const Elf64_Shdr *)(elf_image + ehdr->e_shoff);
+    for (int i = 0; i < ehdr->e_shnum; i++) {
+        if (shdrs[i].sh_type != SHT_SYMTAB) {
+            continue;
+        }
+
+        const Elf64_Sym *syms = (const Elf64_Sym *)(elf_image + shdrs[i].sh_offset);
+        const char *strtab = elf_image + shdrs[shdrs[i].sh_link].sh_offset;
+        size_t n = shdrs[i].sh_size / sizeof(Elf64_Sym);
+
+        symbols = calloc(n, sizeof(*symbols));
+        for (size_t s = 0; s < n; s++) {
+            int type = ELF64_ST_TYPE(syms[s].st_info);
+            /* Functions, plus untyped labels from the assembly stubs */
+            if ((type != STT_FUNC && type != STT_NOTYPE) ||
+                syms[s].st_shndx == SHN_UNDEF || syms[s].st_shndx >= SHN_LORESERVE ||
+                syms[s].st_value == 0 || strtab[syms[s].st_name] == '\0') {
+                continue;
+            }
+            if (type == STT_NOTYPE &&
+                !(shdrs[syms[s].st_shndx].sh_flags & SHF_EXECINSTR)) {
+                continue;
+            }
+            symbols[symbol_count].addr = syms[s].st_value;
+            symbols[symbol_count].size = syms[s].st_size;
+            symbols[symbol_count].name = strtab + syms[s].st_name;
+            symbols[symbol_count].last_sample = UINT64_MAX;
+            symbol_count++;
+        }
+        break;
+    }
+
+    if (symbol_count == 0) {
+        fprintf(stderr, "profsym: no symbols in %s\n", path);
+        return -1;
+    }
+
+    qsort(symbols, symbol_count, sizeof(*symbols), compare_addr);
+    return 0;
+}
+
+/**
+ * Function containing `addr`: the nearest symbol at or below it
+ */
+static symbol_t *lookup(uint64_t addr) {
+    size_t lo = 0, hi = symbol_count;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (symbols[mid].addr <= addr) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == 0) {
+        return NULL;
+    }
+
+    /* Prefer a sized function symbol over a label at the same address */
+    symbol_t *sym = &symbols[lo - 1];
+    while (sym > symbols && sym[-1].addr == sym->addr && sym->size == 0) {
+        sym--;
+    }
+    if (sym->size && addr >= sym->addr + sym->size) {
+        return NULL;
+    }
+    return sym;
+}
+
+static const char *name_of(const symbol_t *sym) {
+    return sym ? sym->name : UNKNOWN_SYMBOL;
+}
+
+int main(int argc, char **argv) {
+    int folded_output = 0;
+    const char *elf_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0) {
+            folded_output = 1;
+        } else {
+            elf_path = argv[i];
+        }
+    }
+    if (!elf_path) {
+        fprintf(stderr, "usage: %s [-f] kernel.elf < serial.log\n", argv[0]);
+        return 2;
+    }
+    if (load_symbols(elf_path) != 0) {
+        return 1;
+    }
+
+    folded_t *stacks = NULL;
+    size_t stack_count = 0, stack_capacity = 0;
+    uint64_t samples = 0, user_samples = 0, unknown_samples = 0, dropped = 0;
+    uint64_t period = 0;
+    char source[16] = "none", event[16] = "none";
+    char line[LINE_MAX_LEN];
+    int in_dump = 0;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        char *mark = strchr(line, '#');
+        if (!mark) {
+            continue;
+        }
+
+        unsigned version;
+        unsigned long long p, total, lost;
+        if (sscanf(mark, "#PROFILE-BEGIN %u %15s %15s %llu", &version, source, event, &p) == 4) {
+            if (version != PROFILE_VERSION) {
+                fprintf(stderr, "profsym: unsupported profile version %u\n", version);
+                return 1;
+            }
+            period = p;
+            in_dump = 1;
+            continue;
+        }
+        if (sscanf(mark, "#PROFILE-END %llu %llu", &total, &lost) == 2) {
+            dropped += lost;
+            in_dump = 0;
+            continue;
+        }
+        if (!in_dump || strncmp(mark, "#S ", 3) != 0) {
+            continue;
+        }
+
+        /* cpu pid flags rip frames... */
+        uint64_t fields[4 + PROFILE_MAX_DEPTH];
+        int n = 0;
+        char *cursor = mark + 3, *end;
+        while (n < (int)(sizeof(fields) / sizeof(fields[0]))) {
+            uint64_t value = strtoull(cursor, &end, 16);
+            if (end == cursor) {
+                break;
+            }
+            fields[n++] = value;
+            cursor = end;
+        }
+        if (n < 4) {
+            continue;
+        }
+
+        samples++;
+
+        /* Outermost first: frames are innermost first after the RIP */
+        const symbol_t *chain[1 + PROFILE_MAX_DEPTH];
+        int depth = 0;
+        if (fields[2] & PROFILE_SAMPLE_USER) {
+            user_samples++;
+            chain[depth++] = NULL;
+        } else {
+            chain[depth++] = lookup(fields[3]);
+            for (int f = 4; f < n; f++) {
+                chain[depth++] = lookup(fields[f] - 1);
+            }
+            if (!chain[0]) {
+                unknown_samples++;
+            }
+        }
+
+        if (!(fields[2] & PROFILE_SAMPLE_USER)) {
+            if (chain[0]) {
+                ((symbol_t *)chain[0])->self++;
+            }
+            for (int d = 0; d < depth; d++) {
+                symbol_t *sym = (symbol_t *)chain[d];
+                if (sym && sym->last_sample != samples) {
+                    sym->last_sample = samples;
+                    sym->total++;
+                }
+            }
+        }
+
+        if (folded_output) {
+            char buf[LINE_MAX_LEN * 2];
+            size_t len = 0;
+            for (int d = depth - 1; d >= 0; d--) {
+                const char *name = (fields[2] & PROFILE_SAMPLE_USER) ? USER_SYMBOL : name_of(chain[d]);
+                len += snprintf(buf + len, sizeof(buf) - len, "%s%s", len ? ";" : "", name);
+                if (len >= sizeof(buf)) {
+                    len = sizeof(buf) - 1;
+                    break;
+                }
+            }
+            if (stack_count == stack_capacity) {
+                stack_capacity = stack_capacity ? stack_capacity * 2 : 1024;
+                stacks = realloc(stacks, stack_capacity * sizeof(*stacks));
+            }
+            stacks[stack_count].stack = strdup(buf);
+            stacks[stack_count].count = 1;
+            stack_count++;
+        }
+    }
+
+    if (samples == 0) {
+        fprintf(stderr, "profsym: no samples in input\n");
+        return 1;
+    }
+
+    if (folded_output) {
+        qsort(stacks, stack_count, sizeof(*stacks), compare_stack);
+        for (size_t i = 0; i < stack_count;) {
+            size_t j = i;
+            uint64_t count = 0;
+            while (j < stack_count && strcmp(stacks[j].stack, stacks[i].stack) == 0) {
+                count += stacks[j].count;
+                j++;
+            }
+            printf("%s %llu\n", stacks[i].stack, (unsigned long long)count);
+            i = j;
+        }
+        return 0;
+    }
+
+    symbol_t **ranked = malloc(symbol_count * sizeof(*ranked));
+    size_t ranked_count = 0;
+    for (size_t i = 0; i < symbol_count; i++) {
+        if (symbols[i].total) {
+            ranked[ranked_count++] = &symbols[i];
+        }
+    }
+    qsort(ranked, ranked_count, sizeof(*ranked), compare_self);
+
+    printf("# %llu samples (%s, %s, period %llu), %llu dropped, %llu user, %llu unresolved\n",
+           (unsigned long long)samples, source, event, (unsigned long long)period,
+           (unsigned long long)dropped, (unsigned long long)user_samples,
+           (unsigned long long)unknown_samples);
+    printf("#  self%%     self  total%%    total  function\n");
+    for (size_t i = 0; i < ranked_count; i++) {
+        printf("%7.2f %8llu %7.2f %8llu  %s\n",
+               100.0 * ranked[i]->self / samples, (unsigned long long)ranked[i]->self,
+               100.0 * ranked[i]->total / samples, (unsigned long long)ranked[i]->total,
+               ranked[i]->name);
+    }
+    if (user_samples) {
+        printf("%7.2f %8llu %7.2f %8llu  %s\n",
+               100.0 * user_samples / samples, (unsigned long long)user_samples,
+               100.0 * user_samples / samples, (unsigned long long)user_samples, USER_SYMBOL);
+    }
+
+    return 0;
+}
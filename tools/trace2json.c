@@ -0,0 +1,273 @@
+/**
+ * QuantumOS Trace Decoder
+ *
+ * Reads a serial console capture containing one or more trace dumps
+ * (see kernel/trace.h) and writes Chrome trace event JSON, loadable in
+ * chrome://tracing or ui.perfetto.dev.
+ *
+ * Each CPU gets two tracks: one with interrupt and resonant sync slices
+ * and instant IPC events, and one showing which process was running,
+ * built from the scheduler switch events. Slice ends whose beginning
+ * was overwritten in the ring are dropped.
+ *
+ * Build with: make trace-decode
+ * Usage:      build/host/tools/trace2json < serial.log > trace.json
+ *
+ * SPDX-License-Identifier: GPL-2.0-only
+ */
+
+#include <kernel/trace.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_MAX_LEN    512
+#define MAX_CPU_TRACKS  256     /* Record cpu field is a byte */
+
+static const char *const event_names[TRACE_EVENT_COUNT] = {
+    [TRACE_SCHED_SWITCH]        = "sched_switch",
+    [TRACE_IRQ_ENTRY]           = "irq",
+    [TRACE_IRQ_EXIT]            = "irq",
+    [TRACE_IPC_SEND]            = "ipc_send",
+    [TRACE_IPC_RECEIVE]         = "ipc_receive",
+    [TRACE_IPC_PORT_SEND]       = "ipc_port_send",
+    [TRACE_IPC_PORT_RECEIVE]    = "ipc_port_receive",
+    [TRACE_RESONANT_SYNC_BEGIN] = "resonant_sync",
+    [TRACE_RESONANT_SYNC_END]   = "resonant_sync",
+};
+
+static const char *const arg_names[TRACE_EVENT_COUNT][2] = {
+    [TRACE_SCHED_SWITCH]        = { "prev_pid", "next_pid" },
+    [TRACE_IRQ_ENTRY]           = { "vector", NULL },
+    [TRACE_IRQ_EXIT]            = { "vector", NULL },
+    [TRACE_IPC_SEND]            = { "receiver", "result" },
+    [TRACE_IPC_RECEIVE]         = { "sender", "result" },
+    [TRACE_IPC_PORT_SEND]       = { "port", "result" },
+    [TRACE_IPC_PORT_RECEIVE]    = { "port", "result" },
+    [TRACE_RESONANT_SYNC_BEGIN] = { "sync_count", NULL },
+    [TRACE_RESONANT_SYNC_END]   = { "oscillators", NULL },
+};
+
+typedef struct {
+    trace_record_t *records;
+    size_t count;
+    size_t capacity;
+} record_list_t;
+
+typedef struct {
+    uint32_t depth;             /* Open slices on the event track */
+    int running;                /* A process slice is open */
+    uint32_t pid;               /* Process of the open slice */
+    double since;               /* Start of the open process slice */
+    int seen;
+} cpu_track_t;
+
+static uint64_t tsc_khz;
+static uint64_t tsc_origin;
+static int first_event = 1;
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int parse_record(const char *hex, trace_record_t *rec) {
+    uint8_t bytes[TRACE_RECORD_SIZE];
+
+    for (int i = 0; i < TRACE_RECORD_SIZE; i++) {
+        int hi = hex_value(hex[2 * i]);
+        int lo = hi < 0 ? -1 : hex_value(hex[2 * i + 1]);
+        if (lo < 0) {
+            return -1;
+        }
+        bytes[i] = (uint8_t)(hi << 4 | lo);
+    }
+
+    memcpy(rec, bytes, sizeof(*rec));
+    return rec->event < TRACE_EVENT_COUNT ? 0 : -1;
+}
+
+static void list_append(record_list_t *list, const trace_record_t *rec) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 4096;
+        list->records = realloc(list->records, list->capacity * sizeof(*rec));
+        if (!list->records) {
+            perror("realloc");
+            exit(1);
+        }
+    }
+    list->records[list->count++] = *rec;
+}
+
+static int compare_tsc(const void *a, const void *b) {
+    const trace_record_t *ra = a, *rb = b;
+    return ra->tsc < rb->tsc ? -1 : ra->tsc > rb->tsc;
+}
+
+static double to_us(uint64_t tsc) {
+    return (double)(tsc - tsc_origin) * 1000.0 / (double)tsc_khz;
+}
+
+static void begin_event(void) {
+    printf(first_event ? "\n" : ",\n");
+    first_event = 0;
+}
+
+static void emit_args(const trace_record_t *rec) {
+    printf(",\"args\":{\"pid\":%u", rec->pid);
+    for (int i = 0; i < 2; i++) {
+        const char *name = arg_names[rec->event][i];
+        uint64_t value = i ? rec->arg1 : rec->arg0;
+        if (name) {
+            printf(",\"%s\":%lld", name, (long long)value);
+        }
+    }
+    printf("}");
+}
+
+static void emit_process_slice(uint32_t cpu, uint32_t pid, double start, double end) {
+    begin_event();
+    printf("{\"name\":\"pid %u\",\"cat\":\"sched\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+           "\"pid\":0,\"tid\":%u,\"args\":{\"pid\":%u}}",
+           pid, start, end - start, cpu * 2 + 1, pid);
+}
+
+static void emit_record(const trace_record_t *rec, cpu_track_t *track) {
+    double ts = to_us(rec->tsc);
+    uint32_t tid = rec->cpu * 2;
+    const char *phase;
+
+    switch (rec->event) {
+        case TRACE_IRQ_ENTRY:
+        case TRACE_RESONANT_SYNC_BEGIN:
+            track->depth++;
+            phase = "B";
+            break;
+        case TRACE_IRQ_EXIT:
+        case TRACE_RESONANT_SYNC_END:
+            if (track->depth == 0) {
+                return;
+            }
+            track->depth--;
+            phase = "E";
+            break;
+        case TRACE_SCHED_SWITCH:
+            if (track->running) {
+                emit_process_slice(rec->cpu, track->pid, track->since, ts);
+            }
+            track->running = 1;
+            track->pid = (uint32_t)rec->arg1;
+            track->since = ts;
+            phase = "i";
+            break;
+        default:
+            phase = "i";
+            break;
+    }
+
+    begin_event();
+    if (rec->event == TRACE_IRQ_ENTRY || rec->event == TRACE_IRQ_EXIT) {
+        printf("{\"name\":\"irq %llu\"", (unsigned long long)rec->arg0);
+    } else {
+        printf("{\"name\":\"%s\"", event_names[rec->event]);
+    }
+    printf(",\"cat\":\"kernel\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":%u",
+           phase, ts, tid);
+    if (phase[0] == 'i') {
+        printf(",\"s\":\"t\"");
+    }
+    if (phase[0] != 'E') {
+        emit_args(rec);
+    }
+    printf("}");
+}
+
+int main(void) {
+    static cpu_track_t tracks[MAX_CPU_TRACKS];
+    record_list_t list = { 0 };
+    char line[LINE_MAX_LEN];
+    int in_dump = 0;
+    size_t bad = 0, dumps = 0;
+    uint64_t overwritten = 0;
+
+    while (fgets(line, sizeof(line), stdin)) {
+        char *mark = strchr(line, '#');
+        if (!mark) {
+            continue;
+        }
+
+        unsigned version, cpus;
+        unsigned long long khz, total, lost;
+        if (sscanf(mark, "#TRACE-BEGIN %u %u %llu", &version, &cpus, &khz) == 3) {
+            if (version != TRACE_VERSION) {
+                fprintf(stderr, "trace2json: unsupported trace version %u\n", version);
+                return 1;
+            }
+            if (khz) {
+                tsc_khz = khz;
+            }
+            in_dump = 1;
+            dumps++;
+        } else if (sscanf(mark, "#TRACE-END %llu %llu", &total, &lost) == 2) {
+            overwritten += lost;
+            in_dump = 0;
+        } else if (in_dump && strncmp(mark, "#T ", 3) == 0) {
+            trace_record_t rec;
+            if (strlen(mark + 3) >= 2 * TRACE_RECORD_SIZE && parse_record(mark + 3, &rec) == 0) {
+                list_append(&list, &rec);
+            } else {
+                bad++;
+            }
+        }
+    }
+
+    if (dumps == 0) {
+        fprintf(stderr, "trace2json: no #TRACE-BEGIN marker in input\n");
+        return 1;
+    }
+    if (tsc_khz == 0) {
+        fprintf(stderr, "trace2json: TSC frequency unknown, assuming 1 GHz\n");
+        tsc_khz = 1000000;
+    }
+
+    qsort(list.records, list.count, sizeof(*list.records), compare_tsc);
+    tsc_origin = list.count ? list.records[0].tsc : 0;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"tsc_khz\":%llu,\"dumps\":%zu,"
+           "\"records\":%zu,\"overwritten\":%llu,\"malformed\":%zu},\"traceEvents\":[",
+           (unsigned long long)tsc_khz, dumps, list.count,
+           (unsigned long long)overwritten, bad);
+
+    for (size_t i = 0; i < list.count; i++) {
+        const trace_record_t *rec = &list.records[i];
+        cpu_track_t *track = &tracks[rec->cpu];
+
+        if (!track->seen) {
+            track->seen = 1;
+            begin_event();
+            printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                   "\"args\":{\"name\":\"CPU %u\"}}", rec->cpu * 2, rec->cpu);
+            begin_event();
+            printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,"
+                   "\"args\":{\"name\":\"CPU %u process\"}}", rec->cpu * 2 + 1, rec->cpu);
+        }
+
+        emit_record(rec, track);
+    }
+
+    /* Close process slices still running at the end of the capture */
+    double end = list.count ? to_us(list.records[list.count - 1].tsc) : 0;
+    for (uint32_t cpu = 0; cpu < MAX_CPU_TRACKS; cpu++) {
+        if (tracks[cpu].running) {
+            emit_process_slice(cpu, tracks[cpu].pid, tracks[cpu].since, end);
+        }
+    }
+
+    printf("\n]}\n");
+    free(list.records);
+
+    return 0;
+}